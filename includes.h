@@ -9,12 +9,15 @@
 #include "pico/multicore.h"
 #include "event_manager.h"
 #include "lib/powerman/PowerManager.h" 
+#include "lib/powerman/sleep_scheduler.h"
 #include <pico/bootrom.h>
 
 #include "ISensor.h"
 #include "lib/sensors/BH1750/BH1750_WRAPPER.h" 
 #include "lib/sensors/BME280/BME280_WRAPPER.h" 
 #include "lib/clock/DS3231.h" 
+#include "lib/clock/time_service.h"
+#include "lib/clock/gps_time_sync.h"
 #include <iostream>
 #include <iomanip>
 #include <queue>
@@ -25,10 +28,19 @@
 #include <map>
 #include "pin_config.h"
 #include "utils.h"
+#include "log.h"
+#include "uart_tx.h"
+#include "i2c_bus.h"
 #include "communication.h"
+#include "beacon.h"
 #include "build_number.h"
 #include "lib/location/gps_collector.h"
+#include "lib/location/gps_uart_rx.h"
+#include "lib/location/gps_config.h"
+#include "lib/location/gps_power.h"
+#include "lib/location/trajectory.h"
 #include "lib/storage/storage.h" 
+#include "lib/storage/system_log.h"
 #include "lib/storage/pico-vfs/include/filesystem/vfs.h"
 #include "telemetry_manager.h"
 #include "system_state_manager.h"
@@ -1,5 +1,6 @@
 #include "DS3231.h"
 #include "utils.h"
+#include "i2c_bus.h"
 #include <cstdio> 
 #include <mutex>  
 #include "event_manager.h"
@@ -186,6 +187,97 @@ time_t DS3231::get_local_time() {
 }
 
 
+/**
+ * @brief Reads the aging offset register
+ * 
+ * @param[out] offset Aging offset, positive values slow the oscillator
+ * @return 0 on success, -1 on failure
+ * @details The aging offset trims the oscillator load capacitance; one LSB is
+ *          about 0.1 ppm at 25°C.
+ * @ingroup DS3231_RTC
+ */
+int DS3231::get_aging_offset(int8_t *offset) {
+    uint8_t value;
+    if (i2c_read_reg(DS3231_AGING_OFFSET_REG, 1, &value) != 0) {
+        return -1;
+    }
+    *offset = static_cast<int8_t>(value);
+    return 0;
+}
+
+
+/**
+ * @brief Writes the aging offset register and applies it
+ * 
+ * @param offset Aging offset, positive values slow the oscillator
+ * @return 0 on success, -1 on failure
+ * @details The new offset is used from the next temperature conversion, so one is
+ *          started right away instead of waiting up to 64 s.
+ * @ingroup DS3231_RTC
+ */
+int DS3231::set_aging_offset(int8_t offset) {
+    uint8_t value = static_cast<uint8_t>(offset);
+    recursive_mutex_enter_blocking(&clock_mutex_);
+    int result = i2c_write_reg(DS3231_AGING_OFFSET_REG, 1, &value);
+    uint8_t control;
+    if (result == 0 && (result = i2c_read_reg(DS3231_CONTROL_REG, 1, &control)) == 0) {
+        control |= DS3231_CONTROL_CONV_BIT;
+        result = i2c_write_reg(DS3231_CONTROL_REG, 1, &control);
+    }
+    recursive_mutex_exit(&clock_mutex_);
+    return result;
+}
+
+
+/**
+ * @brief Gets the interval between two GPS synchronisations
+ * 
+ * @return Interval in minutes
+ * @ingroup DS3231_RTC
+ */
+uint32_t DS3231::get_sync_interval() const {
+    return sync_interval_minutes_;
+}
+
+
+/**
+ * @brief Sets the interval between two GPS synchronisations
+ * 
+ * @param minutes Interval in minutes (1 to 10080, one week)
+ * @return True if the interval was accepted
+ * @ingroup DS3231_RTC
+ */
+bool DS3231::set_sync_interval(uint32_t minutes) {
+    if (minutes == 0 || minutes > 10080) {
+        return false;
+    }
+    sync_interval_minutes_ = minutes;
+    return true;
+}
+
+
+/**
+ * @brief Gets the UTC time of the last GPS synchronisation
+ * 
+ * @return Unix timestamp, 0 if the clock was never synchronised
+ * @ingroup DS3231_RTC
+ */
+time_t DS3231::get_last_sync_time() const {
+    return last_sync_time_;
+}
+
+
+/**
+ * @brief Records a GPS synchronisation
+ * 
+ * @param unix_time UTC time of the synchronisation
+ * @ingroup DS3231_RTC
+ */
+void DS3231::set_last_sync_time(time_t unix_time) {
+    last_sync_time_ = unix_time;
+}
+
+
 // ==================== private methods
 
 /**
@@ -196,8 +288,8 @@ time_t DS3231::get_local_time() {
  * @param[out] data Buffer to store read data
  * @return 0 on success, -1 on failure
  * @details This method performs a thread-safe I²C read operation from the DS3231.
- *          It first writes the register address to the device, then reads the
- *          requested number of bytes. All access is protected by a mutex to prevent
+ *          It writes the register address and reads the requested number of
+ *          bytes after a repeated start, in one bus transaction. All access is protected by a mutex to prevent
  *          concurrent I²C operations that could corrupt data.
  * 
  * @note This is a low-level method used internally by the class.
@@ -210,15 +302,8 @@ int DS3231::i2c_read_reg(uint8_t reg_addr, size_t length, uint8_t *data) {
 
     recursive_mutex_enter_blocking(&clock_mutex_);
     uint8_t reg = reg_addr;
-    int write_result = i2c_write_blocking(i2c, ds3231_addr, &reg, 1, true);
-    if (write_result == PICO_ERROR_GENERIC) {
-        status = "Failed to write register address to DS3231";
-        uart_print(status, VerbosityLevel::ERROR);
-        recursive_mutex_exit(&clock_mutex_);
-        return -1;
-    }
-    int read_result = i2c_read_blocking(i2c, ds3231_addr, data, length, false);
-    if (read_result == PICO_ERROR_GENERIC) {
+    int read_result = i2c_bus_write_read(i2c, ds3231_addr, &reg, 1, data, length);
+    if (read_result < 0) {
         status = "Failed to read register data from DS3231";
         uart_print(status, VerbosityLevel::ERROR);
         recursive_mutex_exit(&clock_mutex_);
@@ -254,9 +339,9 @@ int DS3231::i2c_write_reg(uint8_t reg_addr, size_t length, uint8_t *data) {
     for (size_t i = 0; i < length; i++) {
         message[i + 1] = data[i];
     }
-    int write_result = i2c_write_blocking(i2c, ds3231_addr, message.data(), (length + 1), false);
-    if (write_result == PICO_ERROR_GENERIC) {
-        uart_print("Error: i2c_write_blocking failed in i2c_write_reg", VerbosityLevel::ERROR);
+    int write_result = i2c_bus_write_read(i2c, ds3231_addr, message.data(), (length + 1), nullptr, 0);
+    if (write_result < 0) {
+        uart_print("Error: I2C write failed in i2c_write_reg", VerbosityLevel::ERROR);
         recursive_mutex_exit(&clock_mutex_);
         return -1;
     }
@@ -59,6 +59,16 @@
  */
 #define DS3231_CONTROL_STATUS_REG       0x0F
 
+/**
+ * @brief Register address: Aging offset (signed, about 0.1 ppm per LSB)
+ */
+#define DS3231_AGING_OFFSET_REG         0x10
+
+/**
+ * @brief Control register bit: start a temperature conversion
+ */
+#define DS3231_CONTROL_CONV_BIT         0x20
+
 /**
  * @brief Register address: Temperature register (MSB)
  */
@@ -163,6 +173,51 @@ public:
      */
     time_t get_local_time();
 
+    /**
+     * @brief Reads the aging offset register
+     * 
+     * @param[out] offset Aging offset, positive values slow the oscillator
+     * @return 0 on success, -1 on failure
+     */
+    int get_aging_offset(int8_t *offset);
+
+    /**
+     * @brief Writes the aging offset register and applies it
+     * 
+     * @param offset Aging offset, positive values slow the oscillator
+     * @return 0 on success, -1 on failure
+     */
+    int set_aging_offset(int8_t offset);
+
+    /**
+     * @brief Gets the interval between two GPS synchronisations
+     * 
+     * @return Interval in minutes
+     */
+    uint32_t get_sync_interval() const;
+
+    /**
+     * @brief Sets the interval between two GPS synchronisations
+     * 
+     * @param minutes Interval in minutes (1 to 10080)
+     * @return True if the interval was accepted
+     */
+    bool set_sync_interval(uint32_t minutes);
+
+    /**
+     * @brief Gets the UTC time of the last GPS synchronisation
+     * 
+     * @return Unix timestamp, 0 if the clock was never synchronised
+     */
+    time_t get_last_sync_time() const;
+
+    /**
+     * @brief Records a GPS synchronisation
+     * 
+     * @param unix_time UTC time of the synchronisation
+     */
+    void set_last_sync_time(time_t unix_time);
+
 
     
 private:
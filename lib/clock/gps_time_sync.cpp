@@ -0,0 +1,241 @@
+#include "gps_time_sync.h"
+#include <cmath>
+#include "DS3231.h"
+#include "time_service.h"
+#include "NMEA_data.h"
+#include "event_manager.h"
+#include "utils.h"
+
+/**
+ * @defgroup TimeService Time Service
+ * @brief Cheap UTC and local timestamps.
+ * @{
+ */
+
+namespace {
+
+/**
+ * @brief Days from 1970-01-01 to a civil date.
+ * @details Proleptic Gregorian calendar, independent of the C library time zone.
+ */
+int64_t days_from_civil(int32_t year, uint32_t month, uint32_t day) {
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t year_of_era = static_cast<uint32_t>(year - era * 400);
+    uint32_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    uint32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return static_cast<int64_t>(era) * 146097 + day_of_era - 719468;
+}
+
+/**
+ * @brief Gets the current GPS UTC time from the latest fix.
+ * @param[out] gps_ms UTC time in ms since the epoch.
+ * @return False if there is no recent valid RMC fix with a date.
+ */
+bool read_gps_time(uint64_t& gps_ms) {
+    GpsFixSnapshot snapshot = NMEAData::get_instance().get_snapshot();
+    const GpsFix& fix = snapshot.fix;
+
+    if (!(fix.sentences & GPS_FIX_HAS_RMC) || !fix.rmc_valid || fix.day == 0 || fix.month == 0 ||
+        snapshot.age_ms > GPS_SYNC_MAX_FIX_AGE_MS) {
+        return false;
+    }
+
+    int64_t days = days_from_civil(2000 + fix.year, fix.month, fix.day);
+    gps_ms = static_cast<uint64_t>(days) * 86400000ULL + fix.utc_time_ms + snapshot.age_ms + GPS_SYNC_NMEA_LATENCY_MS;
+    return true;
+}
+
+/**
+ * @brief Waits for the next DS3231 seconds edge.
+ * @param[out] edge_s RTC second that started at the edge.
+ * @param[out] edge_us time_us_64() of the edge, the middle of the two reads around it.
+ * @return False if the RTC could not be read or no edge was seen within GPS_SYNC_EDGE_TIMEOUT_MS.
+ * @details Reads the RTC back to back, so the edge is placed within one I2C read.
+ *          Blocks for up to one second.
+ */
+bool read_rtc_edge(time_t& edge_s, uint64_t& edge_us) {
+    DS3231& rtc = DS3231::get_instance();
+    uint64_t start_us = time_us_64();
+    uint64_t last_us = start_us;
+    time_t second = rtc.get_time();
+
+    while (second != -1 && time_us_64() - start_us < GPS_SYNC_EDGE_TIMEOUT_MS * 1000ULL) {
+        uint64_t poll_us = time_us_64();
+        time_t now_s = rtc.get_time();
+        if (now_s != second) {
+            if (now_s != second + 1) {
+                return false;
+            }
+            edge_s = now_s;
+            edge_us = poll_us - (poll_us - last_us) / 2;
+            return true;
+        }
+        last_us = poll_us;
+    }
+    return false;
+}
+
+} // namespace
+
+
+GpsTimeSync& GpsTimeSync::get_instance() {
+    static GpsTimeSync instance;
+    return instance;
+}
+
+
+/**
+ * @brief Runs a sync when it is due or requested.
+ * @param now_ms Current time in ms since boot.
+ * @details The first attempt is made GPS_SYNC_RETRY_MS after boot, then every
+ *          DS3231 sync interval, or every GPS_SYNC_RETRY_MS while no fix is
+ *          available.
+ */
+void GpsTimeSync::process(uint32_t now_ms) {
+    if (!requested.exchange(false) && now_ms - last_attempt_ms < next_delay_ms) {
+        return;
+    }
+    last_attempt_ms = now_ms;
+
+    uint64_t gps_ms;
+    if (!read_gps_time(gps_ms)) {
+        stats.not_ready++;
+        next_delay_ms = GPS_SYNC_RETRY_MS;
+        if (!not_ready_reported) {
+            not_ready_reported = true;
+            EventEmitter::emit(EventGroup::CLOCK, ClockEvent::GPS_SYNC_DATA_NOT_READY);
+        }
+        return;
+    }
+
+    not_ready_reported = false;
+    next_delay_ms = DS3231::get_instance().get_sync_interval() * 60 * 1000;
+    sync(gps_ms, time_us_64());
+}
+
+
+void GpsTimeSync::request_sync() {
+    requested = true;
+}
+
+
+bool GpsTimeSync::needs_fast_poll(uint32_t now_ms) const {
+    return requested.load() || now_ms - last_attempt_ms + GPS_SYNC_FAST_POLL_LEAD_MS >= next_delay_ms;
+}
+
+
+void GpsTimeSync::on_fix_available() {
+    if (not_ready_reported) {
+        requested = true;
+    }
+}
+
+
+// ==================== private methods
+
+/**
+ * @brief Compares RTC and GPS time, updates the drift and corrects the RTC.
+ * @param gps_ms GPS UTC time in ms since the epoch.
+ * @param measured_us time_us_64() at which gps_ms was valid.
+ * @details The RTC is read at its next seconds edge, where its time is exact to
+ *          the edge detection, and gps_ms is carried forward to that edge. Without
+ *          an edge the sync is retried after GPS_SYNC_RETRY_MS.
+ */
+void GpsTimeSync::sync(uint64_t gps_ms, uint64_t measured_us) {
+    DS3231& rtc = DS3231::get_instance();
+    if (!aging_read) {
+        aging_read = rtc.get_aging_offset(&stats.aging_offset) == 0;
+    }
+
+    // compare at a fresh RTC seconds edge; the TimeService time is extrapolated on the XOSC
+    time_t edge_s;
+    uint64_t edge_us;
+    if (!read_rtc_edge(edge_s, edge_us)) {
+        stats.not_ready++;
+        next_delay_ms = GPS_SYNC_RETRY_MS;
+        return;
+    }
+    uint64_t rtc_ms = static_cast<uint64_t>(edge_s) * 1000;
+    gps_ms += (edge_us - measured_us) / 1000;
+    int64_t offset_ms = static_cast<int64_t>(rtc_ms) - static_cast<int64_t>(gps_ms);
+
+    stats.syncs++;
+    stats.last_offset_ms = static_cast<int32_t>(offset_ms);
+    update_drift(gps_ms, offset_ms);
+
+    if (std::llabs(offset_ms) > GPS_SYNC_CORRECTION_THRESHOLD_MS) {
+        // write the next GPS second as it starts
+        uint64_t next_second = gps_ms / 1000 + 1;
+        uint64_t now_us = time_us_64();
+        busy_wait_until(from_us_since_boot(now_us + (next_second * 1000 - gps_ms) * 1000));
+
+        if (TimeService::get_instance().set_time(static_cast<time_t>(next_second)) == 0) {
+            stats.corrections++;
+            reference_valid = true;
+            reference_gps_ms = next_second * 1000;
+            reference_offset_ms = 0;
+            uart_print("RTC corrected from GPS by " + std::to_string(-offset_ms) + " ms", VerbosityLevel::INFO);
+        }
+        gps_ms = next_second * 1000;
+    }
+
+    stats.last_sync_utc = gps_ms / 1000;
+    rtc.set_last_sync_time(static_cast<time_t>(stats.last_sync_utc));
+    EventEmitter::emit(EventGroup::CLOCK, ClockEvent::GPS_SYNC);
+}
+
+
+/**
+ * @brief Estimates the RTC rate error and trims the aging offset.
+ * @param gps_ms GPS UTC time of the comparison.
+ * @param offset_ms RTC minus GPS time.
+ * @details The rate is the offset change since the reference (the last
+ *          correction or estimate) divided by the GPS time elapsed. A timestamp
+ *          error of a few ms over the one hour baseline is still about 1 ppm,
+ *          ten aging LSB, so the rates go through a first-order low-pass filter
+ *          and the aging offset moves by at most GPS_SYNC_MAX_AGING_STEP towards
+ *          the filtered drift. A fast RTC gets a larger aging offset, which
+ *          slows the oscillator; the expected effect of the step is taken out
+ *          of the filtered drift.
+ */
+void GpsTimeSync::update_drift(uint64_t gps_ms, int64_t offset_ms) {
+    if (!reference_valid) {
+        reference_valid = true;
+        reference_gps_ms = gps_ms;
+        reference_offset_ms = offset_ms;
+        return;
+    }
+
+    uint64_t elapsed_ms = gps_ms - reference_gps_ms;
+    if (elapsed_ms < GPS_SYNC_MIN_DRIFT_BASELINE_S * 1000ULL) {
+        return;
+    }
+
+    stats.last_drift_ppm = static_cast<float>(offset_ms - reference_offset_ms) / static_cast<float>(elapsed_ms) * 1e6f;
+    reference_gps_ms = gps_ms;
+    reference_offset_ms = offset_ms;
+
+    if (drift_valid) {
+        stats.drift_ppm += (stats.last_drift_ppm - stats.drift_ppm) * GPS_SYNC_DRIFT_FILTER_GAIN;
+    } else {
+        stats.drift_ppm = stats.last_drift_ppm;
+        drift_valid = true;
+    }
+
+    long step = std::lround(stats.drift_ppm / DS3231_AGING_PPM_PER_LSB);
+    step = step > GPS_SYNC_MAX_AGING_STEP ? GPS_SYNC_MAX_AGING_STEP :
+           (step < -GPS_SYNC_MAX_AGING_STEP ? -GPS_SYNC_MAX_AGING_STEP : step);
+    if (step == 0 || !aging_read) {
+        return;
+    }
+
+    long aging = stats.aging_offset + step;
+    aging = aging > INT8_MAX ? INT8_MAX : (aging < INT8_MIN ? INT8_MIN : aging);
+    if (aging != stats.aging_offset && DS3231::get_instance().set_aging_offset(static_cast<int8_t>(aging)) == 0) {
+        stats.drift_ppm -= static_cast<float>(aging - stats.aging_offset) * DS3231_AGING_PPM_PER_LSB;
+        stats.aging_offset = static_cast<int8_t>(aging);
+        stats.aging_updates++;
+    }
+}
+/** @} */ // TimeService
@@ -0,0 +1,174 @@
+#ifndef GPS_TIME_SYNC_H
+#define GPS_TIME_SYNC_H
+
+#include <cstdint>
+#include <atomic>
+#include <time.h>
+
+/**
+ * @file gps_time_sync.h
+ * @brief Disciplines the DS3231 to GPS time
+ * @details Every DS3231 sync interval the service compares the GPS UTC of the
+ *          latest valid RMC fix with the DS3231 time at its next seconds edge.
+ *          The GPS time is the RMC time plus the age of the fix, so the
+ *          comparison has millisecond resolution although the RTC only counts
+ *          seconds. The time served by TimeService is not used: it is
+ *          extrapolated on the system clock for up to TIME_RESYNC_INTERVAL_MS
+ *          and would add the system clock error to the drift estimate. The
+ *          age is counted from the reception of the RMC '$' by the UART
+ *          interrupt, not from when core 1 parsed it.
+ *
+ *          - Offsets above GPS_SYNC_CORRECTION_THRESHOLD_MS are corrected by
+ *            writing the RTC exactly at a GPS second boundary; writing the
+ *            seconds register restarts the DS3231 countdown chain, so the RTC
+ *            second then starts on the GPS second.
+ *          - The change of the offset between two syncs at least
+ *            GPS_SYNC_MIN_DRIFT_BASELINE_S apart is the RTC drift rate. The
+ *            rates are low-pass filtered and the filtered drift is compensated
+ *            by trimming the DS3231 aging offset by at most
+ *            GPS_SYNC_MAX_AGING_STEP per sync, so a noisy pair of syncs moves
+ *            the oscillator by at most that step.
+ *
+ *          Comparisons emit ClockEvent::GPS_SYNC; an attempt without a valid
+ *          fix emits ClockEvent::GPS_SYNC_DATA_NOT_READY once and is retried
+ *          every GPS_SYNC_RETRY_MS.
+ *
+ * @defgroup TimeService Time Service
+ * @brief Cheap UTC and local timestamps.
+ * @{
+ */
+
+/**
+ * @brief Delay before retrying when no valid fix was available.
+ */
+static constexpr uint32_t GPS_SYNC_RETRY_MS = 60 * 1000;
+
+/**
+ * @brief Oldest RMC position accepted for a sync.
+ */
+static constexpr uint32_t GPS_SYNC_MAX_FIX_AGE_MS = 1500;
+
+/**
+ * @brief Typical delay between the fix epoch and the reception of its RMC sentence.
+ */
+static constexpr uint32_t GPS_SYNC_NMEA_LATENCY_MS = 50;
+
+/**
+ * @brief Time before a due sync from which the core 1 loop runs fast, so the RMC is parsed as it arrives.
+ */
+static constexpr uint32_t GPS_SYNC_FAST_POLL_LEAD_MS = 2000;
+
+/**
+ * @brief Longest wait for the DS3231 seconds edge a sync compares at.
+ */
+static constexpr uint32_t GPS_SYNC_EDGE_TIMEOUT_MS = 1500;
+
+/**
+ * @brief Offset above which the RTC is rewritten.
+ */
+static constexpr int32_t GPS_SYNC_CORRECTION_THRESHOLD_MS = 100;
+
+/**
+ * @brief Shortest time between two syncs used for a drift estimate.
+ */
+static constexpr uint32_t GPS_SYNC_MIN_DRIFT_BASELINE_S = 3600;
+
+/**
+ * @brief Frequency change of one DS3231 aging offset LSB at 25°C.
+ */
+static constexpr float DS3231_AGING_PPM_PER_LSB = 0.1f;
+
+/**
+ * @brief Weight of a new rate measurement in the filtered drift.
+ */
+static constexpr float GPS_SYNC_DRIFT_FILTER_GAIN = 0.25f;
+
+/**
+ * @brief Largest aging offset change applied after one drift measurement, in LSB.
+ */
+static constexpr int GPS_SYNC_MAX_AGING_STEP = 1;
+
+/**
+ * @brief GPS synchronisation counters and drift estimate.
+ */
+struct GpsTimeSyncStats {
+    uint32_t syncs;          /**< Comparisons with a valid fix */
+    uint32_t corrections;    /**< RTC rewrites */
+    uint32_t not_ready;      /**< Attempts without a valid fix or RTC seconds edge */
+    uint32_t aging_updates;  /**< Aging offset changes */
+    int32_t last_offset_ms;  /**< RTC minus GPS time at the last sync */
+    float drift_ppm;         /**< Filtered RTC rate error at the current aging offset, positive if fast */
+    float last_drift_ppm;    /**< Last unfiltered rate measurement */
+    int8_t aging_offset;     /**< DS3231 aging offset register */
+    uint32_t last_sync_utc;  /**< UTC time of the last sync, 0 if none */
+};
+
+/**
+ * @brief Synchronises the DS3231 to GPS time and compensates its drift.
+ */
+class GpsTimeSync {
+public:
+    /**
+     * @brief Gets the singleton instance of the GpsTimeSync class.
+     * @return A reference to the singleton instance.
+     */
+    static GpsTimeSync& get_instance();
+
+    /**
+     * @brief Runs a sync when it is due or requested.
+     * @param now_ms Current time in ms since boot.
+     * @details Called from the core 1 loop. A sync blocks for up to one second
+     *          to catch the RTC seconds edge, and a correction for up to one more
+     *          second to reach the next GPS second boundary.
+     */
+    void process(uint32_t now_ms);
+
+    /**
+     * @brief Requests a sync at the next process() call.
+     */
+    void request_sync();
+
+    /**
+     * @brief Retries at once a sync that found no fix.
+     * @details Called when the receiver reports a fix, so a sync that was due
+     *          while the receiver was off runs inside the fix window.
+     */
+    void on_fix_available();
+
+    /**
+     * @brief Tells whether the core 1 loop should run fast.
+     * @param now_ms Current time in ms since boot.
+     * @return True from GPS_SYNC_FAST_POLL_LEAD_MS before a sync is due, or with a sync requested.
+     */
+    bool needs_fast_poll(uint32_t now_ms) const;
+
+    /**
+     * @brief Gets the counters and drift estimate.
+     * @return Copy of the statistics.
+     */
+    GpsTimeSyncStats get_stats() const { return stats; }
+
+private:
+    GpsTimeSync() = default;
+    GpsTimeSync(const GpsTimeSync&) = delete;
+    GpsTimeSync& operator=(const GpsTimeSync&) = delete;
+
+    void sync(uint64_t gps_ms, uint64_t measured_us);
+    void update_drift(uint64_t gps_ms, int64_t offset_ms);
+
+    std::atomic<bool> requested{false};
+    uint32_t last_attempt_ms = 0;
+    uint32_t next_delay_ms = GPS_SYNC_RETRY_MS;
+    bool not_ready_reported = false;
+    bool aging_read = false;
+
+    bool reference_valid = false;
+    uint64_t reference_gps_ms = 0;
+    int64_t reference_offset_ms = 0;
+    bool drift_valid = false;
+
+    GpsTimeSyncStats stats = {};
+};
+
+#endif // GPS_TIME_SYNC_H
+/** @} */
@@ -0,0 +1,283 @@
+#include "time_service.h"
+#include "DS3231.h"
+#include "utils.h"
+#include <cstdlib>
+
+/**
+ * @defgroup TimeService Time Service
+ * @brief Cheap UTC and local timestamps.
+ * @{
+ */
+
+/**
+ * @brief Gives up on a tight seconds edge after this long and accepts the next one.
+ */
+static constexpr uint32_t EDGE_HUNT_TIMEOUT_MS = 5000;
+
+/**
+ * @brief Minimum RTC time between two anchors for a drift estimate.
+ */
+static constexpr uint64_t DRIFT_MIN_BASELINE_MS = 60 * 1000;
+
+
+TimeService::TimeService() :
+    anchor_utc_ms(0),
+    anchor_us(0),
+    baseline_utc_ms(0),
+    baseline_us(0),
+    baseline_valid(false),
+    stats{},
+    state(SyncState::IDLE),
+    last_resync_ms(0),
+    hunt_second(0),
+    hunt_last_poll_us(0),
+    hunt_start_ms(0),
+    hunt_generation(0)
+{
+    critical_section_init(&anchor_lock);
+}
+
+
+/**
+ * @brief Gets the singleton instance of the TimeService class.
+ * @return A reference to the singleton instance.
+ * @ingroup TimeService
+ */
+TimeService& TimeService::get_instance() {
+    static TimeService instance;
+    return instance;
+}
+
+
+/**
+ * @brief Takes a coarse anchor from one RTC read and schedules an edge resync.
+ * @return True if the RTC could be read.
+ * @details Until the first edge is found the anchor can be up to one second behind.
+ * @ingroup TimeService
+ */
+bool TimeService::init() {
+    time_t rtc_time = DS3231::get_instance().get_time();
+    uint64_t now_us = time_us_64();
+
+    if (rtc_time == -1) {
+        critical_section_enter_blocking(&anchor_lock);
+        stats.read_failures++;
+        critical_section_exit(&anchor_lock);
+        uart_print("Time service: RTC not readable, using time since boot", VerbosityLevel::ERROR);
+        return false;
+    }
+
+    set_anchor(static_cast<uint64_t>(rtc_time) * 1000, now_us, 1000);
+    request_resync();
+    uart_print("Time service initialized", VerbosityLevel::INFO);
+    return true;
+}
+
+
+/**
+ * @brief Runs the resync state machine.
+ * @param now_ms Current time in ms since boot.
+ * @details In IDLE a resync starts every TIME_RESYNC_INTERVAL_MS or when requested.
+ *          In EDGE_HUNT each call reads the RTC once; when the second changes
+ *          between two reads the edge is placed in the middle of the two reads.
+ *          Edges seen through a gap wider than twice TIME_MAX_EDGE_UNCERTAINTY_MS
+ *          are skipped unless the hunt has run for EDGE_HUNT_TIMEOUT_MS.
+ * @ingroup TimeService
+ */
+void TimeService::process(uint32_t now_ms) {
+    bool start_hunt = resync_requested.exchange(false) ||
+                      (state == SyncState::IDLE && now_ms - last_resync_ms >= TIME_RESYNC_INTERVAL_MS);
+
+    if (state == SyncState::IDLE && !start_hunt) {
+        return;
+    }
+
+    uint64_t poll_us = time_us_64();
+    time_t rtc_time = DS3231::get_instance().get_time();
+
+    if (rtc_time == -1) {
+        critical_section_enter_blocking(&anchor_lock);
+        stats.read_failures++;
+        critical_section_exit(&anchor_lock);
+        state = SyncState::IDLE;
+        last_resync_ms = now_ms;
+        return;
+    }
+
+    if (start_hunt) {
+        state = SyncState::EDGE_HUNT;
+        hunt_second = rtc_time;
+        hunt_last_poll_us = poll_us;
+        hunt_start_ms = now_ms;
+        hunt_generation = anchor_generation.load();
+        return;
+    }
+
+    if (rtc_time == hunt_second) {
+        hunt_last_poll_us = poll_us;
+        return;
+    }
+
+    uint64_t gap_us = poll_us - hunt_last_poll_us;
+    uint32_t uncertainty_ms = gap_us / 2000;
+    bool single_step = rtc_time == hunt_second + 1;
+
+    if ((!single_step || uncertainty_ms > TIME_MAX_EDGE_UNCERTAINTY_MS) &&
+        now_ms - hunt_start_ms < EDGE_HUNT_TIMEOUT_MS) {
+        hunt_second = rtc_time;
+        hunt_last_poll_us = poll_us;
+        return;
+    }
+
+    if (hunt_generation == anchor_generation.load()) {
+        on_edge(rtc_time, poll_us - gap_us / 2, uncertainty_ms);
+    }
+
+    state = SyncState::IDLE;
+    last_resync_ms = now_ms;
+}
+
+
+/**
+ * @brief Sets the RTC and re-anchors to the written time.
+ * @param unix_time UTC time in seconds since the epoch.
+ * @return 0 on success, -1 on failure.
+ * @details Writing the seconds register restarts the DS3231 countdown chain, so the
+ *          written second starts at the write. The drift baseline restarts because
+ *          the step is intentional.
+ * @ingroup TimeService
+ */
+int TimeService::set_time(time_t unix_time) {
+    if (DS3231::get_instance().set_time(unix_time) != 0) {
+        return -1;
+    }
+    uint64_t now_us = time_us_64();
+
+    anchor_generation++;
+    set_anchor(static_cast<uint64_t>(unix_time) * 1000, now_us, 1);
+
+    critical_section_enter_blocking(&anchor_lock);
+    stats.anchored = true;
+    baseline_utc_ms = anchor_utc_ms;
+    baseline_us = anchor_us;
+    baseline_valid = true;
+    critical_section_exit(&anchor_lock);
+
+    return 0;
+}
+
+
+/**
+ * @brief Gets the UTC time.
+ * @return Milliseconds since the epoch.
+ * @ingroup TimeService
+ */
+uint64_t TimeService::get_utc_ms() {
+    critical_section_enter_blocking(&anchor_lock);
+    uint64_t utc_ms = anchor_utc_ms + (time_us_64() - anchor_us) / 1000;
+    critical_section_exit(&anchor_lock);
+    return utc_ms;
+}
+
+
+/**
+ * @brief Gets the local time (UTC plus the DS3231 timezone offset).
+ * @return Milliseconds since the epoch.
+ * @ingroup TimeService
+ */
+uint64_t TimeService::get_local_ms() {
+    int64_t offset_ms = static_cast<int64_t>(DS3231::get_instance().get_timezone_offset()) * 60 * 1000;
+    return get_utc_ms() + offset_ms;
+}
+
+
+/**
+ * @brief Requests an edge resync at the next process() call.
+ * @ingroup TimeService
+ */
+void TimeService::request_resync() {
+    resync_requested = true;
+}
+
+
+/**
+ * @brief Gets the synchronisation state and drift statistics.
+ * @return Copy of the statistics.
+ * @ingroup TimeService
+ */
+TimeSyncStats TimeService::get_stats() {
+    critical_section_enter_blocking(&anchor_lock);
+    TimeSyncStats copy = stats;
+    copy.anchor_age_s = (time_us_64() - anchor_us) / 1000000;
+    critical_section_exit(&anchor_lock);
+    return copy;
+}
+
+
+// ==================== private methods
+
+/**
+ * @brief Replaces the anchor.
+ * @param utc_ms UTC time of the anchor in ms since the epoch.
+ * @param timer_us time_us_64() at the anchor.
+ * @param uncertainty_ms Uncertainty of the anchor.
+ * @ingroup TimeService
+ */
+void TimeService::set_anchor(uint64_t utc_ms, uint64_t timer_us, uint32_t uncertainty_ms) {
+    critical_section_enter_blocking(&anchor_lock);
+    anchor_utc_ms = utc_ms;
+    anchor_us = timer_us;
+    stats.uncertainty_ms = uncertainty_ms;
+    critical_section_exit(&anchor_lock);
+}
+
+
+/**
+ * @brief Re-anchors to a seconds edge and updates the drift statistics.
+ * @param rtc_time RTC second that started at the edge.
+ * @param edge_us Estimated time_us_64() of the edge.
+ * @param uncertainty_ms Uncertainty of the edge.
+ * @details The offset is the extrapolated time at the edge minus the RTC time.
+ *          Drift is measured against the first edge after boot or the last step,
+ *          so its resolution improves as the baseline grows.
+ * @ingroup TimeService
+ */
+void TimeService::on_edge(time_t rtc_time, uint64_t edge_us, uint32_t uncertainty_ms) {
+    uint64_t rtc_ms = static_cast<uint64_t>(rtc_time) * 1000;
+    bool stepped = false;
+
+    critical_section_enter_blocking(&anchor_lock);
+    int64_t offset_ms = static_cast<int64_t>(anchor_utc_ms + (edge_us - anchor_us) / 1000) - static_cast<int64_t>(rtc_ms);
+
+    if (stats.anchored) {
+        stats.resyncs++;
+        stats.last_offset_ms = static_cast<int32_t>(offset_ms);
+
+        if (std::llabs(offset_ms) > TIME_STEP_THRESHOLD_MS) {
+            stats.steps++;
+            stepped = true;
+            baseline_valid = false;
+        } else if (baseline_valid && rtc_ms - baseline_utc_ms >= DRIFT_MIN_BASELINE_MS) {
+            double rtc_elapsed_us = static_cast<double>(rtc_ms - baseline_utc_ms) * 1000.0;
+            double timer_elapsed_us = static_cast<double>(edge_us - baseline_us);
+            stats.drift_ppm = static_cast<float>((timer_elapsed_us - rtc_elapsed_us) / rtc_elapsed_us * 1e6);
+        }
+    }
+
+    if (!baseline_valid) {
+        baseline_utc_ms = rtc_ms;
+        baseline_us = edge_us;
+        baseline_valid = true;
+    }
+
+    anchor_utc_ms = rtc_ms;
+    anchor_us = edge_us;
+    stats.uncertainty_ms = uncertainty_ms;
+    stats.anchored = true;
+    critical_section_exit(&anchor_lock);
+
+    if (stepped) {
+        uart_print("Time service: RTC stepped by " + std::to_string(-offset_ms) + " ms", VerbosityLevel::WARNING);
+    }
+}
+/** @} */ // TimeService
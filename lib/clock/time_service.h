@@ -0,0 +1,167 @@
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <cstdint>
+#include <atomic>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "pico/critical_section.h"
+
+/**
+ * @file time_service.h
+ * @brief Wall-clock time derived from the DS3231 and the microsecond timer
+ * @details Reading the DS3231 costs an I2C burst read, a BCD decode and mktime().
+ *          The time service reads the RTC only when (re)synchronising and anchors
+ *          the RTC second to time_us_64(). Every other timestamp is the anchor plus
+ *          the elapsed timer time, which takes a critical section and some integer
+ *          arithmetic.
+ *
+ *          The DS3231 only reports whole seconds, so a resync polls the RTC from
+ *          process() until the seconds register changes and anchors to that edge.
+ *          The offset between the extrapolated and the read time at each resync
+ *          is the timer/RTC drift since the previous anchor.
+ *
+ * @defgroup TimeService Time Service
+ * @brief Cheap UTC and local timestamps.
+ * @{
+ */
+
+/**
+ * @brief Interval between two RTC resyncs.
+ */
+static constexpr uint32_t TIME_RESYNC_INTERVAL_MS = 10 * 60 * 1000;
+
+/**
+ * @brief Largest timer gap around a seconds edge accepted as an anchor.
+ */
+static constexpr uint32_t TIME_MAX_EDGE_UNCERTAINTY_MS = 25;
+
+/**
+ * @brief Offset beyond which a resync is treated as a clock step, not drift.
+ */
+static constexpr int32_t TIME_STEP_THRESHOLD_MS = 2000;
+
+/**
+ * @brief Synchronisation state and drift statistics.
+ */
+struct TimeSyncStats {
+    bool anchored;              /**< Anchor taken at a seconds edge */
+    uint32_t uncertainty_ms;    /**< Half width of the timer window around the anchored edge */
+    int32_t last_offset_ms;     /**< Extrapolated minus RTC time at the last resync */
+    float drift_ppm;            /**< Timer rate relative to the RTC since the last step, positive if the timer runs fast */
+    uint32_t resyncs;           /**< Edge resyncs since boot */
+    uint32_t steps;             /**< Resyncs that found an offset above TIME_STEP_THRESHOLD_MS */
+    uint32_t read_failures;     /**< Failed RTC reads */
+    uint32_t anchor_age_s;      /**< Time since the last anchor */
+};
+
+/**
+ * @brief Serves UTC and local time from an RTC anchor and the microsecond timer.
+ */
+class TimeService {
+public:
+    /**
+     * @brief Gets the singleton instance of the TimeService class.
+     * @return A reference to the singleton instance.
+     */
+    static TimeService& get_instance();
+
+    /**
+     * @brief Takes a coarse anchor from one RTC read and schedules an edge resync.
+     * @return True if the RTC could be read.
+     */
+    bool init();
+
+    /**
+     * @brief Runs the resync state machine.
+     * @param now_ms Current time in ms since boot.
+     * @details Called from the core 1 loop. Reads the RTC only while looking for a
+     *          seconds edge.
+     */
+    void process(uint32_t now_ms);
+
+    /**
+     * @brief Sets the RTC and re-anchors to the written time.
+     * @param unix_time UTC time in seconds since the epoch.
+     * @return 0 on success, -1 on failure.
+     */
+    int set_time(time_t unix_time);
+
+    /**
+     * @brief Gets the UTC time.
+     * @return Milliseconds since the epoch.
+     */
+    uint64_t get_utc_ms();
+
+    /**
+     * @brief Gets the UTC time.
+     * @return Seconds since the epoch.
+     */
+    uint32_t get_utc() { return get_utc_ms() / 1000; }
+
+    /**
+     * @brief Gets the local time (UTC plus the DS3231 timezone offset).
+     * @return Milliseconds since the epoch.
+     */
+    uint64_t get_local_ms();
+
+    /**
+     * @brief Gets the local time (UTC plus the DS3231 timezone offset).
+     * @return Seconds since the epoch.
+     */
+    uint32_t get_local_time() { return get_local_ms() / 1000; }
+
+    /**
+     * @brief Requests an edge resync at the next process() call.
+     */
+    void request_resync();
+
+    /**
+     * @brief Tells whether process() needs to be called at a short period.
+     * @return True while looking for a seconds edge or with a resync requested.
+     * @details The edge is placed between two RTC reads, so the loop period
+     *          bounds the anchor uncertainty.
+     */
+    bool needs_fast_poll() const { return state == SyncState::EDGE_HUNT || resync_requested.load(); }
+
+    /**
+     * @brief Gets the synchronisation state and drift statistics.
+     * @return Copy of the statistics.
+     */
+    TimeSyncStats get_stats();
+
+private:
+    enum class SyncState : uint8_t {
+        IDLE,
+        EDGE_HUNT
+    };
+
+    critical_section_t anchor_lock;
+    uint64_t anchor_utc_ms;
+    uint64_t anchor_us;
+    uint64_t baseline_utc_ms;
+    uint64_t baseline_us;
+    bool baseline_valid;
+    TimeSyncStats stats;
+
+    std::atomic<bool> resync_requested{false};
+    std::atomic<uint32_t> anchor_generation{0};
+
+    SyncState state;
+    uint32_t last_resync_ms;
+    time_t hunt_second;
+    uint64_t hunt_last_poll_us;
+    uint32_t hunt_start_ms;
+    uint32_t hunt_generation;
+
+    TimeService();
+
+    TimeService(const TimeService&) = delete;
+    TimeService& operator=(const TimeService&) = delete;
+
+    void set_anchor(uint64_t utc_ms, uint64_t timer_us, uint32_t uncertainty_ms);
+    void on_edge(time_t rtc_time, uint64_t edge_us, uint32_t uncertainty_ms);
+};
+
+#endif // TIME_SERVICE_H
+/** @} */
@@ -418,6 +418,22 @@ void LoRaClass::channelActivityDetection(void)
   writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_CAD);
 }
 
+// polled alternative to onCadDone for boards without DIO0 wired to an IRQ
+// returns -1 while CAD is running, 0 if the channel is free, 1 if a preamble was detected
+int LoRaClass::cadStatus() 
+{
+  int irqFlags = readRegister(REG_IRQ_FLAGS);
+
+  if ((irqFlags & IRQ_CAD_DONE_MASK) == 0) {
+    return -1;
+  }
+
+  // clear IRQ's
+  writeRegister(REG_IRQ_FLAGS, IRQ_CAD_DONE_MASK | IRQ_CAD_DETECTED_MASK);
+
+  return (irqFlags & IRQ_CAD_DETECTED_MASK) ? 1 : 0;
+}
+
 void LoRaClass::idle() 
 {
   writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_STDBY);
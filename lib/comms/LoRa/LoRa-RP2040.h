@@ -45,6 +45,7 @@ public:
 
   void receive(int size = 0);
   void channelActivityDetection(void);
+  int cadStatus();
 
   void idle();
   void sleep();
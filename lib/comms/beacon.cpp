@@ -0,0 +1,168 @@
+/**
+ * @file beacon.cpp
+ * @brief Implementation of the periodic housekeeping beacon.
+ *
+ * @defgroup Beacon Beacon
+ * @brief Unsolicited housekeeping packet.
+ *
+ * @{
+ */
+
+#include "beacon.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include "communication.h"
+#include "event_manager.h"
+#include "log.h"
+#include "system_state_manager.h"
+#include "telemetry_manager.h"
+
+namespace {
+
+/**
+ * @brief Clamps a float to the int16_t range after rounding.
+ * @param value Value to convert.
+ * @return Rounded and saturated value.
+ */
+int16_t to_int16(float value) {
+    if (std::isnan(value)) return 0;
+    float rounded = std::round(value);
+    if (rounded > INT16_MAX) return INT16_MAX;
+    if (rounded < INT16_MIN) return INT16_MIN;
+    return static_cast<int16_t>(rounded);
+}
+
+/**
+ * @brief Converts volts to millivolts saturated to uint16_t.
+ * @param volts Voltage in volts.
+ * @return Voltage in millivolts.
+ */
+uint16_t to_millivolts(float volts) {
+    if (std::isnan(volts) || volts <= 0.0f) return 0;
+    float mv = std::round(volts * 1000.0f);
+    return (mv > UINT16_MAX) ? UINT16_MAX : static_cast<uint16_t>(mv);
+}
+
+} // namespace
+
+/**
+ * @brief Sends the beacon if it is due and the link is quiet.
+ * @param current_time Current system time in milliseconds since boot.
+ * @return True if a beacon was transmitted.
+ * @details Must be called from the core 0 main loop - the same context that
+ *          processes commands. frame_process() sends every response frame and
+ *          fragment before it returns (send_packet() waits for the end of each
+ *          transmission), so no response is in flight when this runs and a
+ *          beacon can only go out between two command exchanges. A due beacon is
+ *          postponed for BEACON_HOLDOFF_MS after the last received packet.
+ * @ingroup Beacon
+ */
+bool BeaconManager::process(uint32_t current_time) {
+    if (interval_s == 0 || !SystemStateManager::get_instance().is_radio_init_ok()) {
+        return false;
+    }
+
+    if (current_time - last_beacon_time < interval_s * 1000) {
+        return false;
+    }
+
+    if (link_stats.rx_packets > 0 && current_time - link_stats.last_rx_time_ms < BEACON_HOLDOFF_MS) {
+        return false;
+    }
+
+    BeaconPacket packet = build_packet();
+    send_packet(reinterpret_cast<const uint8_t*>(&packet), sizeof(packet));
+    last_beacon_time = current_time;
+
+    log_record(LogSite::BEACON_SENT, packet.sequence);
+    return true;
+}
+
+/**
+ * @brief Assembles a beacon packet from the latest snapshots.
+ * @return Beacon packet with sequence number and CRC filled in.
+ * @details Telemetry values come from the last record collected by core 1, so
+ *          building a beacon costs no sensor or I2C access.
+ * @ingroup Beacon
+ */
+BeaconPacket BeaconManager::build_packet() {
+    BeaconPacket packet = {};
+    packet.magic = BEACON_MAGIC;
+    packet.version = BEACON_VERSION;
+    packet.sequence = sequence++;
+    packet.uptime_s = to_ms_since_boot(get_absolute_time()) / 1000;
+
+    TelemetryRecord telemetry;
+    SensorDataRecord sensors;
+    bool telemetry_valid = TelemetryManager::get_instance().get_last_records(telemetry, sensors);
+    if (telemetry_valid) {
+        packet.timestamp = telemetry.timestamp;
+        packet.battery_mv = to_millivolts(telemetry.battery_voltage);
+        packet.system_mv = to_millivolts(telemetry.system_voltage);
+        packet.usb_current_ma = to_int16(telemetry.charge_current_usb);
+        packet.solar_current_ma = to_int16(telemetry.charge_current_solar);
+        packet.discharge_current_ma = to_int16(telemetry.discharge_current);
+        packet.temperature_cdeg = to_int16(sensors.temperature * 100.0f);
+        packet.latitude_e7 = telemetry.gps.latitude_e7;
+        packet.longitude_e7 = telemetry.gps.longitude_e7;
+        packet.altitude_m = to_int16(telemetry.gps.altitude_mm / 1000.0f);
+        packet.fix_quality = telemetry.gps.fix_quality;
+        packet.satellites = telemetry.gps.satellites;
+    }
+
+    packet.event_count = EventManager::get_instance().get_total_event_count();
+    packet.rx_packets = static_cast<uint16_t>(link_stats.rx_packets);
+    packet.tx_packets = static_cast<uint16_t>(link_stats.tx_packets);
+    packet.rx_errors = static_cast<uint16_t>(link_stats.rx_errors);
+    packet.last_rssi_dbm = link_stats.last_rssi;
+    packet.last_snr_qdb = static_cast<int8_t>(to_int16(link_stats.last_snr * 4.0f));
+
+    SystemStateManager& state = SystemStateManager::get_instance();
+    uint8_t flags = 0;
+    if (state.is_sd_card_mounted()) flags |= BEACON_FLAG_SD_MOUNTED;
+    if (state.is_radio_init_ok()) flags |= BEACON_FLAG_RADIO_OK;
+    if (state.is_light_sensor_init_ok()) flags |= BEACON_FLAG_LIGHT_OK;
+    if (state.is_env_sensor_init_ok()) flags |= BEACON_FLAG_ENV_OK;
+    if (state.get_operating_mode() == SystemOperatingMode::USB_POWERED) flags |= BEACON_FLAG_USB_POWERED;
+    if (gpio_get(GPS_POWER_ENABLE_PIN)) flags |= BEACON_FLAG_GPS_POWERED;
+    if (telemetry_valid) flags |= BEACON_FLAG_TELEMETRY_OK;
+    packet.status_flags = flags;
+
+    packet.crc = crc16_ccitt(reinterpret_cast<const uint8_t*>(&packet), offsetof(BeaconPacket, crc));
+    return packet;
+}
+
+/**
+ * @brief Encodes a beacon packet as an uppercase hex string.
+ * @param packet Packet to encode.
+ * @return Hex string, two characters per byte in on-air order.
+ * @ingroup Beacon
+ */
+std::string BeaconManager::to_hex(const BeaconPacket& packet) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&packet);
+    std::stringstream ss;
+    ss << std::hex << std::uppercase << std::setfill('0');
+    for (size_t i = 0; i < sizeof(packet); i++) {
+        ss << std::setw(2) << static_cast<int>(bytes[i]);
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Sets the beacon interval.
+ * @param seconds Interval in seconds, 0 to disable the beacon.
+ * @return True if the interval was accepted.
+ * @ingroup Beacon
+ */
+bool BeaconManager::set_interval(uint32_t seconds) {
+    if (seconds != 0 && (seconds < MIN_INTERVAL_S || seconds > MAX_INTERVAL_S)) {
+        return false;
+    }
+    interval_s = seconds;
+    return true;
+}
+
+/** @} */
@@ -0,0 +1,186 @@
+/**
+ * @file beacon.h
+ * @brief Periodic housekeeping beacon transmitted over LoRa.
+ *
+ * @details The beacon is a single fixed-layout binary packet sent every
+ *          configurable number of seconds without being polled by the ground.
+ *          It is assembled from the latest TelemetryManager and
+ *          SystemStateManager snapshots and is transmitted only from the core 0
+ *          main loop, between command exchanges.
+ *
+ * @defgroup Beacon Beacon
+ * @brief Unsolicited housekeeping packet.
+ *
+ * @{
+ */
+
+#ifndef BEACON_H
+#define BEACON_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief First byte of every beacon packet.
+ * @details Text frames always start with 'K' (FRAME_BEGIN), so the ground
+ *          station tells the two apart by the first payload byte.
+ */
+#define BEACON_MAGIC 0xBC
+
+/**
+ * @brief Beacon layout version, bumped on every change of BeaconPacket.
+ */
+#define BEACON_VERSION 1
+
+/**
+ * @brief Beacon packet as sent on air (after the two LoRa address bytes).
+ * @details All multi-byte fields are little-endian. The CRC is CRC-16/CCITT-FALSE
+ *          computed over all preceding bytes of the packet.
+ *
+ *          | Offset | Size | Field                | Unit                      |
+ *          |--------|------|----------------------|---------------------------|
+ *          | 0      | 1    | magic                | 0xBC                      |
+ *          | 1      | 1    | version              | -                         |
+ *          | 2      | 2    | sequence             | -                         |
+ *          | 4      | 4    | uptime               | s                         |
+ *          | 8      | 4    | timestamp            | Unix time (local)         |
+ *          | 12     | 2    | battery voltage      | mV                        |
+ *          | 14     | 2    | system voltage       | mV                        |
+ *          | 16     | 2    | USB charge current   | mA                        |
+ *          | 18     | 2    | solar charge current | mA                        |
+ *          | 20     | 2    | discharge current    | mA                        |
+ *          | 22     | 2    | temperature          | 0.01 °C                   |
+ *          | 24     | 4    | latitude             | 1e-7 deg, north positive  |
+ *          | 28     | 4    | longitude            | 1e-7 deg, east positive   |
+ *          | 32     | 2    | altitude             | m                         |
+ *          | 34     | 1    | GPS fix quality      | GGA fix quality           |
+ *          | 35     | 1    | satellites           | -                         |
+ *          | 36     | 2    | events since boot    | -                         |
+ *          | 38     | 2    | LoRa packets RX      | -                         |
+ *          | 40     | 2    | LoRa packets TX      | -                         |
+ *          | 42     | 2    | LoRa RX errors       | -                         |
+ *          | 44     | 2    | last RSSI            | dBm                       |
+ *          | 46     | 1    | last SNR             | 0.25 dB                   |
+ *          | 47     | 1    | status flags         | see BeaconStatusFlag      |
+ *          | 48     | 2    | CRC                  | -                         |
+ * @ingroup Beacon
+ */
+struct BeaconPacket {
+    uint8_t magic;
+    uint8_t version;
+    uint16_t sequence;
+    uint32_t uptime_s;
+    uint32_t timestamp;
+    uint16_t battery_mv;
+    uint16_t system_mv;
+    int16_t usb_current_ma;
+    int16_t solar_current_ma;
+    int16_t discharge_current_ma;
+    int16_t temperature_cdeg;
+    int32_t latitude_e7;
+    int32_t longitude_e7;
+    int16_t altitude_m;
+    uint8_t fix_quality;
+    uint8_t satellites;
+    uint16_t event_count;
+    uint16_t rx_packets;
+    uint16_t tx_packets;
+    uint16_t rx_errors;
+    int16_t last_rssi_dbm;
+    int8_t last_snr_qdb;
+    uint8_t status_flags;
+    uint16_t crc;
+} __attribute__((packed));
+
+static_assert(sizeof(BeaconPacket) == 50, "Beacon layout changed - bump BEACON_VERSION and update the ground decoder");
+
+/**
+ * @brief Bits of BeaconPacket::status_flags.
+ * @ingroup Beacon
+ */
+enum BeaconStatusFlag : uint8_t {
+    BEACON_FLAG_SD_MOUNTED     = 1 << 0, /**< SD card mounted */
+    BEACON_FLAG_RADIO_OK       = 1 << 1, /**< Radio initialized */
+    BEACON_FLAG_LIGHT_OK       = 1 << 2, /**< Light sensor initialized */
+    BEACON_FLAG_ENV_OK         = 1 << 3, /**< Environment sensor initialized */
+    BEACON_FLAG_USB_POWERED    = 1 << 4, /**< Operating mode is USB powered */
+    BEACON_FLAG_GPS_POWERED    = 1 << 5, /**< GPS module power enabled */
+    BEACON_FLAG_TELEMETRY_OK   = 1 << 6, /**< Telemetry snapshot available */
+};
+
+/**
+ * @brief Schedules and assembles the housekeeping beacon.
+ * @details Singleton driven from the core 0 main loop by process(). A command
+ *          response, fragments included, is sent synchronously by frame_process()
+ *          in the same loop, so a beacon can only go out between two exchanges.
+ *          It is also deferred for BEACON_HOLDOFF_MS after the last received
+ *          packet, leaving the ground room for a follow-up command.
+ *
+ *          tools/beacon_decode.py decodes beacons and 8.5 responses.
+ * @ingroup Beacon
+ */
+class BeaconManager {
+public:
+    /**
+     * @brief Gets the singleton instance of the BeaconManager class.
+     * @return A reference to the singleton instance.
+     */
+    static BeaconManager& get_instance() {
+        static BeaconManager instance;
+        return instance;
+    }
+
+    /**
+     * @brief Sends the beacon if it is due and the link is quiet.
+     * @param current_time Current system time in milliseconds since boot.
+     * @return True if a beacon was transmitted.
+     */
+    bool process(uint32_t current_time);
+
+    /**
+     * @brief Assembles a beacon packet from the latest snapshots.
+     * @return Beacon packet with sequence number and CRC filled in.
+     */
+    BeaconPacket build_packet();
+
+    /**
+     * @brief Encodes a beacon packet as an uppercase hex string.
+     * @param packet Packet to encode.
+     * @return Hex string, two characters per byte in on-air order.
+     */
+    static std::string to_hex(const BeaconPacket& packet);
+
+    /**
+     * @brief Gets the beacon interval.
+     * @return Interval in seconds, 0 if the beacon is disabled.
+     */
+    uint32_t get_interval() const { return interval_s; }
+
+    /**
+     * @brief Sets the beacon interval.
+     * @param seconds Interval in seconds, 0 to disable the beacon.
+     * @return True if the interval was accepted.
+     */
+    bool set_interval(uint32_t seconds);
+
+    /** @brief Default beacon interval in seconds. */
+    static constexpr uint32_t DEFAULT_INTERVAL_S = 60;
+    /** @brief Shortest accepted beacon interval in seconds. */
+    static constexpr uint32_t MIN_INTERVAL_S = 10;
+    /** @brief Longest accepted beacon interval in seconds. */
+    static constexpr uint32_t MAX_INTERVAL_S = 3600;
+    /** @brief Quiet time after the last received packet before a beacon may be sent. */
+    static constexpr uint32_t BEACON_HOLDOFF_MS = 3000;
+
+private:
+    BeaconManager() = default;
+    BeaconManager(const BeaconManager&) = delete;
+    BeaconManager& operator=(const BeaconManager&) = delete;
+
+    uint32_t interval_s = DEFAULT_INTERVAL_S;
+    uint32_t last_beacon_time = 0;
+    uint16_t sequence = 0;
+};
+
+#endif // BEACON_H
+/** @} */
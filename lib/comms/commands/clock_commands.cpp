@@ -1,11 +1,16 @@
 #include "communication.h"
 #include <time.h>
 #include "DS3231.h" // Include the DS3231 header
+#include "time_service.h"
+#include "gps_time_sync.h"
 
 static constexpr uint8_t clock_commands_group_id = 3;
 static constexpr uint8_t time_command_id = 0;
 static constexpr uint8_t timezone_offset_command_id = 1;
 static constexpr uint8_t internal_temperature_command_id = 4;
+static constexpr uint8_t time_sync_stats_command_id = 5;
+static constexpr uint8_t timestamp_benchmark_command_id = 6;
+static constexpr uint8_t gps_time_sync_command_id = 7;
 /**
  * @defgroup ClockCommands Clock Management Commands
  * @brief Commands for managing system time and clock settings
@@ -44,14 +49,14 @@ std::vector<Frame> handle_time(const std::string& param, OperationType operation
                 return frames;
             }
 
-            if (DS3231::get_instance().set_time(newTime) != 0) {
+            if (TimeService::get_instance().set_time(newTime) != 0) {
                 error_msg = error_code_to_string(ErrorCode::FAIL_TO_SET);
                 frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, time_command_id, error_msg));
                 return frames;
             }
 
             EventEmitter::emit(EventGroup::CLOCK, ClockEvent::CHANGED);
-            frames.push_back(frame_build(OperationType::RES, clock_commands_group_id, time_command_id, std::to_string(DS3231::get_instance().get_time())));
+            frames.push_back(frame_build(OperationType::RES, clock_commands_group_id, time_command_id, std::to_string(TimeService::get_instance().get_utc())));
             return frames;
         } catch (...) {
             error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
@@ -65,13 +70,7 @@ std::vector<Frame> handle_time(const std::string& param, OperationType operation
             return frames;
         }
 
-        uint32_t time_unix = DS3231::get_instance().get_local_time();
-        if (time_unix == 0) {
-            error_msg = error_code_to_string(ErrorCode::INTERNAL_FAIL_TO_READ);
-            frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, time_command_id, error_msg));
-            return frames;
-        }
-
+        uint32_t time_unix = TimeService::get_instance().get_local_time();
         frames.push_back(frame_build(OperationType::VAL, clock_commands_group_id, time_command_id, std::to_string(time_unix)));
         return frames;
     }
@@ -174,4 +173,178 @@ std::vector<Frame> handle_get_internal_temperature(const std::string& param, Ope
     return frames;
 }
 
+
+/**
+ * @brief Handler for the time service synchronisation statistics
+ * @param param Empty string expected
+ * @param operationType GET
+ * @return Frame with comma separated values:
+ *         anchored,uncertainty_ms,last_offset_ms,drift_ppm,resyncs,steps,read_failures,anchor_age_s
+ * @note GET: <b>KBST;0;GET;3;5;;KBST</b>
+ * @note last_offset_ms is the time served by the time service minus the RTC time at the
+ *       last resync, drift_ppm the timer rate against the RTC (positive if the timer is fast).
+ * @ingroup ClockCommands
+ * @xrefitem command "Command" "Clock Commands" Command ID: 3.5
+ */
+std::vector<Frame> handle_get_time_sync_stats(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType != OperationType::GET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, time_sync_stats_command_id, error_msg));
+        return frames;
+    }
+
+    if (!param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+        frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, time_sync_stats_command_id, error_msg));
+        return frames;
+    }
+
+    TimeSyncStats stats = TimeService::get_instance().get_stats();
+
+    std::stringstream ss;
+    ss << (stats.anchored ? 1 : 0) << ","
+       << stats.uncertainty_ms << ","
+       << stats.last_offset_ms << ","
+       << std::fixed << std::setprecision(2) << stats.drift_ppm << ","
+       << stats.resyncs << ","
+       << stats.steps << ","
+       << stats.read_failures << ","
+       << stats.anchor_age_s;
+
+    frames.push_back(frame_build(OperationType::VAL, clock_commands_group_id, time_sync_stats_command_id, ss.str()));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for measuring the cost of a timestamp
+ * @param param Number of timestamps to take with each method (1-1000, optional, default 100)
+ * @param operationType GET
+ * @return Frame with comma separated values: rtc_ns,cached_ns
+ *         - rtc_ns: average time of DS3231::get_local_time() (I2C read, BCD decode, mktime)
+ *         - cached_ns: average time of TimeService::get_local_time()
+ * @note GET: <b>KBST;0;GET;3;6;[N];KBST</b>
+ * @note Blocks the command loop for N RTC reads, roughly N * 0.3 ms at 400 kHz.
+ * @ingroup ClockCommands
+ * @xrefitem command "Command" "Clock Commands" Command ID: 3.6
+ */
+std::vector<Frame> handle_timestamp_benchmark(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType != OperationType::GET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, timestamp_benchmark_command_id, error_msg));
+        return frames;
+    }
+
+    uint32_t count = 100;
+    if (!param.empty()) {
+        try {
+            count = std::stoul(param);
+        } catch (...) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+            frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, timestamp_benchmark_command_id, error_msg));
+            return frames;
+        }
+        if (count == 0 || count > 1000) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+            frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, timestamp_benchmark_command_id, error_msg));
+            return frames;
+        }
+    }
+
+    volatile uint32_t sink = 0;
+
+    uint64_t start = time_us_64();
+    for (uint32_t i = 0; i < count; i++) {
+        sink = DS3231::get_instance().get_local_time();
+    }
+    uint64_t rtc_ns = (time_us_64() - start) * 1000 / count;
+
+    start = time_us_64();
+    for (uint32_t i = 0; i < count; i++) {
+        sink = TimeService::get_instance().get_local_time();
+    }
+    uint64_t cached_ns = (time_us_64() - start) * 1000 / count;
+    (void)sink;
+
+    std::string result = std::to_string(rtc_ns) + "," + std::to_string(cached_ns);
+    frames.push_back(frame_build(OperationType::VAL, clock_commands_group_id, timestamp_benchmark_command_id, result));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for the GPS time synchronisation
+ * @param param For SET: sync interval in minutes (1-10080), 0 keeps the interval. For GET: empty string
+ * @param operationType GET/SET
+ * @return GET: frame with comma separated values:
+ *         syncs,corrections,not_ready,last_offset_ms,drift_ppm,aging_offset,interval_min,last_sync,last_drift_ppm
+ *         SET: frame echoing the parameter
+ * @note GET: <b>KBST;0;GET;3;7;;KBST</b>
+ * @note SET: <b>KBST;0;SET;3;7;INTERVAL_MIN;KBST</b>
+ * @note last_offset_ms is the RTC minus the GPS time at the last sync, drift_ppm the filtered RTC rate
+ *       error at the current aging offset (positive if fast), last_drift_ppm the last unfiltered
+ *       measurement. SET also starts a sync.
+ * @ingroup ClockCommands
+ * @xrefitem command "Command" "Clock Commands" Command ID: 3.7
+ */
+std::vector<Frame> handle_gps_time_sync(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType == OperationType::SET) {
+        if (param.empty()) {
+            error_msg = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+            frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, gps_time_sync_command_id, error_msg));
+            return frames;
+        }
+
+        unsigned long minutes;
+        try {
+            minutes = std::stoul(param);
+        } catch (...) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+            frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, gps_time_sync_command_id, error_msg));
+            return frames;
+        }
+
+        if (minutes != 0 && !DS3231::get_instance().set_sync_interval(minutes)) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+            frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, gps_time_sync_command_id, error_msg));
+            return frames;
+        }
+
+        GpsTimeSync::get_instance().request_sync();
+        frames.push_back(frame_build(OperationType::RES, clock_commands_group_id, gps_time_sync_command_id, param));
+        return frames;
+    }
+
+    if (operationType != OperationType::GET || !param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, clock_commands_group_id, gps_time_sync_command_id, error_msg));
+        return frames;
+    }
+
+    GpsTimeSyncStats stats = GpsTimeSync::get_instance().get_stats();
+
+    std::stringstream ss;
+    ss << stats.syncs << ","
+       << stats.corrections << ","
+       << stats.not_ready << ","
+       << stats.last_offset_ms << ","
+       << std::fixed << std::setprecision(2) << stats.drift_ppm << ","
+       << static_cast<int>(stats.aging_offset) << ","
+       << DS3231::get_instance().get_sync_interval() << ","
+       << stats.last_sync_utc << ","
+       << stats.last_drift_ppm;
+
+    frames.push_back(frame_build(OperationType::VAL, clock_commands_group_id, gps_time_sync_command_id, ss.str()));
+    return frames;
+}
+
 /** @} */ // end of ClockCommands group
\ No newline at end of file
@@ -30,21 +30,52 @@ CommandMap command_handlers = {
     {CMD(1, 1), handle_get_build_version},            // Group 1, Command 1
     {CMD(1, 2), handle_get_power_mode},               // Group 1, Command 2
     {CMD(1, 3), handle_get_uptime},                   // Group 1, Command 3
+    {CMD(1, 4), handle_get_uart_stats},               // Group 1, Command 4
+    {CMD(1, 5), handle_get_log_tail},                 // Group 1, Command 5
+    {CMD(1, 6), handle_log_storage_level},            // Group 1, Command 6
+    {CMD(1, 7), handle_sleep_scheduler},              // Group 1, Command 7
     {CMD(1, 8), handle_verbosity},                    // Group 1, Command 8
     {CMD(1, 9), handle_enter_bootloader_mode},        // Group 1, Command 9
+    {CMD(1, 10), handle_get_i2c_stats},               // Group 1, Command 10
+    
+    {CMD(2, 0), handle_radio_rx_mode},                // Group 2, Command 0
+    {CMD(2, 1), handle_radio_wake_period},            // Group 2, Command 1
+    {CMD(2, 2), handle_get_radio_power_stats},        // Group 2, Command 2
     
     {CMD(3, 0), handle_time},                         // Group 3, Command 0
     {CMD(3, 1), handle_timezone_offset},              // Group 3, Command 1
     {CMD(3, 4), handle_get_internal_temperature},     // Group 3, Command 4
+    {CMD(3, 5), handle_get_time_sync_stats},          // Group 3, Command 5
+    {CMD(3, 6), handle_timestamp_benchmark},          // Group 3, Command 6
+    {CMD(3, 7), handle_gps_time_sync},                // Group 3, Command 7
     
     {CMD(5, 1), handle_get_last_events},              // Group 5, Command 1
     {CMD(5, 2), handle_get_event_count},              // Group 5, Command 2
+    {CMD(5, 3), handle_get_event_queue_stats},        // Group 5, Command 3
+    {CMD(5, 4), handle_get_stored_events_by_id},      // Group 5, Command 4
+    {CMD(5, 5), handle_get_stored_events_by_time},    // Group 5, Command 5
+    {CMD(5, 6), handle_get_stored_events_by_group},   // Group 5, Command 6
+    {CMD(5, 7), handle_reaction_rule},                // Group 5, Command 7
+    {CMD(5, 8), handle_event_stats},                  // Group 5, Command 8
+    {CMD(5, 9), handle_get_event_stats_detail},       // Group 5, Command 9
     
     {CMD(7, 1), handle_gps_power_status},             // Group 7, Command 1
     {CMD(7, 2), handle_enable_gps_uart_passthrough},  // Group 7, Command 2
+    {CMD(7, 3), handle_get_gps_parse_stats},          // Group 7, Command 3
+    {CMD(7, 4), handle_get_gps_fix_quality},          // Group 7, Command 4
+    {CMD(7, 5), handle_get_gps_uart_rx_stats},        // Group 7, Command 5
+    {CMD(7, 6), handle_gps_receiver_config},          // Group 7, Command 6
+    {CMD(7, 7), handle_gps_power_profile},            // Group 7, Command 7
+    {CMD(7, 8), handle_get_gps_power_stats},          // Group 7, Command 8
+    {CMD(7, 9), handle_get_trajectory},               // Group 7, Command 9
+    {CMD(7, 10), handle_trajectory_config},           // Group 7, Command 10
     
     {CMD(8, 2), handle_get_last_telemetry_record},    // Group 8, Command 2
     {CMD(8, 3), handle_get_last_sensor_record},       // Group 8, Command 3
+    {CMD(8, 4), handle_beacon_interval},              // Group 8, Command 4
+    {CMD(8, 5), handle_get_beacon},                   // Group 8, Command 5
+    {CMD(8, 6), handle_telemetry_deadband},           // Group 8, Command 6
+    {CMD(8, 7), handle_environment_sensor_config},    // Group 8, Command 7
 };
 
 
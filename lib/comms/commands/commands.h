@@ -11,6 +11,9 @@
 std::vector<Frame> handle_time(const std::string& param, OperationType operationType);
 std::vector<Frame> handle_timezone_offset(const std::string& param, OperationType operationType);
 std::vector<Frame> handle_get_internal_temperature(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_time_sync_stats(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_timestamp_benchmark(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_gps_time_sync(const std::string& param, OperationType operationType);
 
 
 // DIAG
@@ -18,23 +21,53 @@ std::vector<Frame> handle_get_commands_list(const std::string& param, OperationT
 std::vector<Frame> handle_get_build_version(const std::string& param, OperationType operationType);
 std::vector<Frame> handle_get_power_mode(const std::string& param, OperationType operationType);
 std::vector<Frame> handle_get_uptime(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_uart_stats(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_log_tail(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_log_storage_level(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_sleep_scheduler(const std::string& param, OperationType operationType);
 std::vector<Frame> handle_verbosity(const std::string& param, OperationType operationType);
 std::vector<Frame> handle_enter_bootloader_mode(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_i2c_stats(const std::string& param, OperationType operationType);
+
+
+// RADIO
+std::vector<Frame> handle_radio_rx_mode(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_radio_wake_period(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_radio_power_stats(const std::string& param, OperationType operationType);
 
 
 // GPS
 std::vector<Frame> handle_gps_power_status(const std::string& param, OperationType operationType);
 std::vector<Frame> handle_enable_gps_uart_passthrough(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_gps_parse_stats(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_gps_fix_quality(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_gps_uart_rx_stats(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_gps_receiver_config(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_gps_power_profile(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_gps_power_stats(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_trajectory(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_trajectory_config(const std::string& param, OperationType operationType);
 
 
 // EVENT
 std::vector<Frame> handle_get_last_events(const std::string& param, OperationType operationType);
 std::vector<Frame> handle_get_event_count(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_event_queue_stats(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_stored_events_by_id(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_stored_events_by_time(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_stored_events_by_group(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_reaction_rule(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_event_stats(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_event_stats_detail(const std::string& param, OperationType operationType);
 
 
 // TELEMETRY
 std::vector<Frame> handle_get_last_telemetry_record(const std::string& param, OperationType operationType);
 std::vector<Frame> handle_get_last_sensor_record(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_beacon_interval(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_get_beacon(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_telemetry_deadband(const std::string& param, OperationType operationType);
+std::vector<Frame> handle_environment_sensor_config(const std::string& param, OperationType operationType);
 
 std::vector<Frame> execute_command(uint32_t commandKey, const std::string& param, OperationType operationType);
 extern std::map<uint32_t, std::function<std::vector<Frame>(const std::string&, OperationType)>> command_handlers;
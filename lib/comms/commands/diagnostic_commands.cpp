@@ -3,6 +3,15 @@
 #include "pico/stdlib.h"
 #include "pico/bootrom.h" 
 #include "system_state_manager.h"
+#include "uart_tx.h"
+#include "log.h"
+#include "system_log.h"
+#include "sleep_scheduler.h"
+#include "i2c_bus.h"
+#include "pin_config.h"
+#include "telemetry_manager.h"
+#include <iomanip>
+#include <sstream>
 /**
  * @defgroup DiagnosticCommands Diagnostic Commands
  * @{
@@ -13,16 +22,21 @@ static constexpr uint8_t commands_list_command_id = 0;
 static constexpr uint8_t build_version_command_id = 1;
 static constexpr uint8_t power_mode_command_id = 2;
 static constexpr uint8_t uptime_command_id = 3;
+static constexpr uint8_t uart_stats_command_id = 4;
+static constexpr uint8_t log_tail_command_id = 5;
+static constexpr uint8_t log_level_command_id = 6;
+static constexpr uint8_t sleep_command_id = 7;
 static constexpr uint8_t verbosity_command_id = 8;
 static constexpr uint8_t enter_bootloader_command_id = 9;
+static constexpr uint8_t i2c_stats_command_id = 10;
 
 /**
- * @brief Handler for listing all available commands on UART
+ * @brief Handler for listing all available commands
  * @param param Empty string expected
  * @param operationType GET
- * @return Vector of response frames - start frame, sequence of elements, end frame
+ * @return Frame with all command IDs as group.command separated by '-'
  * @note <b>KBST;0;GET;1;0;;TSBK</b>
- * @note Print all available commands on UART port
+ * @note Return all available commands. Over LoRa the list is fragmented by the transport.
  * @ingroup DiagnosticCommands
  * @xrefitem command "Command" "List of Commands" Command ID: 0
  */
@@ -48,24 +62,13 @@ std::vector<Frame> handle_get_commands_list(const std::string& param, OperationT
         uint8_t group = (command_key >> 8) & 0xFF;
         uint8_t command = command_key & 0xFF;
 
-        std::string command_details = std::to_string(group) + "." + std::to_string(command);
-
-        if (combined_command_details.length() + command_details.length() + 1 > 100) {
-            frames.push_back(frame_build(OperationType::SEQ, diagnostic_commands_group_id, commands_list_command_id, combined_command_details));
-            combined_command_details = "";
-        }
-
         if (!combined_command_details.empty()) {
             combined_command_details += "-";
         }
-        combined_command_details += command_details;
-    }
-
-    if (!combined_command_details.empty()) {
-        frames.push_back(frame_build(OperationType::SEQ, diagnostic_commands_group_id, commands_list_command_id, combined_command_details));
+        combined_command_details += std::to_string(group) + "." + std::to_string(command);
     }
 
-    frames.push_back(frame_build(OperationType::VAL, diagnostic_commands_group_id, commands_list_command_id, "SEQ_DONE"));
+    frames.push_back(frame_build(OperationType::VAL, diagnostic_commands_group_id, commands_list_command_id, combined_command_details));
     return frames;
 }
 
@@ -133,6 +136,46 @@ std::vector<Frame> handle_get_uptime(const std::string& param, OperationType ope
 }
 
 
+/**
+ * @brief Get debug UART output statistics
+ * @param param Empty string expected
+ * @param operationType GET
+ * @return One-element vector with result frame, comma separated:
+ *         bytes_written,bytes_dropped,peak_used,ring_size,blocked_writes,log_dropped_core0,log_dropped_core1
+ * @note <b>KBST;0;GET;1;4;;TSBK</b>
+ * @note Get the DMA transmit ring counters and the deferred log drop counters
+ * @ingroup DiagnosticCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 1.4
+ */
+std::vector<Frame> handle_get_uart_stats(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (!(operationType == OperationType::GET)) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, uart_stats_command_id, error_msg));
+        return frames;
+    }
+
+    if (!param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, uart_stats_command_id, error_msg));
+        return frames;
+    }
+
+    UartTxStats stats = uart_tx_get_stats();
+    std::string value = std::to_string(stats.bytes_written) + "," +
+                        std::to_string(stats.bytes_dropped) + "," +
+                        std::to_string(stats.peak_used) + "," +
+                        std::to_string(UART_TX_RING_SIZE) + "," +
+                        std::to_string(stats.blocked_writes) + "," +
+                        std::to_string(log_get_dropped(0)) + "," +
+                        std::to_string(log_get_dropped(1));
+    frames.push_back(frame_build(OperationType::VAL, diagnostic_commands_group_id, uart_stats_command_id, value));
+    return frames;
+}
+
+
 /**
  * @brief Get system power mode
  * @param param Empty string expected
@@ -166,6 +209,233 @@ std::vector<Frame> handle_get_power_mode(const std::string& param, OperationType
 }
 
 
+/**
+ * @brief Fetch a range from the end of the SD card system log
+ * @param param "LENGTH" or "OFFSET,LENGTH" - LENGTH bytes ending OFFSET bytes before the end of the log
+ * @param operationType GET
+ * @return One-element vector with result frame: FILE_SIZE,HEX where HEX is the requested range
+ *         hex encoded (the log contains ';' and line breaks)
+ * @note <b>KBST;0;GET;1;5;[OFFSET,]LENGTH;TSBK</b>
+ * @note LENGTH - up to 1024 bytes. Page backwards by increasing OFFSET; FILE_SIZE tells where the log starts.
+ * @note Over LoRa the response is fragmented by the transport.
+ * @ingroup DiagnosticCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 1.5
+ */
+std::vector<Frame> handle_get_log_tail(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (!(operationType == OperationType::GET)) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, log_tail_command_id, error_msg));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, log_tail_command_id, error_msg));
+        return frames;
+    }
+
+    size_t offset = 0;
+    size_t length = 0;
+    try {
+        size_t separator = param.find(',');
+        if (separator == std::string::npos) {
+            length = std::stoul(param);
+        } else {
+            offset = std::stoul(param.substr(0, separator));
+            length = std::stoul(param.substr(separator + 1));
+        }
+    } catch (...) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, log_tail_command_id, error_msg));
+        return frames;
+    }
+
+    if (length == 0 || length > SystemLog::MAX_READ_LENGTH) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, log_tail_command_id, error_msg));
+        return frames;
+    }
+
+    if (!SystemStateManager::get_instance().is_sd_card_mounted()) {
+        error_msg = error_code_to_string(ErrorCode::INTERNAL_FAIL_TO_READ);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, log_tail_command_id, error_msg));
+        return frames;
+    }
+
+    size_t file_size = 0;
+    std::string data = SystemLog::get_instance().read_tail(offset, length, file_size);
+
+    std::stringstream ss;
+    ss << file_size << ",";
+    ss << std::hex << std::uppercase << std::setfill('0');
+    for (unsigned char c : data) {
+        ss << std::setw(2) << static_cast<int>(c);
+    }
+
+    frames.push_back(frame_build(OperationType::VAL, diagnostic_commands_group_id, log_tail_command_id, ss.str()));
+    return frames;
+}
+
+
+/**
+ * @brief Get or set the SD card system log storage level
+ * @param param For SET: level 0-4 (0 disables the log). For GET: empty
+ * @param operationType GET or SET
+ * @return One-element vector with the current level
+ * @note <b>KBST;0;GET;1;6;;TSBK</b>
+ * @note <b>KBST;0;SET;1;6;[level];TSBK</b>
+ * @note Messages at this level and more severe are stored, independently of the UART verbosity (1.8)
+ * @ingroup DiagnosticCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 1.6
+ */
+std::vector<Frame> handle_log_storage_level(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType == OperationType::GET) {
+        if (!param.empty()) {
+            error_msg = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+            frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, log_level_command_id, error_msg));
+            return frames;
+        }
+        VerbosityLevel current_level = SystemLog::get_instance().get_storage_level();
+        frames.push_back(frame_build(OperationType::VAL, diagnostic_commands_group_id, log_level_command_id,
+                        std::to_string(static_cast<int>(current_level))));
+        return frames;
+    }
+    else if (operationType == OperationType::SET) {
+        try {
+            int level = std::stoi(param);
+            if (level < 0 || level > 4) {
+                error_msg = error_code_to_string(ErrorCode::PARAM_INVALID);
+                frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, log_level_command_id, error_msg));
+                return frames;
+            }
+            SystemLog::get_instance().set_storage_level(static_cast<VerbosityLevel>(level));
+            frames.push_back(frame_build(OperationType::RES, diagnostic_commands_group_id, log_level_command_id, std::to_string(level)));
+            return frames;
+        } catch (...) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+            frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, log_level_command_id, error_msg));
+            return frames;
+        }
+    }
+    else {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, log_level_command_id, error_msg));
+        return frames;
+    }
+}
+
+/**
+ * @brief Get or set the sleep of both cores between their scheduled work
+ * @param param For GET: empty for the current operating mode, or MODE. For SET: ENABLED,MAX_IDLE0_MS,MAX_IDLE1_MS
+ * @param operationType GET or SET
+ * @return One-element vector with the sleep state and statistics
+ * @note <b>KBST;0;GET;1;7;;TSBK</b>
+ * @note <b>KBST;0;GET;1;7;[mode];TSBK</b>
+ * @note <b>KBST;0;SET;1;7;[enabled],[max_idle0_ms],[max_idle1_ms];TSBK</b>
+ * @note MODE - 0 battery powered, 1 USB powered; the statistics are counted separately per mode
+ * @note Response: ENABLED,MAX_IDLE0_MS,MAX_IDLE1_MS,MODE,DUTY0_PERMILLE,DUTY1_PERMILLE,WAKEUPS0,WAKEUPS1,
+ *       EARLY_WAKEUPS0,EST_MA,EST_BUSY_MA,MEAS_MA
+ * @note DUTY - time awake per core in 1/1000; EST_MA - estimated MCU current, EST_BUSY_MA - the same
+ *       period without sleeping; MEAS_MA - average measured board discharge current, -1 without samples
+ * @note MAX_IDLE - longest sleep of a core, 1-1000 ms; it bounds the latency of polled work
+ * @ingroup DiagnosticCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 1.7
+ */
+std::vector<Frame> handle_sleep_scheduler(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+    SleepScheduler& scheduler = SleepScheduler::get_instance();
+
+    if (operationType == OperationType::GET) {
+        size_t mode = static_cast<size_t>(SystemStateManager::get_instance().get_operating_mode());
+        if (!param.empty()) {
+            try {
+                mode = std::stoul(param);
+            } catch (...) {
+                error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+                frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, sleep_command_id, error_msg));
+                return frames;
+            }
+            if (mode >= SLEEP_MODE_COUNT) {
+                error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+                frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, sleep_command_id, error_msg));
+                return frames;
+            }
+        }
+
+        SleepModeStats stats = scheduler.get_stats(mode);
+        auto duty_permille = [&stats](size_t core) {
+            uint64_t total = stats.cores[core].active_us + stats.cores[core].sleep_us;
+            return total ? stats.cores[core].active_us * 1000 / total : 1000;
+        };
+
+        std::stringstream ss;
+        ss << (scheduler.is_enabled() ? 1 : 0) << ","
+           << scheduler.get_max_idle(0) << ","
+           << scheduler.get_max_idle(1) << ","
+           << mode << ","
+           << duty_permille(0) << ","
+           << duty_permille(1) << ","
+           << stats.cores[0].wakeups << ","
+           << stats.cores[1].wakeups << ","
+           << stats.cores[0].early_wakeups << ","
+           << std::fixed << std::setprecision(2)
+           << SleepScheduler::estimate_current_ma(stats, false) << ","
+           << SleepScheduler::estimate_current_ma(stats, true) << ","
+           << (stats.current_samples ? stats.current_sum_ma / stats.current_samples : -1.0f);
+
+        frames.push_back(frame_build(OperationType::VAL, diagnostic_commands_group_id, sleep_command_id, ss.str()));
+        return frames;
+    }
+    else if (operationType == OperationType::SET) {
+        unsigned long fields[3];
+        size_t start = 0;
+        bool valid = !param.empty();
+        try {
+            for (size_t i = 0; i < 3 && valid; i++) {
+                size_t separator = param.find(',', start);
+                valid = (separator == std::string::npos) == (i == 2);
+                fields[i] = std::stoul(param.substr(start, separator - start));
+                start = separator + 1;
+            }
+        } catch (...) {
+            valid = false;
+        }
+
+        if (!valid) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+            frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, sleep_command_id, error_msg));
+            return frames;
+        }
+
+        if (fields[0] > 1 ||
+            fields[1] == 0 || fields[1] > SLEEP_MAX_IDLE_LIMIT_MS ||
+            fields[2] == 0 || fields[2] > SLEEP_MAX_IDLE_LIMIT_MS) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+            frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, sleep_command_id, error_msg));
+            return frames;
+        }
+
+        scheduler.set_max_idle(0, static_cast<uint32_t>(fields[1]));
+        scheduler.set_max_idle(1, static_cast<uint32_t>(fields[2]));
+        scheduler.set_enabled(fields[0] == 1);
+        uart_print("SLEEP_SCHEDULER_" + param, VerbosityLevel::INFO);
+        frames.push_back(frame_build(OperationType::RES, diagnostic_commands_group_id, sleep_command_id, param));
+        return frames;
+    }
+    else {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, sleep_command_id, error_msg));
+        return frames;
+    }
+}
+
 /**
  * @brief Handles setting or getting the UART verbosity level.
  *
@@ -270,4 +540,75 @@ std::vector<Frame> handle_enter_bootloader_mode(const std::string& param, Operat
     return frames;
 }
 
+/**
+ * @brief Get I2C bus and sensor sweep timing
+ * @param param Empty for the sensor sweeps, "0" for the sensors bus (i2c0) or "1" for the main bus (i2c1)
+ * @param operationType GET
+ * @return One-element vector with result frame
+ * @note <b>KBST;0;GET;1;10;[BUS];TSBK</b>
+ * @note Without BUS: SWEEPS,LAST_US,AVG_US,MAX_US,AVG_I2C_IRQ_US,AVG_I2C_WAIT_US of the sensor sweeps
+ *       of the telemetry collection, -1 averages before the first sweep.
+ * @note With BUS: TRANSACTIONS,NACKS,TIMEOUTS,ERRORS,QUEUE_FULL,BYTES,BUSY_US,AVG_LATENCY_US,MAX_LATENCY_US,IRQ_US,WAIT_US
+ * @ingroup DiagnosticCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 1.10
+ */
+std::vector<Frame> handle_get_i2c_stats(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (!(operationType == OperationType::GET)) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, i2c_stats_command_id, error_msg));
+        return frames;
+    }
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+
+    if (param.empty()) {
+        SensorSweepStats sweeps = TelemetryManager::get_instance().get_sweep_stats();
+        ss << sweeps.sweeps << "," << sweeps.last_us << ",";
+        if (sweeps.sweeps > 0) {
+            ss << static_cast<double>(sweeps.total_us) / sweeps.sweeps << ","
+               << sweeps.max_us << ","
+               << static_cast<double>(sweeps.irq_us) / sweeps.sweeps << ","
+               << static_cast<double>(sweeps.wait_us) / sweeps.sweeps;
+        } else {
+            ss << "-1," << sweeps.max_us << ",-1,-1";
+        }
+        frames.push_back(frame_build(OperationType::VAL, diagnostic_commands_group_id, i2c_stats_command_id, ss.str()));
+        return frames;
+    }
+
+    i2c_inst_t* bus = nullptr;
+    if (param == "0") {
+        bus = SENSORS_I2C_PORT;
+    } else if (param == "1") {
+        bus = MAIN_I2C_PORT;
+    } else {
+        error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, diagnostic_commands_group_id, i2c_stats_command_id, error_msg));
+        return frames;
+    }
+
+    I2cBusStats stats = i2c_bus_get_stats(bus);
+    ss << stats.transactions << ","
+       << stats.nacks << ","
+       << stats.timeouts << ","
+       << stats.errors << ","
+       << stats.queue_full << ","
+       << stats.bytes << ","
+       << stats.busy_us << ",";
+    if (stats.transactions > 0) {
+        ss << static_cast<double>(stats.latency_us) / stats.transactions;
+    } else {
+        ss << "-1";
+    }
+    ss << "," << stats.max_latency_us << ","
+       << stats.irq_us << ","
+       << stats.wait_us;
+    frames.push_back(frame_build(OperationType::VAL, diagnostic_commands_group_id, i2c_stats_command_id, ss.str()));
+    return frames;
+}
+
 /** @} */ 
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "communication.h"
 #include "event_manager.h"
+#include "event_reactions.h"
+#include "system_state_manager.h"
+#include "time_service.h"
 #include <sstream>
 
 
@@ -12,6 +15,71 @@
 static constexpr uint8_t event_commands_group_id = 5;
 static constexpr uint8_t last_events_command_id = 1;
 static constexpr uint8_t event_count_command_id = 2;
+static constexpr uint8_t event_queue_stats_command_id = 3;
+static constexpr uint8_t stored_events_by_id_command_id = 4;
+static constexpr uint8_t stored_events_by_time_command_id = 5;
+static constexpr uint8_t stored_events_by_group_command_id = 6;
+static constexpr uint8_t reaction_rule_command_id = 7;
+static constexpr uint8_t event_stats_command_id = 8;
+static constexpr uint8_t event_stats_detail_command_id = 9;
+
+
+/**
+ * @brief Appends one event in the IIIITTTTTTTTGGEE hex format to a stream
+ * @param ss Stream set up for upper case hex with '0' fill
+ * @param event Event to append
+ */
+static void append_event_hex(std::stringstream& ss, const EventLog& event) {
+    ss << std::setw(4) << event.id
+       << std::setw(8) << event.timestamp
+       << std::setw(2) << static_cast<int>(event.group)
+       << std::setw(2) << static_cast<int>(event.event);
+}
+
+
+/**
+ * @brief Encodes events in the IIIITTTTTTTTGGEE hex format separated by '-'
+ * @param events Events to encode
+ * @return Encoded events, empty string if there are none
+ */
+static std::string encode_events(const std::vector<EventLog>& events) {
+    std::stringstream ss;
+    ss << std::hex << std::uppercase << std::setfill('0');
+    for (size_t i = 0; i < events.size(); i++) {
+        if (i > 0) ss << "-";
+        append_event_hex(ss, events[i]);
+    }
+    return ss.str();
+}
+
+
+/**
+ * @brief Parses "FROM,TO[,GROUP]" range parameters
+ * @param param Parameter string
+ * @param from First value of the range
+ * @param to Last value of the range
+ * @param group Group filter, -1 if absent
+ * @return True if the parameter has the expected format
+ */
+static bool parse_range_param(const std::string& param, uint32_t& from, uint32_t& to, int& group) {
+    size_t first_separator = param.find(',');
+    if (first_separator == std::string::npos) {
+        return false;
+    }
+    size_t second_separator = param.find(',', first_separator + 1);
+
+    try {
+        from = std::stoul(param.substr(0, first_separator));
+        to = std::stoul(param.substr(first_separator + 1, second_separator - first_separator - 1));
+        group = -1;
+        if (second_separator != std::string::npos) {
+            group = std::stoi(param.substr(second_separator + 1));
+        }
+    } catch (...) {
+        return false;
+    }
+    return group >= -1 && group <= 0xFF;
+}
 
 
 /**
@@ -19,19 +87,18 @@ static constexpr uint8_t event_count_command_id = 2;
  * @param param Number of events to retrieve (optional, default 10). If 0, all events are returned.
  * @param operationType GET
  * @return Frame containing:
- *         - Success: A sequence of frames, each containing up to 10 hex-encoded events.
+ *         - Success: A single frame with the hex-encoded events, newest first.
  *           Each event is in the format IIIITTTTTTTTGGEE, separated by '-'.
  *           - IIII: Event ID (16-bit, 4 hex characters)
  *           - TTTTTTTT: Unix Timestamp (32-bit, 8 hex characters)
  *           - GG: Event Group (8-bit, 2 hex characters)
  *           - EE: Event Type (8-bit, 2 hex characters)
- *           The last frame in the sequence is a VAL frame with the message "SEQ_DONE".
  *         - Error: A single frame with an error message:
  *           - "INVALID OPERATION": If the operation type is not GET.
  *           - "INVALID COUNT": If the count is greater than EVENT_BUFFER_SIZE.
  *           - "INVALID PARAMETER": If the parameter is not a valid unsigned integer.
  * @note <b>KBST;0;GET;5;1;[N];TSBK</b> - Retrieves the last N events. If N is 0, retrieves all events.
- * @note Returns up to 10 most recent events per frame.
+ * @note Over LoRa the response is fragmented by the transport.
  * @ingroup EventCommands
  * @xrefitem command "Command" "List of Commands" Command ID: 5.1
  */
@@ -66,27 +133,17 @@ std::vector<Frame> handle_get_last_events(const std::string& param, OperationTyp
     size_t to_return = (count == 0) ? available : std::min(count, available);
     size_t event_index = available;
 
+    std::stringstream ss;
+    ss << std::hex << std::uppercase << std::setfill('0');
     while (to_return > 0) {
-        std::stringstream ss;
-        ss << std::hex << std::uppercase << std::setfill('0');
-        size_t events_in_frame = 0;
+        event_index--;
+        const EventLog& event = event_manager.get_event(event_index);
+        append_event_hex(ss, event);
 
-        for (size_t i = 0; i < 10 && to_return > 0; ++i) {
-            event_index--;
-            const EventLog& event = event_manager.get_event(event_index);
-
-            ss << std::setw(4) << event.id
-               << std::setw(8) << event.timestamp
-               << std::setw(2) << static_cast<int>(event.group)
-               << std::setw(2) << static_cast<int>(event.event);
-
-            if (to_return > 1) ss << "-";
-            to_return--;
-            events_in_frame++;
-        }
-        frames.push_back(frame_build(OperationType::SEQ, event_commands_group_id, last_events_command_id, ss.str()));
+        if (to_return > 1) ss << "-";
+        to_return--;
     }
-    frames.push_back(frame_build(OperationType::VAL, event_commands_group_id, last_events_command_id, "SEQ_DONE"));
+    frames.push_back(frame_build(OperationType::VAL, event_commands_group_id, last_events_command_id, ss.str()));
     return frames;
 }
 
@@ -118,4 +175,409 @@ std::vector<Frame> handle_get_event_count(const std::string& param, OperationTyp
                     std::to_string(event_manager.get_event_count())));
     return frames;
 }
+
+
+/**
+ * @brief Handler for the event queue statistics
+ * @param param Empty string expected
+ * @param operationType GET
+ * @return Frame with comma separated values:
+ *         dropped_core0,dropped_core1,pending,reactions_run
+ * @note <b>KBST;0;GET;5;3;;TSBK</b>
+ * @note dropped_coreN counts events lost because the queue of that core was full,
+ *       pending the events emitted but not yet stored in the event log,
+ *       reactions_run the reaction rule actions applied since boot (5.7).
+ * @ingroup EventCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 5.3
+ */
+std::vector<Frame> handle_get_event_queue_stats(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType != OperationType::GET || !param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, event_queue_stats_command_id, error_msg));
+        return frames;
+    }
+
+    auto& event_manager = EventManager::get_instance();
+    std::stringstream ss;
+    ss << event_manager.get_dropped_count(0) << ","
+       << event_manager.get_dropped_count(1) << ","
+       << event_manager.get_pending_count() << ","
+       << get_reactions_run();
+
+    frames.push_back(frame_build(OperationType::VAL, event_commands_group_id, event_queue_stats_command_id, ss.str()));
+    return frames;
+}
+
+/**
+ * @brief Handler for reading events by ID range from the event log on the SD card
+ * @param param "FROM,TO[,GROUP]" - decimal event IDs and an optional decimal group filter
+ * @param operationType GET
+ * @return Frame containing:
+ *         - Success: Up to EVENT_QUERY_MAX_RESULTS events in the 5.1 format, oldest first.
+ *           Empty if no stored event matches.
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;5;4;FROM,TO[,GROUP];TSBK</b>
+ * @note IDs wrap at 65535, so TO may be lower than FROM. If the response is full, repeat
+ *       the query from the last returned ID + 1. Events not yet flushed are only in 5.1.
+ * @ingroup EventCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 5.4
+ */
+std::vector<Frame> handle_get_stored_events_by_id(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType != OperationType::GET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_id_command_id, error_msg));
+        return frames;
+    }
+
+    uint32_t from_id, to_id;
+    int group;
+    if (!parse_range_param(param, from_id, to_id, group) || from_id > 0xFFFF || to_id > 0xFFFF) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_INVALID);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_id_command_id, error_msg));
+        return frames;
+    }
+
+    if (!SystemStateManager::get_instance().is_sd_card_mounted()) {
+        error_msg = error_code_to_string(ErrorCode::INTERNAL_FAIL_TO_READ);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_id_command_id, error_msg));
+        return frames;
+    }
+
+    std::vector<EventLog> events = EventManager::get_instance().query_by_id(from_id, to_id, group, EVENT_QUERY_MAX_RESULTS);
+    frames.push_back(frame_build(OperationType::VAL, event_commands_group_id, stored_events_by_id_command_id, encode_events(events)));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for reading events by time range from the event log on the SD card
+ * @param param "FROM,TO[,GROUP]" - local Unix timestamps and an optional decimal group filter
+ * @param operationType GET
+ * @return Frame containing:
+ *         - Success: Up to EVENT_QUERY_MAX_RESULTS events in the 5.1 format, oldest first.
+ *           Empty if no stored event matches.
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;5;5;FROM,TO[,GROUP];TSBK</b>
+ * @note If the response is full, repeat the query from the last returned timestamp.
+ * @ingroup EventCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 5.5
+ */
+std::vector<Frame> handle_get_stored_events_by_time(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType != OperationType::GET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_time_command_id, error_msg));
+        return frames;
+    }
+
+    uint32_t from_time, to_time;
+    int group;
+    if (!parse_range_param(param, from_time, to_time, group)) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_INVALID);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_time_command_id, error_msg));
+        return frames;
+    }
+
+    if (from_time > to_time) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_time_command_id, error_msg));
+        return frames;
+    }
+
+    if (!SystemStateManager::get_instance().is_sd_card_mounted()) {
+        error_msg = error_code_to_string(ErrorCode::INTERNAL_FAIL_TO_READ);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_time_command_id, error_msg));
+        return frames;
+    }
+
+    std::vector<EventLog> events = EventManager::get_instance().query_by_time(from_time, to_time, group, EVENT_QUERY_MAX_RESULTS);
+    frames.push_back(frame_build(OperationType::VAL, event_commands_group_id, stored_events_by_time_command_id, encode_events(events)));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for reading the newest events of one group from the event log on the SD card
+ * @param param "GROUP[,N]" - decimal group and number of events (1-EVENT_QUERY_MAX_RESULTS, default 10)
+ * @param operationType GET
+ * @return Frame containing:
+ *         - Success: Up to N events in the 5.1 format, newest first
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;5;6;GROUP[,N];TSBK</b>
+ * @ingroup EventCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 5.6
+ */
+std::vector<Frame> handle_get_stored_events_by_group(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType != OperationType::GET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_group_command_id, error_msg));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_group_command_id, error_msg));
+        return frames;
+    }
+
+    unsigned long group = 0;
+    size_t count = 10;
+    try {
+        size_t separator = param.find(',');
+        group = std::stoul(param.substr(0, separator));
+        if (separator != std::string::npos) {
+            count = std::stoul(param.substr(separator + 1));
+        }
+    } catch (...) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_INVALID);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_group_command_id, error_msg));
+        return frames;
+    }
+
+    if (group > 0xFF || count == 0 || count > EVENT_QUERY_MAX_RESULTS) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_group_command_id, error_msg));
+        return frames;
+    }
+
+    if (!SystemStateManager::get_instance().is_sd_card_mounted()) {
+        error_msg = error_code_to_string(ErrorCode::INTERNAL_FAIL_TO_READ);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, stored_events_by_group_command_id, error_msg));
+        return frames;
+    }
+
+    std::vector<EventLog> events = EventManager::get_instance().query_by_group(group, count);
+    frames.push_back(frame_build(OperationType::VAL, event_commands_group_id, stored_events_by_group_command_id, encode_events(events)));
+    return frames;
+}
+
+/**
+ * @brief Handler for the event reaction rules
+ * @param param For SET: "INDEX,GROUP,EVENT,ACTION,VALUE". For GET: empty
+ * @param operationType GET to list the rules, SET to replace one
+ * @return Frame containing:
+ *         - GET: Non-empty rules as INDEX,GROUP,EVENT,ACTION,VALUE separated by '-'
+ *         - SET: The rule as written
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;5;7;;TSBK</b>
+ * @note <b>KBST;0;SET;5;7;INDEX,GROUP,EVENT,ACTION,VALUE;TSBK</b>
+ * @note INDEX - 0 to REACTION_RULE_COUNT-1
+ * @note ACTION - 0 clear rule, 1 telemetry sample interval (VALUE ms), 2 GPS power (VALUE 0/1),
+ *       3 beacon interval (VALUE s, 0 stops), 4 radio RX mode (VALUE 0/1)
+ * @note Example: SET 5;7;6,1,1,4,1 switches the radio to duty-cycled RX on BATTERY_LOW.
+ *       Rules are kept in RAM and return to the defaults after a reset.
+ * @ingroup EventCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 5.7
+ */
+std::vector<Frame> handle_reaction_rule(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType == OperationType::GET) {
+        if (!param.empty()) {
+            error_msg = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+            frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, reaction_rule_command_id, error_msg));
+            return frames;
+        }
+
+        std::stringstream ss;
+        bool first = true;
+        for (size_t i = 0; i < REACTION_RULE_COUNT; i++) {
+            ReactionRule rule = get_reaction_rule(i);
+            if (rule.action == ReactionAction::NONE) {
+                continue;
+            }
+            if (!first) ss << "-";
+            ss << i << "," << static_cast<int>(rule.group) << "," << static_cast<int>(rule.event) << ","
+               << static_cast<int>(rule.action) << "," << rule.value;
+            first = false;
+        }
+        frames.push_back(frame_build(OperationType::VAL, event_commands_group_id, reaction_rule_command_id, ss.str()));
+        return frames;
+    }
+
+    if (operationType != OperationType::SET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, reaction_rule_command_id, error_msg));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, reaction_rule_command_id, error_msg));
+        return frames;
+    }
+
+    unsigned long fields[5];
+    size_t start = 0;
+    bool valid = true;
+    try {
+        for (size_t i = 0; i < 5 && valid; i++) {
+            size_t separator = param.find(',', start);
+            valid = (separator == std::string::npos) == (i == 4);
+            fields[i] = std::stoul(param.substr(start, separator - start));
+            start = separator + 1;
+        }
+    } catch (...) {
+        valid = false;
+    }
+
+    if (!valid) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, reaction_rule_command_id, error_msg));
+        return frames;
+    }
+
+    if (fields[1] > 0xFF || fields[2] > 0xFF || fields[3] > 0xFF) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, reaction_rule_command_id, error_msg));
+        return frames;
+    }
+
+    ReactionRule rule{static_cast<uint8_t>(fields[1]), static_cast<uint8_t>(fields[2]),
+                      static_cast<ReactionAction>(fields[3]), static_cast<uint32_t>(fields[4])};
+    if (!set_reaction_rule(fields[0], rule)) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, reaction_rule_command_id, error_msg));
+        return frames;
+    }
+
+    frames.push_back(frame_build(OperationType::RES, event_commands_group_id, reaction_rule_command_id, param));
+    return frames;
+}
+
+/**
+ * @brief Handler for the event statistics matrix
+ * @param param Empty string expected
+ * @param operationType GET to read the matrix, SET to reset all statistics
+ * @return Frame containing:
+ *         - GET: One entry per (group, event) seen since the last reset, separated by '-'.
+ *           Each entry is GE,COUNT,RATE,PEAK
+ *           - G, E: Event group and code, one hex character each
+ *           - COUNT: Events since the last reset, also across reboots
+ *           - RATE: Events in the current minute
+ *           - PEAK: Highest number of events in one minute
+ *         - SET: "RESET"
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;5;8;;TSBK</b>
+ * @note <b>KBST;0;SET;5;8;;TSBK</b> - Clears the statistics
+ * @note A high PEAK next to a low COUNT points at a short storm, e.g. USB connect/disconnect flapping.
+ * @ingroup EventCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 5.8
+ */
+std::vector<Frame> handle_event_stats(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (!param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, event_stats_command_id, error_msg));
+        return frames;
+    }
+
+    auto& event_manager = EventManager::get_instance();
+
+    if (operationType == OperationType::SET) {
+        event_manager.reset_event_stats();
+        frames.push_back(frame_build(OperationType::RES, event_commands_group_id, event_stats_command_id, "RESET"));
+        return frames;
+    }
+
+    if (operationType != OperationType::GET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, event_stats_command_id, error_msg));
+        return frames;
+    }
+
+    uint32_t now = TimeService::get_instance().get_local_time();
+    std::stringstream ss;
+    bool first = true;
+    for (uint8_t group = 0; group < EVENT_STATS_GROUPS; group++) {
+        for (uint8_t event = 0; event < EVENT_STATS_CODES; event++) {
+            EventStats stats;
+            if (!event_manager.get_event_stats(group, event, stats) || stats.count == 0) {
+                continue;
+            }
+            if (!first) ss << "-";
+            ss << std::hex << std::uppercase << static_cast<int>(group) << static_cast<int>(event) << std::dec
+               << "," << stats.count
+               << "," << EventManager::get_minute_rate(stats, now)
+               << "," << stats.peak_per_minute;
+            first = false;
+        }
+    }
+
+    frames.push_back(frame_build(OperationType::VAL, event_commands_group_id, event_stats_command_id, ss.str()));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for the statistics of one (group, event) pair
+ * @param param "GROUP,EVENT" in decimal
+ * @param operationType GET
+ * @return Frame with comma separated values: COUNT,FIRST_SEEN,LAST_SEEN,RATE,PEAK
+ *         - FIRST_SEEN, LAST_SEEN: Local Unix timestamps, 0 if never seen
+ *         - RATE, PEAK: As in 5.8
+ * @note <b>KBST;0;GET;5;9;GROUP,EVENT;TSBK</b>
+ * @ingroup EventCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 5.9
+ */
+std::vector<Frame> handle_get_event_stats_detail(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType != OperationType::GET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, event_stats_detail_command_id, error_msg));
+        return frames;
+    }
+
+    size_t separator = param.find(',');
+    if (separator == std::string::npos) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, event_stats_detail_command_id, error_msg));
+        return frames;
+    }
+
+    unsigned long group, event;
+    try {
+        group = std::stoul(param.substr(0, separator));
+        event = std::stoul(param.substr(separator + 1));
+    } catch (...) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, event_stats_detail_command_id, error_msg));
+        return frames;
+    }
+
+    EventStats stats;
+    if (group > 0xFF || event > 0xFF ||
+        !EventManager::get_instance().get_event_stats(group, event, stats)) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, event_commands_group_id, event_stats_detail_command_id, error_msg));
+        return frames;
+    }
+
+    uint32_t now = TimeService::get_instance().get_local_time();
+    std::stringstream ss;
+    ss << stats.count << ","
+       << stats.first_seen << ","
+       << stats.last_seen << ","
+       << EventManager::get_minute_rate(stats, now) << ","
+       << stats.peak_per_minute;
+
+    frames.push_back(frame_build(OperationType::VAL, event_commands_group_id, event_stats_detail_command_id, ss.str()));
+    return frames;
+}
 /** @} */ // end of EventCommands group
\ No newline at end of file
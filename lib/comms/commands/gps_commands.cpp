@@ -1,11 +1,25 @@
 #include "communication.h"
 #include "lib/location/gps_collector.h"
+#include "lib/location/gps_uart_rx.h"
+#include "lib/location/gps_config.h"
+#include "lib/location/gps_power.h"
+#include "lib/location/trajectory.h"
+#include <iomanip>
 #include <sstream> 
 #include "system_state_manager.h"
+#include "uart_tx.h"
 
 static constexpr uint8_t gps_commands_group_id = 7;
 static constexpr uint8_t power_status_command_id = 1;
 static constexpr uint8_t passthrough_command_id = 2;
+static constexpr uint8_t parse_stats_command_id = 3;
+static constexpr uint8_t fix_quality_command_id = 4;
+static constexpr uint8_t uart_rx_stats_command_id = 5;
+static constexpr uint8_t receiver_config_command_id = 6;
+static constexpr uint8_t power_profile_command_id = 7;
+static constexpr uint8_t power_stats_command_id = 8;
+static constexpr uint8_t trajectory_command_id = 9;
+static constexpr uint8_t trajectory_config_command_id = 10;
 
 /**
  * @defgroup GPSCommands GPS Commands
@@ -22,9 +36,13 @@ static constexpr uint8_t passthrough_command_id = 2;
  *          or
  *         - Error: Error reason
  * @note <b>KBST;0;GET;7;1;;TSBK</b>
- * @note Return current GPS module power state: ON/OFF
+ * @note Return current GPS module power state: ON/OFF. With the power scheduler
+ *       enabled the module is off between duty cycle windows; the scheduler state
+ *       that SET changes is the SCHEDULER field of 7.8
  * @note <b>KBST;0;SET;7;1;POWER;TSBK</b>
  * @note POWER - 0 - OFF, 1 - ON
+ * @note SET enables or disables the GPS power scheduler, which switches the module
+ *       according to the power profile of the operating mode
  * @ingroup GPSCommands
  * @xrefitem command "Command" "List of Commands" Command ID: 7.1
  */
@@ -54,8 +72,7 @@ std::vector<Frame> handle_gps_power_status(const std::string& param, OperationTy
                 frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, power_status_command_id, error_str));
                 return frames;
             }
-            gpio_put(GPS_POWER_ENABLE_PIN, power_status);
-            EventEmitter::emit(EventGroup::GPS, power_status ? GPSEvent::POWER_ON : GPSEvent::POWER_OFF);
+            GpsPowerScheduler::get_instance().set_enabled(power_status != 0);
             frames.push_back(frame_build(OperationType::RES, gps_commands_group_id, power_status_command_id, std::to_string(power_status)));
             return frames;
         } catch (...) {
@@ -130,10 +147,11 @@ std::vector<Frame> handle_enable_gps_uart_passthrough(const std::string& param,
     std::string input_buffer;
     bool exit_requested = false;
     SystemStateManager::get_instance().set_gps_collection_paused(true);
+    gps_uart_rx_set_enabled(false);
     sleep_ms(100); 
 
     uint32_t original_baud_rate = DEBUG_UART_BAUD_RATE;
-    uint32_t gps_baud_rate = GPS_UART_BAUD_RATE;
+    uint32_t gps_baud_rate = GpsConfigManager::get_instance().get_baud_rate();
     uint32_t start_time = to_ms_since_boot(get_absolute_time());
 
     EventEmitter::emit(EventGroup::GPS, GPSEvent::PASS_THROUGH_START);
@@ -144,7 +162,8 @@ std::vector<Frame> handle_enable_gps_uart_passthrough(const std::string& param,
                          "Send " + EXIT_SEQUENCE + " to exit";
     uart_print(message, VerbosityLevel::INFO);
 
-    sleep_ms(10);
+    // the TX ring must be empty before the baud rate changes
+    uart_tx_flush();
     
     // Change main UART baudrate to GPS module baudrate for passthrough duration
     uart_set_baudrate(DEBUG_UART_PORT, gps_baud_rate);
@@ -184,6 +203,7 @@ std::vector<Frame> handle_enable_gps_uart_passthrough(const std::string& param,
     
     sleep_ms(50);
     
+    gps_uart_rx_set_enabled(true);
     SystemStateManager::get_instance().set_gps_collection_paused(false);
     EventEmitter::emit(EventGroup::GPS, GPSEvent::PASS_THROUGH_END);
     
@@ -194,4 +214,544 @@ std::vector<Frame> handle_enable_gps_uart_passthrough(const std::string& param,
     frames.push_back(frame_build(OperationType::RES, gps_commands_group_id, passthrough_command_id, response));
     return frames;
 }
+
+
+/**
+ * @brief Handler for reading NMEA parser statistics
+ * @param param Empty
+ * @param operationType GET
+ * @return Vector of Frames containing:
+ *         - Success: SENTENCES,UNSUPPORTED,CHECKSUM,OVERFLOWS,AVG_US,MAX_US,RMC_OK,RMC_BAD,GGA_OK,GGA_BAD,GSA_OK,GSA_BAD,GSV_OK,GSV_BAD
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;7;3;;TSBK</b>
+ * @note CHECKSUM counts lines rejected for a missing or wrong checksum, *_BAD counts rejections per sentence type
+ * @note AVG_US and MAX_US are parse times measured on target with the microsecond timer
+ * @ingroup GPSCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 7.3
+ */
+std::vector<Frame> handle_get_gps_parse_stats(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+
+    if (operationType != OperationType::GET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, parse_stats_command_id, error_str));
+        return frames;
+    }
+
+    if (!param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, parse_stats_command_id, error_str));
+        return frames;
+    }
+
+    GpsParseStats stats = get_gps_parse_stats();
+    uint32_t average_us = stats.sentences ? stats.total_parse_us / stats.sentences : 0;
+
+    std::stringstream ss;
+    ss << stats.sentences << ","
+       << stats.unsupported << ","
+       << stats.checksum_errors << ","
+       << stats.overflows << ","
+       << average_us << ","
+       << stats.max_parse_us;
+    for (size_t type = static_cast<size_t>(NmeaSentence::RMC); type < static_cast<size_t>(NmeaSentence::COUNT); type++) {
+        ss << "," << stats.accepted[type] << "," << stats.rejected[type];
+    }
+
+    frames.push_back(frame_build(OperationType::VAL, gps_commands_group_id, parse_stats_command_id, ss.str()));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for reading the measured GPS fix quality
+ * @param param Empty
+ * @param operationType GET
+ * @return Vector of Frames containing:
+ *         - Success: FIX_TYPE,USED,IN_VIEW,TRACKED,PDOP,HDOP,VDOP,MAX_SNR,AVG_SNR,AGE_MS,GENERATION
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;7;4;;TSBK</b>
+ * @note FIX_TYPE, USED and DOPs come from GSA, IN_VIEW and SNRs (dB-Hz) from GSV
+ * @note TRACKED is the number of satellites in view with a non-zero SNR, AVG_SNR is averaged over them
+ * @note AGE_MS is the time since the last valid RMC position (4294967295 if none), GENERATION counts fix updates
+ * @ingroup GPSCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 7.4
+ */
+std::vector<Frame> handle_get_gps_fix_quality(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+
+    if (operationType != OperationType::GET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, fix_quality_command_id, error_str));
+        return frames;
+    }
+
+    if (!param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, fix_quality_command_id, error_str));
+        return frames;
+    }
+
+    GpsFixSnapshot snapshot = NMEAData::get_instance().get_snapshot();
+    const GpsFix& fix = snapshot.fix;
+
+    uint32_t tracked = 0;
+    uint32_t snr_sum = 0;
+    uint8_t max_snr = 0;
+    for (uint8_t i = 0; i < fix.satellite_count; i++) {
+        uint8_t snr = fix.satellites_in_view[i].snr;
+        if (snr > 0) {
+            tracked++;
+            snr_sum += snr;
+        }
+        if (snr > max_snr) {
+            max_snr = snr;
+        }
+    }
+
+    auto dop = [](uint16_t value_c) {
+        char buffer[12];
+        snprintf(buffer, sizeof(buffer), "%u.%02u", value_c / 100, value_c % 100);
+        return std::string(buffer);
+    };
+
+    std::stringstream ss;
+    ss << static_cast<int>(fix.fix_type) << ","
+       << static_cast<int>(fix.satellites_used) << ","
+       << static_cast<int>(fix.satellite_count) << ","
+       << tracked << ","
+       << dop(fix.pdop_c) << ","
+       << dop(fix.hdop_c) << ","
+       << dop(fix.vdop_c) << ","
+       << static_cast<int>(max_snr) << ","
+       << (tracked ? snr_sum / tracked : 0) << ","
+       << snapshot.age_ms << ","
+       << snapshot.generation;
+
+    frames.push_back(frame_build(OperationType::VAL, gps_commands_group_id, fix_quality_command_id, ss.str()));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for reading GPS UART receive statistics
+ * @param param Empty
+ * @param operationType GET
+ * @return Vector of Frames containing:
+ *         - Success: BYTES,PEAK_USED,RING_OVERRUNS,FIFO_OVERRUNS,LINE_ERRORS
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;7;5;;TSBK</b>
+ * @note RING_OVERRUNS counts bytes dropped because the receive ring was full, FIFO_OVERRUNS
+ *       counts UART hardware FIFO overruns; both stay 0 when no byte was lost
+ * @ingroup GPSCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 7.5
+ */
+std::vector<Frame> handle_get_gps_uart_rx_stats(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+
+    if (operationType != OperationType::GET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, uart_rx_stats_command_id, error_str));
+        return frames;
+    }
+
+    if (!param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, uart_rx_stats_command_id, error_str));
+        return frames;
+    }
+
+    GpsUartRxStats stats = gps_uart_rx_get_stats();
+
+    std::stringstream ss;
+    ss << stats.bytes_received << ","
+       << stats.peak_used << ","
+       << stats.ring_overruns << ","
+       << stats.fifo_overruns << ","
+       << stats.line_errors;
+
+    frames.push_back(frame_build(OperationType::VAL, gps_commands_group_id, uart_rx_stats_command_id, ss.str()));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for the GPS receiver configuration
+ * @param param For SET: RECEIVER,BAUD,RATE_HZ. For GET: empty
+ * @param operationType GET to read the configuration, SET to reconfigure the receiver
+ * @return Vector of Frames containing:
+ *         - Success: GET - RECEIVER,BAUD,RATE_HZ,STATE,ACKS,NACKS,TIMEOUTS,FALLBACKS,DURATION_MS
+ *                    SET - accepted parameters, the receiver is reconfigured by core 1
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;7;6;;TSBK</b>
+ * @note STATE - 0 default, 1 configured, 2 partial, 3 no receiver
+ * @note <b>KBST;0;SET;7;6;RECEIVER,BAUD,RATE_HZ;TSBK</b>
+ * @note RECEIVER - 0 MTK (PMTK), 1 u-blox (UBX); BAUD - 9600, 19200, 38400, 57600 or 115200; RATE_HZ - 1-10
+ * @ingroup GPSCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 7.6
+ */
+std::vector<Frame> handle_gps_receiver_config(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+    GpsConfigManager& config = GpsConfigManager::get_instance();
+
+    if (operationType == OperationType::GET) {
+        if (!param.empty()) {
+            error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+            frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, receiver_config_command_id, error_str));
+            return frames;
+        }
+
+        GpsConfigStatus status = config.get_status();
+        std::stringstream ss;
+        ss << static_cast<int>(status.receiver) << ","
+           << status.baud << ","
+           << status.rate_hz << ","
+           << static_cast<int>(status.state) << ","
+           << status.acks << ","
+           << status.nacks << ","
+           << status.timeouts << ","
+           << status.fallbacks << ","
+           << status.duration_ms;
+        frames.push_back(frame_build(OperationType::VAL, gps_commands_group_id, receiver_config_command_id, ss.str()));
+        return frames;
+    }
+
+    if (operationType != OperationType::SET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, receiver_config_command_id, error_str));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, receiver_config_command_id, error_str));
+        return frames;
+    }
+
+    unsigned long fields[3];
+    size_t start = 0;
+    bool valid = true;
+    try {
+        for (size_t i = 0; i < 3 && valid; i++) {
+            size_t separator = param.find(',', start);
+            valid = (separator == std::string::npos) == (i == 2);
+            fields[i] = std::stoul(param.substr(start, separator - start));
+            start = separator + 1;
+        }
+    } catch (...) {
+        valid = false;
+    }
+
+    if (!valid) {
+        error_str = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, receiver_config_command_id, error_str));
+        return frames;
+    }
+
+    if (fields[0] >= static_cast<unsigned long>(GpsReceiverType::COUNT) ||
+        !config.request_configure(static_cast<GpsReceiverType>(fields[0]), fields[1], fields[2])) {
+        error_str = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, receiver_config_command_id, error_str));
+        return frames;
+    }
+
+    frames.push_back(frame_build(OperationType::RES, gps_commands_group_id, receiver_config_command_id, param));
+    return frames;
+}
+
+/**
+ * @brief Handler for the GPS power profiles
+ * @param param For SET: PROFILE,MODE,PERIOD_S,MAX_WINDOW_S. For GET: empty
+ * @param operationType GET to read the active profile, SET to change a profile
+ * @return Vector of Frames containing:
+ *         - Success: GET - PROFILE,MODE,PERIOD_S,MAX_WINDOW_S,STATE,ENABLED,NEXT_WINDOW_S
+ *                    SET - accepted parameters
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;7;7;;TSBK</b>
+ * @note PROFILE - 0 USB, 1 battery; the profile of the current operating mode is active
+ * @note STATE - 0 off, 1 acquiring, 2 holding fix, 3 on
+ * @note <b>KBST;0;SET;7;7;PROFILE,MODE,PERIOD_S,MAX_WINDOW_S;TSBK</b>
+ * @note MODE - 0 off, 1 always on, 2 duty cycled; PERIOD_S - 60-86400; MAX_WINDOW_S - 30-PERIOD_S
+ * @ingroup GPSCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 7.7
+ */
+std::vector<Frame> handle_gps_power_profile(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+    GpsPowerScheduler& scheduler = GpsPowerScheduler::get_instance();
+
+    if (operationType == OperationType::GET) {
+        if (!param.empty()) {
+            error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+            frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, power_profile_command_id, error_str));
+            return frames;
+        }
+
+        bool battery = SystemStateManager::get_instance().get_operating_mode() == SystemOperatingMode::BATTERY_POWERED;
+        GpsPowerProfile profile = scheduler.get_profile(battery);
+        std::stringstream ss;
+        ss << (battery ? 1 : 0) << ","
+           << static_cast<int>(profile.mode) << ","
+           << profile.period_s << ","
+           << profile.max_window_s << ","
+           << static_cast<int>(scheduler.get_state()) << ","
+           << (scheduler.is_enabled() ? 1 : 0) << ","
+           << scheduler.get_next_window_s();
+        frames.push_back(frame_build(OperationType::VAL, gps_commands_group_id, power_profile_command_id, ss.str()));
+        return frames;
+    }
+
+    if (operationType != OperationType::SET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, power_profile_command_id, error_str));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, power_profile_command_id, error_str));
+        return frames;
+    }
+
+    unsigned long fields[4];
+    size_t start = 0;
+    bool valid = true;
+    try {
+        for (size_t i = 0; i < 4 && valid; i++) {
+            size_t separator = param.find(',', start);
+            valid = (separator == std::string::npos) == (i == 3);
+            fields[i] = std::stoul(param.substr(start, separator - start));
+            start = separator + 1;
+        }
+    } catch (...) {
+        valid = false;
+    }
+
+    if (!valid) {
+        error_str = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, power_profile_command_id, error_str));
+        return frames;
+    }
+
+    if (fields[0] > 1 || fields[1] >= static_cast<unsigned long>(GpsPowerMode::COUNT) ||
+        !scheduler.set_profile(fields[0] == 1, {static_cast<GpsPowerMode>(fields[1]),
+                                                static_cast<uint32_t>(fields[2]),
+                                                static_cast<uint32_t>(fields[3])})) {
+        error_str = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, power_profile_command_id, error_str));
+        return frames;
+    }
+
+    frames.push_back(frame_build(OperationType::RES, gps_commands_group_id, power_profile_command_id, param));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for the GPS fix window and time-to-first-fix statistics
+ * @param param Empty
+ * @param operationType GET
+ * @return Vector of Frames containing:
+ *         - Success: WINDOWS,FIXES,TIMEOUTS,LAST_TTFF_MS,WARM_TTFF_MS,COLD_TTFF_MS,WINDOW_S,ON_PERMILLE,SCHEDULER
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;7;8;;TSBK</b>
+ * @note WARM_TTFF_MS and COLD_TTFF_MS are running averages, 0 until a start of that kind got a fix
+ * @note ON_PERMILLE - share of the time since boot the receiver was powered
+ * @note SCHEDULER - 1 if the GPS power scheduler is enabled, the state SET 7.1 changes
+ * @ingroup GPSCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 7.8
+ */
+std::vector<Frame> handle_get_gps_power_stats(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+
+    if (operationType != OperationType::GET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, power_stats_command_id, error_str));
+        return frames;
+    }
+
+    if (!param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, power_stats_command_id, error_str));
+        return frames;
+    }
+
+    GpsPowerScheduler& scheduler = GpsPowerScheduler::get_instance();
+    GpsPowerStats stats = scheduler.get_stats();
+    uint64_t uptime_ms = to_ms_since_boot(get_absolute_time());
+
+    std::stringstream ss;
+    ss << stats.windows << ","
+       << stats.fixes << ","
+       << stats.timeouts << ","
+       << stats.last_ttff_ms << ","
+       << stats.warm_ttff_ms << ","
+       << stats.cold_ttff_ms << ","
+       << stats.window_s << ","
+       << (uptime_ms ? stats.on_time_ms * 1000 / uptime_ms : 0) << ","
+       << (scheduler.is_enabled() ? 1 : 0);
+
+    frames.push_back(frame_build(OperationType::VAL, gps_commands_group_id, power_stats_command_id, ss.str()));
+    return frames;
+}
+
+/**
+ * @brief Handler for reading the simplified trajectory
+ * @param param "COUNT" or "START,COUNT" - COUNT points from index START, 0 being the oldest
+ * @param operationType GET
+ * @return Vector of Frames containing:
+ *         - Success: TOTAL,START,COUNT,HEX - HEX is the binary polyline part, hex encoded
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;7;9;[START,]COUNT;TSBK</b>
+ * @note COUNT - 1-48. The binary layout is described at TrajectoryStore::encode(); every part
+ *       starts with an absolute point. tools/trajectory_kml.py converts the responses to KML.
+ * @ingroup GPSCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 7.9
+ */
+std::vector<Frame> handle_get_trajectory(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+
+    if (operationType != OperationType::GET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, trajectory_command_id, error_str));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, trajectory_command_id, error_str));
+        return frames;
+    }
+
+    size_t start = 0;
+    size_t count = 0;
+    try {
+        size_t separator = param.find(',');
+        if (separator == std::string::npos) {
+            count = std::stoul(param);
+        } else {
+            start = std::stoul(param.substr(0, separator));
+            count = std::stoul(param.substr(separator + 1));
+        }
+    } catch (...) {
+        error_str = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, trajectory_command_id, error_str));
+        return frames;
+    }
+
+    TrajectoryStore& store = TrajectoryStore::get_instance();
+    size_t total = store.get_stats().stored;
+    if (count == 0 || count > TRAJECTORY_MAX_READ_POINTS || (start >= total && total != 0)) {
+        error_str = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, trajectory_command_id, error_str));
+        return frames;
+    }
+
+    uint8_t buffer[1 + 4 * 4 + (TRAJECTORY_MAX_READ_POINTS - 1) * 4 * 5];
+    size_t encoded = 0;
+    size_t length = store.encode(start, count, buffer, sizeof(buffer), encoded);
+
+    std::stringstream ss;
+    ss << total << "," << start << "," << encoded << ",";
+    ss << std::hex << std::uppercase << std::setfill('0');
+    for (size_t i = 0; i < length; i++) {
+        ss << std::setw(2) << static_cast<int>(buffer[i]);
+    }
+
+    frames.push_back(frame_build(OperationType::VAL, gps_commands_group_id, trajectory_command_id, ss.str()));
+    return frames;
+}
+
+
+/**
+ * @brief Handler for the trajectory store settings and counters
+ * @param param For SET: TOLERANCE_M or TOLERANCE_M,CLEAR. For GET: empty
+ * @param operationType GET to read the counters, SET to change the tolerance
+ * @return Vector of Frames containing:
+ *         - Success: GET - TOLERANCE_M,INPUT,KEPT,STORED,OVERWRITTEN,FULL_WINDOWS
+ *                    SET - accepted parameters
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;7;10;;TSBK</b>
+ * @note <b>KBST;0;SET;7;10;TOLERANCE_M[,CLEAR];TSBK</b>
+ * @note TOLERANCE_M - 1-1000 m, largest distance of a dropped position from the polyline;
+ *       CLEAR - 1 also empties the store
+ * @ingroup GPSCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 7.10
+ */
+std::vector<Frame> handle_trajectory_config(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+    TrajectoryStore& store = TrajectoryStore::get_instance();
+
+    if (operationType == OperationType::GET) {
+        if (!param.empty()) {
+            error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+            frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, trajectory_config_command_id, error_str));
+            return frames;
+        }
+
+        TrajectoryStats stats = store.get_stats();
+        std::stringstream ss;
+        ss << stats.tolerance_m << ","
+           << stats.input_points << ","
+           << stats.kept_points << ","
+           << stats.stored << ","
+           << stats.overwritten << ","
+           << stats.full_windows;
+        frames.push_back(frame_build(OperationType::VAL, gps_commands_group_id, trajectory_config_command_id, ss.str()));
+        return frames;
+    }
+
+    if (operationType != OperationType::SET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, trajectory_config_command_id, error_str));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, trajectory_config_command_id, error_str));
+        return frames;
+    }
+
+    unsigned long tolerance;
+    unsigned long clear = 0;
+    try {
+        size_t separator = param.find(',');
+        tolerance = std::stoul(param.substr(0, separator));
+        if (separator != std::string::npos) {
+            clear = std::stoul(param.substr(separator + 1));
+        }
+    } catch (...) {
+        error_str = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, trajectory_config_command_id, error_str));
+        return frames;
+    }
+
+    if (clear > 1 || !store.set_tolerance(tolerance)) {
+        error_str = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, gps_commands_group_id, trajectory_config_command_id, error_str));
+        return frames;
+    }
+    if (clear) {
+        store.clear();
+    }
+
+    frames.push_back(frame_build(OperationType::RES, gps_commands_group_id, trajectory_config_command_id, param));
+    return frames;
+}
 /** @} */ // end of GPSCommands group
\ No newline at end of file
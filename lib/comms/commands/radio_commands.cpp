@@ -0,0 +1,195 @@
+#include "commands.h"
+#include "communication.h"
+#include <iomanip>
+#include <sstream>
+
+static constexpr uint8_t radio_commands_group_id = 2;
+static constexpr uint8_t rx_mode_command_id = 0;
+static constexpr uint8_t wake_period_command_id = 1;
+static constexpr uint8_t power_stats_command_id = 2;
+
+/**
+ * @defgroup RadioCommands Radio Commands
+ * @brief Commands for the LoRa receive duty cycle and its power statistics
+ * @{
+ */
+
+/**
+ * @brief Handler for the LoRa receive mode
+ * @param param For SET: "0" continuous RX, "1" duty-cycled RX (sleep + CAD). For GET: empty
+ * @param operationType GET to read the current mode, SET to change it
+ * @return Vector of Frames containing:
+ *         - Success: Current receive mode (0/1)
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;2;0;;TSBK</b>
+ * @note Return current receive mode
+ * @note <b>KBST;0;SET;2;0;MODE;TSBK</b>
+ * @note MODE - 0 - CONTINUOUS, 1 - DUTY_CYCLED
+ * @note In duty-cycled mode the ground must send with a preamble longer than the wake period (2.1)
+ * @ingroup RadioCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 2.0
+ */
+std::vector<Frame> handle_radio_rx_mode(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+
+    if (operationType == OperationType::GET) {
+        if (!param.empty()) {
+            error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+            frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, rx_mode_command_id, error_str));
+            return frames;
+        }
+        frames.push_back(frame_build(OperationType::VAL, radio_commands_group_id, rx_mode_command_id,
+                        std::to_string(static_cast<int>(radio_get_rx_mode()))));
+        return frames;
+    }
+
+    if (operationType != OperationType::SET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, rx_mode_command_id, error_str));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, rx_mode_command_id, error_str));
+        return frames;
+    }
+
+    try {
+        int mode = std::stoi(param);
+        if (mode != 0 && mode != 1) {
+            error_str = error_code_to_string(ErrorCode::PARAM_INVALID);
+            frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, rx_mode_command_id, error_str));
+            return frames;
+        }
+        radio_set_rx_mode(static_cast<RadioRxMode>(mode));
+        frames.push_back(frame_build(OperationType::RES, radio_commands_group_id, rx_mode_command_id, std::to_string(mode)));
+        return frames;
+    } catch (...) {
+        error_str = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, rx_mode_command_id, error_str));
+        return frames;
+    }
+}
+
+
+/**
+ * @brief Handler for the duty-cycle wake period
+ * @param param For SET: wake period in milliseconds. For GET: empty
+ * @param operationType GET to read the period, SET to change it
+ * @return Vector of Frames containing:
+ *         - Success: Current wake period in ms
+ *          or
+ *         - Error: Error reason
+ * @note <b>KBST;0;GET;2;1;;TSBK</b>
+ * @note Return the time the radio sleeps between two CAD wake-ups
+ * @note <b>KBST;0;SET;2;1;PERIOD;TSBK</b>
+ * @note PERIOD - 100-10000 ms
+ * @ingroup RadioCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 2.1
+ */
+std::vector<Frame> handle_radio_wake_period(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+
+    if (operationType == OperationType::GET) {
+        if (!param.empty()) {
+            error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+            frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, wake_period_command_id, error_str));
+            return frames;
+        }
+        frames.push_back(frame_build(OperationType::VAL, radio_commands_group_id, wake_period_command_id,
+                        std::to_string(radio_get_wake_period())));
+        return frames;
+    }
+
+    if (operationType != OperationType::SET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, wake_period_command_id, error_str));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, wake_period_command_id, error_str));
+        return frames;
+    }
+
+    try {
+        uint32_t period = std::stoul(param);
+        if (!radio_set_wake_period(period)) {
+            error_str = error_code_to_string(ErrorCode::INVALID_VALUE);
+            frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, wake_period_command_id, error_str));
+            return frames;
+        }
+        frames.push_back(frame_build(OperationType::RES, radio_commands_group_id, wake_period_command_id,
+                        std::to_string(radio_get_wake_period())));
+        return frames;
+    } catch (...) {
+        error_str = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, wake_period_command_id, error_str));
+        return frames;
+    }
+}
+
+
+/**
+ * @brief Handler for the radio power statistics
+ * @param param Empty string expected
+ * @param operationType GET
+ * @return Frame with comma separated values:
+ *         rx_ms,cad_ms,sleep_ms,standby_ms,tx_ms,cad_runs,cad_detections,cad_timeouts,lbt_busy,lbt_forced,
+ *         est_ma,est_continuous_ma,meas_continuous_ma,meas_duty_ma
+ * @note <b>KBST;0;GET;2;2;;TSBK</b>
+ * @note est_ma is the radio-only current estimated from datasheet figures, est_continuous_ma
+ *       the same period with the receiver always on. meas_*_ma are the average measured
+ *       board discharge currents while in each receive mode (-1 if no samples yet).
+ * @ingroup RadioCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 2.2
+ */
+std::vector<Frame> handle_get_radio_power_stats(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_str;
+
+    if (operationType != OperationType::GET) {
+        error_str = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, power_stats_command_id, error_str));
+        return frames;
+    }
+
+    if (!param.empty()) {
+        error_str = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+        frames.push_back(frame_build(OperationType::ERR, radio_commands_group_id, power_stats_command_id, error_str));
+        return frames;
+    }
+
+    RadioPowerStats stats = radio_get_power_stats();
+
+    auto measured_average = [&stats](RadioRxMode mode) {
+        uint8_t index = static_cast<uint8_t>(mode);
+        return stats.current_samples[index] ? stats.current_sum_ma[index] / stats.current_samples[index] : -1.0f;
+    };
+
+    std::stringstream ss;
+    ss << stats.rx_us / 1000 << ","
+       << stats.cad_us / 1000 << ","
+       << stats.sleep_us / 1000 << ","
+       << stats.standby_us / 1000 << ","
+       << stats.tx_us / 1000 << ","
+       << stats.cad_runs << ","
+       << stats.cad_detections << ","
+       << stats.cad_timeouts << ","
+       << stats.lbt_busy << ","
+       << stats.lbt_forced << ","
+       << std::fixed << std::setprecision(2)
+       << radio_estimate_current_ma(stats, false) << ","
+       << radio_estimate_current_ma(stats, true) << ","
+       << measured_average(RadioRxMode::CONTINUOUS) << ","
+       << measured_average(RadioRxMode::DUTY_CYCLED);
+
+    frames.push_back(frame_build(OperationType::VAL, radio_commands_group_id, power_stats_command_id, ss.str()));
+    return frames;
+}
+/** @} */ // RadioCommands
@@ -1,10 +1,16 @@
 #include "commands.h"
 #include "communication.h"
 #include "telemetry_manager.h"
+#include "beacon.h"
+#include "ISensor.h"
 
 static constexpr uint8_t telemetry_commands_group = 8;
 static constexpr uint8_t last_telemetry_command_id = 2;
 static constexpr uint8_t last_sensor_command_id = 3;
+static constexpr uint8_t beacon_interval_command_id = 4;
+static constexpr uint8_t beacon_command_id = 5;
+static constexpr uint8_t deadband_command_id = 6;
+static constexpr uint8_t environment_sensor_command_id = 7;
 
 /**
  * @defgroup TelemetryBufferCommands Telemetry Buffer Commands
@@ -96,4 +102,256 @@ std::vector<Frame> handle_get_last_sensor_record([[maybe_unused]]const std::stri
 
     return frames;
 }
+
+/**
+ * @brief Handler for getting and setting the beacon interval
+ * @param param For SET: interval in seconds (0 disables the beacon), for GET: empty string
+ * @param operationType GET/SET
+ * @return Vector of frames containing success/error and the beacon interval in seconds
+ * @note GET: <b>KBST;0;GET;8;4;;TSBK</b>
+ * @note SET: <b>KBST;0;SET;8;4;SECONDS;TSBK</b>
+ * @note SECONDS - 0 (off) or 10-3600
+ * @ingroup TelemetryBufferCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 8.4
+ */
+std::vector<Frame> handle_beacon_interval(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+    auto& beacon = BeaconManager::get_instance();
+
+    if (operationType == OperationType::GET) {
+        if (!param.empty()) {
+            error_msg = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+            frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, beacon_interval_command_id, error_msg));
+            return frames;
+        }
+        frames.push_back(frame_build(OperationType::VAL, telemetry_commands_group, beacon_interval_command_id,
+                        std::to_string(beacon.get_interval()), ValueUnit::SECOND));
+        return frames;
+    }
+
+    if (operationType != OperationType::SET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, beacon_interval_command_id, error_msg));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, beacon_interval_command_id, error_msg));
+        return frames;
+    }
+
+    try {
+        uint32_t interval = std::stoul(param);
+        if (!beacon.set_interval(interval)) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+            frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, beacon_interval_command_id, error_msg));
+            return frames;
+        }
+        frames.push_back(frame_build(OperationType::RES, telemetry_commands_group, beacon_interval_command_id,
+                        std::to_string(beacon.get_interval()), ValueUnit::SECOND));
+        return frames;
+    } catch (...) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, beacon_interval_command_id, error_msg));
+        return frames;
+    }
+}
+
+
+/**
+ * @brief Handler for building a beacon on demand
+ * @param param Empty string expected
+ * @param operationType GET
+ * @return Frame containing the beacon packet as a hex string (see BeaconPacket for the layout)
+ * @note <b>KBST;0;GET;8;5;;TSBK</b>
+ * @note Lets the ground decoder be checked over UART without waiting for a beacon on air;
+ * tools/beacon_decode.py unpacks the response
+ * @ingroup TelemetryBufferCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 8.5
+ */
+std::vector<Frame> handle_get_beacon(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+
+    if (operationType != OperationType::GET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, beacon_command_id, error_msg));
+        return frames;
+    }
+
+    if (!param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, beacon_command_id, error_msg));
+        return frames;
+    }
+
+    BeaconPacket packet = BeaconManager::get_instance().build_packet();
+    frames.push_back(frame_build(OperationType::VAL, telemetry_commands_group, beacon_command_id, BeaconManager::to_hex(packet)));
+    return frames;
+}
+
+/**
+ * @brief Handler for the deadband compression of a telemetry channel
+ * @param param For GET: CHANNEL, for SET: CHANNEL,DEVIATION_MILLI,MAX_INTERVAL_S
+ * @param operationType GET/SET
+ * @return Vector of frames containing success/error and the channel settings
+ * @note GET: <b>KBST;0;GET;8;6;CHANNEL;TSBK</b>
+ * @note Returns NAME,DEVIATION_MILLI,MAX_INTERVAL_S,SAMPLES,STORED
+ * @note SET: <b>KBST;0;SET;8;6;CHANNEL,DEVIATION_MILLI,MAX_INTERVAL_S;TSBK</b>
+ * @note CHANNEL - 0 battery_v, 1 system_v, 2 usb_ma, 3 solar_ma, 4 discharge_ma,
+ *       5 temperature, 6 pressure, 7 humidity, 8 light
+ * @note DEVIATION_MILLI - largest reconstruction error in 1/1000 of the channel unit, 0 stores every sample
+ * @note MAX_INTERVAL_S - longest time between stored samples, 1-86400
+ * @ingroup TelemetryBufferCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 8.6
+ */
+std::vector<Frame> handle_telemetry_deadband(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+    auto& telemetry = TelemetryManager::get_instance();
+
+    if (operationType != OperationType::GET && operationType != OperationType::SET) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, deadband_command_id, error_msg));
+        return frames;
+    }
+
+    if (param.empty()) {
+        error_msg = error_code_to_string(ErrorCode::PARAM_REQUIRED);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, deadband_command_id, error_msg));
+        return frames;
+    }
+
+    const size_t field_count = operationType == OperationType::GET ? 1 : 3;
+    unsigned long fields[3];
+    size_t start = 0;
+    bool valid = true;
+    try {
+        for (size_t i = 0; i < field_count && valid; i++) {
+            size_t separator = param.find(',', start);
+            valid = (separator == std::string::npos) == (i == field_count - 1);
+            fields[i] = std::stoul(param.substr(start, separator - start));
+            start = separator + 1;
+        }
+    } catch (...) {
+        valid = false;
+    }
+
+    if (!valid) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, deadband_command_id, error_msg));
+        return frames;
+    }
+
+    if (fields[0] >= TELEMETRY_CHANNEL_COUNT) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, deadband_command_id, error_msg));
+        return frames;
+    }
+    TelemetryChannel channel = static_cast<TelemetryChannel>(fields[0]);
+
+    if (operationType == OperationType::GET) {
+        SwingingDoor door = telemetry.get_deadband(channel);
+        SwingingDoorStats stats = door.get_stats();
+        std::string response = std::string(TELEMETRY_CHANNELS[fields[0]].name) + "," +
+                               std::to_string(static_cast<unsigned long>(door.get_deviation() * 1000.0f + 0.5f)) + "," +
+                               std::to_string(door.get_max_interval()) + "," +
+                               std::to_string(stats.samples) + "," +
+                               std::to_string(stats.kept);
+        frames.push_back(frame_build(OperationType::VAL, telemetry_commands_group, deadband_command_id, response));
+        return frames;
+    }
+
+    if (fields[1] > 1000000 || !telemetry.set_deadband(channel, fields[1] / 1000.0f, static_cast<uint32_t>(fields[2]))) {
+        error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, deadband_command_id, error_msg));
+        return frames;
+    }
+
+    frames.push_back(frame_build(OperationType::RES, telemetry_commands_group, deadband_command_id, param));
+    return frames;
+}
+
+/**
+ * @brief Get or set the acquisition settings of the environment sensor (BME280)
+ * @param param For GET: empty. For SET: MODE,OSRS_T,OSRS_P,OSRS_H,FILTER,STANDBY_MS
+ * @param operationType GET or SET
+ * @return One-element vector with the settings
+ * @note <b>KBST;0;GET;8;7;;TSBK</b>
+ * @note <b>KBST;0;SET;8;7;[mode],[osrs_t],[osrs_p],[osrs_h],[filter],[standby_ms];TSBK</b>
+ * @note Example: <b>KBST;0;SET;8;7;forced,1,4,1,0,1000;TSBK</b>
+ * @note MODE - forced (one measurement per telemetry sample), normal (free running) or sleep (no measurements)
+ * @note OSRS_T, OSRS_P, OSRS_H - oversampling 0, 1, 2, 4, 8 or 16; 0 skips the value, not allowed for temperature
+ * @note FILTER - IIR filter coefficient 0 (off), 2, 4, 8 or 16
+ * @note STANDBY_MS - time between measurements in normal mode: 0.5, 10, 20, 62.5, 125, 250, 500 or 1000
+ * @note GET response: MODE,OSRS_T,OSRS_P,OSRS_H,FILTER,STANDBY_MS,MEASUREMENT_US, the last being the longest measurement time
+ * @ingroup TelemetryBufferCommands
+ * @xrefitem command "Command" "List of Commands" Command ID: 8.7
+ */
+std::vector<Frame> handle_environment_sensor_config(const std::string& param, OperationType operationType) {
+    std::vector<Frame> frames;
+    std::string error_msg;
+    static const char* const keys[] = {"mode", "temperature_oversampling", "pressure_oversampling",
+                                       "humidity_oversampling", "filter", "standby_ms"};
+    static constexpr size_t key_count = sizeof(keys) / sizeof(keys[0]);
+    SensorWrapper& sensor_wrapper = SensorWrapper::get_instance();
+
+    if (operationType == OperationType::GET) {
+        if (!param.empty()) {
+            error_msg = error_code_to_string(ErrorCode::PARAM_UNNECESSARY);
+            frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, environment_sensor_command_id, error_msg));
+            return frames;
+        }
+
+        std::map<std::string, std::string> config = sensor_wrapper.sensor_get_configuration(SensorType::ENVIRONMENT);
+        if (config.empty()) {
+            error_msg = error_code_to_string(ErrorCode::INTERNAL_FAIL_TO_READ);
+            frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, environment_sensor_command_id, error_msg));
+            return frames;
+        }
+
+        std::string response;
+        for (const char* key : keys) {
+            response += config[key] + ",";
+        }
+        response += config["measurement_us"];
+        frames.push_back(frame_build(OperationType::VAL, telemetry_commands_group, environment_sensor_command_id, response));
+        return frames;
+    }
+    else if (operationType == OperationType::SET) {
+        std::map<std::string, std::string> config;
+        size_t start = 0;
+        bool valid = true;
+        for (size_t i = 0; i < key_count && valid; i++) {
+            size_t separator = param.find(',', start);
+            valid = (separator == std::string::npos) == (i == key_count - 1);
+            std::string value = param.substr(start, separator - start);
+            valid = valid && !value.empty();
+            config[keys[i]] = value;
+            start = separator + 1;
+        }
+
+        if (!valid) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_FORMAT);
+            frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, environment_sensor_command_id, error_msg));
+            return frames;
+        }
+
+        if (!sensor_wrapper.sensor_configure(SensorType::ENVIRONMENT, config)) {
+            error_msg = error_code_to_string(ErrorCode::INVALID_VALUE);
+            frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, environment_sensor_command_id, error_msg));
+            return frames;
+        }
+
+        frames.push_back(frame_build(OperationType::RES, telemetry_commands_group, environment_sensor_command_id, param));
+        return frames;
+    }
+    else {
+        error_msg = error_code_to_string(ErrorCode::INVALID_OPERATION);
+        frames.push_back(frame_build(OperationType::ERR, telemetry_commands_group, environment_sensor_command_id, error_msg));
+        return frames;
+    }
+}
 /** @} */ // TelemetryBufferCommands
\ No newline at end of file
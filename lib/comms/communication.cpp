@@ -1,4 +1,11 @@
 #include "communication.h"
+#include "system_state_manager.h"
+#include "pico/rand.h"
+
+/**
+ * @brief Radio link counters, see LinkStats
+ */
+LinkStats link_stats = {};
 
 /**
  * @brief Initializes the LoRa radio module.
@@ -31,9 +38,355 @@ bool initialize_radio() {
 
 /**
  * @brief Callback function for LoRa transmission completion.
- * @details Prints a debug message to the UART and sets the LoRa module to receive mode.
+ * @details Prints a debug message to the UART and sets the LoRa module to receive mode
+ *          unless the receiver is duty-cycled, in which case radio_poll() owns the radio.
  */
 void lora_tx_done_callback() {
     uart_print("LoRa transmission complete", VerbosityLevel::DEBUG);
-    LoRa.receive(0);
+    if (radio_get_rx_mode() == RadioRxMode::CONTINUOUS) {
+        LoRa.receive(0);
+    }
+}
+
+namespace {
+
+/**
+ * @brief State of the duty-cycled receive scheduler.
+ */
+enum class RadioState : uint8_t {
+    RX,       /**< Listening (continuous mode or RX window after activity) */
+    SLEEP,    /**< Radio asleep until the next wake-up */
+    STANDBY   /**< Radio idle, e.g. during listen-before-talk backoff */
+};
+
+constexpr uint32_t DEFAULT_WAKE_PERIOD_MS = 1000;
+constexpr uint32_t MIN_WAKE_PERIOD_MS = 100;
+constexpr uint32_t MAX_WAKE_PERIOD_MS = 10000;
+constexpr uint32_t RX_WINDOW_MS = 2000;          // stay awake this long after activity or a packet
+constexpr uint32_t CAD_TIMEOUT_MS = 50;          // CAD takes ~2 symbols, a few ms at SF7/125 kHz
+constexpr uint8_t MAX_CAD_TIMEOUTS = 3;          // consecutive timeouts before falling back to continuous RX
+constexpr uint8_t LBT_ATTEMPTS = 4;
+constexpr uint32_t LBT_BACKOFF_MIN_MS = 20;
+constexpr long DEFAULT_PREAMBLE_SYMBOLS = 8;
+constexpr float SYMBOL_TIME_MS = 1.024f;         // SF7, 125 kHz as configured by LoRa.begin()
+
+// SX1278 typical supply currents from the datasheet (433 MHz, LnaBoost on, PA_BOOST +17 dBm)
+constexpr float CURRENT_RX_MA = 11.5f;
+constexpr float CURRENT_CAD_MA = 11.5f;
+constexpr float CURRENT_STANDBY_MA = 1.6f;
+constexpr float CURRENT_SLEEP_MA = 0.0002f;
+constexpr float CURRENT_TX_MA = 87.0f;
+
+RadioRxMode rx_mode = RadioRxMode::CONTINUOUS;
+constexpr uint8_t NO_PENDING_RX_MODE = 0xFF;
+volatile uint8_t pending_rx_mode = NO_PENDING_RX_MODE;  // set from core 1, applied by radio_poll() on core 0
+uint32_t wake_period_ms = DEFAULT_WAKE_PERIOD_MS;
+RadioState radio_state = RadioState::RX;
+uint64_t state_since_us = 0;
+uint32_t sleep_start_ms = 0;
+uint32_t rx_window_end_ms = 0;
+uint8_t consecutive_cad_timeouts = 0;
+RadioPowerStats power_stats = {};
+auto_init_mutex(current_sample_mutex);
+
+/**
+ * @brief Adds the time spent in the current state to its counter and restarts the state timer.
+ */
+void account_state() {
+    uint64_t now = time_us_64();
+    uint64_t elapsed = now - state_since_us;
+    switch (radio_state) {
+        case RadioState::RX:      power_stats.rx_us += elapsed; break;
+        case RadioState::SLEEP:   power_stats.sleep_us += elapsed; break;
+        case RadioState::STANDBY: power_stats.standby_us += elapsed; break;
+    }
+    state_since_us = now;
+}
+
+/**
+ * @brief Runs a single channel activity detection and waits for the result.
+ * @param timeout_ms Maximum time to wait for CAD done.
+ * @return 1 if a preamble was detected, 0 if the channel is free, -1 on timeout.
+ * @details The CAD done flag is polled over SPI rather than taken from DIO0, so it
+ *          works regardless of the DIO0 wiring. The radio is left in standby.
+ */
+int run_cad(uint32_t timeout_ms) {
+    account_state();
+
+    uint64_t start = time_us_64();
+    LoRa.idle();
+    LoRa.channelActivityDetection();
+    power_stats.cad_runs++;
+
+    int result;
+    while ((result = LoRa.cadStatus()) < 0 && time_us_64() - start < timeout_ms * 1000ULL) {
+        tight_loop_contents();
+    }
+
+    if (result < 0) {
+        power_stats.cad_timeouts++;
+        LoRa.idle();
+    } else if (result > 0) {
+        power_stats.cad_detections++;
+    }
+
+    power_stats.cad_us += time_us_64() - start;
+    state_since_us = time_us_64();
+    radio_state = RadioState::STANDBY;
+    return result;
+}
+
+/**
+ * @brief Puts the radio to sleep until the next wake-up.
+ * @param now_ms Current time in milliseconds since boot.
+ */
+void enter_sleep(uint32_t now_ms) {
+    account_state();
+    LoRa.sleep();
+    radio_state = RadioState::SLEEP;
+    sleep_start_ms = now_ms;
+}
+
+/**
+ * @brief Keeps the radio listening for RX_WINDOW_MS.
+ * @param now_ms Current time in milliseconds since boot.
+ * @details The receiver preamble length is raised to cover the wake period so the
+ *          long wake-up preamble sent by the ground is accepted.
+ */
+void open_rx_window(uint32_t now_ms) {
+    account_state();
+    LoRa.setPreambleLength(static_cast<long>(wake_period_ms / SYMBOL_TIME_MS) + DEFAULT_PREAMBLE_SYMBOLS);
+    radio_state = RadioState::RX;
+    rx_window_end_ms = now_ms + RX_WINDOW_MS;
+}
+
+} // namespace
+
+/**
+ * @brief Polls the radio for a received packet according to the receive mode.
+ * @return Size of the received packet, 0 if none.
+ * @details Replaces a direct LoRa.parse_packet() call in the main loop. In continuous
+ *          mode it is exactly that. In duty-cycled mode the radio sleeps for the wake
+ *          period, runs CAD and only enters receive for RX_WINDOW_MS when a preamble
+ *          is detected; each received packet extends the window. After
+ *          MAX_CAD_TIMEOUTS consecutive CAD timeouts the radio falls back to
+ *          continuous mode and CommsEvent::RADIO_ERROR is emitted. A mode
+ *          requested with radio_request_rx_mode() is applied first.
+ */
+int radio_poll() {
+    uint8_t pending = pending_rx_mode;
+    if (pending != NO_PENDING_RX_MODE) {
+        pending_rx_mode = NO_PENDING_RX_MODE;
+        radio_set_rx_mode(static_cast<RadioRxMode>(pending));
+    }
+
+    if (rx_mode == RadioRxMode::CONTINUOUS) {
+        return LoRa.parse_packet();
+    }
+
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+
+    if (radio_state == RadioState::RX) {
+        int packet_size = LoRa.parse_packet();
+        if (packet_size) {
+            rx_window_end_ms = now_ms + RX_WINDOW_MS;
+            return packet_size;
+        }
+        if (static_cast<int32_t>(now_ms - rx_window_end_ms) >= 0) {
+            enter_sleep(now_ms);
+        }
+        return 0;
+    }
+
+    if (radio_state == RadioState::SLEEP && now_ms - sleep_start_ms < wake_period_ms) {
+        return 0;
+    }
+
+    int cad = run_cad(CAD_TIMEOUT_MS);
+    if (cad < 0) {
+        if (++consecutive_cad_timeouts >= MAX_CAD_TIMEOUTS) {
+            uart_print("CAD not responding, falling back to continuous RX", VerbosityLevel::WARNING);
+            radio_set_rx_mode(RadioRxMode::CONTINUOUS);
+            EventEmitter::emit(EventGroup::COMMS, CommsEvent::RADIO_ERROR);
+            return 0;
+        }
+        enter_sleep(now_ms);
+        return 0;
+    }
+
+    consecutive_cad_timeouts = 0;
+    if (cad > 0) {
+        open_rx_window(now_ms);
+    } else {
+        enter_sleep(now_ms);
+    }
+    return 0;
+}
+
+/**
+ * @brief Waits for a free channel before transmitting.
+ * @return True if the channel was found free, false if the transmission goes out anyway.
+ * @details Runs CAD up to LBT_ATTEMPTS times with a random backoff between attempts
+ *          taken from get_rand_32(); the radio's wideband RSSI is not random after
+ *          CAD, which leaves the radio in standby. A CAD timeout does not block the
+ *          transmission. Also restores the default preamble length for TX.
+ */
+bool listen_before_talk() {
+    if (!SystemStateManager::get_instance().is_radio_init_ok()) {
+        return true;
+    }
+
+    if (rx_mode == RadioRxMode::DUTY_CYCLED) {
+        LoRa.setPreambleLength(DEFAULT_PREAMBLE_SYMBOLS);
+    }
+
+    for (uint8_t attempt = 0; attempt < LBT_ATTEMPTS; attempt++) {
+        int cad = run_cad(CAD_TIMEOUT_MS);
+        if (cad <= 0) {
+            return true;
+        }
+        power_stats.lbt_busy++;
+        sleep_ms(LBT_BACKOFF_MIN_MS + (get_rand_32() & 0x7F));
+    }
+
+    power_stats.lbt_forced++;
+    return false;
+}
+
+/**
+ * @brief Accounts a finished transmission and restores the receive state.
+ * @param duration_us Time the radio spent transmitting.
+ * @details In duty-cycled mode a transmission opens an RX window so a reply from
+ *          the ground is not missed.
+ */
+void radio_on_tx_complete(uint64_t duration_us) {
+    account_state();
+    power_stats.tx_us += duration_us;
+    state_since_us = time_us_64();
+
+    if (rx_mode == RadioRxMode::DUTY_CYCLED) {
+        open_rx_window(to_ms_since_boot(get_absolute_time()));
+    } else {
+        radio_state = RadioState::RX;
+    }
+}
+
+/**
+ * @brief Selects the receive mode.
+ * @param mode New receive mode.
+ * @details Switching to continuous mode restores the default preamble length and
+ *          lets the next radio_poll() put the radio back into receive.
+ */
+void radio_set_rx_mode(RadioRxMode mode) {
+    if (mode == rx_mode) {
+        return;
+    }
+
+    account_state();
+    rx_mode = mode;
+    consecutive_cad_timeouts = 0;
+
+    if (mode == RadioRxMode::CONTINUOUS) {
+        LoRa.setPreambleLength(DEFAULT_PREAMBLE_SYMBOLS);
+        LoRa.idle();
+        radio_state = RadioState::RX;
+    } else {
+        enter_sleep(to_ms_since_boot(get_absolute_time()));
+    }
+
+    uart_print("Radio RX mode: " + std::string(mode == RadioRxMode::CONTINUOUS ? "CONTINUOUS" : "DUTY_CYCLED"), VerbosityLevel::INFO);
+}
+
+/**
+ * @brief Requests a receive mode change from another core.
+ * @param mode New receive mode.
+ * @details The radio SPI is driven by core 0 only; the change is applied by
+ *          the next radio_poll(). A later request replaces an unapplied one.
+ */
+void radio_request_rx_mode(RadioRxMode mode) {
+    pending_rx_mode = static_cast<uint8_t>(mode);
+}
+
+/**
+ * @brief Gets the receive mode.
+ * @return Current receive mode.
+ */
+RadioRxMode radio_get_rx_mode() {
+    return rx_mode;
+}
+
+/**
+ * @brief Sets the sleep time between two CAD wake-ups in duty-cycled mode.
+ * @param period_ms Wake period in milliseconds, MIN_WAKE_PERIOD_MS to MAX_WAKE_PERIOD_MS.
+ * @return True if the period was accepted.
+ * @note The ground station must transmit with a preamble longer than the wake period.
+ */
+bool radio_set_wake_period(uint32_t period_ms) {
+    if (period_ms < MIN_WAKE_PERIOD_MS || period_ms > MAX_WAKE_PERIOD_MS) {
+        return false;
+    }
+    wake_period_ms = period_ms;
+    return true;
+}
+
+/**
+ * @brief Gets the duty-cycle wake period.
+ * @return Wake period in milliseconds.
+ */
+uint32_t radio_get_wake_period() {
+    return wake_period_ms;
+}
+
+/**
+ * @brief Records a measured battery discharge current for the active receive mode.
+ * @param discharge_current_ma Discharge current in mA.
+ * @details Called from the telemetry collection on core 1.
+ */
+void radio_record_current_sample(float discharge_current_ma) {
+    mutex_enter_blocking(&current_sample_mutex);
+    uint8_t index = static_cast<uint8_t>(rx_mode);
+    power_stats.current_sum_ma[index] += discharge_current_ma;
+    power_stats.current_samples[index]++;
+    mutex_exit(&current_sample_mutex);
+}
+
+/**
+ * @brief Gets a snapshot of the radio power counters.
+ * @return Copy of the counters, including the time spent in the current state.
+ */
+RadioPowerStats radio_get_power_stats() {
+    account_state();
+    mutex_enter_blocking(&current_sample_mutex);
+    RadioPowerStats snapshot = power_stats;
+    mutex_exit(&current_sample_mutex);
+    return snapshot;
+}
+
+/**
+ * @brief Estimates the average radio supply current from the time counters.
+ * @param stats Counters to evaluate.
+ * @param continuous_rx If true, estimate what the same period would have cost with
+ *        the radio listening continuously instead of sleeping.
+ * @return Estimated average radio current in mA, 0 if no time was accounted.
+ * @details Uses typical SX1278 datasheet currents. The estimate covers the radio
+ *          alone; the measured discharge current averages include the whole board.
+ */
+float radio_estimate_current_ma(const RadioPowerStats& stats, bool continuous_rx) {
+    double tx = static_cast<double>(stats.tx_us);
+    double total = static_cast<double>(stats.rx_us + stats.cad_us + stats.sleep_us + stats.standby_us) + tx;
+    if (total <= 0.0) {
+        return 0.0f;
+    }
+
+    double charge;
+    if (continuous_rx) {
+        charge = (total - tx) * CURRENT_RX_MA + tx * CURRENT_TX_MA;
+    } else {
+        charge = stats.rx_us * static_cast<double>(CURRENT_RX_MA)
+               + stats.cad_us * static_cast<double>(CURRENT_CAD_MA)
+               + stats.sleep_us * static_cast<double>(CURRENT_SLEEP_MA)
+               + stats.standby_us * static_cast<double>(CURRENT_STANDBY_MA)
+               + tx * CURRENT_TX_MA;
+    }
+    return static_cast<float>(charge / total);
 }
@@ -6,11 +6,67 @@
 #include "protocol.h"
 #include "event_manager.h"
 
+/**
+ * @brief Radio link counters maintained by the LoRa send and receive paths.
+ * @details Only updated from core 0 (main loop), read by the beacon and diagnostics.
+ */
+struct LinkStats {
+    uint32_t rx_packets;      /**< LoRa packets received */
+    uint32_t tx_packets;      /**< LoRa packets transmitted */
+    uint32_t rx_errors;       /**< Received packets rejected (size, address) */
+    int16_t last_rssi;        /**< RSSI of the last received packet in dBm */
+    float last_snr;           /**< SNR of the last received packet in dB */
+    uint32_t last_rx_time_ms; /**< Time of the last received packet in ms since boot */
+};
+
+extern LinkStats link_stats;
+
+/**
+ * @brief Receive strategy of the LoRa radio.
+ */
+enum class RadioRxMode : uint8_t {
+    CONTINUOUS = 0,  /**< Radio always listening (default) */
+    DUTY_CYCLED = 1  /**< Radio sleeps and wakes periodically to run CAD */
+};
+
+/**
+ * @brief Radio activity and power counters.
+ * @details Times are accumulated by the core 0 radio scheduler. The current samples
+ *          are the measured battery discharge current (INA3221) collected by the
+ *          telemetry cycle, bucketed by the receive mode active at the time.
+ */
+struct RadioPowerStats {
+    uint64_t rx_us;                   /**< Time spent listening */
+    uint64_t cad_us;                  /**< Time spent in channel activity detection */
+    uint64_t sleep_us;                /**< Time spent in radio sleep */
+    uint64_t standby_us;              /**< Time spent in standby (LBT backoff) */
+    uint64_t tx_us;                   /**< Time spent transmitting */
+    uint32_t cad_runs;                /**< CAD operations started */
+    uint32_t cad_detections;          /**< CAD operations that detected a preamble */
+    uint32_t cad_timeouts;            /**< CAD operations without a CAD done interrupt */
+    uint32_t lbt_busy;                /**< Listen-before-talk attempts that found the channel busy */
+    uint32_t lbt_forced;              /**< Transmissions sent after exhausting all LBT attempts */
+    float current_sum_ma[2];          /**< Sum of discharge current samples per RadioRxMode */
+    uint32_t current_samples[2];      /**< Number of discharge current samples per RadioRxMode */
+};
+
 bool initialize_radio();
 void lora_tx_done_callback();
+int radio_poll();
+bool listen_before_talk();
+void radio_on_tx_complete(uint64_t duration_us);
+void radio_set_rx_mode(RadioRxMode mode);
+void radio_request_rx_mode(RadioRxMode mode);
+RadioRxMode radio_get_rx_mode();
+bool radio_set_wake_period(uint32_t period_ms);
+uint32_t radio_get_wake_period();
+void radio_record_current_sample(float discharge_current_ma);
+RadioPowerStats radio_get_power_stats();
+float radio_estimate_current_ma(const RadioPowerStats& stats, bool continuous_rx);
 void on_receive(int packetSize);
 void handle_uart_input();
 void send_message(std::string outgoing);
+void send_packet(const uint8_t* payload, size_t length);
 void send_frame_uart(const Frame& frame);
 void send_frame_lora(const Frame& frame);
 
@@ -18,6 +74,7 @@ std::vector<Frame> execute_command(uint32_t commandKey, const std::string& param
 
 void frame_process(const std::string& data, Interface interface);
 std::string frame_encode(const Frame& frame);
+std::vector<Frame> frame_fragment(const Frame& frame, size_t max_encoded_length);
 Frame frame_decode(const std::string& data);
 Frame frame_build(OperationType operation, uint8_t group, uint8_t command,const std::string& value, const ValueUnit unitType  = ValueUnit::UNDEFINED);
 
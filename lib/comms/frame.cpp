@@ -1,4 +1,6 @@
 #include "communication.h"
+#include "log.h"
+#include <algorithm>
 
 using CommandHandler = std::function<std::vector<Frame>(const std::string&, OperationType)>;
 extern std::map<uint32_t, CommandHandler> command_handlers;
@@ -66,7 +68,7 @@ Frame frame_decode(const std::string& data) {
         std::stringstream ss(data);
         std::string token;
 
-        uart_print("Decoding frame: " + data, VerbosityLevel::WARNING);
+        log_record(LogSite::FRAME_DECODE, data.length());
 
         if (!std::getline(ss, token, DELIMITER) || token != FRAME_BEGIN) {
             throw std::runtime_error("DECODE_INVALID_HEADER");
@@ -122,6 +124,67 @@ Frame frame_decode(const std::string& data) {
     }
 }
 
+/**
+ * @brief Splits a frame into fragments that each encode to at most max_encoded_length characters.
+ * @param frame The frame to split.
+ * @param max_encoded_length Maximum length of one encoded fragment.
+ * @return The frame itself if it already fits, otherwise the list of fragments in order.
+ * @details Each fragment carries a slice of the value prefixed with "<index>/<total>:",
+ *          index counting from 1. All fragments but the last are SEQ frames; the last one
+ *          keeps the operation type and unit of the original frame, so the receiver knows
+ *          the payload is complete. Slices are made as large as the limit allows.
+ *          tools/frame_reassemble.py is the reference reassembler for the ground.
+ * @code
+ * KBST;1;SEQ;5;1;1/3:0001...;TSBK
+ * KBST;1;SEQ;5;1;2/3:...;TSBK
+ * KBST;1;VAL;5;1;3/3:...;TSBK
+ * @endcode
+ * @ingroup FrameHandling
+ */
+std::vector<Frame> frame_fragment(const Frame& frame, size_t max_encoded_length) {
+    std::vector<Frame> fragments;
+
+    if (frame_encode(frame).length() <= max_encoded_length) {
+        fragments.push_back(frame);
+        return fragments;
+    }
+
+    Frame empty_frame = frame;
+    empty_frame.value = "";
+    size_t overhead = frame_encode(empty_frame).length();
+    empty_frame.operationType = OperationType::SEQ;
+    overhead = std::max(overhead, frame_encode(empty_frame).length());
+
+    const std::string& payload = frame.value;
+    size_t total = 1;
+    size_t chunk_length = 0;
+    while (true) {
+        size_t header_length = 2 * std::to_string(total).length() + 2;
+        if (overhead + header_length >= max_encoded_length) {
+            fragments.push_back(frame);
+            return fragments;
+        }
+        chunk_length = max_encoded_length - overhead - header_length;
+        size_t needed = (payload.length() + chunk_length - 1) / chunk_length;
+        if (needed <= total) {
+            break;
+        }
+        total = needed;
+    }
+
+    for (size_t i = 0; i < total; i++) {
+        Frame fragment = frame;
+        fragment.value = std::to_string(i + 1) + "/" + std::to_string(total) + ":" +
+                         payload.substr(i * chunk_length, chunk_length);
+        if (i + 1 < total) {
+            fragment.operationType = OperationType::SEQ;
+        }
+        fragments.push_back(fragment);
+    }
+
+    return fragments;
+}
+
 /**
  * @brief Executes a command based on the command key and the parameter.
  * @param data The Frame data in string format.
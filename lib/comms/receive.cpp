@@ -1,4 +1,5 @@
 #include "communication.h"
+#include "log.h"
 
 #define MAX_PACKET_SIZE 255
 
@@ -22,8 +23,7 @@ bool extract_and_process_frames(const std::string& buffer, Interface interface)
         
         if (footer_pos > header_pos) {
             std::string frame_data = buffer.substr(header_pos, footer_pos + FRAME_END.length() - header_pos);
-            uart_print("Extracted frame (length=" + std::to_string(frame_data.length()) + 
-                        "): " + frame_data, VerbosityLevel::DEBUG);
+            log_record(LogSite::FRAME_EXTRACTED, frame_data.length());
             frame_process(frame_data, interface);
             found_frame = true;
         }
@@ -32,7 +32,7 @@ bool extract_and_process_frames(const std::string& buffer, Interface interface)
     }
     
     if (!found_frame) {
-        uart_print("No valid frame found in received data", VerbosityLevel::WARNING);
+        log_record(LogSite::FRAME_NOT_FOUND);
     }
     
     return found_frame;
@@ -47,7 +47,8 @@ bool extract_and_process_frames(const std::string& buffer, Interface interface)
  */
 bool process_lora_packet(const std::vector<uint8_t>& buffer, int bytes_read) {
     if (bytes_read < 2) { 
-        uart_print("Error: Packet too small to contain metadata!", VerbosityLevel::ERROR);
+        log_record(LogSite::LORA_PACKET_TOO_SMALL);
+        link_stats.rx_errors++;
         return false;
     }
     
@@ -55,12 +56,14 @@ bool process_lora_packet(const std::vector<uint8_t>& buffer, int bytes_read) {
     uint8_t received_local_address = buffer[1];
     
     if (received_destination != lora_address_local) {
-        uart_print("Error: Destination address mismatch!", VerbosityLevel::ERROR);
+        log_record(LogSite::LORA_DEST_MISMATCH, received_destination);
+        link_stats.rx_errors++;
         return false;
     }
     
     if (received_local_address != lora_address_remote) {
-        uart_print("Error: Local address mismatch!", VerbosityLevel::ERROR);
+        log_record(LogSite::LORA_SRC_MISMATCH, received_local_address);
+        link_stats.rx_errors++;
         return false;
     }
 
@@ -70,13 +73,15 @@ bool process_lora_packet(const std::vector<uint8_t>& buffer, int bytes_read) {
     
     if (received.empty()) return false;
     
-    std::stringstream hex_dump;
-    hex_dump << "Raw bytes: ";
-    for (int i = 0; i < bytes_read; i++) {
-        hex_dump << std::hex << std::setfill('0') << std::setw(2) 
-                << static_cast<int>(buffer[i]) << " ";
+    if (log_enabled(VerbosityLevel::DEBUG)) {
+        std::stringstream hex_dump;
+        hex_dump << "Raw bytes: ";
+        for (int i = 0; i < bytes_read; i++) {
+            hex_dump << std::hex << std::setfill('0') << std::setw(2) 
+                    << static_cast<int>(buffer[i]) << " ";
+        }
+        uart_print(hex_dump.str(), VerbosityLevel::DEBUG);
     }
-    uart_print(hex_dump.str(), VerbosityLevel::DEBUG);
     
     // Extract and process frames using the common function
     return extract_and_process_frames(received, Interface::LORA);
@@ -91,7 +96,11 @@ bool process_lora_packet(const std::vector<uint8_t>& buffer, int bytes_read) {
  */
 void on_receive(int packet_size) {
     if (packet_size == 0) return;
-    uart_print("Received LoRa packet of size " + std::to_string(packet_size), VerbosityLevel::DEBUG);
+    link_stats.rx_packets++;
+    link_stats.last_rssi = LoRa.packetRssi();
+    link_stats.last_snr = LoRa.packetSnr();
+    link_stats.last_rx_time_ms = to_ms_since_boot(get_absolute_time());
+    log_record(LogSite::LORA_PACKET_RECEIVED, packet_size, static_cast<uint32_t>(link_stats.last_rssi));
 
     std::vector<uint8_t> buffer;
     buffer.reserve(packet_size); 
@@ -100,15 +109,14 @@ void on_receive(int packet_size) {
     
     while (LoRa.available() && bytes_read < packet_size) {
         if (bytes_read >= MAX_PACKET_SIZE) {
-            uart_print("Error: Packet exceeds maximum allowed size!", VerbosityLevel::ERROR);
+            log_record(LogSite::LORA_PACKET_OVERSIZE);
+            link_stats.rx_errors++;
             return;
         }
         buffer.push_back(LoRa.read());
         bytes_read++;
     }
 
-    uart_print("Received " + std::to_string(bytes_read) + " bytes", VerbosityLevel::DEBUG);
-    
     process_lora_packet(buffer, bytes_read);
 }
 
@@ -126,7 +134,9 @@ void handle_uart_input() {
 
         if (c == '\r' || c == '\n') {
             if (!uart_buffer.empty()) {
-                uart_print("Received UART string: " + uart_buffer, VerbosityLevel::DEBUG);
+                if (log_enabled(VerbosityLevel::DEBUG)) {
+                    uart_print("Received UART string: " + uart_buffer, VerbosityLevel::DEBUG);
+                }
                 extract_and_process_frames(uart_buffer, Interface::UART);
                 uart_buffer.clear();
             }
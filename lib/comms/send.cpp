@@ -1,5 +1,16 @@
 #include "communication.h"
+#include "log.h"
 
+/**
+ * @brief Longest encoded frame that fits one LoRa packet.
+ * @details 255 byte FIFO limit minus the two address bytes and the terminating null.
+ */
+static constexpr size_t LORA_MAX_FRAME_LENGTH = 255 - 2 - 1;
+
+/**
+ * @brief Pause between two fragments of one frame, same as between response frames.
+ */
+static constexpr uint32_t LORA_FRAGMENT_GAP_MS = 25;
 
 /**
  * @file send.cpp
@@ -7,42 +18,71 @@
  */
 
 /**
- * @brief Sends a message using LoRa.
- * @param outgoing The message to send.
- * @details Converts the outgoing string to a C-style string, adds destination and local addresses,
- *          and sends the message using LoRa. Prints a log message to the UART.
+ * @brief Sends a raw payload using LoRa.
+ * @param payload Pointer to the payload bytes.
+ * @param length Number of payload bytes.
+ * @details Prepends destination and local addresses and transmits the packet synchronously
+ *          after listen_before_talk(). Used directly for binary packets (e.g. the beacon)
+ *          and by send_message() for text frames.
  */
-void send_message(std::string outgoing)
+void send_packet(const uint8_t* payload, size_t length)
 {
-    std::vector<char> send(outgoing.length() + 1);
-    strcpy(send.data(), outgoing.c_str());
+    if (!listen_before_talk()) {
+        log_record(LogSite::LORA_CHANNEL_BUSY);
+    }
 
-    uart_print("LoRa packet begin", VerbosityLevel::DEBUG);
+    uint64_t tx_start = time_us_64();
     LoRa.beginPacket();       // start packet
     LoRa.write(lora_address_remote);  // add destination address
     LoRa.write(lora_address_local); // add sender address
-    for(size_t i = 0; i < send.size(); i++) {
-        LoRa.write(static_cast<uint8_t>(send[i]));         // add payload byte by byte
-    }
+    LoRa.write(payload, length);      // add payload
     LoRa.endPacket(false);    // finish packet and send it, param - async
+    uint64_t tx_duration = time_us_64() - tx_start;
+    radio_on_tx_complete(tx_duration);
+
+    link_stats.tx_packets++;
+    log_record(LogSite::LORA_PACKET_SENT, length + 2, static_cast<uint32_t>(tx_duration));
+
+    LoRa.flush();
+}
 
-    uart_print("LoRa packet end", VerbosityLevel::DEBUG);
+/**
+ * @brief Sends a message using LoRa.
+ * @param outgoing The message to send.
+ * @details Sends the outgoing string including its terminating null character
+ *          and prints a log message to the UART.
+ */
+void send_message(std::string outgoing)
+{
+    send_packet(reinterpret_cast<const uint8_t*>(outgoing.c_str()), outgoing.length() + 1);
 
-    std::string message_to_log = "Sent message of size " + std::to_string(send.size());
+    if (!log_enabled(VerbosityLevel::DEBUG)) {
+        return;
+    }
+
+    std::string message_to_log = "Sent message of size " + std::to_string(outgoing.length() + 1);
     message_to_log += " to 0x" + std::to_string(lora_address_remote);
-    message_to_log += " containing: " + std::string(send.data());
+    message_to_log += " containing: " + outgoing;
 
     uart_print(message_to_log, VerbosityLevel::DEBUG);
-    
-    LoRa.flush();
 }
 
 
+/**
+ * @brief Sends a frame using LoRa.
+ * @param frame The frame to send.
+ * @details Frames longer than one packet are split by frame_fragment() and sent as
+ *          consecutive packets, so handlers can return a payload of any size.
+ */
 void send_frame_lora(const Frame& frame) {
-    uart_print("Sending frame via LoRa", VerbosityLevel::DEBUG);
-    std::string outgoing = frame_encode(frame);
-    send_message(outgoing);
-    uart_print("Frame sent via LoRa", VerbosityLevel::DEBUG);
+    std::vector<Frame> fragments = frame_fragment(frame, LORA_MAX_FRAME_LENGTH);
+    for (size_t i = 0; i < fragments.size(); i++) {
+        if (i > 0) {
+            sleep_ms(LORA_FRAGMENT_GAP_MS);
+        }
+        send_message(frame_encode(fragments[i]));
+    }
+    log_record(LogSite::LORA_FRAME_SENT, frame.group, frame.command, fragments.size());
 }
 
 // If level is 0 - SILENT it means no diagnostic output but frame communications should still work
@@ -0,0 +1,135 @@
+/**
+ * @file event_codes.h
+ * @brief Event groups and codes.
+ * @details Kept free of SDK dependencies so host tools can use them.
+ * @ingroup EventManagement
+ */
+
+#ifndef EVENT_CODES_H
+#define EVENT_CODES_H
+
+#include <cstdint>
+
+/**
+ * @brief Enumeration of event groups.
+ * @details Defines the different categories of events that can be logged.
+ * @ingroup EventManagement
+ */
+enum class EventGroup : uint8_t {
+    /** @brief System-level events. */
+    SYSTEM = 0x00,
+    /** @brief Power management events. */
+    POWER = 0x01,
+    /** @brief Communications events. */
+    COMMS = 0x02,
+    /** @brief GPS events. */
+    GPS = 0x03,
+    /** @brief Clock events. */
+    CLOCK = 0x04
+};
+
+
+/**
+ * @brief Enumeration of system events.
+ * @details Defines specific system-level events.
+ * @ingroup EventManagement
+ */
+enum class SystemEvent : uint8_t {
+    /** @brief System boot event. */
+    BOOT = 0x01,
+    /** @brief System shutdown event. */
+    SHUTDOWN = 0x02,
+    /** @brief Watchdog reset event. */
+    WATCHDOG_RESET = 0x03,
+    /** @brief Core 1 start event. */
+    CORE1_START = 0x04,
+    /** @brief Core 1 stop event. */
+    CORE1_STOP = 0x05
+};
+
+/**
+ * @brief Enumeration of power events.
+ * @details Defines specific power management events.
+ * @ingroup EventManagement
+ */
+enum class PowerEvent : uint8_t {
+    /** @brief Low battery event. */
+    BATTERY_LOW = 0x01,
+    /** @brief Overcharge event. */
+    BATTERY_FULL = 0x02,
+    /** @brief Power falling event. */
+    POWER_FALLING = 0x03,
+    /** @brief Power normal event. */
+    BATTERY_NORMAL = 0x04,
+    /** @brief Solar charging active event. */
+    SOLAR_ACTIVE = 0x05,
+    /** @brief Solar charging inactive event. */
+    SOLAR_INACTIVE = 0x06,
+    /** @brief USB connected event. */
+    USB_CONNECTED = 0x07,
+    /** @brief USB disconnected event. */
+    USB_DISCONNECTED = 0x08,
+    /** @brief Current balance negative */
+    DISCHARGING = 0x09,
+    /** @brief Current balance positive */
+    CHARGING = 0x0A,
+};
+
+
+/**
+ * @brief Enumeration of communications events.
+ * @details Defines specific communications events.
+ * @ingroup EventManagement
+ */
+enum class CommsEvent : uint8_t {
+    /** @brief Radio initialization event. */
+    RADIO_INIT = 0x01,
+    /** @brief Radio error event. */
+    RADIO_ERROR = 0x02,
+    /** @brief Message received event. */
+    MSG_RECEIVED = 0x03,
+    /** @brief Message sent event. */
+    MSG_SENT = 0x04,
+    /** @brief UART error event. */
+    UART_ERROR = 0x06
+};
+
+/**
+ * @brief Enumeration of GPS events.
+ * @details Defines specific GPS events.
+ * @ingroup EventManagement
+ */
+enum class GPSEvent : uint8_t {
+    /** @brief GPS lock event. */
+    LOCK = 0x01,
+    /** @brief GPS lost event. */
+    LOST = 0x02,
+    /** @brief GPS error event. */
+    ERROR = 0x03,
+    /** @brief GPS power on event. */
+    POWER_ON = 0x04,
+    /** @brief GPS power off event. */
+    POWER_OFF = 0x05,
+    /** @brief GPS data ready event. */
+    DATA_READY = 0x06,
+    /** @brief GPS pass-through start event. */
+    PASS_THROUGH_START = 0x07,
+    /** @brief GPS pass-through end event. */
+    PASS_THROUGH_END = 0x08
+};
+
+/**
+ * @brief Enumeration of clock events.
+ * @details Defines specific clock-related events.
+ * @ingroup EventManagement
+ */
+enum class ClockEvent : uint8_t {
+    /** @brief Clock changed event. */
+    CHANGED = 0x01,
+    /** @brief GPS sync event. */
+    GPS_SYNC = 0x02,
+    /** @brief GPS sync data not ready event. */
+    GPS_SYNC_DATA_NOT_READY = 0x03
+};
+
+#endif // EVENT_CODES_H
@@ -19,12 +19,143 @@
 #include "pico/multicore.h"
 #include "communication.h"
 #include "utils.h"
-#include "DS3231.h"
+#include "log.h"
+#include "time_service.h"
+#include "event_reactions.h"
+#include <algorithm>
+#include <cstring>
+
+
+/**
+ * @brief Number of records read from the event log file at once.
+ */
+static constexpr size_t EVENT_LOG_READ_CHUNK = 64;
+
+
+/**
+ * @brief Reads the header of an event log file.
+ * @param[in] file Open event log file.
+ * @param[out] header Header read from the file.
+ * @return True if the file has a valid header.
+ * @ingroup EventManagement
+ */
+static bool read_log_header(FILE* file, EventLogFileHeader& header) {
+    if (fseek(file, 0, SEEK_SET) != 0 || fread(&header, sizeof(header), 1, file) != 1) {
+        return false;
+    }
+    return header.magic == EVENT_LOG_MAGIC && header.record_size == sizeof(EventLog);
+}
+
+
+/**
+ * @brief Gets the number of records in an event log file.
+ * @param[in] file Open event log file.
+ * @return Number of complete records after the header.
+ * @ingroup EventManagement
+ */
+static uint32_t read_log_record_count(FILE* file) {
+    if (fseek(file, 0, SEEK_END) != 0) {
+        return 0;
+    }
+    long size = ftell(file);
+    if (size <= static_cast<long>(sizeof(EventLogFileHeader))) {
+        return 0;
+    }
+    return (size - sizeof(EventLogFileHeader)) / sizeof(EventLog);
+}
+
+
+/**
+ * @brief Reads one record of an event log file.
+ * @param[in] file Open event log file.
+ * @param[in] index Record index.
+ * @param[out] record Record read from the file.
+ * @return True if the record was read.
+ * @ingroup EventManagement
+ */
+static bool read_log_record(FILE* file, uint32_t index, EventLog& record) {
+    long offset = sizeof(EventLogFileHeader) + static_cast<long>(index) * sizeof(EventLog);
+    return fseek(file, offset, SEEK_SET) == 0 && fread(&record, sizeof(record), 1, file) == 1;
+}
+
+
+/**
+ * @brief Finds the first record whose key is not less than a value.
+ * @param[in] file Open event log file.
+ * @param[in] count Number of records in the file.
+ * @param[in] value Value to search for.
+ * @param[in] key Key of a record, non-decreasing over the file.
+ * @return Index of the record, or count if there is none.
+ * @ingroup EventManagement
+ */
+template<typename Key>
+static uint32_t find_log_lower_bound(FILE* file, uint32_t count, uint32_t value, Key key) {
+    uint32_t low = 0;
+    uint32_t high = count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        EventLog record;
+        if (!read_log_record(file, mid, record)) {
+            return count;
+        }
+        if (key(record) < value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+
+/**
+ * @brief Collects records from an index forward until a stop condition.
+ * @param[in] file Open event log file.
+ * @param[in] index First record to read.
+ * @param[in] count Number of records in the file.
+ * @param[in] group Group to collect, or -1 for all groups.
+ * @param[in] max_results Maximum number of records to collect.
+ * @param[in] stop Returns true for the first record past the range.
+ * @return Collected records.
+ * @ingroup EventManagement
+ */
+template<typename Stop>
+static std::vector<EventLog> scan_log_forward(FILE* file, uint32_t index, uint32_t count, int group,
+                                              size_t max_results, Stop stop) {
+    std::vector<EventLog> results;
+    EventLog chunk[EVENT_LOG_READ_CHUNK];
+
+    long offset = sizeof(EventLogFileHeader) + static_cast<long>(index) * sizeof(EventLog);
+    if (index >= count || fseek(file, offset, SEEK_SET) != 0) {
+        return results;
+    }
+
+    while (index < count && results.size() < max_results) {
+        size_t wanted = std::min<size_t>(EVENT_LOG_READ_CHUNK, count - index);
+        size_t read = fread(chunk, sizeof(EventLog), wanted, file);
+        if (read == 0) {
+            break;
+        }
+        for (size_t i = 0; i < read && results.size() < max_results; i++) {
+            if (stop(chunk[i])) {
+                return results;
+            }
+            if (group < 0 || chunk[i].group == group) {
+                results.push_back(chunk[i]);
+            }
+        }
+        index += read;
+    }
+    return results;
+}
 
 
 /**
  * @brief Initializes the event manager.
  * @return True if initialization was successful, false otherwise.
+ * @details Opens the binary event log and continues event IDs after its last
+ *          record, so IDs in the file stay increasing across reboots. A missing
+ *          file is created with a header.
  * @ingroup EventManagement
  */
 bool EventManager::init() {
@@ -33,66 +164,148 @@ bool EventManager::init() {
         return false;
     }
 
-    FILE* file = fopen(EVENT_LOG_FILE, "w");
-    if (!file) {
-        file = fopen(EVENT_LOG_FILE, "w");
-        if (file) {
-            fclose(file);
-            uart_print("Created new event log", VerbosityLevel::INFO);
+    mutex_enter_blocking(&fileMutex);
+    load_stats();
+
+    FILE* file = fopen(EVENT_LOG_FILE, "rb");
+    if (file) {
+        EventLogFileHeader header;
+        EventLog last;
+        uint32_t count = 0;
+        bool valid = read_log_header(file, header);
+        if (valid) {
+            count = read_log_record_count(file);
         }
-        else {
-            uart_print("Failed to create event log", VerbosityLevel::ERROR);
-            return false;
+        if (valid && count > 0 && read_log_record(file, count - 1, last)) {
+            mutex_enter_blocking(&eventMutex);
+            nextEventId = last.id + 1;
+            mutex_exit(&eventMutex);
         }
-    }
-    else {
         fclose(file);
+
+        if (valid) {
+            mutex_exit(&fileMutex);
+            uart_print("Event manager initialized, " + std::to_string(count) + " events in log", VerbosityLevel::INFO);
+            return true;
+        }
     }
 
-    uart_print("Event manager initialized", VerbosityLevel::INFO);
+    file = open_for_append(nextEventId);
+    mutex_exit(&fileMutex);
+
+    if (!file) {
+        uart_print("Failed to create event log", VerbosityLevel::ERROR);
+        return false;
+    }
+    fclose(file);
+    uart_print("Created new event log", VerbosityLevel::INFO);
     return true;
 }
 
 
 /**
- * @brief Logs an event to the event buffer.
+ * @brief Queues an event for the consumer.
  * @param[in] group Event group.
  * @param[in] event Event code.
+ * @details Appends to the queue of the calling core. If the queue is full the
+ *          event is dropped and counted.
  * @ingroup EventManagement
  */
 void EventManager::log_event(uint8_t group, uint8_t event) {
-    mutex_enter_blocking(&eventMutex);
+    EventQueue& queue = queues[get_core_num()];
+    uint32_t head = queue.head.load(std::memory_order_relaxed);
+    uint32_t tail = queue.tail.load(std::memory_order_acquire);
+
+    if (head - tail >= EVENT_QUEUE_SIZE) {
+        queue.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    PendingEvent& pending = queue.entries[head % EVENT_QUEUE_SIZE];
+    pending.uptime_ms = to_ms_since_boot(get_absolute_time());
+    pending.group = group;
+    pending.event = event;
 
-    uint32_t timestamp = DS3231::get_instance().get_local_time();
-    uint16_t id = nextEventId++;
+    queue.head.store(head + 1, std::memory_order_release);
+}
 
-    EventLog& log = events[writeIndex];
-    log.id = id;
-    log.timestamp = timestamp;
-    log.group = group;
-    log.event = event;
 
-    writeIndex = (writeIndex + 1) % EVENT_BUFFER_SIZE;
-    if (eventCount < EVENT_BUFFER_SIZE) {
-        eventCount++;
+/**
+ * @brief Moves queued events of both cores into the event buffer.
+ * @details Each event is timestamped with the current local time minus its age
+ *          in the queue, then dispatched to subscriptions and reaction rules. POWER events and every
+ *          EVENT_FLUSH_THRESHOLD events trigger a save to storage.
+ * @ingroup EventManagement
+ */
+void EventManager::process() {
+    if (get_pending_count() == 0) {
+        return;
     }
 
-    eventsSinceFlush++;
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    uint64_t now_local_ms = TimeService::get_instance().get_local_ms();
+    bool flush_required = false;
 
-    mutex_exit(&eventMutex);
+    for (uint core = 0; core < 2; core++) {
+        EventQueue& queue = queues[core];
+        uint32_t head = queue.head.load(std::memory_order_acquire);
+        uint32_t tail = queue.tail.load(std::memory_order_relaxed);
 
-    std::string event_string = "Event: " + std::to_string(id) +
-        " Group: " + std::to_string(group) +
-        " Event: " + std::to_string(event);
-    uart_print(event_string, VerbosityLevel::WARNING);
+        while (tail != head) {
+            PendingEvent pending = queue.entries[tail % EVENT_QUEUE_SIZE];
+            tail++;
+            queue.tail.store(tail, std::memory_order_release);
 
-    if (eventsSinceFlush >= EVENT_FLUSH_THRESHOLD || group == static_cast<uint8_t>(EventGroup::POWER)) {
+            mutex_enter_blocking(&eventMutex);
+
+            uint16_t id = nextEventId++;
+            EventLog& log = events[writeIndex];
+            log.id = id;
+            log.timestamp = (now_local_ms - (now_ms - pending.uptime_ms)) / 1000;
+            log.group = pending.group;
+            log.event = pending.event;
+
+            writeIndex = (writeIndex + 1) % EVENT_BUFFER_SIZE;
+            if (eventCount < EVENT_BUFFER_SIZE) {
+                eventCount++;
+            }
+
+            eventsSinceFlush++;
+            update_stats(pending.group, pending.event, log.timestamp);
+
+            mutex_exit(&eventMutex);
+
+            log_record(LogSite::EVENT_LOGGED, id, pending.group, pending.event);
+            dispatch_event(pending.group, pending.event);
+
+            if (eventsSinceFlush >= EVENT_FLUSH_THRESHOLD || pending.group == static_cast<uint8_t>(EventGroup::POWER)) {
+                flush_required = true;
+            }
+        }
+    }
+
+    if (flush_required) {
         save_to_storage();
+        save_stats();
         eventsSinceFlush = 0;
     }
 }
 
 
+/**
+ * @brief Gets the number of events waiting in the queues.
+ * @return Queued events of both cores.
+ * @ingroup EventManagement
+ */
+uint32_t EventManager::get_pending_count() const {
+    uint32_t pending = 0;
+    for (const EventQueue& queue : queues) {
+        pending += queue.head.load(std::memory_order_acquire) - queue.tail.load(std::memory_order_relaxed);
+    }
+    return pending;
+}
+
+
 /**
  * @brief Gets an event from the event buffer.
  * @param[in] index Index of the event to retrieve.
@@ -123,6 +336,8 @@ const EventLog& EventManager::get_event(size_t index) const {
 /**
  * @brief Saves the event buffer to persistent storage.
  * @return True if the save was successful, false otherwise.
+ * @details Appends the events since the last flush to the event log file as
+ *          packed EventLog records.
  * @ingroup EventManagement
  */
 bool EventManager::save_to_storage() {
@@ -133,26 +348,331 @@ bool EventManager::save_to_storage() {
         }
     }
 
-    FILE* file = fopen(EVENT_LOG_FILE, "a");
-    if (file) {
-        size_t startIdx = (writeIndex >= eventsSinceFlush) ?
-            writeIndex - eventsSinceFlush :
-            EVENT_BUFFER_SIZE - (eventsSinceFlush - writeIndex);
+    if (eventsSinceFlush == 0) {
+        return true;
+    }
+
+    size_t startIdx = (writeIndex >= eventsSinceFlush) ?
+        writeIndex - eventsSinceFlush :
+        EVENT_BUFFER_SIZE - (eventsSinceFlush - writeIndex);
 
+    mutex_enter_blocking(&fileMutex);
+    FILE* file = open_for_append(events[startIdx].id);
+    if (file) {
         for (size_t i = 0; i < eventsSinceFlush; i++) {
             size_t idx = (startIdx + i) % EVENT_BUFFER_SIZE;
-            fprintf(file, "%u;%lu;%u;%u\n",
-                events[idx].id,
-                events[idx].timestamp,
-                events[idx].group,
-                events[idx].event
-            );
+            fwrite(&events[idx], sizeof(EventLog), 1, file);
         }
         fclose(file);
+        mutex_exit(&fileMutex);
         uart_print("Events saved to storage", VerbosityLevel::INFO);
         return true;
     }
+    mutex_exit(&fileMutex);
     return false;
 }
 
+
+/**
+ * @brief Opens the event log file for appending, rotating or creating it if needed.
+ * @param[in] first_id ID of the first record that will be appended.
+ * @return Open file, or nullptr on failure.
+ * @details The file is rotated to EVENT_LOG_BACKUP_FILE when first_id is
+ *          EVENT_LOG_MAX_RECORDS or more past the first ID of the file. A new
+ *          file starts with a header holding first_id. Caller holds fileMutex.
+ * @ingroup EventManagement
+ */
+FILE* EventManager::open_for_append(uint16_t first_id) {
+    FILE* file = fopen(EVENT_LOG_FILE, "rb");
+    if (file) {
+        EventLogFileHeader header;
+        bool valid = read_log_header(file, header);
+        fclose(file);
+
+        if (valid && static_cast<uint16_t>(first_id - header.first_id) < EVENT_LOG_MAX_RECORDS) {
+            return fopen(EVENT_LOG_FILE, "ab");
+        }
+        if (valid) {
+            remove(EVENT_LOG_BACKUP_FILE);
+            rename(EVENT_LOG_FILE, EVENT_LOG_BACKUP_FILE);
+        }
+    }
+
+    file = fopen(EVENT_LOG_FILE, "wb");
+    if (!file) {
+        return nullptr;
+    }
+
+    EventLogFileHeader header = {EVENT_LOG_MAGIC, EVENT_LOG_VERSION, sizeof(EventLog), first_id};
+    if (fwrite(&header, sizeof(header), 1, file) != 1) {
+        fclose(file);
+        return nullptr;
+    }
+    return file;
+}
+
+
+/**
+ * @brief Reads events in an ID range from the event log file.
+ * @param[in] from_id First ID.
+ * @param[in] to_id Last ID, may have wrapped past 65535.
+ * @param[in] group Group to return, or -1 for all groups.
+ * @param[in] max_results Maximum number of events to return.
+ * @return Matching events, oldest first.
+ * @details IDs are compared as offsets from the first ID of the file, which
+ *          increase through the file. Without gaps the record of from_id is at
+ *          that offset; otherwise it is found by binary search.
+ * @ingroup EventManagement
+ */
+std::vector<EventLog> EventManager::query_by_id(uint16_t from_id, uint16_t to_id, int group, size_t max_results) {
+    std::vector<EventLog> results;
+
+    mutex_enter_blocking(&fileMutex);
+    FILE* file = fopen(EVENT_LOG_FILE, "rb");
+    EventLogFileHeader header;
+    if (!file || !read_log_header(file, header)) {
+        if (file) fclose(file);
+        mutex_exit(&fileMutex);
+        return results;
+    }
+
+    uint16_t first_id = header.first_id;
+    auto id_offset = [first_id](const EventLog& record) -> uint32_t {
+        return static_cast<uint16_t>(record.id - first_id);
+    };
+    uint32_t from_offset = static_cast<uint16_t>(from_id - first_id);
+    uint32_t to_offset = static_cast<uint16_t>(to_id - first_id);
+    uint32_t count = read_log_record_count(file);
+
+    if (from_offset <= to_offset) {
+        EventLog first;
+        uint32_t start = from_offset;
+        if (start >= count || !read_log_record(file, start, first) || first.id != from_id) {
+            start = find_log_lower_bound(file, count, from_offset, id_offset);
+        }
+        results = scan_log_forward(file, start, count, group, max_results,
+            [&](const EventLog& record) { return id_offset(record) > to_offset; });
+    }
+
+    fclose(file);
+    mutex_exit(&fileMutex);
+    return results;
+}
+
+
+/**
+ * @brief Reads events in a time range from the event log file.
+ * @param[in] from_time First timestamp.
+ * @param[in] to_time Last timestamp.
+ * @param[in] group Group to return, or -1 for all groups.
+ * @param[in] max_results Maximum number of events to return.
+ * @return Matching events, oldest first.
+ * @details Binary search on the timestamp, which assumes timestamps do not go
+ *          backwards in the file. After the clock was set back, events logged
+ *          before the step may be missed.
+ * @ingroup EventManagement
+ */
+std::vector<EventLog> EventManager::query_by_time(uint32_t from_time, uint32_t to_time, int group, size_t max_results) {
+    std::vector<EventLog> results;
+
+    mutex_enter_blocking(&fileMutex);
+    FILE* file = fopen(EVENT_LOG_FILE, "rb");
+    EventLogFileHeader header;
+    if (!file || !read_log_header(file, header)) {
+        if (file) fclose(file);
+        mutex_exit(&fileMutex);
+        return results;
+    }
+
+    if (from_time <= to_time) {
+        uint32_t count = read_log_record_count(file);
+        uint32_t start = find_log_lower_bound(file, count, from_time,
+            [](const EventLog& record) -> uint32_t { return record.timestamp; });
+        results = scan_log_forward(file, start, count, group, max_results,
+            [to_time](const EventLog& record) { return record.timestamp > to_time; });
+    }
+
+    fclose(file);
+    mutex_exit(&fileMutex);
+    return results;
+}
+
+
+/**
+ * @brief Reads the newest events of one group from the event log file.
+ * @param[in] group Event group.
+ * @param[in] max_results Maximum number of events to return.
+ * @return Matching events, newest first.
+ * @details Reads the file backwards in chunks of EVENT_LOG_READ_CHUNK records.
+ * @ingroup EventManagement
+ */
+std::vector<EventLog> EventManager::query_by_group(uint8_t group, size_t max_results) {
+    std::vector<EventLog> results;
+
+    mutex_enter_blocking(&fileMutex);
+    FILE* file = fopen(EVENT_LOG_FILE, "rb");
+    EventLogFileHeader header;
+    if (!file || !read_log_header(file, header)) {
+        if (file) fclose(file);
+        mutex_exit(&fileMutex);
+        return results;
+    }
+
+    EventLog chunk[EVENT_LOG_READ_CHUNK];
+    uint32_t index = read_log_record_count(file);
+    while (index > 0 && results.size() < max_results) {
+        uint32_t read = std::min<uint32_t>(EVENT_LOG_READ_CHUNK, index);
+        index -= read;
+        long offset = sizeof(EventLogFileHeader) + static_cast<long>(index) * sizeof(EventLog);
+        if (fseek(file, offset, SEEK_SET) != 0 || fread(chunk, sizeof(EventLog), read, file) != read) {
+            break;
+        }
+        for (uint32_t i = read; i > 0 && results.size() < max_results; i--) {
+            if (chunk[i - 1].group == group) {
+                results.push_back(chunk[i - 1]);
+            }
+        }
+    }
+
+    fclose(file);
+    mutex_exit(&fileMutex);
+    return results;
+}
+
+
+/**
+ * @brief Gets the statistics of one (group, event) pair.
+ * @param[in] group Event group.
+ * @param[in] event Event code.
+ * @param[out] out Copy of the statistics.
+ * @return False if the pair is outside the statistics matrix.
+ * @ingroup EventManagement
+ */
+bool EventManager::get_event_stats(uint8_t group, uint8_t event, EventStats& out) {
+    if (group >= EVENT_STATS_GROUPS || event >= EVENT_STATS_CODES) {
+        return false;
+    }
+    mutex_enter_blocking(&eventMutex);
+    out = stats[group][event];
+    mutex_exit(&eventMutex);
+    return true;
+}
+
+
+/**
+ * @brief Clears all event statistics and the persisted copy.
+ * @ingroup EventManagement
+ */
+void EventManager::reset_event_stats() {
+    mutex_enter_blocking(&eventMutex);
+    for (auto& group_stats : stats) {
+        for (EventStats& entry : group_stats) {
+            entry = EventStats{};
+        }
+    }
+    mutex_exit(&eventMutex);
+
+    if (SystemStateManager::get_instance().is_sd_card_mounted()) {
+        mutex_enter_blocking(&fileMutex);
+        remove(EVENT_STATS_FILE);
+        mutex_exit(&fileMutex);
+    }
+}
+
+
+/**
+ * @brief Counts an event in the statistics matrix.
+ * @param[in] group Event group.
+ * @param[in] event Event code.
+ * @param[in] timestamp Event timestamp.
+ * @details Constant time. Pairs outside the matrix are not counted. Caller holds
+ *          eventMutex.
+ * @ingroup EventManagement
+ */
+void EventManager::update_stats(uint8_t group, uint8_t event, uint32_t timestamp) {
+    if (group >= EVENT_STATS_GROUPS || event >= EVENT_STATS_CODES) {
+        return;
+    }
+
+    EventStats& entry = stats[group][event];
+    if (entry.count == 0) {
+        entry.first_seen = timestamp;
+    }
+
+    if (entry.count == 0 || entry.last_seen / 60 != timestamp / 60) {
+        entry.minute_count = 0;
+    }
+    if (entry.minute_count < UINT16_MAX) {
+        entry.minute_count++;
+    }
+    if (entry.minute_count > entry.peak_per_minute) {
+        entry.peak_per_minute = entry.minute_count;
+    }
+
+    entry.count++;
+    entry.last_seen = timestamp;
+}
+
+
+/**
+ * @brief Writes the statistics matrix to EVENT_STATS_FILE.
+ * @return True if the file was written.
+ * @details The file is the magic, the group and code dimensions and the matrix
+ *          of EventStats as in RAM.
+ * @ingroup EventManagement
+ */
+bool EventManager::save_stats() {
+    if (!SystemStateManager::get_instance().is_sd_card_mounted()) {
+        return false;
+    }
+
+    static EventStats snapshot[EVENT_STATS_GROUPS][EVENT_STATS_CODES];
+    mutex_enter_blocking(&eventMutex);
+    memcpy(snapshot, stats, sizeof(stats));
+    mutex_exit(&eventMutex);
+
+    mutex_enter_blocking(&fileMutex);
+    FILE* file = fopen(EVENT_STATS_FILE, "wb");
+    bool written = false;
+    if (file) {
+        uint32_t magic = EVENT_STATS_MAGIC;
+        uint8_t dimensions[2] = {EVENT_STATS_GROUPS, EVENT_STATS_CODES};
+        written = fwrite(&magic, sizeof(magic), 1, file) == 1 &&
+                  fwrite(dimensions, sizeof(dimensions), 1, file) == 1 &&
+                  fwrite(snapshot, sizeof(snapshot), 1, file) == 1;
+        fclose(file);
+    }
+    mutex_exit(&fileMutex);
+    return written;
+}
+
+
+/**
+ * @brief Restores the statistics matrix from EVENT_STATS_FILE.
+ * @details A file with other dimensions is ignored. Caller holds fileMutex.
+ * @ingroup EventManagement
+ */
+void EventManager::load_stats() {
+    FILE* file = fopen(EVENT_STATS_FILE, "rb");
+    if (!file) {
+        return;
+    }
+
+    static EventStats loaded[EVENT_STATS_GROUPS][EVENT_STATS_CODES];
+    uint32_t magic = 0;
+    uint8_t dimensions[2] = {0, 0};
+    bool valid = fread(&magic, sizeof(magic), 1, file) == 1 &&
+                 fread(dimensions, sizeof(dimensions), 1, file) == 1 &&
+                 magic == EVENT_STATS_MAGIC &&
+                 dimensions[0] == EVENT_STATS_GROUPS && dimensions[1] == EVENT_STATS_CODES &&
+                 fread(loaded, sizeof(loaded), 1, file) == 1;
+    fclose(file);
+
+    if (valid) {
+        mutex_enter_blocking(&eventMutex);
+        memcpy(stats, loaded, sizeof(stats));
+        mutex_exit(&eventMutex);
+    }
+}
+
 /** @} */
\ No newline at end of file
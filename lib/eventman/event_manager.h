@@ -21,10 +21,14 @@
 #include "PowerManager.h"
 #include <cstdint>
 #include <string>
+#include <vector>
+#include <cstdio>
+#include <atomic>
 #include "pico/mutex.h"
 #include "storage.h"
 #include "utils.h"
 #include "system_state_manager.h"
+#include "event_codes.h"
 
 /**
  * @brief Size of the event buffer.
@@ -37,132 +41,61 @@
 #define EVENT_FLUSH_THRESHOLD 10
 
 /**
- * @brief Path to the event log file.
+ * @brief Path to the binary event log file.
  */
-#define EVENT_LOG_FILE "/event_log.csv"
+#define EVENT_LOG_FILE "/event_log.bin"
 
+/**
+ * @brief Path the event log is renamed to when it is full.
+ */
+#define EVENT_LOG_BACKUP_FILE "/event_log.1.bin"
 
 /**
- * @brief Enumeration of event groups.
- * @details Defines the different categories of events that can be logged.
- * @ingroup EventManagement
+ * @brief Event log file magic, "KEVT" in file byte order.
  */
-enum class EventGroup : uint8_t {
-    /** @brief System-level events. */
-    SYSTEM = 0x00,
-    /** @brief Power management events. */
-    POWER = 0x01,
-    /** @brief Communications events. */
-    COMMS = 0x02,
-    /** @brief GPS events. */
-    GPS = 0x03,
-    /** @brief Clock events. */
-    CLOCK = 0x04
-};
+#define EVENT_LOG_MAGIC 0x5456454B
 
+/**
+ * @brief Event log file format version.
+ */
+#define EVENT_LOG_VERSION 1
 
 /**
- * @brief Enumeration of system events.
- * @details Defines specific system-level events.
- * @ingroup EventManagement
+ * @brief Largest ID distance between the first and the last record of one event log file.
+ * @details Kept below 65536 so that the ID offset from the first record is unique and
+ *          increasing within a file.
  */
-enum class SystemEvent : uint8_t {
-    /** @brief System boot event. */
-    BOOT = 0x01,
-    /** @brief System shutdown event. */
-    SHUTDOWN = 0x02,
-    /** @brief Watchdog reset event. */
-    WATCHDOG_RESET = 0x03,
-    /** @brief Core 1 start event. */
-    CORE1_START = 0x04,
-    /** @brief Core 1 stop event. */
-    CORE1_STOP = 0x05
-};
+#define EVENT_LOG_MAX_RECORDS 60000
 
 /**
- * @brief Enumeration of power events.
- * @details Defines specific power management events.
- * @ingroup EventManagement
+ * @brief Maximum number of events returned by one storage query.
  */
-enum class PowerEvent : uint8_t {
-    /** @brief Low battery event. */
-    BATTERY_LOW = 0x01,
-    /** @brief Overcharge event. */
-    BATTERY_FULL = 0x02,
-    /** @brief Power falling event. */
-    POWER_FALLING = 0x03,
-    /** @brief Power normal event. */
-    BATTERY_NORMAL = 0x04,
-    /** @brief Solar charging active event. */
-    SOLAR_ACTIVE = 0x05,
-    /** @brief Solar charging inactive event. */
-    SOLAR_INACTIVE = 0x06,
-    /** @brief USB connected event. */
-    USB_CONNECTED = 0x07,
-    /** @brief USB disconnected event. */
-    USB_DISCONNECTED = 0x08,
-    /** @brief Current balance negative */
-    DISCHARGING = 0x09,
-    /** @brief Current balance positive */
-    CHARGING = 0x0A,
-};
+#define EVENT_QUERY_MAX_RESULTS 50
 
+/**
+ * @brief Path to the persisted event statistics.
+ */
+#define EVENT_STATS_FILE "/event_stats.bin"
 
 /**
- * @brief Enumeration of communications events.
- * @details Defines specific communications events.
- * @ingroup EventManagement
+ * @brief Event statistics file magic, "KEST" in file byte order.
  */
-enum class CommsEvent : uint8_t {
-    /** @brief Radio initialization event. */
-    RADIO_INIT = 0x01,
-    /** @brief Radio error event. */
-    RADIO_ERROR = 0x02,
-    /** @brief Message received event. */
-    MSG_RECEIVED = 0x03,
-    /** @brief Message sent event. */
-    MSG_SENT = 0x04,
-    /** @brief UART error event. */
-    UART_ERROR = 0x06
-};
+#define EVENT_STATS_MAGIC 0x5453454B
 
 /**
- * @brief Enumeration of GPS events.
- * @details Defines specific GPS events.
- * @ingroup EventManagement
+ * @brief Number of event groups with statistics.
  */
-enum class GPSEvent : uint8_t {
-    /** @brief GPS lock event. */
-    LOCK = 0x01,
-    /** @brief GPS lost event. */
-    LOST = 0x02,
-    /** @brief GPS error event. */
-    ERROR = 0x03,
-    /** @brief GPS power on event. */
-    POWER_ON = 0x04,
-    /** @brief GPS power off event. */
-    POWER_OFF = 0x05,
-    /** @brief GPS data ready event. */
-    DATA_READY = 0x06,
-    /** @brief GPS pass-through start event. */
-    PASS_THROUGH_START = 0x07,
-    /** @brief GPS pass-through end event. */
-    PASS_THROUGH_END = 0x08
-};
+#define EVENT_STATS_GROUPS 5
 
 /**
- * @brief Enumeration of clock events.
- * @details Defines specific clock-related events.
- * @ingroup EventManagement
+ * @brief Number of event codes per group with statistics.
  */
-enum class ClockEvent : uint8_t {
-    /** @brief Clock changed event. */
-    CHANGED = 0x01,
-    /** @brief GPS sync event. */
-    GPS_SYNC = 0x02,
-    /** @brief GPS sync data not ready event. */
-    GPS_SYNC_DATA_NOT_READY = 0x03
-};
+#define EVENT_STATS_CODES 16
+
+/**
+ * @brief Number of emitted events each core can queue before events are dropped.
+ */
+#define EVENT_QUEUE_SIZE 32
 
 
 /**
@@ -181,7 +114,69 @@ class EventLog {
         /** @brief Event code. */
         uint8_t event;
     } __attribute__((packed));
-    
+
+
+/**
+ * @brief Counters of one (group, event) pair.
+ * @details Rates are counted per wall-clock minute of the event timestamps.
+ * @ingroup EventManagement
+ */
+struct EventStats {
+    /** @brief Events since the statistics were reset. */
+    uint32_t count;
+    /** @brief Timestamp of the first event. */
+    uint32_t first_seen;
+    /** @brief Timestamp of the last event. */
+    uint32_t last_seen;
+    /** @brief Events in the minute of last_seen. */
+    uint16_t minute_count;
+    /** @brief Highest number of events in one minute. */
+    uint16_t peak_per_minute;
+};
+
+
+/**
+ * @brief Header at the start of the binary event log file.
+ * @details Followed by EventLog records exactly as stored in RAM. Record i is at
+ *          offset sizeof(EventLogFileHeader) + i * sizeof(EventLog).
+ * @ingroup EventManagement
+ */
+struct EventLogFileHeader {
+    /** @brief EVENT_LOG_MAGIC. */
+    uint32_t magic;
+    /** @brief EVENT_LOG_VERSION. */
+    uint8_t version;
+    /** @brief sizeof(EventLog). */
+    uint8_t record_size;
+    /** @brief ID of the first record in the file. */
+    uint16_t first_id;
+} __attribute__((packed));
+
+
+/**
+ * @brief Event waiting in a per-core queue for the consumer.
+ * @ingroup EventManagement
+ */
+struct PendingEvent {
+    /** @brief Time of the emit in milliseconds since boot. */
+    uint32_t uptime_ms;
+    /** @brief Event group. */
+    uint8_t group;
+    /** @brief Event code. */
+    uint8_t event;
+};
+
+/**
+ * @brief Single-producer single-consumer queue of emitted events for one core.
+ * @details head is only written by the emitting core, tail only by the consumer.
+ * @ingroup EventManagement
+ */
+struct EventQueue {
+    PendingEvent entries[EVENT_QUEUE_SIZE];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> dropped{0};
+};
 
     /**
  * @brief Manages event logging and storage.
@@ -189,6 +184,11 @@ class EventLog {
  *          circular buffer and saving them to persistent storage. It ensures
  *          thread-safe access to the event log and provides methods for
  *          initializing, logging, retrieving, saving, and loading events.
+ *
+ *          Emitting only appends to a lock-free queue owned by the calling core.
+ *          process(), the single consumer running on core 1, assigns IDs and
+ *          timestamps, stores the events in the buffer, prints them and
+ *          persists them, so an emitter never waits for I2C or the SD card.
  * @ingroup EventManagement
  */
 class EventManager {
@@ -197,18 +197,28 @@ private:
     size_t eventCount;
     size_t writeIndex;
     mutex_t eventMutex;
+    mutex_t fileMutex;
     uint16_t nextEventId;
     size_t eventsSinceFlush;
+    EventQueue queues[2];
+    EventStats stats[EVENT_STATS_GROUPS][EVENT_STATS_CODES];
 
     EventManager() :
         eventCount(0),
         writeIndex(0),
         nextEventId(0),
-        eventsSinceFlush(0)
+        eventsSinceFlush(0),
+        stats{}
     {
         mutex_init(&eventMutex);
+        mutex_init(&fileMutex);
     }
 
+    FILE* open_for_append(uint16_t first_id);
+    void update_stats(uint8_t group, uint8_t event, uint32_t timestamp);
+    bool save_stats();
+    void load_stats();
+
     EventManager(const EventManager&) = delete;
     EventManager& operator=(const EventManager&) = delete;
 
@@ -225,16 +235,40 @@ private:
     /**
      * @brief Initializes the event manager.
      * @return True if initialization was successful, false otherwise.
+     * @details Continues event IDs after the last record in the event log file.
      */
     bool init();
 
     /**
-     * @brief Logs an event to the event buffer.
+     * @brief Queues an event for the consumer.
      * @param[in] group Event group.
      * @param[in] event Event code.
+     * @details Constant time and lock-free; not for use from interrupt handlers.
      */
     void log_event(uint8_t group, uint8_t event);
 
+    /**
+     * @brief Moves queued events of both cores into the event buffer.
+     * @details Single consumer, called from the core 1 loop. Timestamps, prints
+     *          and persists the events.
+     */
+    void process();
+
+    /**
+     * @brief Gets the number of events dropped because a core's queue was full.
+     * @param[in] core Core number (0 or 1).
+     * @return Dropped events since boot.
+     */
+    uint32_t get_dropped_count(uint core) const {
+        return core < 2 ? queues[core].dropped.load(std::memory_order_relaxed) : 0;
+    }
+
+    /**
+     * @brief Gets the number of events waiting in the queues.
+     * @return Queued events of both cores.
+     */
+    uint32_t get_pending_count() const;
+
     /**
      * @brief Gets an event from the event buffer.
      * @param[in] index Index of the event to retrieve.
@@ -248,11 +282,69 @@ private:
      */
     size_t get_event_count() const { return eventCount; }
 
+    /**
+     * @brief Gets the number of events logged since boot.
+     * @return The total number of events, wrapping at 65536 together with the event ID.
+     */
+    uint16_t get_total_event_count() const { return nextEventId; }
+
     /**
      * @brief Saves the event buffer to persistent storage.
      * @return True if the save was successful, false otherwise.
      */
     bool save_to_storage();
+
+    /**
+     * @brief Reads events in an ID range from the event log file.
+     * @param[in] from_id First ID.
+     * @param[in] to_id Last ID, may have wrapped past 65535.
+     * @param[in] group Group to return, or -1 for all groups.
+     * @param[in] max_results Maximum number of events to return.
+     * @return Matching events, oldest first.
+     */
+    std::vector<EventLog> query_by_id(uint16_t from_id, uint16_t to_id, int group, size_t max_results);
+
+    /**
+     * @brief Reads events in a time range from the event log file.
+     * @param[in] from_time First timestamp.
+     * @param[in] to_time Last timestamp.
+     * @param[in] group Group to return, or -1 for all groups.
+     * @param[in] max_results Maximum number of events to return.
+     * @return Matching events, oldest first.
+     */
+    std::vector<EventLog> query_by_time(uint32_t from_time, uint32_t to_time, int group, size_t max_results);
+
+    /**
+     * @brief Reads the newest events of one group from the event log file.
+     * @param[in] group Event group.
+     * @param[in] max_results Maximum number of events to return.
+     * @return Matching events, newest first.
+     */
+    std::vector<EventLog> query_by_group(uint8_t group, size_t max_results);
+
+    /**
+     * @brief Gets the statistics of one (group, event) pair.
+     * @param[in] group Event group.
+     * @param[in] event Event code.
+     * @param[out] out Copy of the statistics.
+     * @return False if the pair is outside the statistics matrix.
+     */
+    bool get_event_stats(uint8_t group, uint8_t event, EventStats& out);
+
+    /**
+     * @brief Gets the number of events of a pair in the minute before a time.
+     * @param[in] stats Statistics of the pair.
+     * @param[in] now Current timestamp.
+     * @return Events in the current minute if the last event was in it, otherwise 0.
+     */
+    static uint16_t get_minute_rate(const EventStats& stats, uint32_t now) {
+        return stats.count && stats.last_seen / 60 == now / 60 ? stats.minute_count : 0;
+    }
+
+    /**
+     * @brief Clears all event statistics and the persisted copy.
+     */
+    void reset_event_stats();
 };
 
 /**
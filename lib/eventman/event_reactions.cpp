@@ -0,0 +1,199 @@
+/**
+ * @file event_reactions.cpp
+ * @brief Subscriptions and configurable reactions to system events.
+ *
+ * @defgroup EventManagement Event Management
+ * @{
+ */
+
+#include "event_reactions.h"
+#include <atomic>
+#include "event_manager.h"
+#include "pico/mutex.h"
+#include "utils.h"
+#include "communication.h"
+#include "beacon.h"
+#include "telemetry_manager.h"
+#include "time_service.h"
+#include "gps_config.h"
+#include "gps_power.h"
+#include "gps_time_sync.h"
+
+namespace {
+
+/**
+ * @brief Re-anchors the time service after the RTC was changed.
+ */
+void on_clock_changed(uint8_t, uint8_t) {
+    TimeService::get_instance().request_resync();
+}
+
+/**
+ * @brief Reconfigures the GPS receiver, which restarts at its defaults after a power cycle.
+ */
+void on_gps_power_on(uint8_t, uint8_t) {
+    GpsConfigManager::get_instance().request_reconfigure();
+}
+
+/**
+ * @brief Lets a pending GPS time sync use the fix of the current window.
+ */
+void on_gps_lock(uint8_t, uint8_t) {
+    GpsTimeSync::get_instance().on_fix_available();
+}
+
+void apply_reaction_rules(uint8_t group, uint8_t event);
+
+/**
+ * @brief Compile-time subscriptions, scanned in order for every event.
+ */
+constexpr EventSubscription subscriptions[] = {
+    {static_cast<uint8_t>(EventGroup::CLOCK), static_cast<uint8_t>(ClockEvent::CHANGED), on_clock_changed},
+    {static_cast<uint8_t>(EventGroup::CLOCK), static_cast<uint8_t>(ClockEvent::GPS_SYNC), on_clock_changed},
+    {static_cast<uint8_t>(EventGroup::GPS), static_cast<uint8_t>(GPSEvent::POWER_ON), on_gps_power_on},
+    {static_cast<uint8_t>(EventGroup::GPS), static_cast<uint8_t>(GPSEvent::LOCK), on_gps_lock},
+    {EVENT_ANY, EVENT_ANY, apply_reaction_rules},
+};
+
+constexpr uint8_t POWER_GROUP = static_cast<uint8_t>(EventGroup::POWER);
+constexpr uint8_t BATTERY_LOW = static_cast<uint8_t>(PowerEvent::BATTERY_LOW);
+constexpr uint8_t BATTERY_NORMAL = static_cast<uint8_t>(PowerEvent::BATTERY_NORMAL);
+
+/**
+ * @brief Reaction rules, defaulting to shedding load on a low battery.
+ */
+ReactionRule rules[REACTION_RULE_COUNT] = {
+    {POWER_GROUP, BATTERY_LOW,    ReactionAction::SET_SAMPLE_INTERVAL, 10000},
+    {POWER_GROUP, BATTERY_LOW,    ReactionAction::GPS_POWER,           0},
+    {POWER_GROUP, BATTERY_LOW,    ReactionAction::SET_BEACON_INTERVAL, 0},
+    {POWER_GROUP, BATTERY_NORMAL, ReactionAction::SET_SAMPLE_INTERVAL, 1000},
+    {POWER_GROUP, BATTERY_NORMAL, ReactionAction::GPS_POWER,           1},
+    {POWER_GROUP, BATTERY_NORMAL, ReactionAction::SET_BEACON_INTERVAL, BeaconManager::DEFAULT_INTERVAL_S},
+};
+
+auto_init_mutex(rules_mutex);
+std::atomic<uint32_t> reactions_run{0};  // counted on core 1, read by 5.3 on core 0
+
+/**
+ * @brief Runs one rule action.
+ * @param action Action to run.
+ * @param value Action argument.
+ * @return True if the action was applied.
+ */
+bool run_action(ReactionAction action, uint32_t value) {
+    switch (action) {
+        case ReactionAction::SET_SAMPLE_INTERVAL:
+            return TelemetryManager::get_instance().set_sample_interval(value);
+
+        case ReactionAction::GPS_POWER:
+            GpsPowerScheduler::get_instance().set_enabled(value != 0);
+            return true;
+
+        case ReactionAction::SET_BEACON_INTERVAL:
+            return BeaconManager::get_instance().set_interval(value);
+
+        case ReactionAction::SET_RADIO_RX_MODE:
+            if (value > static_cast<uint32_t>(RadioRxMode::DUTY_CYCLED)) {
+                return false;
+            }
+            // runs on core 1, the radio belongs to core 0
+            radio_request_rx_mode(static_cast<RadioRxMode>(value));
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Runs the actions of all rules matching an event.
+ * @param group Event group.
+ * @param event Event code.
+ * @details Matching rules are copied under the rules mutex and run after it is
+ *          released, so a command changing rules never waits on an action.
+ */
+void apply_reaction_rules(uint8_t group, uint8_t event) {
+    ReactionRule matched[REACTION_RULE_COUNT];
+    size_t matched_count = 0;
+
+    mutex_enter_blocking(&rules_mutex);
+    for (const ReactionRule& rule : rules) {
+        if (rule.action != ReactionAction::NONE && rule.group == group && rule.event == event) {
+            matched[matched_count++] = rule;
+        }
+    }
+    mutex_exit(&rules_mutex);
+
+    for (size_t i = 0; i < matched_count; i++) {
+        if (run_action(matched[i].action, matched[i].value)) {
+            reactions_run.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            uart_print("Reaction " + std::to_string(static_cast<int>(matched[i].action)) + " rejected value " +
+                       std::to_string(matched[i].value), VerbosityLevel::WARNING);
+        }
+    }
+}
+
+} // namespace
+
+
+/**
+ * @brief Calls the subscriptions and runs the reaction rules matching an event.
+ * @param group Event group.
+ * @param event Event code.
+ * @ingroup EventManagement
+ */
+void dispatch_event(uint8_t group, uint8_t event) {
+    for (const EventSubscription& subscription : subscriptions) {
+        if ((subscription.group == group || subscription.group == EVENT_ANY) &&
+            (subscription.event == event || subscription.event == EVENT_ANY)) {
+            subscription.handler(group, event);
+        }
+    }
+}
+
+
+/**
+ * @brief Gets a reaction rule.
+ * @param index Rule index, below REACTION_RULE_COUNT.
+ * @return Copy of the rule, an empty rule for an invalid index.
+ * @ingroup EventManagement
+ */
+ReactionRule get_reaction_rule(size_t index) {
+    if (index >= REACTION_RULE_COUNT) {
+        return ReactionRule{0, 0, ReactionAction::NONE, 0};
+    }
+    mutex_enter_blocking(&rules_mutex);
+    ReactionRule rule = rules[index];
+    mutex_exit(&rules_mutex);
+    return rule;
+}
+
+
+/**
+ * @brief Replaces a reaction rule.
+ * @param index Rule index, below REACTION_RULE_COUNT.
+ * @param rule New rule, ReactionAction::NONE clears the slot.
+ * @return True if the index and the action are valid.
+ * @ingroup EventManagement
+ */
+bool set_reaction_rule(size_t index, const ReactionRule& rule) {
+    if (index >= REACTION_RULE_COUNT || rule.action >= ReactionAction::COUNT) {
+        return false;
+    }
+    mutex_enter_blocking(&rules_mutex);
+    rules[index] = rule;
+    mutex_exit(&rules_mutex);
+    return true;
+}
+
+
+/**
+ * @brief Gets the number of actions run since boot.
+ * @return Actions run by reaction rules.
+ * @ingroup EventManagement
+ */
+uint32_t get_reactions_run() {
+    return reactions_run.load(std::memory_order_relaxed);
+}
+/** @} */
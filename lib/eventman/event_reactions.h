@@ -0,0 +1,120 @@
+/**
+ * @file event_reactions.h
+ * @brief Subscriptions and configurable reactions to system events.
+ *
+ * @details Events are dispatched by EventManager::process() on core 1 after
+ *          they are stored. Two kinds of consumers exist:
+ *          - subscriptions: a fixed table of (group, event, handler) entries in
+ *            event_reactions.cpp, for modules that must react in code;
+ *          - reaction rules: a small RAM table of (group, event, action, value)
+ *            entries set by command, for load shedding policy that the ground
+ *            may want to change without a firmware update.
+ *
+ *          Dispatch scans both tables once per event, so its cost is bounded by
+ *          their sizes. Handlers and actions must not block.
+ *
+ * @defgroup EventManagement Event Management
+ * @{
+ */
+
+#ifndef EVENT_REACTIONS_H
+#define EVENT_REACTIONS_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Matches any event group or code in a subscription.
+ */
+#define EVENT_ANY 0xFF
+
+/**
+ * @brief Number of configurable reaction rules.
+ */
+#define REACTION_RULE_COUNT 16
+
+/**
+ * @brief Handler called for a subscribed event.
+ * @param group Event group.
+ * @param event Event code.
+ */
+typedef void (*EventHandler)(uint8_t group, uint8_t event);
+
+/**
+ * @brief Entry of the compile-time subscription table.
+ * @ingroup EventManagement
+ */
+struct EventSubscription {
+    /** @brief Event group, or EVENT_ANY. */
+    uint8_t group;
+    /** @brief Event code, or EVENT_ANY. */
+    uint8_t event;
+    /** @brief Handler to call. */
+    EventHandler handler;
+};
+
+/**
+ * @brief Actions a reaction rule can take.
+ * @ingroup EventManagement
+ */
+enum class ReactionAction : uint8_t {
+    /** @brief Empty rule. */
+    NONE = 0,
+    /** @brief Set the telemetry sample interval to value ms. */
+    SET_SAMPLE_INTERVAL = 1,
+    /** @brief Disable (value 0) or enable (value 1) the GPS power scheduler. */
+    GPS_POWER = 2,
+    /** @brief Set the beacon interval to value s, 0 stops the beacon. */
+    SET_BEACON_INTERVAL = 3,
+    /** @brief Set the LoRa receive mode, 0 continuous, 1 duty-cycled. */
+    SET_RADIO_RX_MODE = 4,
+    /** @brief Number of actions. */
+    COUNT
+};
+
+/**
+ * @brief Configurable reaction to an event.
+ * @ingroup EventManagement
+ */
+struct ReactionRule {
+    /** @brief Event group. */
+    uint8_t group;
+    /** @brief Event code. */
+    uint8_t event;
+    /** @brief Action to take. */
+    ReactionAction action;
+    /** @brief Action argument. */
+    uint32_t value;
+};
+
+/**
+ * @brief Calls the subscriptions and runs the reaction rules matching an event.
+ * @param group Event group.
+ * @param event Event code.
+ * @details Called by the event consumer on core 1.
+ */
+void dispatch_event(uint8_t group, uint8_t event);
+
+/**
+ * @brief Gets a reaction rule.
+ * @param index Rule index, below REACTION_RULE_COUNT.
+ * @return Copy of the rule.
+ */
+ReactionRule get_reaction_rule(size_t index);
+
+/**
+ * @brief Replaces a reaction rule.
+ * @param index Rule index, below REACTION_RULE_COUNT.
+ * @param rule New rule, ReactionAction::NONE clears the slot.
+ * @return True if the index and the action are valid.
+ */
+bool set_reaction_rule(size_t index, const ReactionRule& rule);
+
+/**
+ * @brief Gets the number of actions run since boot.
+ * @return Actions run by reaction rules.
+ */
+uint32_t get_reactions_run();
+
+#endif // EVENT_REACTIONS_H
+/** @} */
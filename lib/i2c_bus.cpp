@@ -0,0 +1,527 @@
+#include "i2c_bus.h"
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+#include "pico/time.h"
+#include "hardware/irq.h"
+
+/**
+ * @file i2c_bus.cpp
+ * @brief Implementation of the interrupt-driven I2C transaction queue
+ * @ingroup I2cBus
+ */
+
+namespace {
+
+/**
+ * @brief Depth of the controller TX and RX FIFOs.
+ */
+constexpr size_t FIFO_DEPTH = 16;
+
+/**
+ * @brief Time after which an abort that raised no interrupt is taken as finished.
+ */
+constexpr uint32_t ABORT_WAIT_US = 1000;
+
+/**
+ * @brief Longest wait for the idle controller to disable before a transaction.
+ * @details Disabling an idle controller takes a few ic_clk cycles.
+ */
+constexpr uint32_t DISABLE_WAIT_US = 100;
+
+/**
+ * @brief Longest sleep of a blocking caller between timeout checks.
+ */
+constexpr uint32_t WAIT_POLL_US = 1000;
+
+constexpr uint32_t ACTIVE_INTERRUPTS = I2C_IC_INTR_MASK_M_RX_FULL_BITS |
+                                       I2C_IC_INTR_MASK_M_TX_ABRT_BITS |
+                                       I2C_IC_INTR_MASK_M_STOP_DET_BITS;
+
+/**
+ * @brief Queue and transfer state of one bus.
+ * @details queue_head and queue_tail are free-running counters; the queue
+ *          index is the counter modulo I2C_BUS_QUEUE_SIZE. All fields are
+ *          guarded by lock, which is also taken by the interrupt and the
+ *          timeout alarm. Alarms are armed and cancelled only with lock
+ *          released: the locked code leaves the work in alarm_to_cancel and
+ *          arm_timeout_us for service_alarms().
+ */
+struct I2cBusState {
+    i2c_inst_t* i2c = nullptr;
+    bool initialized = false;
+    critical_section_t lock;
+    I2cTransaction* queue[I2C_BUS_QUEUE_SIZE] = {};
+    uint32_t queue_head = 0;
+    uint32_t queue_tail = 0;
+    I2cTransaction* current = nullptr;
+    size_t commands_issued = 0;
+    size_t bytes_read = 0;
+    uint64_t start_us = 0;
+    uint32_t generation = 0;
+    bool aborting = false;
+    uint64_t abort_us = 0;
+    alarm_id_t timeout_alarm = 0;
+    alarm_id_t alarm_to_cancel = 0;
+    uint32_t arm_timeout_us = 0;
+    I2cBusStats stats = {};
+};
+
+I2cBusState buses[2];
+
+I2cBusState& bus_for(i2c_inst_t* i2c) {
+    return buses[i2c == i2c0 ? 0 : 1];
+}
+
+int64_t timeout_handler(alarm_id_t id, void* user_data);
+
+/**
+ * @brief Issues write bytes and read commands while the FIFOs have room.
+ * @details Read commands are limited so the bytes they return always fit the
+ *          RX FIFO. The TX empty interrupt is enabled only while the TX FIFO
+ *          is what holds back the remaining commands. Caller holds bus.lock.
+ */
+void fill_tx_locked(I2cBusState& bus) {
+    I2cTransaction* transaction = bus.current;
+    i2c_hw_t* hw = i2c_get_hw(bus.i2c);
+    size_t total = transaction->write_length + transaction->read_length;
+    bool tx_full = false;
+
+    while (bus.commands_issued < total) {
+        if (i2c_get_write_available(bus.i2c) == 0) {
+            tx_full = true;
+            break;
+        }
+
+        size_t index = bus.commands_issued;
+        uint32_t command;
+        if (index < transaction->write_length) {
+            command = transaction->write_data[index];
+        } else {
+            size_t reads_in_flight = index - transaction->write_length - bus.bytes_read;
+            if (reads_in_flight >= FIFO_DEPTH) {
+                break;
+            }
+            command = I2C_IC_DATA_CMD_CMD_BITS;
+            if (index == transaction->write_length && transaction->write_length > 0) {
+                command |= I2C_IC_DATA_CMD_RESTART_BITS;
+            }
+        }
+        if (index == total - 1) {
+            command |= I2C_IC_DATA_CMD_STOP_BITS;
+        }
+        hw->data_cmd = command;
+        bus.commands_issued++;
+    }
+
+    hw->intr_mask = ACTIVE_INTERRUPTS | (tx_full ? I2C_IC_INTR_MASK_M_TX_EMPTY_BITS : 0);
+}
+
+/**
+ * @brief Moves received bytes to the read buffer. Caller holds bus.lock.
+ */
+void drain_rx_locked(I2cBusState& bus) {
+    I2cTransaction* transaction = bus.current;
+    i2c_hw_t* hw = i2c_get_hw(bus.i2c);
+    while (bus.bytes_read < transaction->read_length && i2c_get_read_available(bus.i2c) > 0) {
+        transaction->read_data[bus.bytes_read++] = static_cast<uint8_t>(hw->data_cmd);
+    }
+}
+
+/**
+ * @brief Starts the next queued transaction if the bus is idle and not aborting.
+ * @details The controller is disabled, and TAR reprogrammed only once
+ *          IC_ENABLE_STATUS shows it off. If it does not turn off within
+ *          DISABLE_WAIT_US the transaction is left without commands and ends
+ *          with its timeout. The timeout alarm is armed by service_alarms().
+ *          Caller holds bus.lock.
+ */
+void start_next_locked(I2cBusState& bus) {
+    if (bus.current != nullptr || bus.aborting || bus.queue_head == bus.queue_tail) {
+        return;
+    }
+
+    I2cTransaction* transaction = bus.queue[bus.queue_tail % I2C_BUS_QUEUE_SIZE];
+    bus.queue_tail++;
+    bus.current = transaction;
+    bus.commands_issued = 0;
+    bus.bytes_read = 0;
+    bus.generation++;
+    bus.start_us = time_us_64();
+    bus.arm_timeout_us = transaction->timeout_us;
+
+    i2c_hw_t* hw = i2c_get_hw(bus.i2c);
+    hw->enable = 0;
+    uint64_t disable_deadline_us = bus.start_us + DISABLE_WAIT_US;
+    while (hw->enable_status & I2C_IC_ENABLE_STATUS_IC_EN_BITS) {
+        if (time_us_64() >= disable_deadline_us) {
+            hw->intr_mask = 0;
+            return;
+        }
+        tight_loop_contents();
+    }
+
+    hw->tar = transaction->address;
+    hw->rx_tl = 0;
+    hw->tx_tl = 0;
+    hw->enable = I2C_IC_ENABLE_ENABLE_BITS;
+    (void)hw->clr_intr;
+    fill_tx_locked(bus);
+}
+
+/**
+ * @brief Ends an abort once the controller has finished it, and starts the next transaction.
+ * @param abort_done True from the TX_ABRT interrupt of the abort.
+ * @details An abort normally ends with the TX_ABRT interrupt; the ABORT bit
+ *          clearing, or ABORT_WAIT_US passing, covers an abort that raised
+ *          none. Caller holds bus.lock.
+ */
+void finish_abort_locked(I2cBusState& bus, bool abort_done) {
+    i2c_hw_t* hw = i2c_get_hw(bus.i2c);
+    if (!bus.aborting) {
+        return;
+    }
+    if (!abort_done && (hw->enable & I2C_IC_ENABLE_ABORT_BITS) && time_us_64() - bus.abort_us < ABORT_WAIT_US) {
+        return;
+    }
+    bus.aborting = false;
+    hw->intr_mask = 0;
+    (void)hw->clr_intr;
+    start_next_locked(bus);
+}
+
+/**
+ * @brief Ends the running transaction and starts the next one.
+ * @return The ended transaction; the caller publishes result with notify()
+ *         after releasing bus.lock.
+ */
+I2cTransaction* complete_locked(I2cBusState& bus, I2cResult result) {
+    I2cTransaction* transaction = bus.current;
+    i2c_hw_t* hw = i2c_get_hw(bus.i2c);
+    hw->intr_mask = 0;
+    if (bus.timeout_alarm > 0) {
+        bus.alarm_to_cancel = bus.timeout_alarm;
+    }
+    bus.timeout_alarm = 0;
+    bus.arm_timeout_us = 0;
+
+    uint64_t now_us = time_us_64();
+    I2cBusStats& stats = bus.stats;
+    stats.transactions++;
+    switch (result) {
+        case I2cResult::OK:
+            stats.bytes += transaction->write_length + transaction->read_length;
+            break;
+        case I2cResult::NACK:
+            stats.nacks++;
+            break;
+        case I2cResult::TIMEOUT:
+            stats.timeouts++;
+            break;
+        default:
+            stats.errors++;
+            break;
+    }
+    stats.busy_us += now_us - bus.start_us;
+    uint32_t latency_us = static_cast<uint32_t>(now_us - transaction->submit_us);
+    stats.latency_us += latency_us;
+    if (latency_us > stats.max_latency_us) {
+        stats.max_latency_us = latency_us;
+    }
+
+    bus.current = nullptr;
+    start_next_locked(bus);
+    return transaction;
+}
+
+/**
+ * @brief Aborts the running transaction with a timeout. Caller holds bus.lock.
+ * @details The bus stays ABORTING, holding back the next transaction, until
+ *          the TX_ABRT interrupt of the abort; nothing waits here.
+ */
+I2cTransaction* abort_locked(I2cBusState& bus) {
+    i2c_hw_t* hw = i2c_get_hw(bus.i2c);
+    hw->enable |= I2C_IC_ENABLE_ABORT_BITS;
+    bus.aborting = true;
+    bus.abort_us = time_us_64();
+    I2cTransaction* transaction = complete_locked(bus, I2cResult::TIMEOUT);
+    hw->intr_mask = I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    return transaction;
+}
+
+/**
+ * @brief Cancels the alarm of the last completed transaction and arms the one of a started transaction.
+ * @details Called after every locked section that may complete or start a
+ *          transaction, with bus.lock released.
+ */
+void service_alarms(I2cBusState& bus) {
+    critical_section_enter_blocking(&bus.lock);
+    alarm_id_t cancel = bus.alarm_to_cancel;
+    bus.alarm_to_cancel = 0;
+    uint32_t timeout_us = bus.arm_timeout_us;
+    bus.arm_timeout_us = 0;
+    uint32_t generation = bus.generation;
+    critical_section_exit(&bus.lock);
+
+    if (cancel > 0) {
+        cancel_alarm(cancel);
+    }
+    if (timeout_us == 0) {
+        return;
+    }
+
+    alarm_id_t id = add_alarm_in_us(timeout_us, timeout_handler, &bus, false);
+    critical_section_enter_blocking(&bus.lock);
+    if (id > 0 && bus.current != nullptr && bus.generation == generation) {
+        bus.timeout_alarm = id;
+        id = 0;
+    }
+    critical_section_exit(&bus.lock);
+
+    // the transaction ended while the alarm was armed
+    if (id > 0) {
+        cancel_alarm(id);
+    }
+}
+
+/**
+ * @brief Calls the completion callback, publishes the result and wakes waiting cores.
+ */
+void notify(I2cTransaction* transaction, I2cResult result) {
+    if (transaction == nullptr) {
+        return;
+    }
+    if (transaction->callback != nullptr) {
+        transaction->callback(transaction, result);
+    }
+    transaction->result = result;
+    __sev();
+}
+
+/**
+ * @brief Aborts the running transaction if it is past its timeout.
+ * @details The deadline is checked rather than the alarm ID, so an alarm of an
+ *          earlier transaction that could not be cancelled in time is harmless.
+ */
+int64_t timeout_handler(alarm_id_t id, void* user_data) {
+    I2cBusState& bus = *static_cast<I2cBusState*>(user_data);
+    I2cTransaction* ended = nullptr;
+
+    critical_section_enter_blocking(&bus.lock);
+    if (bus.current != nullptr && time_us_64() - bus.start_us >= bus.current->timeout_us) {
+        if (bus.timeout_alarm == id) {
+            bus.timeout_alarm = 0;
+        }
+        ended = abort_locked(bus);
+    }
+    critical_section_exit(&bus.lock);
+
+    service_alarms(bus);
+    notify(ended, I2cResult::TIMEOUT);
+    return 0;
+}
+
+/**
+ * @brief Services the interrupt of a bus.
+ */
+void handle_interrupt(I2cBusState& bus) {
+    uint64_t entry_us = time_us_64();
+    i2c_hw_t* hw = i2c_get_hw(bus.i2c);
+    I2cTransaction* ended = nullptr;
+    I2cResult result = I2cResult::OK;
+
+    critical_section_enter_blocking(&bus.lock);
+    uint32_t status = hw->intr_stat;
+
+    if (bus.current == nullptr) {
+        // the abort of a timed out transfer has finished, or a late event of it
+        (void)hw->clr_tx_abrt;
+        if (bus.aborting && (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS)) {
+            finish_abort_locked(bus, true);
+        } else {
+            hw->intr_mask = 0;
+            (void)hw->clr_intr;
+        }
+    } else if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        uint32_t source = hw->tx_abrt_source;
+        (void)hw->clr_tx_abrt;
+        bool nack = source & (I2C_IC_TX_ABRT_SOURCE_ABRT_7B_ADDR_NOACK_BITS | I2C_IC_TX_ABRT_SOURCE_ABRT_TXDATA_NOACK_BITS);
+        result = nack ? I2cResult::NACK : I2cResult::ERROR;
+        ended = complete_locked(bus, result);
+    } else {
+        if (status & I2C_IC_INTR_STAT_R_RX_FULL_BITS) {
+            drain_rx_locked(bus);
+        }
+        if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+            (void)hw->clr_stop_det;
+            drain_rx_locked(bus);
+            I2cTransaction* transaction = bus.current;
+            bool complete = bus.commands_issued == transaction->write_length + transaction->read_length &&
+                            bus.bytes_read == transaction->read_length;
+            result = complete ? I2cResult::OK : I2cResult::ERROR;
+            ended = complete_locked(bus, result);
+        } else {
+            fill_tx_locked(bus);
+        }
+    }
+
+    bus.stats.irq_us += time_us_64() - entry_us;
+    critical_section_exit(&bus.lock);
+
+    service_alarms(bus);
+    notify(ended, result);
+}
+
+void i2c0_irq_handler() {
+    handle_interrupt(buses[0]);
+}
+
+void i2c1_irq_handler() {
+    handle_interrupt(buses[1]);
+}
+
+/**
+ * @brief Aborts the running transaction if it is past its timeout, and ends a finished abort.
+ * @details Covers a timeout alarm that could not be allocated and an abort
+ *          that raised no interrupt.
+ */
+void check_timeout(I2cBusState& bus) {
+    I2cTransaction* ended = nullptr;
+
+    critical_section_enter_blocking(&bus.lock);
+    if (bus.current != nullptr && time_us_64() - bus.start_us > bus.current->timeout_us) {
+        ended = abort_locked(bus);
+    } else {
+        finish_abort_locked(bus, false);
+    }
+    critical_section_exit(&bus.lock);
+
+    service_alarms(bus);
+    notify(ended, I2cResult::TIMEOUT);
+}
+
+/**
+ * @brief Runs a transaction with the blocking SDK calls, before i2c_bus_init().
+ */
+int write_read_blocking(i2c_inst_t* i2c, uint8_t address, const uint8_t* write_data, size_t write_length,
+                        uint8_t* read_data, size_t read_length, uint32_t timeout_us) {
+    int ret = 0;
+    if (write_length > 0) {
+        ret = i2c_write_timeout_us(i2c, address, write_data, write_length, read_length > 0, timeout_us);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    if (read_length > 0) {
+        ret = i2c_read_timeout_us(i2c, address, read_data, read_length, false, timeout_us);
+    }
+    return ret;
+}
+
+} // namespace
+
+bool i2c_bus_init(i2c_inst_t* i2c) {
+    I2cBusState& bus = bus_for(i2c);
+    if (bus.initialized) {
+        return true;
+    }
+
+    critical_section_init(&bus.lock);
+    bus.i2c = i2c;
+    i2c_get_hw(i2c)->intr_mask = 0;
+
+    uint irq = i2c == i2c0 ? I2C0_IRQ : I2C1_IRQ;
+    irq_set_exclusive_handler(irq, i2c == i2c0 ? i2c0_irq_handler : i2c1_irq_handler);
+    irq_set_enabled(irq, true);
+
+    bus.initialized = true;
+    return true;
+}
+
+bool i2c_bus_submit(i2c_inst_t* i2c, I2cTransaction* transaction) {
+    I2cBusState& bus = bus_for(i2c);
+    if (!bus.initialized || transaction == nullptr ||
+        (transaction->write_length == 0 && transaction->read_length == 0)) {
+        return false;
+    }
+
+    critical_section_enter_blocking(&bus.lock);
+    if (bus.queue_head - bus.queue_tail >= I2C_BUS_QUEUE_SIZE) {
+        bus.stats.queue_full++;
+        critical_section_exit(&bus.lock);
+        return false;
+    }
+
+    transaction->result = I2cResult::PENDING;
+    transaction->submit_us = time_us_64();
+    bus.queue[bus.queue_head % I2C_BUS_QUEUE_SIZE] = transaction;
+    bus.queue_head++;
+    finish_abort_locked(bus, false);
+    start_next_locked(bus);
+    critical_section_exit(&bus.lock);
+
+    service_alarms(bus);
+    return true;
+}
+
+I2cResult i2c_bus_wait(i2c_inst_t* i2c, I2cTransaction* transaction) {
+    I2cBusState& bus = bus_for(i2c);
+    uint64_t start_us = time_us_64();
+
+    while (transaction->result == I2cResult::PENDING) {
+        best_effort_wfe_or_timeout(delayed_by_us(get_absolute_time(), WAIT_POLL_US));
+        check_timeout(bus);
+    }
+
+    critical_section_enter_blocking(&bus.lock);
+    bus.stats.wait_us += time_us_64() - start_us;
+    critical_section_exit(&bus.lock);
+    return transaction->result;
+}
+
+int i2c_bus_write_read(i2c_inst_t* i2c, uint8_t address, const uint8_t* write_data, size_t write_length,
+                       uint8_t* read_data, size_t read_length, uint32_t timeout_us) {
+    if (!bus_for(i2c).initialized) {
+        return write_read_blocking(i2c, address, write_data, write_length, read_data, read_length, timeout_us);
+    }
+
+    I2cTransaction transaction;
+    transaction.address = address;
+    transaction.write_data = write_data;
+    transaction.write_length = write_length;
+    transaction.read_data = read_data;
+    transaction.read_length = read_length;
+    transaction.timeout_us = timeout_us;
+
+    // a full queue drains within the timeouts of the transactions ahead
+    absolute_time_t submit_deadline = delayed_by_us(get_absolute_time(),
+                                                    static_cast<uint64_t>(I2C_BUS_QUEUE_SIZE + 1) * timeout_us);
+    while (!i2c_bus_submit(i2c, &transaction)) {
+        if (write_length == 0 && read_length == 0) {
+            return PICO_ERROR_GENERIC;
+        }
+        if (absolute_time_diff_us(get_absolute_time(), submit_deadline) <= 0) {
+            return PICO_ERROR_TIMEOUT;
+        }
+        best_effort_wfe_or_timeout(delayed_by_us(get_absolute_time(), WAIT_POLL_US));
+    }
+
+    switch (i2c_bus_wait(i2c, &transaction)) {
+        case I2cResult::OK:
+            return static_cast<int>(read_length > 0 ? read_length : write_length);
+        case I2cResult::TIMEOUT:
+            return PICO_ERROR_TIMEOUT;
+        default:
+            return PICO_ERROR_GENERIC;
+    }
+}
+
+I2cBusStats i2c_bus_get_stats(i2c_inst_t* i2c) {
+    I2cBusState& bus = bus_for(i2c);
+    if (!bus.initialized) {
+        return bus.stats;
+    }
+    critical_section_enter_blocking(&bus.lock);
+    I2cBusStats snapshot = bus.stats;
+    critical_section_exit(&bus.lock);
+    return snapshot;
+}
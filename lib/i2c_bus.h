@@ -0,0 +1,151 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <cstdint>
+#include <cstddef>
+#include "hardware/i2c.h"
+
+/**
+ * @file i2c_bus.h
+ * @brief Interrupt-driven I2C transaction queue for both buses
+ * @details Each bus has a queue of transactions served by its I2C interrupt:
+ *          the handler keeps the controller TX FIFO filled with the write bytes
+ *          and read commands and drains the RX FIFO, so the submitting core is
+ *          free while the bytes are on the wire. A transaction is a write, a
+ *          read, or a write followed by a repeated start and a read, which makes
+ *          the usual "set register pointer, read" pair atomic with respect to
+ *          other users of the bus.
+ *
+ *          Every transaction has its own timeout, enforced by a timer alarm
+ *          that aborts the transfer, so a device holding the bus no longer
+ *          hangs the caller as the SDK blocking calls did.
+ *
+ *          Transactions are either submitted with i2c_bus_submit() and
+ *          completed through their callback or polled with i2c_bus_wait(), or
+ *          run with the blocking i2c_bus_write_read(), which sleeps the core
+ *          in WFE until completion. Transactions on the two buses run
+ *          concurrently.
+ *
+ *          Before i2c_bus_init() the blocking helpers fall back to the SDK
+ *          timeout functions.
+ *
+ * @defgroup I2cBus I2C Bus
+ * @brief Non-blocking I2C transactions.
+ * @{
+ */
+
+/**
+ * @brief Number of transactions that can wait on one bus, besides the running one.
+ */
+static constexpr size_t I2C_BUS_QUEUE_SIZE = 8;
+
+/**
+ * @brief Default timeout of a transaction in microseconds.
+ * @details A 30-byte transaction takes under 1 ms at 400 kHz.
+ */
+static constexpr uint32_t I2C_BUS_DEFAULT_TIMEOUT_US = 5000;
+
+/**
+ * @brief State of a transaction.
+ */
+enum class I2cResult : uint8_t {
+    PENDING,    /**< Queued or running */
+    OK,         /**< All bytes transferred */
+    NACK,       /**< Address or data not acknowledged */
+    TIMEOUT,    /**< Aborted after its timeout */
+    ERROR       /**< Other abort, or the bus was not initialised */
+};
+
+struct I2cTransaction;
+
+/**
+ * @brief Completion callback, called from the bus interrupt or timeout alarm.
+ * @param transaction The completed transaction.
+ * @param result Its final result, published in the transaction after the callback returns.
+ */
+typedef void (*I2cCallback)(I2cTransaction* transaction, I2cResult result);
+
+/**
+ * @brief One I2C transaction.
+ * @details The caller owns the transaction and its buffers until the result
+ *          is no longer PENDING.
+ */
+struct I2cTransaction {
+    uint8_t address = 0;                                /**< 7-bit device address */
+    const uint8_t* write_data = nullptr;                /**< Bytes written first */
+    size_t write_length = 0;                            /**< Number of bytes written */
+    uint8_t* read_data = nullptr;                       /**< Buffer for the bytes read after the write */
+    size_t read_length = 0;                             /**< Number of bytes read */
+    uint32_t timeout_us = I2C_BUS_DEFAULT_TIMEOUT_US;   /**< Time allowed from the start of the transfer */
+    I2cCallback callback = nullptr;                     /**< Optional completion callback */
+    void* context = nullptr;                            /**< Free for the callback */
+    volatile I2cResult result = I2cResult::OK;          /**< Set to PENDING on submission */
+    uint64_t submit_us = 0;                             /**< Time of submission, set by the bus */
+};
+
+/**
+ * @brief Counters of one bus.
+ */
+struct I2cBusStats {
+    uint32_t transactions;  /**< Transactions completed */
+    uint32_t nacks;         /**< Transactions ended by a NACK */
+    uint32_t timeouts;      /**< Transactions aborted after their timeout */
+    uint32_t errors;        /**< Transactions ended by another abort */
+    uint32_t queue_full;    /**< Submissions refused because the queue was full */
+    uint32_t bytes;         /**< Bytes written and read */
+    uint64_t busy_us;       /**< Time the bus was running a transaction */
+    uint64_t latency_us;    /**< Sum of the times from submission to completion */
+    uint32_t max_latency_us;/**< Longest time from submission to completion */
+    uint64_t irq_us;        /**< CPU time spent in the bus interrupt */
+    uint64_t wait_us;       /**< Time callers slept in the blocking helpers */
+};
+
+/**
+ * @brief Installs the interrupt handler of a bus.
+ * @param i2c Bus, already set up with i2c_init().
+ * @return True if the bus is ready.
+ * @details The interrupt and the timeout alarms are serviced by the calling
+ *          core; transactions may be submitted from either core.
+ */
+bool i2c_bus_init(i2c_inst_t* i2c);
+
+/**
+ * @brief Queues a transaction.
+ * @param i2c Bus.
+ * @param transaction Transaction to run; its result becomes PENDING.
+ * @return True if queued, false if the queue is full or the bus is not initialised.
+ */
+bool i2c_bus_submit(i2c_inst_t* i2c, I2cTransaction* transaction);
+
+/**
+ * @brief Sleeps until a submitted transaction has completed.
+ * @param i2c Bus the transaction was submitted to.
+ * @param transaction The transaction.
+ * @return The final result.
+ */
+I2cResult i2c_bus_wait(i2c_inst_t* i2c, I2cTransaction* transaction);
+
+/**
+ * @brief Runs a write, a read, or a write and a read with a repeated start.
+ * @param i2c Bus.
+ * @param address 7-bit device address.
+ * @param write_data Bytes to write, may be null if write_length is 0.
+ * @param write_length Number of bytes to write.
+ * @param read_data Buffer for the bytes read, may be null if read_length is 0.
+ * @param read_length Number of bytes to read.
+ * @param timeout_us Time allowed for the transfer.
+ * @return Number of bytes read, or written if read_length is 0; PICO_ERROR_TIMEOUT or PICO_ERROR_GENERIC.
+ * @details Must not be called with the interrupts of the core servicing the bus disabled.
+ */
+int i2c_bus_write_read(i2c_inst_t* i2c, uint8_t address, const uint8_t* write_data, size_t write_length,
+                       uint8_t* read_data, size_t read_length, uint32_t timeout_us = I2C_BUS_DEFAULT_TIMEOUT_US);
+
+/**
+ * @brief Gets a snapshot of the counters of a bus.
+ * @param i2c Bus.
+ * @return Copy of the counters.
+ */
+I2cBusStats i2c_bus_get_stats(i2c_inst_t* i2c);
+
+#endif // I2C_BUS_H
+/** @} */
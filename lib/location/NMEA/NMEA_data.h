@@ -4,8 +4,8 @@
  *
  * @details This file defines the NMEAData class, a singleton that stores and
  *          provides access to parsed data from NMEA sentences received from a GPS module.
- *          It includes methods for updating and retrieving RMC and GGA tokens,
- *          as well as converting the data to a Unix timestamp.
+ *          The data is held as a fixed-point GpsFix produced by nmea_parser and
+ *          published through a seqlock.
  *
  * @defgroup Location Location
  * @brief Classes for handling location data.
@@ -16,38 +16,59 @@
 #ifndef NMEA_DATA_H
 #define NMEA_DATA_H
 
-#include <vector>
-#include <string>
-#include "pico/sync.h"
-#include <cstring>
+#include <atomic>
+#include <cstdint>
+#include "pico/stdlib.h"
+#include "nmea_parser.h"
 
 /**
- * @brief Manages parsed NMEA sentences.
- * @details This class is a singleton that stores and provides access to parsed
- *          data from NMEA sentences received from a GPS module. It includes
- *          methods for updating and retrieving RMC and GGA tokens, as well as
- *          converting the data to a Unix timestamp.
+ * @brief Age reported for a fix whose position was never received.
+ */
+#define GPS_FIX_AGE_NEVER UINT32_MAX
+
+/**
+ * @brief Position age above which consumers treat a fix as stale.
+ */
+#define GPS_FIX_STALE_MS 5000
+
+/**
+ * @brief Consistent copy of the published fix.
+ * @ingroup Location
+ */
+struct GpsFixSnapshot {
+    /** @brief Fix assembled from the sentences received so far. */
+    GpsFix fix;
+    /** @brief Number of fixes published since boot, increases with every update. */
+    uint32_t generation;
+    /** @brief Time since the reception of the last valid RMC position in ms, GPS_FIX_AGE_NEVER if none. */
+    uint32_t age_ms;
+};
+
+/**
+ * @brief Manages the fix decoded from NMEA sentences.
+ * @details This class is a singleton holding the latest GpsFix published by
+ *          the GPS collector on core 1. The fix is guarded by a seqlock: the
+ *          single writer makes the sequence odd, copies the fix and makes the
+ *          sequence even again, without ever blocking. Readers on any core copy
+ *          the fix and retry if the sequence was odd or changed meanwhile, so
+ *          RMC, GGA, GSA and GSV fields always come from the same update.
  * @ingroup Location
  */
 class NMEAData {
 private:
-    /** @brief Vector of tokens from the most recent RMC sentence. */
-    std::vector<std::string> rmc_tokens_;
-    /** @brief Vector of tokens from the most recent GGA sentence. */
-    std::vector<std::string> gga_tokens_;
-    /** @brief Mutex for thread-safe access to the RMC tokens. */
-    mutex_t rmc_mutex_;
-    /** @brief Mutex for thread-safe access to the GGA tokens. */
-    mutex_t gga_mutex_;
+    /** @brief Seqlock sequence, odd while an update is in progress. */
+    std::atomic<uint32_t> sequence_{0};
+    /** @brief Most recently published fix. */
+    GpsFix fix_ = {};
+    /** @brief Time since boot at which the last valid RMC position was received, in ms. */
+    uint32_t position_time_ms_ = 0;
+    /** @brief A valid RMC position was published at least once. */
+    bool has_position_ = false;
 
     /**
      * @brief Private constructor for the singleton pattern.
-     * @details Initializes the mutexes.
      */
-    NMEAData() {
-        mutex_init(&rmc_mutex_);
-        mutex_init(&gga_mutex_);
-    }
+    NMEAData() = default;
 
     /**
      * @brief Deleted copy constructor to prevent copying.
@@ -69,45 +90,60 @@ public:
     }
 
     /**
-     * @brief Updates the RMC tokens with new data.
-     * @param[in] tokens Vector of strings representing the RMC tokens.
+     * @brief Publishes a new fix.
+     * @param[in] fix Fix assembled by the collector.
+     * @param[in] new_position True if the update carries a valid RMC position,
+     *            which restarts the fix age.
+     * @param[in] received_ms Time since boot at which the sentence was received.
+     * @details Single writer: called only by the collector on core 1.
      */
-    void update_rmc_tokens(const std::vector<std::string>& tokens) {
-        mutex_enter_blocking(&rmc_mutex_);
-        rmc_tokens_ = tokens;
-        mutex_exit(&rmc_mutex_);
-    }
+    void update_fix(const GpsFix& fix, bool new_position, uint32_t received_ms) {
+        uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
 
-    /**
-     * @brief Updates the GGA tokens with new data.
-     * @param[in] tokens Vector of strings representing the GGA tokens.
-     */
-    void update_gga_tokens(const std::vector<std::string>& tokens) {
-        mutex_enter_blocking(&gga_mutex_);
-        gga_tokens_ = tokens;
-        mutex_exit(&gga_mutex_);
+        fix_ = fix;
+        if (new_position) {
+            position_time_ms_ = received_ms;
+            has_position_ = true;
+        }
+
+        std::atomic_thread_fence(std::memory_order_release);
+        sequence_.store(sequence + 2, std::memory_order_relaxed);
     }
 
     /**
-     * @brief Gets a copy of the RMC tokens.
-     * @return A copy of the RMC tokens.
+     * @brief Gets a consistent copy of the latest fix.
+     * @return Fix, generation and age; all zero before the first sentence.
+     * @details Lock-free, retries while an update is in progress.
      */
-    std::vector<std::string> get_rmc_tokens() const {
-        mutex_enter_blocking(const_cast<mutex_t*>(&rmc_mutex_));
-        std::vector<std::string> copy = rmc_tokens_;
-        mutex_exit(const_cast<mutex_t*>(&rmc_mutex_));
-        return copy;
+    GpsFixSnapshot get_snapshot() const {
+        GpsFixSnapshot snapshot;
+        uint32_t position_time_ms;
+        bool has_position;
+        uint32_t before;
+        uint32_t after;
+
+        do {
+            before = sequence_.load(std::memory_order_acquire);
+            snapshot.fix = fix_;
+            position_time_ms = position_time_ms_;
+            has_position = has_position_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence_.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        snapshot.generation = before / 2;
+        snapshot.age_ms = has_position ? to_ms_since_boot(get_absolute_time()) - position_time_ms : GPS_FIX_AGE_NEVER;
+        return snapshot;
     }
 
     /**
-     * @brief Gets a copy of the GGA tokens.
-     * @return A copy of the GGA tokens.
+     * @brief Gets a consistent copy of the latest fix.
+     * @return A copy of the fix, all zero before the first sentence.
      */
-    std::vector<std::string> get_gga_tokens() const {
-        mutex_enter_blocking(const_cast<mutex_t*>(&gga_mutex_));
-        std::vector<std::string> copy = gga_tokens_;
-        mutex_exit(const_cast<mutex_t*>(&gga_mutex_));
-        return copy;
+    GpsFix get_fix() const {
+        return get_snapshot().fix;
     }
 };
 
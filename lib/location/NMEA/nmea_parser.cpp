@@ -0,0 +1,440 @@
+/**
+ * @file nmea_parser.cpp
+ * @brief Allocation-free NMEA 0183 parser.
+ *
+ * @defgroup Location Location
+ * @brief Classes for handling location data.
+ *
+ * @{
+ */
+
+#include "nmea_parser.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief Parses a run of decimal digits.
+ * @param[in] data First digit.
+ * @param[in] count Number of digits.
+ * @param[out] value Parsed value.
+ * @return False if a character is not a digit.
+ */
+bool parse_digits(const char* data, size_t count, uint32_t& value) {
+    value = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (data[i] < '0' || data[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (data[i] - '0');
+    }
+    return true;
+}
+
+/**
+ * @brief Parses an hhmmss.sss time field.
+ * @param[in] field Time field.
+ * @param[out] time_ms Milliseconds since midnight.
+ * @return False if the field is malformed.
+ */
+bool parse_time(const NmeaField& field, uint32_t& time_ms) {
+    uint32_t hours, minutes;
+    int64_t seconds_ms;
+    if (field.length < 6 || !parse_digits(field.data, 2, hours) || !parse_digits(field.data + 2, 2, minutes)) {
+        return false;
+    }
+    NmeaField seconds = {field.data + 4, static_cast<uint8_t>(field.length - 4)};
+    if (!nmea_parse_fixed(seconds, 3, seconds_ms)) {
+        return false;
+    }
+    time_ms = (hours * 3600 + minutes * 60) * 1000 + static_cast<uint32_t>(seconds_ms);
+    return true;
+}
+
+/**
+ * @brief Parses a ddmm.mmmm / dddmm.mmmm coordinate and its hemisphere.
+ * @param[in] value Coordinate field.
+ * @param[in] hemisphere Hemisphere field, 'S' and 'W' are negative.
+ * @param[out] value_e7 Coordinate in 1e-7 degrees.
+ * @return False if the coordinate is empty or malformed.
+ */
+bool parse_coordinate(const NmeaField& value, const NmeaField& hemisphere, int32_t& value_e7) {
+    int64_t raw;
+    if (!nmea_parse_fixed(value, 5, raw) || raw < 0) {
+        return false;
+    }
+    int64_t degrees = raw / 10000000;
+    int64_t minutes_e5 = raw % 10000000;
+    int64_t result = degrees * 10000000 + (minutes_e5 * 100 + 30) / 60;
+    if (hemisphere.length == 1 && (hemisphere.data[0] == 'S' || hemisphere.data[0] == 'W')) {
+        result = -result;
+    }
+    value_e7 = static_cast<int32_t>(result);
+    return true;
+}
+
+/**
+ * @brief Parses a field of at most 9 digits, empty fields give 0.
+ * @param[in] field Field to parse.
+ * @param[out] value Parsed value.
+ * @return False if the field contains a non-digit.
+ */
+bool parse_uint(const NmeaField& field, uint32_t& value) {
+    return field.length <= 9 && parse_digits(field.data, field.length, value);
+}
+
+/**
+ * @brief Parses a dilution of precision field into hundredths.
+ * @param[in] field DOP field such as "1.25".
+ * @return DOP in 0.01, 0 if the field is empty or malformed.
+ */
+uint16_t parse_dop(const NmeaField& field) {
+    int64_t dop_c;
+    return nmea_parse_fixed(field, 2, dop_c) && dop_c >= 0 && dop_c <= UINT16_MAX ? static_cast<uint16_t>(dop_c) : 0;
+}
+
+/**
+ * @brief Identifies a sentence from its address, ignoring the talker.
+ * @param[in] address Field 0, e.g. "GNRMC".
+ * @return Sentence type, UNKNOWN for proprietary or unhandled sentences.
+ */
+NmeaSentence sentence_type(const NmeaField& address) {
+    if (address.length != 5 || address.data[0] == 'P') {
+        return NmeaSentence::UNKNOWN;
+    }
+    const char* type = address.data + 2;
+    if (memcmp(type, "RMC", 3) == 0) return NmeaSentence::RMC;
+    if (memcmp(type, "GGA", 3) == 0) return NmeaSentence::GGA;
+    if (memcmp(type, "GSA", 3) == 0) return NmeaSentence::GSA;
+    if (memcmp(type, "GSV", 3) == 0) return NmeaSentence::GSV;
+    return NmeaSentence::UNKNOWN;
+}
+
+/**
+ * @brief Converts a hexadecimal digit.
+ * @return Digit value, -1 if c is not a hexadecimal digit.
+ */
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * @brief Applies RMC fields to a fix.
+ * @details $--RMC,time,status,lat,N/S,lon,E/W,speed_kn,course,date,...
+ */
+bool parse_rmc(const NmeaField* fields, size_t count, GpsFix& fix) {
+    if (count < 10) {
+        return false;
+    }
+
+    uint32_t time_ms;
+    if (parse_time(fields[1], time_ms)) {
+        fix.utc_time_ms = time_ms;
+    }
+
+    fix.rmc_valid = fields[2].length == 1 && fields[2].data[0] == 'A';
+
+    if (!parse_coordinate(fields[3], fields[4], fix.latitude_e7)) {
+        fix.latitude_e7 = 0;
+    }
+    if (!parse_coordinate(fields[5], fields[6], fix.longitude_e7)) {
+        fix.longitude_e7 = 0;
+    }
+
+    int64_t knots_e3;
+    fix.speed_mmps = nmea_parse_fixed(fields[7], 3, knots_e3) && knots_e3 > 0 ?
+        static_cast<uint32_t>(knots_e3 * 514444 / 1000000) : 0;
+
+    int64_t course_e2;
+    fix.course_cdeg = nmea_parse_fixed(fields[8], 2, course_e2) && course_e2 >= 0 && course_e2 < 36000 ?
+        static_cast<uint16_t>(course_e2) : 0;
+
+    uint32_t day, month, year;
+    if (fields[9].length == 6 && parse_digits(fields[9].data, 2, day) &&
+        parse_digits(fields[9].data + 2, 2, month) && parse_digits(fields[9].data + 4, 2, year)) {
+        fix.day = day;
+        fix.month = month;
+        fix.year = year;
+    }
+
+    fix.sentences |= GPS_FIX_HAS_RMC;
+    return true;
+}
+
+/**
+ * @brief Applies GGA fields to a fix.
+ * @details $--GGA,time,lat,N/S,lon,E/W,quality,satellites,hdop,altitude,M,...
+ */
+bool parse_gga(const NmeaField* fields, size_t count, GpsFix& fix) {
+    if (count < 10) {
+        return false;
+    }
+
+    uint32_t quality, satellites;
+    if (!parse_uint(fields[6], quality) || !parse_uint(fields[7], satellites)) {
+        return false;
+    }
+    fix.fix_quality = quality;
+    fix.satellites = satellites;
+
+    int64_t altitude_mm;
+    fix.altitude_mm = nmea_parse_fixed(fields[9], 3, altitude_mm) ? static_cast<int32_t>(altitude_mm) : 0;
+
+    fix.sentences |= GPS_FIX_HAS_GGA;
+    return true;
+}
+
+/**
+ * @brief Applies GSA fields to a fix.
+ * @details $--GSA,mode,fix_type,prn1,...,prn12,pdop,hdop,vdop[,system]
+ *          Multi-constellation receivers send one GSA per system in a row, so
+ *          used satellites are summed while GSA sentences follow each other.
+ */
+bool parse_gsa(const NmeaField* fields, size_t count, GpsFix& fix) {
+    if (count < 18) {
+        return false;
+    }
+
+    uint32_t fix_type;
+    if (!parse_uint(fields[2], fix_type)) {
+        return false;
+    }
+
+    uint8_t used = 0;
+    for (size_t i = 3; i <= 14; i++) {
+        if (fields[i].length) {
+            used++;
+        }
+    }
+
+    bool same_epoch = fix.last_sentence == static_cast<uint8_t>(NmeaSentence::GSA);
+    fix.satellites_used = same_epoch ? fix.satellites_used + used : used;
+    fix.fix_type = fix_type;
+    fix.pdop_c = parse_dop(fields[15]);
+    fix.hdop_c = parse_dop(fields[16]);
+    fix.vdop_c = parse_dop(fields[17]);
+
+    fix.sentences |= GPS_FIX_HAS_GSA;
+    return true;
+}
+
+/**
+ * @brief Applies GSV fields to a fix.
+ * @details $--GSV,messages,message,in_view,{prn,elevation,azimuth,snr}x1..4[,signal]
+ *          The first message of a system drops that system's satellites, the
+ *          following ones append until GPS_MAX_SATELLITES is reached.
+ */
+bool parse_gsv(const NmeaField* fields, size_t count, char system, GpsFix& fix) {
+    uint32_t message;
+    if (count < 4 || !parse_uint(fields[2], message)) {
+        return false;
+    }
+
+    if (message == 1) {
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < fix.satellite_count; i++) {
+            if (fix.satellites_in_view[i].system != system) {
+                fix.satellites_in_view[kept++] = fix.satellites_in_view[i];
+            }
+        }
+        fix.satellite_count = kept;
+    }
+
+    for (size_t i = 4; i + 3 < count; i += 4) {
+        uint32_t prn, elevation, snr;
+        if (!fields[i].length) {
+            continue;
+        }
+        if (!parse_uint(fields[i], prn) || !parse_uint(fields[i + 1], elevation) || !parse_uint(fields[i + 3], snr)) {
+            return false;
+        }
+        if (fix.satellite_count < GPS_MAX_SATELLITES) {
+            fix.satellites_in_view[fix.satellite_count++] = {system, static_cast<uint8_t>(prn),
+                                                             static_cast<uint8_t>(elevation), static_cast<uint8_t>(snr)};
+        }
+    }
+
+    fix.sentences |= GPS_FIX_HAS_GSV;
+    return true;
+}
+
+} // namespace
+
+
+/**
+ * @brief Splits a sentence into fields without copying.
+ * @param[in] sentence Sentence starting with '$', optionally ending with "*hh".
+ * @param[in] length Number of characters in sentence.
+ * @param[out] fields Receives up to max_fields fields.
+ * @param[in] max_fields Size of fields.
+ * @return Number of fields found, 0 if the sentence does not start with '$'.
+ * @ingroup Location
+ */
+size_t nmea_split_fields(const char* sentence, size_t length, NmeaField* fields, size_t max_fields) {
+    if (length == 0 || sentence[0] != '$') {
+        return 0;
+    }
+
+    size_t count = 0;
+    size_t start = 1;
+    for (size_t i = 1; i <= length && count < max_fields; i++) {
+        if (i == length || sentence[i] == ',' || sentence[i] == '*') {
+            fields[count].data = sentence + start;
+            fields[count].length = static_cast<uint8_t>(i - start);
+            count++;
+            start = i + 1;
+            if (i < length && sentence[i] == '*') {
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+
+/**
+ * @brief Verifies the "*hh" checksum of a sentence.
+ * @param[in] sentence Sentence starting with '$'.
+ * @param[in] length Number of characters in sentence.
+ * @return True if the sentence ends with "*hh" matching the XOR of the characters between '$' and '*'.
+ * @ingroup Location
+ */
+bool nmea_verify_checksum(const char* sentence, size_t length) {
+    if (length < 4 || sentence[0] != '$' || sentence[length - 3] != '*') {
+        return false;
+    }
+
+    uint8_t checksum = 0;
+    for (size_t i = 1; i < length - 3; i++) {
+        checksum ^= static_cast<uint8_t>(sentence[i]);
+    }
+
+    int high = hex_value(sentence[length - 2]);
+    int low = hex_value(sentence[length - 1]);
+    return high >= 0 && low >= 0 && checksum == ((high << 4) | low);
+}
+
+
+/**
+ * @brief Parses a decimal field into a fixed-point integer.
+ * @param[in] field Field such as "-12.345".
+ * @param[in] decimals Number of decimals of the result, extra digits are truncated.
+ * @param[out] value Field value multiplied by 10^decimals.
+ * @return False if the field is empty or not a number.
+ * @ingroup Location
+ */
+bool nmea_parse_fixed(const NmeaField& field, uint8_t decimals, int64_t& value) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < field.length && (field.data[i] == '-' || field.data[i] == '+')) {
+        negative = field.data[i] == '-';
+        i++;
+    }
+
+    int64_t result = 0;
+    bool digits = false;
+    bool fraction = false;
+    uint8_t fraction_digits = 0;
+    for (; i < field.length; i++) {
+        char c = field.data[i];
+        if (c == '.' && !fraction) {
+            fraction = true;
+        } else if (c >= '0' && c <= '9') {
+            digits = true;
+            if (fraction) {
+                if (fraction_digits == decimals) {
+                    continue;
+                }
+                fraction_digits++;
+            }
+            result = result * 10 + (c - '0');
+        } else {
+            return false;
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+
+    for (; fraction_digits < decimals; fraction_digits++) {
+        result *= 10;
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+
+/**
+ * @brief Parses one sentence into a fix.
+ * @param[in] sentence Sentence starting with '$'.
+ * @param[in] length Number of characters in sentence.
+ * @param[in,out] fix Fix whose fields covered by the sentence are replaced.
+ * @param[out] type Type of the sentence, set as soon as its address is read.
+ * @return OK if the fix was updated, otherwise why the sentence was rejected.
+ * @ingroup Location
+ */
+NmeaStatus nmea_parse_sentence(const char* sentence, size_t length, GpsFix& fix, NmeaSentence& type) {
+    type = NmeaSentence::UNKNOWN;
+
+    NmeaField fields[NMEA_MAX_FIELDS];
+    size_t count = nmea_split_fields(sentence, length, fields, NMEA_MAX_FIELDS);
+    if (count == 0) {
+        return NmeaStatus::MALFORMED;
+    }
+
+    type = sentence_type(fields[0]);
+    if (!nmea_verify_checksum(sentence, length)) {
+        return NmeaStatus::BAD_CHECKSUM;
+    }
+
+    bool parsed;
+    switch (type) {
+        case NmeaSentence::RMC:
+            parsed = parse_rmc(fields, count, fix);
+            break;
+        case NmeaSentence::GGA:
+            parsed = parse_gga(fields, count, fix);
+            break;
+        case NmeaSentence::GSA:
+            parsed = parse_gsa(fields, count, fix);
+            break;
+        case NmeaSentence::GSV:
+            parsed = parse_gsv(fields, count, fields[0].data[1], fix);
+            break;
+        default:
+            return NmeaStatus::UNSUPPORTED;
+    }
+    if (!parsed) {
+        return NmeaStatus::MALFORMED;
+    }
+
+    fix.last_sentence = static_cast<uint8_t>(type);
+    return NmeaStatus::OK;
+}
+
+
+/**
+ * @brief Formats a coordinate in NMEA ddmm.mmmmm / dddmm.mmmmm notation.
+ * @param[out] buffer Output buffer.
+ * @param[in] size Size of buffer.
+ * @param[in] value_e7 Coordinate in 1e-7 degrees, the sign is not printed.
+ * @param[in] latitude True for two degree digits, false for three.
+ * @return Result of snprintf.
+ * @ingroup Location
+ */
+int nmea_format_coordinate(char* buffer, size_t size, int32_t value_e7, bool latitude) {
+    uint32_t magnitude = value_e7 < 0 ? -static_cast<int64_t>(value_e7) : value_e7;
+    unsigned degrees = magnitude / 10000000;
+    unsigned minutes_e5 = (static_cast<uint64_t>(magnitude % 10000000) * 60 + 50) / 100;
+    if (minutes_e5 >= 6000000) {
+        degrees++;
+        minutes_e5 -= 6000000;
+    }
+    return snprintf(buffer, size, latitude ? "%02u%02u.%05u" : "%03u%02u.%05u",
+                    degrees, minutes_e5 / 100000, minutes_e5 % 100000);
+}
+/** @} */
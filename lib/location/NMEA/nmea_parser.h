@@ -0,0 +1,204 @@
+/**
+ * @file nmea_parser.h
+ * @brief Allocation-free NMEA 0183 parser.
+ *
+ * @details Sentences are tokenized in place: each field is a pointer into the
+ *          receive buffer and a length, so parsing a sentence performs no copies
+ *          and no heap allocation. RMC, GGA, GSA and GSV fields are converted
+ *          straight to integers in a GpsFix, without going through strings or
+ *          floats.
+ *
+ *          Every sentence must carry a valid "*hh" checksum. Sentences are
+ *          dispatched on their three letter type, so any talker ($GP, $GN,
+ *          $GL, $GA, $GB, ...) is accepted.
+ *
+ * @defgroup Location Location
+ * @brief Classes for handling location data.
+ *
+ * @{
+ */
+
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Maximum number of fields of a sentence that are tokenized.
+ */
+#define NMEA_MAX_FIELDS 24
+
+/** @brief GpsFix::sentences bit set once an RMC sentence was parsed. */
+#define GPS_FIX_HAS_RMC 0x01
+/** @brief GpsFix::sentences bit set once a GGA sentence was parsed. */
+#define GPS_FIX_HAS_GGA 0x02
+/** @brief GpsFix::sentences bit set once a GSA sentence was parsed. */
+#define GPS_FIX_HAS_GSA 0x04
+/** @brief GpsFix::sentences bit set once a GSV sentence was parsed. */
+#define GPS_FIX_HAS_GSV 0x08
+
+/**
+ * @brief Number of satellites in view kept in a GpsFix.
+ */
+#define GPS_MAX_SATELLITES 32
+
+/**
+ * @brief Satellite in view reported by GSV.
+ * @ingroup Location
+ */
+struct GpsSatellite {
+    /** @brief Second letter of the talker: 'P' GPS, 'L' GLONASS, 'A' Galileo, 'B' BeiDou. */
+    char system;
+    /** @brief Satellite PRN number. */
+    uint8_t prn;
+    /** @brief Elevation in degrees. */
+    uint8_t elevation;
+    /** @brief Signal to noise ratio in dB-Hz, 0 if not tracked. */
+    uint8_t snr;
+};
+
+/**
+ * @brief Position, velocity and time decoded from NMEA sentences.
+ * @details Plain data in fixed point, cheap to copy between cores.
+ * @ingroup Location
+ */
+struct GpsFix {
+    /** @brief UTC time of day in milliseconds (RMC). */
+    uint32_t utc_time_ms;
+    /** @brief Latitude in 1e-7 degrees, north positive (RMC). */
+    int32_t latitude_e7;
+    /** @brief Longitude in 1e-7 degrees, east positive (RMC). */
+    int32_t longitude_e7;
+    /** @brief Altitude above mean sea level in millimetres (GGA). */
+    int32_t altitude_mm;
+    /** @brief Speed over ground in millimetres per second (RMC). */
+    uint32_t speed_mmps;
+    /** @brief Course over ground in 0.01 degrees (RMC). */
+    uint16_t course_cdeg;
+    /** @brief UTC day of month, 1-31, 0 if unknown (RMC). */
+    uint8_t day;
+    /** @brief UTC month, 1-12, 0 if unknown (RMC). */
+    uint8_t month;
+    /** @brief UTC year minus 2000 (RMC). */
+    uint8_t year;
+    /** @brief Fix quality, 0 invalid, 1 GPS, 2 DGPS, ... (GGA). */
+    uint8_t fix_quality;
+    /** @brief Satellites used in the solution (GGA). */
+    uint8_t satellites;
+    /** @brief RMC status is 'A' (data valid). */
+    bool rmc_valid;
+    /** @brief GPS_FIX_HAS_* bits of the sentences parsed so far. */
+    uint8_t sentences;
+    /** @brief Fix type, 1 none, 2 2D, 3 3D (GSA). */
+    uint8_t fix_type;
+    /** @brief Satellites used in the solution, summed over consecutive GSA sentences. */
+    uint8_t satellites_used;
+    /** @brief Position dilution of precision in 0.01 (GSA). */
+    uint16_t pdop_c;
+    /** @brief Horizontal dilution of precision in 0.01 (GSA). */
+    uint16_t hdop_c;
+    /** @brief Vertical dilution of precision in 0.01 (GSA). */
+    uint16_t vdop_c;
+    /** @brief Type of the last sentence parsed, used to group GSA sentences of one epoch. */
+    uint8_t last_sentence;
+    /** @brief Number of entries in satellites_in_view. */
+    uint8_t satellite_count;
+    /** @brief Satellites in view (GSV), replaced per system on the first GSV message. */
+    GpsSatellite satellites_in_view[GPS_MAX_SATELLITES];
+};
+
+/**
+ * @brief One field of a sentence, pointing into the sentence buffer.
+ * @ingroup Location
+ */
+struct NmeaField {
+    /** @brief First character of the field. */
+    const char* data;
+    /** @brief Number of characters, 0 for an empty field. */
+    uint8_t length;
+};
+
+/**
+ * @brief Sentence types understood by the parser.
+ * @ingroup Location
+ */
+enum class NmeaSentence : uint8_t {
+    /** @brief Not parsed. */
+    UNKNOWN = 0,
+    /** @brief Recommended minimum data. */
+    RMC,
+    /** @brief Fix data. */
+    GGA,
+    /** @brief DOP and active satellites. */
+    GSA,
+    /** @brief Satellites in view. */
+    GSV,
+    /** @brief Number of sentence types. */
+    COUNT
+};
+
+/**
+ * @brief Outcome of parsing a sentence.
+ * @ingroup Location
+ */
+enum class NmeaStatus : uint8_t {
+    /** @brief Sentence parsed into the fix. */
+    OK = 0,
+    /** @brief Valid sentence of a type the parser does not handle. */
+    UNSUPPORTED,
+    /** @brief Missing or wrong "*hh" checksum. */
+    BAD_CHECKSUM,
+    /** @brief Too few fields or malformed fields. */
+    MALFORMED
+};
+
+/**
+ * @brief Splits a sentence into fields without copying.
+ * @param[in] sentence Sentence starting with '$', optionally ending with "*hh".
+ * @param[in] length Number of characters in sentence.
+ * @param[out] fields Receives up to max_fields fields. Field 0 is the address, e.g. "GPRMC".
+ * @param[in] max_fields Size of fields.
+ * @return Number of fields found, 0 if the sentence does not start with '$'.
+ */
+size_t nmea_split_fields(const char* sentence, size_t length, NmeaField* fields, size_t max_fields);
+
+/**
+ * @brief Verifies the "*hh" checksum of a sentence.
+ * @param[in] sentence Sentence starting with '$'.
+ * @param[in] length Number of characters in sentence.
+ * @return True if the sentence ends with "*hh" matching the XOR of the characters between '$' and '*'.
+ */
+bool nmea_verify_checksum(const char* sentence, size_t length);
+
+/**
+ * @brief Parses a decimal field into a fixed-point integer.
+ * @param[in] field Field such as "-12.345".
+ * @param[in] decimals Number of decimals of the result, extra digits are truncated.
+ * @param[out] value Field value multiplied by 10^decimals.
+ * @return False if the field is empty or not a number.
+ */
+bool nmea_parse_fixed(const NmeaField& field, uint8_t decimals, int64_t& value);
+
+/**
+ * @brief Parses one sentence into a fix.
+ * @param[in] sentence Sentence starting with '$'.
+ * @param[in] length Number of characters in sentence.
+ * @param[in,out] fix Fix whose fields covered by the sentence are replaced.
+ * @param[out] type Type of the sentence, set as soon as its address is read.
+ * @return OK if the fix was updated, otherwise why the sentence was rejected.
+ */
+NmeaStatus nmea_parse_sentence(const char* sentence, size_t length, GpsFix& fix, NmeaSentence& type);
+
+/**
+ * @brief Formats a coordinate in NMEA ddmm.mmmmm / dddmm.mmmmm notation.
+ * @param[out] buffer Output buffer.
+ * @param[in] size Size of buffer.
+ * @param[in] value_e7 Coordinate in 1e-7 degrees, the sign is not printed.
+ * @param[in] latitude True for two degree digits, false for three.
+ * @return Result of snprintf.
+ */
+int nmea_format_coordinate(char* buffer, size_t size, int32_t value_e7, bool latitude);
+
+#endif // NMEA_PARSER_H
+/** @} */
@@ -15,13 +15,11 @@
 #include "lib/location/gps_collector.h"
 #include "utils.h"
 #include "pico/time.h"
-#include "lib/location/NMEA/nmea_data.h"
+#include "lib/location/NMEA/NMEA_data.h"
+#include "lib/location/NMEA/nmea_parser.h"
+#include "lib/location/gps_uart_rx.h"
 #include "event_manager.h"
-#include <vector>
-#include <ctime>
-#include <cstring>
-#include "DS3231.h"
-#include <sstream>
+#include <array>
 #include "system_state_manager.h"
 
 /**
@@ -30,30 +28,80 @@
 #define MAX_RAW_DATA_LENGTH 256
 
 /**
- * @brief Splits a string into tokens based on a delimiter.
- *
- * @param[in] str The string to split.
- * @param[in] delimiter The delimiter character.
- * @return A vector of strings representing the tokens.
- * @ingroup Location
+ * @brief Number of bytes taken from the receive ring at a time.
+ */
+#define GPS_READ_CHUNK 64
+
+namespace {
+
+/** @brief Sentence being received, kept across calls. */
+std::array<char, MAX_RAW_DATA_LENGTH> raw_data_buffer;
+/** @brief Number of characters in raw_data_buffer. */
+size_t raw_data_index = 0;
+/** @brief Stream position of the first character in raw_data_buffer. */
+uint32_t raw_data_position = 0;
+/** @brief Fix assembled from the sentences parsed so far. */
+GpsFix working_fix = {};
+/** @brief Parser counters, only written by core 1. */
+GpsParseStats parse_stats = {};
+
+/**
+ * @brief Parses a complete sentence and publishes the fix it updated.
+ * @param[in] sentence Sentence starting with '$'.
+ * @param[in] length Number of characters in sentence.
+ * @param[in] position Stream position of the first character.
+ * @details A position is timestamped with the reception of its '$', or with
+ *          the parse time if the receive ring no longer knows it.
  */
-std::vector<std::string> splitString(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
-    while (std::getline(ss, token, delimiter)) {
-        tokens.push_back(token);
+void handle_sentence(const char* sentence, size_t length, uint32_t position) {
+    uint32_t start_us = time_us_32();
+    NmeaSentence type;
+    NmeaStatus status = nmea_parse_sentence(sentence, length, working_fix, type);
+    uint32_t elapsed_us = time_us_32() - start_us;
+
+    parse_stats.sentences++;
+    parse_stats.total_parse_us += elapsed_us;
+    if (elapsed_us > parse_stats.max_parse_us) {
+        parse_stats.max_parse_us = elapsed_us;
+    }
+
+    size_t index = static_cast<size_t>(type);
+    switch (status) {
+        case NmeaStatus::OK: {
+            parse_stats.accepted[index]++;
+            uint64_t received_us;
+            if (!gps_uart_rx_sentence_time(position, received_us)) {
+                received_us = time_us_64();
+            }
+            NMEAData::get_instance().update_fix(working_fix, type == NmeaSentence::RMC && working_fix.rmc_valid,
+                                                static_cast<uint32_t>(received_us / 1000));
+            break;
+        }
+        case NmeaStatus::UNSUPPORTED:
+            parse_stats.unsupported++;
+            break;
+        case NmeaStatus::BAD_CHECKSUM:
+            parse_stats.checksum_errors++;
+            parse_stats.rejected[index]++;
+            break;
+        default:
+            parse_stats.rejected[index]++;
+            break;
     }
-    return tokens;
 }
 
+} // namespace
+
+
 /**
  * @brief Collects GPS data from the UART and updates the NMEA data.
  *
- * @details This function reads raw NMEA sentences from the GPS UART,
- *          parses them, and updates the RMC and GGA tokens in the
- *          NMEAData singleton. It also handles buffer overflow and
- *          checks for bootloader reset pending status.
+ * @details Bytes are taken from the interrupt-fed receive ring (gps_uart_rx.h)
+ *          and accumulated in a static buffer, so a sentence split
+ *          across two calls is completed on the next call. Complete sentences
+ *          are checked and parsed in place into a GpsFix, which is published to
+ *          the NMEAData singleton after every accepted sentence. No heap memory
+ *          is used.
  * @ingroup Location
  */
 void collect_gps_data() {
@@ -62,36 +110,39 @@ void collect_gps_data() {
         return;
     }
 
-    std::array<char, MAX_RAW_DATA_LENGTH> raw_data_buffer;
-    static int raw_data_index = 0;
-
-    while (uart_is_readable(GPS_UART_PORT)) {
-        char c = uart_getc(GPS_UART_PORT);
-
-        if (c == '\r' || c == '\n') {
-            // End of message
-            if (raw_data_index > 0) {
-                raw_data_buffer[raw_data_index] = '\0';
-                std::string message(raw_data_buffer.data());
-                raw_data_index = 0;
+    char chunk[GPS_READ_CHUNK];
+    size_t count;
+    uint32_t position = gps_uart_rx_position();
+    while ((count = gps_uart_rx_read(chunk, sizeof(chunk))) > 0) {
+        for (size_t i = 0; i < count; i++, position++) {
+            char c = chunk[i];
 
-                // Split the message into tokens
-                std::vector<std::string> tokens = splitString(message, ',');
-
-                // Update the global vectors based on the sentence type
-                if (message.find("$GPRMC") == 0) {
-                    NMEAData::get_instance().update_rmc_tokens(tokens);
-                } else if (message.find("$GPGGA") == 0) {
-                    NMEAData::get_instance().update_gga_tokens(tokens);
+            if (c == '\r' || c == '\n') {
+                // End of message
+                if (raw_data_index > 0) {
+                    handle_sentence(raw_data_buffer.data(), raw_data_index, raw_data_position);
+                    raw_data_index = 0;
+                }
+            } else if (raw_data_index < MAX_RAW_DATA_LENGTH) {
+                if (raw_data_index == 0) {
+                    raw_data_position = position;
                 }
-            }
-        } else {
-            if (raw_data_index < MAX_RAW_DATA_LENGTH - 1) {
                 raw_data_buffer[raw_data_index++] = c;
             } else {
+                parse_stats.overflows++;
                 raw_data_index = 0;
             }
         }
     }
 }
-/** @} */
\ No newline at end of file
+
+
+/**
+ * @brief Gets the parser counters.
+ * @return Copy of the counters.
+ * @ingroup Location
+ */
+GpsParseStats get_gps_parse_stats() {
+    return parse_stats;
+}
+/** @} */
@@ -15,21 +15,50 @@
 #ifndef GPS_COLLECTOR_H
 #define GPS_COLLECTOR_H
 
-#include <string>
+#include <cstdint>
 #include "hardware/uart.h"
-#include "lib/location/NMEA/nmea_data.h" // Include the new header
+#include "lib/location/NMEA/NMEA_data.h"
 #include "pin_config.h"
 
+/**
+ * @brief Counters of the NMEA parser.
+ * @ingroup Location
+ */
+struct GpsParseStats {
+    /** @brief Complete lines passed to the parser. */
+    uint32_t sentences;
+    /** @brief Sentences parsed into the fix, indexed by NmeaSentence. */
+    uint32_t accepted[static_cast<size_t>(NmeaSentence::COUNT)];
+    /** @brief Sentences rejected for a bad checksum or malformed fields, indexed by NmeaSentence. */
+    uint32_t rejected[static_cast<size_t>(NmeaSentence::COUNT)];
+    /** @brief Rejections caused by a missing or wrong checksum. */
+    uint32_t checksum_errors;
+    /** @brief Valid sentences of types the parser does not handle. */
+    uint32_t unsupported;
+    /** @brief Lines dropped because they did not fit the receive buffer. */
+    uint32_t overflows;
+    /** @brief Sum of the parse times in microseconds. */
+    uint32_t total_parse_us;
+    /** @brief Longest parse time in microseconds. */
+    uint32_t max_parse_us;
+};
+
 /**
  * @brief Collects GPS data from the UART and updates the NMEA data.
  *
  * @details This function reads raw NMEA sentences from the GPS UART,
- *          parses them, and updates the RMC and GGA tokens in the
- *          NMEAData singleton. It also handles buffer overflow and
- *          checks for bootloader reset pending status.
+ *          parses them in place, and publishes the resulting GpsFix to the
+ *          NMEAData singleton. Runs on core 1.
  * @ingroup Location
  */
 void collect_gps_data();
 
+/**
+ * @brief Gets the parser counters.
+ * @return Copy of the counters.
+ * @ingroup Location
+ */
+GpsParseStats get_gps_parse_stats();
+
 #endif
  /** @} */
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "gps_config.h"
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "lib/location/gps_uart_rx.h"
+#include "event_manager.h"
+#include "system_state_manager.h"
+#include "utils.h"
+
+/**
+ * @file gps_config.cpp
+ * @brief Implementation of the GPS receiver configuration stage
+ * @ingroup Location
+ */
+
+namespace {
+
+/**
+ * @brief Baud rates a receiver can be switched to.
+ */
+constexpr uint32_t SUPPORTED_BAUDS[] = {9600, 19200, 38400, 57600, 115200};
+
+/**
+ * @brief Checks whether a baud rate is supported.
+ */
+bool is_supported_baud(uint32_t baud) {
+    for (uint32_t supported : SUPPORTED_BAUDS) {
+        if (baud == supported) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void uart_link_write(void*, const uint8_t* data, size_t length) {
+    uart_write_blocking(GPS_UART_PORT, data, length);
+}
+
+size_t uart_link_read(void*, char* buffer, size_t length) {
+    return gps_uart_rx_read(buffer, length);
+}
+
+uint32_t uart_link_now_ms(void*) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+void uart_link_sleep_ms(void*, uint32_t ms) {
+    sleep_ms(ms);
+}
+
+} // namespace
+
+
+GpsConfigManager& GpsConfigManager::get_instance() {
+    static GpsConfigManager instance;
+    return instance;
+}
+
+/**
+ * @brief Link callback switching the GPS UART.
+ * @details Waits for the command in flight to leave at the old rate first.
+ */
+void GpsConfigManager::link_set_baud(void* context, uint32_t baud) {
+    uart_tx_wait_blocking(GPS_UART_PORT);
+    uart_set_baudrate(GPS_UART_PORT, baud);
+    static_cast<GpsConfigManager*>(context)->current_baud.store(baud);
+}
+
+
+/**
+ * @brief Runs the configuration with the requested settings.
+ * @return Resulting state.
+ * @details Runs gps_config_run() over the GPS UART and its receive ring.
+ */
+GpsConfigState GpsConfigManager::configure() {
+    GpsConfigLink link = {this, uart_link_write, uart_link_read, link_set_baud, uart_link_now_ms, uart_link_sleep_ms};
+    uint32_t fallbacks = status.fallbacks;
+    status.baud = current_baud.load();
+
+    gps_config_run(link, status, requested_receiver, requested_baud, requested_rate_hz);
+
+    if (status.fallbacks != fallbacks) {
+        uart_print("GPS silent at " + std::to_string(requested_baud) + " baud, fell back", VerbosityLevel::WARNING);
+    }
+    if (status.state == GpsConfigState::NO_RECEIVER) {
+        uart_print("GPS config: no receiver answering", VerbosityLevel::ERROR);
+        EventEmitter::emit(EventGroup::GPS, GPSEvent::ERROR);
+        return status.state;
+    }
+
+    bool complete = status.state == GpsConfigState::CONFIGURED;
+    uart_print("GPS config (" + std::string(gps_receiver_profile(status.receiver).name) + "): " +
+               std::to_string(current_baud.load()) + " baud, " + std::to_string(status.rate_hz) + " Hz, " +
+               (complete ? "complete" : "partial"),
+               complete ? VerbosityLevel::INFO : VerbosityLevel::WARNING);
+    return status.state;
+}
+
+
+/**
+ * @brief Requests a configuration run with new settings.
+ * @param receiver Receiver type.
+ * @param baud Baud rate, one of 9600, 19200, 38400, 57600, 115200.
+ * @param rate_hz Navigation rate, 1 to GPS_CONFIG_MAX_RATE_HZ.
+ * @return True if the settings are valid; the run happens in process().
+ * @details Called from the command handler on core 0; the settings are
+ *          published to core 1 by the release store of pending.
+ */
+bool GpsConfigManager::request_configure(GpsReceiverType receiver, uint32_t baud, uint32_t rate_hz) {
+    if (receiver >= GpsReceiverType::COUNT || !is_supported_baud(baud) ||
+        rate_hz == 0 || rate_hz > GPS_CONFIG_MAX_RATE_HZ) {
+        return false;
+    }
+    requested_receiver = receiver;
+    requested_baud = baud;
+    requested_rate_hz = rate_hz;
+    pending.store(true, std::memory_order_release);
+    return true;
+}
+
+
+void GpsConfigManager::request_reconfigure() {
+    pending.store(true, std::memory_order_release);
+}
+
+
+/**
+ * @brief Runs a requested configuration.
+ * @details Waits while the GPS is powered off or in pass-through mode; a power
+ *          on requests a new run since the receiver then restarts at its defaults.
+ */
+void GpsConfigManager::process() {
+    if (!pending.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (SystemStateManager::get_instance().is_gps_collection_paused() || !gpio_get(GPS_POWER_ENABLE_PIN)) {
+        return;
+    }
+    pending.store(false);
+    configure();
+}
+
+
+GpsConfigStatus GpsConfigManager::get_status() const {
+    GpsConfigStatus copy = status;
+    copy.baud = current_baud.load();
+    return copy;
+}
@@ -0,0 +1,259 @@
+#ifndef GPS_CONFIG_H
+#define GPS_CONFIG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "pin_config.h"
+
+/**
+ * @file gps_config.h
+ * @brief Startup configuration of the GPS receiver
+ * @details At power-on the receiver talks at 9600 baud, outputs every sentence
+ *          it knows and computes one fix per second. The configuration stage
+ *          switches it to a higher baud rate, enables only the sentences the
+ *          parser uses (RMC, GGA, GSA and a decimated GSV) and raises the
+ *          navigation rate.
+ *
+ *          Receiver commands are produced by a GpsReceiverProfile, so supporting
+ *          another module means adding a profile: MediaTek PMTK and u-blox UBX are
+ *          provided. Each step is verified: output and rate changes by the
+ *          receiver's ACK, a baud change by a checksummed NMEA sentence received
+ *          at the new rate. If the receiver does not answer at the new baud rate,
+ *          both sides fall back to GPS_UART_BAUD_RATE.
+ *
+ *          The profiles and the sequence (gps_receiver.cpp) have no SDK
+ *          dependency and talk to the receiver through a GpsConfigLink;
+ *          tools/gps_config_sim.cpp runs them against a scripted receiver.
+ *
+ *          The configuration owns the GPS UART while it runs, so it is executed
+ *          on core 1 between two collect_gps_data() calls. The baud rate it leaves
+ *          the UART at is returned by get_baud_rate() and must be used by any other
+ *          code talking to the receiver.
+ *
+ * @defgroup Location Location
+ * @brief Classes for handling location data.
+ * @{
+ */
+
+/**
+ * @brief Receiver command sets.
+ */
+enum class GpsReceiverType : uint8_t {
+    MTK = 0, /**< MediaTek / Quectel PMTK NMEA commands */
+    UBX = 1, /**< u-blox UBX binary protocol */
+    COUNT    /**< Number of receiver types */
+};
+
+/**
+ * @brief Outcome of scanning received bytes for a command acknowledgement.
+ */
+enum class GpsAckResult : uint8_t {
+    NONE = 0, /**< No acknowledgement for the command seen yet */
+    ACK,      /**< Command accepted */
+    NACK      /**< Command rejected */
+};
+
+/**
+ * @brief Bytes collected while looking for an acknowledgement.
+ */
+struct GpsAckScanner {
+    uint8_t data[80]; /**< Current NMEA line or last UBX frame bytes */
+    size_t length;    /**< Bytes in data */
+};
+
+/**
+ * @brief Command builders and ACK parser of one receiver type.
+ * @details Builders write one complete command (framing and checksum included)
+ *          and return its length, 0 if it does not fit. They and scan_ack are
+ *          pure functions of their arguments, so they can be checked off target.
+ */
+struct GpsReceiverProfile {
+    /** @brief Profile name used in logs. */
+    const char* name;
+    /** @brief Builds the command switching the receiver UART to a baud rate. */
+    size_t (*build_baud)(uint32_t baud, uint8_t* out, size_t size);
+    /** @brief Builds the command setting the navigation rate in Hz. */
+    size_t (*build_rate)(uint32_t rate_hz, uint8_t* out, size_t size);
+    /**
+     * @brief Builds the index-th sentence output command.
+     * @return Command length, 0 once index is past the last command.
+     */
+    size_t (*build_output)(uint8_t index, uint8_t* out, size_t size);
+    /**
+     * @brief Feeds one received byte to the ACK parser.
+     * @param scanner Parser state, cleared before each command.
+     * @param byte Received byte.
+     * @param command Command waiting for its acknowledgement.
+     * @param command_length Length of command.
+     */
+    GpsAckResult (*scan_ack)(GpsAckScanner& scanner, uint8_t byte, const uint8_t* command, size_t command_length);
+};
+
+/**
+ * @brief Gets the profile of a receiver type.
+ * @param type Receiver type, below GpsReceiverType::COUNT.
+ * @return Profile.
+ */
+const GpsReceiverProfile& gps_receiver_profile(GpsReceiverType type);
+
+/**
+ * @brief Receiver type configured at boot.
+ */
+static constexpr GpsReceiverType GPS_CONFIG_DEFAULT_RECEIVER = GpsReceiverType::MTK;
+
+/**
+ * @brief Baud rate requested at boot.
+ */
+static constexpr uint32_t GPS_CONFIG_DEFAULT_BAUD = 115200;
+
+/**
+ * @brief Navigation rate requested at boot in Hz.
+ */
+static constexpr uint32_t GPS_CONFIG_DEFAULT_RATE_HZ = 5;
+
+/**
+ * @brief Highest navigation rate accepted in Hz.
+ */
+static constexpr uint32_t GPS_CONFIG_MAX_RATE_HZ = 10;
+
+/**
+ * @brief Largest framed command any profile builds (the MTK PMTK314 output
+ *        sentence is 51 bytes).
+ */
+static constexpr size_t GPS_CONFIG_MAX_COMMAND = 64;
+
+/**
+ * @brief Time to wait for an acknowledgement.
+ */
+static constexpr uint32_t GPS_CONFIG_ACK_TIMEOUT_MS = 1000;
+
+/**
+ * @brief Time to wait for a valid sentence when checking a baud rate.
+ */
+static constexpr uint32_t GPS_CONFIG_PROBE_TIMEOUT_MS = 1500;
+
+/**
+ * @brief Result of the last configuration run.
+ */
+enum class GpsConfigState : uint8_t {
+    DEFAULT = 0,  /**< Not configured, receiver at its power-on settings */
+    CONFIGURED,   /**< Every step acknowledged */
+    PARTIAL,      /**< Receiver answering, but a step was rejected or fell back */
+    NO_RECEIVER   /**< No valid sentence at any baud rate tried */
+};
+
+/**
+ * @brief Configuration settings and counters.
+ */
+struct GpsConfigStatus {
+    GpsReceiverType receiver; /**< Receiver type in use */
+    uint32_t baud;            /**< Baud rate the GPS UART runs at */
+    uint32_t rate_hz;         /**< Navigation rate acknowledged by the receiver */
+    GpsConfigState state;     /**< Result of the last run */
+    uint32_t acks;            /**< Commands acknowledged */
+    uint32_t nacks;           /**< Commands rejected */
+    uint32_t timeouts;        /**< Commands with no answer */
+    uint32_t fallbacks;       /**< Baud changes reverted to the default */
+    uint32_t duration_ms;     /**< Duration of the last run */
+};
+
+/**
+ * @brief Byte link to the receiver used by a configuration run.
+ */
+struct GpsConfigLink {
+    /** @brief Passed to every callback. */
+    void* context;
+    /** @brief Sends bytes to the receiver. */
+    void (*write)(void* context, const uint8_t* data, size_t length);
+    /** @brief Copies received bytes, returns their number, 0 if none. */
+    size_t (*read)(void* context, char* buffer, size_t length);
+    /** @brief Switches the local UART to a baud rate once the bytes written are sent. */
+    void (*set_baud)(void* context, uint32_t baud);
+    /** @brief Gets the current time in ms. */
+    uint32_t (*now_ms)(void* context);
+    /** @brief Waits a number of ms. */
+    void (*sleep_ms)(void* context, uint32_t ms);
+};
+
+/**
+ * @brief Runs the configuration sequence over a link.
+ * @param link Link to the receiver.
+ * @param status Settings and counters; baud must hold the rate the link runs at and is updated.
+ * @param receiver Receiver type.
+ * @param baud Baud rate to switch to.
+ * @param rate_hz Navigation rate to set.
+ * @return Resulting state, also stored in status.
+ * @details Blocks for up to a few seconds; the counters of status are accumulated.
+ */
+GpsConfigState gps_config_run(const GpsConfigLink& link, GpsConfigStatus& status, GpsReceiverType receiver,
+                              uint32_t baud, uint32_t rate_hz);
+
+/**
+ * @brief Configures the GPS receiver and keeps the GPS UART at the matching baud rate.
+ */
+class GpsConfigManager {
+public:
+    /**
+     * @brief Gets the singleton instance of the GpsConfigManager class.
+     * @return A reference to the singleton instance.
+     */
+    static GpsConfigManager& get_instance();
+
+    /**
+     * @brief Runs the configuration with the requested settings.
+     * @return Resulting state.
+     * @details Blocks for up to a few seconds. Must run on core 1, outside
+     *          collect_gps_data().
+     */
+    GpsConfigState configure();
+
+    /**
+     * @brief Requests a configuration run with new settings.
+     * @param receiver Receiver type.
+     * @param baud Baud rate, one of 9600, 19200, 38400, 57600, 115200.
+     * @param rate_hz Navigation rate, 1 to GPS_CONFIG_MAX_RATE_HZ.
+     * @return True if the settings are valid; the run happens in process().
+     */
+    bool request_configure(GpsReceiverType receiver, uint32_t baud, uint32_t rate_hz);
+
+    /**
+     * @brief Requests a run with the current settings, e.g. after a GPS power cycle.
+     */
+    void request_reconfigure();
+
+    /**
+     * @brief Runs a requested configuration.
+     * @details Called from the core 1 loop.
+     */
+    void process();
+
+    /**
+     * @brief Gets the baud rate the GPS UART runs at.
+     * @return Baud rate.
+     */
+    uint32_t get_baud_rate() const { return current_baud.load(); }
+
+    /**
+     * @brief Gets the settings and counters.
+     * @return Copy of the status.
+     */
+    GpsConfigStatus get_status() const;
+
+private:
+    GpsConfigManager() = default;
+    GpsConfigManager(const GpsConfigManager&) = delete;
+    GpsConfigManager& operator=(const GpsConfigManager&) = delete;
+
+    static void link_set_baud(void* context, uint32_t baud);
+
+    std::atomic<uint32_t> current_baud{GPS_UART_BAUD_RATE};
+    std::atomic<bool> pending{false};
+    GpsReceiverType requested_receiver = GPS_CONFIG_DEFAULT_RECEIVER;
+    uint32_t requested_baud = GPS_CONFIG_DEFAULT_BAUD;
+    uint32_t requested_rate_hz = GPS_CONFIG_DEFAULT_RATE_HZ;
+    GpsConfigStatus status = {GPS_CONFIG_DEFAULT_RECEIVER, GPS_UART_BAUD_RATE, 1, GpsConfigState::DEFAULT, 0, 0, 0, 0, 0};
+};
+
+#endif // GPS_CONFIG_H
+/** @} */
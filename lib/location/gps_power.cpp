@@ -0,0 +1,250 @@
+#include "gps_power.h"
+#include "pico/stdlib.h"
+#include "pin_config.h"
+#include "lib/location/NMEA/NMEA_data.h"
+#include "event_manager.h"
+#include "system_state_manager.h"
+#include "utils.h"
+
+/**
+ * @file gps_power.cpp
+ * @brief Implementation of the duty-cycled GPS power scheduler
+ * @ingroup Location
+ */
+
+GpsPowerScheduler& GpsPowerScheduler::get_instance() {
+    static GpsPowerScheduler instance;
+    return instance;
+}
+
+
+GpsPowerScheduler::GpsPowerScheduler()
+    : profiles{GPS_POWER_USB_PROFILE, GPS_POWER_BATTERY_PROFILE} {
+    mutex_init(&mutex);
+}
+
+
+/**
+ * @brief Opens and closes fix windows.
+ * @param now_ms Current time in ms since boot.
+ * @details The receiver is left alone while the GPS is in pass-through mode.
+ *          A fix is a valid RMC position received after the window opened.
+ */
+void GpsPowerScheduler::process(uint32_t now_ms) {
+    if (SystemStateManager::get_instance().is_gps_collection_paused()) {
+        return;
+    }
+    bool battery = SystemStateManager::get_instance().get_operating_mode() == SystemOperatingMode::BATTERY_POWERED;
+
+    mutex_enter_blocking(&mutex);
+    if (!initialised) {
+        // the pin is set up by init_pico_hw()
+        initialised = true;
+        powered = gpio_get(GPS_POWER_ENABLE_PIN);
+        power_on_ms = now_ms;
+    }
+
+    GpsPowerProfile profile = profiles[battery ? 1 : 0];
+    GpsPowerMode mode = enabled.load() ? profile.mode : GpsPowerMode::OFF;
+    bool changed = profile_changed.exchange(false) || battery != last_battery;
+    last_battery = battery;
+
+    switch (mode) {
+        case GpsPowerMode::OFF:
+            set_power(false, now_ms);
+            state = GpsPowerState::OFF;
+            window_scheduled = false;
+            break;
+
+        case GpsPowerMode::ALWAYS_ON: {
+            set_power(true, now_ms);
+            state = GpsPowerState::ON;
+            window_scheduled = false;
+
+            GpsFixSnapshot snapshot = NMEAData::get_instance().get_snapshot();
+            if (snapshot.fix.rmc_valid && snapshot.age_ms < GPS_FIX_STALE_MS) {
+                has_fix = true;
+                last_fix_ms = now_ms - snapshot.age_ms;
+            }
+            break;
+        }
+
+        case GpsPowerMode::DUTY_CYCLED:
+            if (state == GpsPowerState::ON || (state == GpsPowerState::OFF && !window_scheduled)) {
+                open_window(now_ms, profile.max_window_s);
+            } else if (state == GpsPowerState::OFF) {
+                if (changed && next_window_ms - window_start_ms > profile.period_s * 1000) {
+                    next_window_ms = window_start_ms + profile.period_s * 1000;
+                }
+                if (static_cast<int32_t>(now_ms - next_window_ms) >= 0) {
+                    open_window(now_ms, profile.max_window_s);
+                }
+            } else if (state == GpsPowerState::ACQUIRING) {
+                GpsFixSnapshot snapshot = NMEAData::get_instance().get_snapshot();
+                uint32_t elapsed_ms = now_ms - window_start_ms;
+
+                if (snapshot.fix.rmc_valid && snapshot.age_ms <= elapsed_ms) {
+                    state = GpsPowerState::HOLDING;
+                    fix_ms = now_ms;
+                    stats.fixes++;
+                    last_timed_out = false;
+                    if (window_counted) {
+                        record_ttff(elapsed_ms, warm_start);
+                    }
+                    EventEmitter::emit(EventGroup::GPS, GPSEvent::LOCK);
+                } else if (elapsed_ms >= stats.window_s * 1000) {
+                    stats.timeouts++;
+                    last_timed_out = true;
+                    uart_print("GPS fix window timed out after " + std::to_string(stats.window_s) + " s", VerbosityLevel::WARNING);
+                    EventEmitter::emit(EventGroup::GPS, GPSEvent::LOST);
+                    close_window(now_ms, profile.period_s);
+                }
+            } else if (now_ms - fix_ms >= GPS_POWER_FIX_HOLD_MS) {
+                has_fix = true;
+                last_fix_ms = fix_ms;
+                close_window(now_ms, profile.period_s);
+            }
+            break;
+
+        default:
+            break;
+    }
+    mutex_exit(&mutex);
+}
+
+
+void GpsPowerScheduler::set_enabled(bool enable) {
+    enabled.store(enable);
+    profile_changed.store(true);
+}
+
+
+GpsPowerProfile GpsPowerScheduler::get_profile(bool battery) {
+    mutex_enter_blocking(&mutex);
+    GpsPowerProfile profile = profiles[battery ? 1 : 0];
+    mutex_exit(&mutex);
+    return profile;
+}
+
+
+bool GpsPowerScheduler::set_profile(bool battery, const GpsPowerProfile& profile) {
+    if (profile.mode >= GpsPowerMode::COUNT ||
+        profile.period_s < GPS_POWER_MIN_PERIOD_S || profile.period_s > GPS_POWER_MAX_PERIOD_S ||
+        profile.max_window_s < GPS_POWER_MIN_WINDOW_S || profile.max_window_s > profile.period_s) {
+        return false;
+    }
+    mutex_enter_blocking(&mutex);
+    profiles[battery ? 1 : 0] = profile;
+    mutex_exit(&mutex);
+    profile_changed.store(true);
+    return true;
+}
+
+
+GpsPowerState GpsPowerScheduler::get_state() {
+    mutex_enter_blocking(&mutex);
+    GpsPowerState copy = state;
+    mutex_exit(&mutex);
+    return copy;
+}
+
+
+uint32_t GpsPowerScheduler::get_next_window_s() {
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    uint32_t seconds = 0;
+    mutex_enter_blocking(&mutex);
+    if (state == GpsPowerState::OFF && window_scheduled && static_cast<int32_t>(next_window_ms - now_ms) > 0) {
+        seconds = (next_window_ms - now_ms) / 1000;
+    }
+    mutex_exit(&mutex);
+    return seconds;
+}
+
+
+GpsPowerStats GpsPowerScheduler::get_stats() {
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    mutex_enter_blocking(&mutex);
+    GpsPowerStats copy = stats;
+    if (powered) {
+        copy.on_time_ms += now_ms - power_on_ms;
+    }
+    mutex_exit(&mutex);
+    return copy;
+}
+
+
+// ==================== private methods
+
+/**
+ * @brief Switches the receiver power and accounts its on time.
+ * @param on True to power the receiver.
+ * @param now_ms Current time in ms since boot.
+ */
+void GpsPowerScheduler::set_power(bool on, uint32_t now_ms) {
+    if (powered == on) {
+        return;
+    }
+    powered = on;
+    gpio_put(GPS_POWER_ENABLE_PIN, on);
+
+    if (on) {
+        power_on_ms = now_ms;
+    } else {
+        stats.on_time_ms += now_ms - power_on_ms;
+    }
+    EventEmitter::emit(EventGroup::GPS, on ? GPSEvent::POWER_ON : GPSEvent::POWER_OFF);
+}
+
+
+/**
+ * @brief Powers the receiver for a fix window sized from the expected start.
+ * @param now_ms Current time in ms since boot.
+ * @param max_window_s Longest window of the profile.
+ */
+void GpsPowerScheduler::open_window(uint32_t now_ms, uint32_t max_window_s) {
+    warm_start = has_fix && now_ms - last_fix_ms < GPS_POWER_WARM_START_S * 1000;
+
+    uint32_t window_s = max_window_s;
+    if (warm_start && !last_timed_out && stats.warm_ttff_ms != 0) {
+        window_s = 3 * stats.warm_ttff_ms / 1000 + 1;
+        window_s = window_s < GPS_POWER_MIN_WINDOW_S ? GPS_POWER_MIN_WINDOW_S : window_s;
+        window_s = window_s > max_window_s ? max_window_s : window_s;
+    }
+
+    // a receiver already running has no meaningful time to first fix
+    window_counted = !powered;
+    set_power(true, now_ms);
+
+    stats.windows++;
+    stats.window_s = window_s;
+    window_start_ms = now_ms;
+    state = GpsPowerState::ACQUIRING;
+}
+
+
+/**
+ * @brief Powers the receiver off and schedules the next window.
+ * @param now_ms Current time in ms since boot.
+ * @param period_s Time between window starts.
+ */
+void GpsPowerScheduler::close_window(uint32_t now_ms, uint32_t period_s) {
+    set_power(false, now_ms);
+    state = GpsPowerState::OFF;
+    window_scheduled = true;
+    next_window_ms = window_start_ms + period_s * 1000;
+    if (static_cast<int32_t>(next_window_ms - now_ms) < 0) {
+        next_window_ms = now_ms;
+    }
+}
+
+
+/**
+ * @brief Adds a time to first fix to the warm or cold average.
+ * @param ttff_ms Time from window start to the first fix.
+ * @param warm True for a warm start.
+ */
+void GpsPowerScheduler::record_ttff(uint32_t ttff_ms, bool warm) {
+    uint32_t& average = warm ? stats.warm_ttff_ms : stats.cold_ttff_ms;
+    average = average == 0 ? ttff_ms : (3 * average + ttff_ms) / 4;
+    stats.last_ttff_ms = ttff_ms;
+}
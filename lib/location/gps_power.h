@@ -0,0 +1,208 @@
+#ifndef GPS_POWER_H
+#define GPS_POWER_H
+
+#include <cstdint>
+#include <atomic>
+#include "pico/mutex.h"
+
+/**
+ * @file gps_power.h
+ * @brief Duty-cycled GPS power scheduling
+ * @details The GPS receiver is one of the largest loads, so on battery it is
+ *          only powered for a fix window once per period. A window ends as soon
+ *          as a valid RMC position has been received and held for
+ *          GPS_POWER_FIX_HOLD_MS, or when the window times out.
+ *
+ *          A start within GPS_POWER_WARM_START_S of the previous fix finds valid
+ *          ephemeris in the receiver and is a warm start; later starts are cold.
+ *          Time-to-first-fix is averaged separately for both, and the next
+ *          window is sized from the average of the start it expects: three
+ *          times the warm average for a warm start, the profile's maximum window
+ *          for a cold start or after a timeout.
+ *
+ *          Each operating mode has its own profile, so switching to battery
+ *          power selects the low-duty profile automatically. Only the scheduler
+ *          drives GPS_POWER_ENABLE_PIN; the power command and reaction rules
+ *          enable or disable it.
+ *
+ * @defgroup Location Location
+ * @brief Classes for handling location data.
+ * @{
+ */
+
+/**
+ * @brief How a profile powers the receiver.
+ */
+enum class GpsPowerMode : uint8_t {
+    OFF = 0,         /**< Receiver off */
+    ALWAYS_ON = 1,   /**< Receiver on permanently */
+    DUTY_CYCLED = 2, /**< Receiver on for a fix window once per period */
+    COUNT            /**< Number of modes */
+};
+
+/**
+ * @brief Power settings used in one operating mode.
+ */
+struct GpsPowerProfile {
+    GpsPowerMode mode;     /**< Power mode */
+    uint32_t period_s;     /**< Time between window starts when duty cycled */
+    uint32_t max_window_s; /**< Longest fix window, used for cold starts */
+};
+
+/**
+ * @brief Profile used when powered from USB.
+ */
+static constexpr GpsPowerProfile GPS_POWER_USB_PROFILE = {GpsPowerMode::ALWAYS_ON, 300, 180};
+
+/**
+ * @brief Low-duty profile used on battery.
+ */
+static constexpr GpsPowerProfile GPS_POWER_BATTERY_PROFILE = {GpsPowerMode::DUTY_CYCLED, 900, 180};
+
+/**
+ * @brief Shortest fix window in seconds.
+ */
+static constexpr uint32_t GPS_POWER_MIN_WINDOW_S = 30;
+
+/**
+ * @brief Shortest and longest period accepted in seconds.
+ */
+static constexpr uint32_t GPS_POWER_MIN_PERIOD_S = 60;
+static constexpr uint32_t GPS_POWER_MAX_PERIOD_S = 86400;
+
+/**
+ * @brief Time the receiver stays on after the first fix of a window.
+ * @details Lets the position settle and the RTC synchronise to GPS time.
+ */
+static constexpr uint32_t GPS_POWER_FIX_HOLD_MS = 5000;
+
+/**
+ * @brief Longest time since the last fix for which a start counts as warm.
+ * @details Broadcast ephemeris stays valid for about four hours.
+ */
+static constexpr uint32_t GPS_POWER_WARM_START_S = 4 * 3600;
+
+/**
+ * @brief Scheduler state.
+ */
+enum class GpsPowerState : uint8_t {
+    OFF = 0,   /**< Receiver off, waiting for the next window */
+    ACQUIRING, /**< Window open, waiting for a fix */
+    HOLDING,   /**< Fix received, receiver kept on for GPS_POWER_FIX_HOLD_MS */
+    ON         /**< Receiver on permanently */
+};
+
+/**
+ * @brief Window and time-to-first-fix statistics.
+ */
+struct GpsPowerStats {
+    uint32_t windows;       /**< Fix windows opened */
+    uint32_t fixes;         /**< Windows that got a fix */
+    uint32_t timeouts;      /**< Windows that timed out */
+    uint32_t last_ttff_ms;  /**< Time to first fix of the last successful window */
+    uint32_t warm_ttff_ms;  /**< Average warm start time to first fix, 0 if none yet */
+    uint32_t cold_ttff_ms;  /**< Average cold start time to first fix, 0 if none yet */
+    uint32_t window_s;      /**< Length of the current or next window */
+    uint64_t on_time_ms;    /**< Time the receiver was powered since boot */
+};
+
+/**
+ * @brief Powers the GPS receiver according to the profile of the operating mode.
+ */
+class GpsPowerScheduler {
+public:
+    /**
+     * @brief Gets the singleton instance of the GpsPowerScheduler class.
+     * @return A reference to the singleton instance.
+     */
+    static GpsPowerScheduler& get_instance();
+
+    /**
+     * @brief Opens and closes fix windows.
+     * @param now_ms Current time in ms since boot.
+     * @details Called from the core 1 loop after collect_gps_data().
+     */
+    void process(uint32_t now_ms);
+
+    /**
+     * @brief Enables or disables the receiver.
+     * @param enable False keeps the receiver off whatever the profile; true
+     *        resumes the profile, opening a window at once when duty cycled.
+     * @details Applied at the next process() call.
+     */
+    void set_enabled(bool enable);
+
+    /**
+     * @brief Checks if the receiver is enabled.
+     * @return True if enabled.
+     */
+    bool is_enabled() const { return enabled.load(); }
+
+    /**
+     * @brief Gets the profile of an operating mode.
+     * @param battery True for the battery profile, false for the USB profile.
+     * @return Copy of the profile.
+     */
+    GpsPowerProfile get_profile(bool battery);
+
+    /**
+     * @brief Replaces the profile of an operating mode.
+     * @param battery True for the battery profile, false for the USB profile.
+     * @param profile New profile.
+     * @return True if the mode, period and window are valid.
+     */
+    bool set_profile(bool battery, const GpsPowerProfile& profile);
+
+    /**
+     * @brief Gets the scheduler state.
+     * @return Current state.
+     */
+    GpsPowerState get_state();
+
+    /**
+     * @brief Gets the time until the next window opens.
+     * @return Seconds, 0 if no window is scheduled.
+     */
+    uint32_t get_next_window_s();
+
+    /**
+     * @brief Gets the window and time-to-first-fix statistics.
+     * @return Copy of the statistics.
+     */
+    GpsPowerStats get_stats();
+
+private:
+    GpsPowerScheduler();
+    GpsPowerScheduler(const GpsPowerScheduler&) = delete;
+    GpsPowerScheduler& operator=(const GpsPowerScheduler&) = delete;
+
+    void set_power(bool on, uint32_t now_ms);
+    void open_window(uint32_t now_ms, uint32_t max_window_s);
+    void close_window(uint32_t now_ms, uint32_t period_s);
+    void record_ttff(uint32_t ttff_ms, bool warm);
+
+    mutex_t mutex;
+    GpsPowerProfile profiles[2];
+    std::atomic<bool> enabled{true};
+    std::atomic<bool> profile_changed{true};
+
+    GpsPowerState state = GpsPowerState::OFF;
+    bool initialised = false;
+    bool powered = false;
+    bool last_battery = false;
+    bool window_scheduled = false;
+    bool window_counted = false;
+    bool warm_start = false;
+    bool last_timed_out = false;
+    bool has_fix = false;
+    uint32_t power_on_ms = 0;
+    uint32_t window_start_ms = 0;
+    uint32_t fix_ms = 0;
+    uint32_t last_fix_ms = 0;
+    uint32_t next_window_ms = 0;
+
+    GpsPowerStats stats = {};
+};
+
+#endif // GPS_POWER_H
+/** @} */
@@ -0,0 +1,410 @@
+#include "gps_config.h"
+#include <cstdio>
+#include <cstring>
+#include "lib/location/NMEA/nmea_parser.h"
+
+/**
+ * @file gps_receiver.cpp
+ * @brief Receiver profiles and configuration sequence of the GPS configuration stage
+ * @details Free of SDK dependencies: the sequence talks to the receiver through
+ *          a GpsConfigLink, so tools/gps_config_sim.cpp can run it against a
+ *          scripted receiver.
+ * @ingroup Location
+ */
+
+namespace {
+
+
+/**
+ * @brief GSV is output once every this many fixes.
+ */
+constexpr uint8_t GSV_FIX_DIVIDER = 5;
+
+/**
+ * @brief Approximate UART bits needed per fix for RMC, GGA, GSA and a decimated GSV.
+ * @details Used to cap the navigation rate so the sentences fit the baud rate.
+ */
+constexpr uint32_t BITS_PER_FIX = 3000;
+
+// MediaTek PMTK
+
+/**
+ * @brief Wraps a PMTK body as "$body*hh\r\n".
+ */
+size_t mtk_frame(const char* body, uint8_t* out, size_t size) {
+    uint8_t checksum = 0;
+    for (const char* c = body; *c; c++) {
+        checksum ^= static_cast<uint8_t>(*c);
+    }
+    int length = snprintf(reinterpret_cast<char*>(out), size, "$%s*%02X\r\n", body, checksum);
+    return length > 0 && static_cast<size_t>(length) < size ? length : 0;
+}
+
+size_t mtk_build_baud(uint32_t baud, uint8_t* out, size_t size) {
+    char body[24];
+    snprintf(body, sizeof(body), "PMTK251,%lu", static_cast<unsigned long>(baud));
+    return mtk_frame(body, out, size);
+}
+
+size_t mtk_build_rate(uint32_t rate_hz, uint8_t* out, size_t size) {
+    char body[24];
+    snprintf(body, sizeof(body), "PMTK220,%lu", static_cast<unsigned long>(1000 / rate_hz));
+    return mtk_frame(body, out, size);
+}
+
+size_t mtk_build_output(uint8_t index, uint8_t* out, size_t size) {
+    if (index > 0) {
+        return 0;
+    }
+    // GLL, RMC, VTG, GGA, GSA, GSV, 13 reserved / proprietary fields
+    char body[64];
+    snprintf(body, sizeof(body), "PMTK314,0,1,0,1,1,%u,0,0,0,0,0,0,0,0,0,0,0,0,0", GSV_FIX_DIVIDER);
+    return mtk_frame(body, out, size);
+}
+
+/**
+ * @brief Looks for "$PMTK001,<command>,<flag>*hh" answering command.
+ * @details Flag 3 is success, 0-2 are invalid, unsupported and failed.
+ */
+GpsAckResult mtk_scan_ack(GpsAckScanner& scanner, uint8_t byte, const uint8_t* command, size_t command_length) {
+    if (byte == '\r') {
+        return GpsAckResult::NONE;
+    }
+    if (byte != '\n') {
+        if (scanner.length < sizeof(scanner.data)) {
+            scanner.data[scanner.length++] = byte;
+        } else {
+            scanner.length = 0;
+        }
+        return GpsAckResult::NONE;
+    }
+
+    const char* line = reinterpret_cast<const char*>(scanner.data);
+    size_t length = scanner.length;
+    scanner.length = 0;
+
+    static constexpr char ACK_PREFIX[] = "$PMTK001,";
+    static constexpr size_t ACK_PREFIX_LENGTH = sizeof(ACK_PREFIX) - 1;
+    if (length < ACK_PREFIX_LENGTH || memcmp(line, ACK_PREFIX, ACK_PREFIX_LENGTH) != 0 ||
+        !nmea_verify_checksum(line, length)) {
+        return GpsAckResult::NONE;
+    }
+
+    // command number: digits after "$PMTK" in the command, up to ',' or '*'
+    const char* sent = reinterpret_cast<const char*>(command) + 5;
+    size_t sent_length = 0;
+    while (5 + sent_length < command_length && sent[sent_length] >= '0' && sent[sent_length] <= '9') {
+        sent_length++;
+    }
+
+    const char* acked = line + ACK_PREFIX_LENGTH;
+    if (ACK_PREFIX_LENGTH + sent_length + 2 > length || memcmp(acked, sent, sent_length) != 0 ||
+        acked[sent_length] != ',') {
+        return GpsAckResult::NONE;
+    }
+    return acked[sent_length + 1] == '3' ? GpsAckResult::ACK : GpsAckResult::NACK;
+}
+
+// u-blox UBX
+
+/**
+ * @brief Wraps a UBX payload with sync bytes, class, id, length and Fletcher checksum.
+ */
+size_t ubx_frame(uint8_t message_class, uint8_t id, const uint8_t* payload, uint16_t payload_length,
+                 uint8_t* out, size_t size) {
+    size_t length = 8u + payload_length;
+    if (length > size) {
+        return 0;
+    }
+    out[0] = 0xB5;
+    out[1] = 0x62;
+    out[2] = message_class;
+    out[3] = id;
+    out[4] = payload_length & 0xFF;
+    out[5] = payload_length >> 8;
+    memcpy(out + 6, payload, payload_length);
+
+    uint8_t ck_a = 0, ck_b = 0;
+    for (size_t i = 2; i < 6u + payload_length; i++) {
+        ck_a += out[i];
+        ck_b += ck_a;
+    }
+    out[6 + payload_length] = ck_a;
+    out[7 + payload_length] = ck_b;
+    return length;
+}
+
+/**
+ * @brief Stores a little-endian value.
+ */
+void put_le(uint8_t* out, uint32_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+size_t ubx_build_baud(uint32_t baud, uint8_t* out, size_t size) {
+    // CFG-PRT for UART1: 8N1, UBX+NMEA in, UBX+NMEA out
+    uint8_t payload[20] = {};
+    payload[0] = 1;
+    put_le(payload + 4, 0x000008D0, 4);
+    put_le(payload + 8, baud, 4);
+    put_le(payload + 12, 0x0003, 2);
+    put_le(payload + 14, 0x0003, 2);
+    return ubx_frame(0x06, 0x00, payload, sizeof(payload), out, size);
+}
+
+size_t ubx_build_rate(uint32_t rate_hz, uint8_t* out, size_t size) {
+    // CFG-RATE: measurement period, one solution per measurement, GPS time
+    uint8_t payload[6];
+    put_le(payload, 1000 / rate_hz, 2);
+    put_le(payload + 2, 1, 2);
+    put_le(payload + 4, 1, 2);
+    return ubx_frame(0x06, 0x08, payload, sizeof(payload), out, size);
+}
+
+size_t ubx_build_output(uint8_t index, uint8_t* out, size_t size) {
+    // CFG-MSG for the standard NMEA messages (class 0xF0) on the current port
+    static constexpr uint8_t messages[][2] = {
+        {0x00, 1},               // GGA
+        {0x01, 0},               // GLL
+        {0x02, 1},               // GSA
+        {0x03, GSV_FIX_DIVIDER}, // GSV
+        {0x04, 1},               // RMC
+        {0x05, 0},               // VTG
+    };
+    if (index >= sizeof(messages) / sizeof(messages[0])) {
+        return 0;
+    }
+    uint8_t payload[3] = {0xF0, messages[index][0], messages[index][1]};
+    return ubx_frame(0x06, 0x01, payload, sizeof(payload), out, size);
+}
+
+/**
+ * @brief Looks for ACK-ACK / ACK-NAK carrying the class and id of command.
+ */
+GpsAckResult ubx_scan_ack(GpsAckScanner& scanner, uint8_t byte, const uint8_t* command, size_t command_length) {
+    static constexpr size_t ACK_LENGTH = 10;
+    if (scanner.length == ACK_LENGTH) {
+        memmove(scanner.data, scanner.data + 1, ACK_LENGTH - 1);
+        scanner.length--;
+    }
+    scanner.data[scanner.length++] = byte;
+    if (scanner.length < ACK_LENGTH || command_length < 4) {
+        return GpsAckResult::NONE;
+    }
+
+    const uint8_t* frame = scanner.data;
+    if (frame[0] != 0xB5 || frame[1] != 0x62 || frame[2] != 0x05 || frame[3] > 0x01 ||
+        frame[4] != 2 || frame[5] != 0 || frame[6] != command[2] || frame[7] != command[3]) {
+        return GpsAckResult::NONE;
+    }
+
+    uint8_t ck_a = 0, ck_b = 0;
+    for (size_t i = 2; i < 8; i++) {
+        ck_a += frame[i];
+        ck_b += ck_a;
+    }
+    if (frame[8] != ck_a || frame[9] != ck_b) {
+        return GpsAckResult::NONE;
+    }
+    return frame[3] == 0x01 ? GpsAckResult::ACK : GpsAckResult::NACK;
+}
+
+constexpr GpsReceiverProfile profiles[] = {
+    {"MTK", mtk_build_baud, mtk_build_rate, mtk_build_output, mtk_scan_ack},
+    {"UBX", ubx_build_baud, ubx_build_rate, ubx_build_output, ubx_scan_ack},
+};
+
+static_assert(sizeof(profiles) / sizeof(profiles[0]) == static_cast<size_t>(GpsReceiverType::COUNT),
+              "one profile per receiver type");
+
+/**
+ * @brief Drops everything waiting on the link.
+ */
+void discard_rx(const GpsConfigLink& link) {
+    char chunk[64];
+    while (link.read(link.context, chunk, sizeof(chunk)) > 0) {
+    }
+}
+
+/**
+ * @brief Switches the local UART and drops bytes received at the old rate.
+ */
+void set_baud(const GpsConfigLink& link, GpsConfigStatus& status, uint32_t baud) {
+    link.set_baud(link.context, baud);
+    status.baud = baud;
+    discard_rx(link);
+}
+
+/**
+ * @brief Listens at a baud rate for one sentence with a valid checksum.
+ * @return True if the receiver talks at that rate.
+ */
+bool probe_baud(const GpsConfigLink& link, GpsConfigStatus& status, uint32_t baud) {
+    set_baud(link, status, baud);
+
+    char line[96];
+    size_t length = 0;
+    uint32_t start = link.now_ms(link.context);
+    while (link.now_ms(link.context) - start < GPS_CONFIG_PROBE_TIMEOUT_MS) {
+        char chunk[32];
+        size_t count = link.read(link.context, chunk, sizeof(chunk));
+        for (size_t i = 0; i < count; i++) {
+            if (chunk[i] == '\r' || chunk[i] == '\n') {
+                if (length > 0 && nmea_verify_checksum(line, length)) {
+                    return true;
+                }
+                length = 0;
+            } else if (length < sizeof(line)) {
+                line[length++] = chunk[i];
+            } else {
+                length = 0;
+            }
+        }
+        if (count == 0) {
+            link.sleep_ms(link.context, 2);
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Sends a command and waits for its acknowledgement.
+ * @return ACK, NACK, or NONE on timeout.
+ */
+GpsAckResult send_command(const GpsConfigLink& link, GpsConfigStatus& status, const uint8_t* command, size_t length) {
+    const GpsReceiverProfile& profile = gps_receiver_profile(status.receiver);
+    GpsAckScanner scanner = {};
+
+    discard_rx(link);
+    link.write(link.context, command, length);
+
+    uint32_t start = link.now_ms(link.context);
+    while (link.now_ms(link.context) - start < GPS_CONFIG_ACK_TIMEOUT_MS) {
+        char chunk[32];
+        size_t count = link.read(link.context, chunk, sizeof(chunk));
+        for (size_t i = 0; i < count; i++) {
+            GpsAckResult result = profile.scan_ack(scanner, static_cast<uint8_t>(chunk[i]), command, length);
+            if (result == GpsAckResult::ACK) {
+                status.acks++;
+                return result;
+            }
+            if (result == GpsAckResult::NACK) {
+                status.nacks++;
+                return result;
+            }
+        }
+        if (count == 0) {
+            link.sleep_ms(link.context, 2);
+        }
+    }
+    status.timeouts++;
+    return GpsAckResult::NONE;
+}
+
+/**
+ * @brief Switches receiver and UART to a baud rate, falling back to the default.
+ * @return True if the receiver answers at baud.
+ * @details A baud change is not reliably acknowledged (the answer may be sent
+ *          at either rate), so it is verified by a sentence at the new rate.
+ */
+bool change_baud(const GpsConfigLink& link, GpsConfigStatus& status, uint32_t baud) {
+    const GpsReceiverProfile& profile = gps_receiver_profile(status.receiver);
+    uint32_t previous = status.baud;
+    uint8_t command[GPS_CONFIG_MAX_COMMAND];
+
+    size_t length = profile.build_baud(baud, command, sizeof(command));
+    link.write(link.context, command, length);
+    link.sleep_ms(link.context, 50);
+    if (probe_baud(link, status, baud)) {
+        return true;
+    }
+
+    status.fallbacks++;
+    if (probe_baud(link, status, previous)) {
+        return false;
+    }
+
+    // receiver possibly switched after all but garbles at baud: ask it for the default
+    length = profile.build_baud(GPS_UART_BAUD_RATE, command, sizeof(command));
+    set_baud(link, status, baud);
+    link.write(link.context, command, length);
+    link.sleep_ms(link.context, 50);
+    probe_baud(link, status, GPS_UART_BAUD_RATE);
+    return false;
+}
+
+} // namespace
+
+
+/**
+ * @brief Gets the profile of a receiver type.
+ * @param type Receiver type, below GpsReceiverType::COUNT.
+ * @return Profile, the default receiver's for an invalid type.
+ */
+const GpsReceiverProfile& gps_receiver_profile(GpsReceiverType type) {
+    if (type >= GpsReceiverType::COUNT) {
+        type = GPS_CONFIG_DEFAULT_RECEIVER;
+    }
+    return profiles[static_cast<size_t>(type)];
+}
+
+
+/**
+ * @brief Runs the configuration sequence.
+ * @details Finds the rate the receiver talks at, then changes the baud rate,
+ *          the sentence output and the navigation rate in that order, so the
+ *          faster output never runs on the slow link. The navigation rate is
+ *          capped to what the final baud rate can carry.
+ */
+GpsConfigState gps_config_run(const GpsConfigLink& link, GpsConfigStatus& status, GpsReceiverType receiver,
+                              uint32_t baud, uint32_t rate_hz) {
+    uint32_t start = link.now_ms(link.context);
+    status.receiver = receiver;
+    const GpsReceiverProfile& profile = gps_receiver_profile(status.receiver);
+
+    uint32_t candidates[] = {status.baud, GPS_UART_BAUD_RATE, baud};
+    bool found = false;
+    for (size_t i = 0; i < 3 && !found; i++) {
+        bool tried = false;
+        for (size_t j = 0; j < i; j++) {
+            tried |= candidates[j] == candidates[i];
+        }
+        found = !tried && probe_baud(link, status, candidates[i]);
+    }
+
+    if (!found) {
+        set_baud(link, status, GPS_UART_BAUD_RATE);
+        status.state = GpsConfigState::NO_RECEIVER;
+        status.duration_ms = link.now_ms(link.context) - start;
+        return status.state;
+    }
+
+    bool complete = true;
+    if (status.baud != baud) {
+        complete &= change_baud(link, status, baud);
+    }
+
+    uint8_t command[GPS_CONFIG_MAX_COMMAND];
+    size_t length;
+    for (uint8_t index = 0; (length = profile.build_output(index, command, sizeof(command))) > 0; index++) {
+        complete &= send_command(link, status, command, length) == GpsAckResult::ACK;
+    }
+
+    uint32_t max_rate_hz = status.baud / BITS_PER_FIX;
+    if (rate_hz > max_rate_hz) {
+        rate_hz = max_rate_hz > 0 ? max_rate_hz : 1;
+        complete = false;
+    }
+    length = profile.build_rate(rate_hz, command, sizeof(command));
+    if (send_command(link, status, command, length) == GpsAckResult::ACK) {
+        status.rate_hz = rate_hz;
+    } else {
+        complete = false;
+    }
+
+    status.state = complete ? GpsConfigState::CONFIGURED : GpsConfigState::PARTIAL;
+    status.duration_ms = link.now_ms(link.context) - start;
+    return status.state;
+}
@@ -0,0 +1,154 @@
+#include "gps_uart_rx.h"
+#include <atomic>
+#include <cstring>
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+#include "pin_config.h"
+
+/**
+ * @file gps_uart_rx.cpp
+ * @brief Implementation of the interrupt-fed GPS UART receive ring
+ * @ingroup Location
+ */
+
+static_assert((GPS_UART_RX_RING_SIZE & (GPS_UART_RX_RING_SIZE - 1)) == 0, "GPS_UART_RX_RING_SIZE must be a power of two");
+static_assert((GPS_UART_RX_MARK_COUNT & (GPS_UART_RX_MARK_COUNT - 1)) == 0, "GPS_UART_RX_MARK_COUNT must be a power of two");
+
+namespace {
+
+/**
+ * @brief Receive ring state.
+ * @details head is written only by the interrupt and tail only by the consumer;
+ *          both are free-running byte counters. Counters are written only by the
+ *          interrupt.
+ */
+struct GpsUartRxRing {
+    char buffer[GPS_UART_RX_RING_SIZE];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    GpsUartRxStats stats = {};
+};
+
+/**
+ * @brief Reception time of a '$' byte.
+ * @details Written only by the interrupt; position is set to UINT32_MAX
+ *          while the entry is rewritten, so a reader can detect a torn copy by
+ *          reading position before and after time_us.
+ */
+struct GpsUartRxMark {
+    std::atomic<uint32_t> position{UINT32_MAX};
+    uint64_t time_us = 0;
+};
+
+GpsUartRxRing ring;
+GpsUartRxMark marks[GPS_UART_RX_MARK_COUNT];
+uint32_t mark_count = 0;
+
+/**
+ * @brief Gets the interrupt number of the GPS UART.
+ */
+uint gps_uart_irq() {
+    return GPS_UART_PORT == uart0 ? UART0_IRQ : UART1_IRQ;
+}
+
+/**
+ * @brief UART RX / RX timeout handler, empties the hardware FIFO into the ring.
+ */
+void gps_uart_rx_handler() {
+    uart_hw_t* hw = uart_get_hw(GPS_UART_PORT);
+    uint64_t now_us = time_us_64();
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+    uint32_t tail = ring.tail.load(std::memory_order_acquire);
+
+    while (uart_is_readable(GPS_UART_PORT)) {
+        uint32_t data = hw->dr;
+
+        if (data & UART_UARTDR_OE_BITS) {
+            ring.stats.fifo_overruns++;
+        }
+        if (data & (UART_UARTDR_FE_BITS | UART_UARTDR_PE_BITS | UART_UARTDR_BE_BITS)) {
+            ring.stats.line_errors++;
+            continue;
+        }
+
+        if (head - tail == GPS_UART_RX_RING_SIZE) {
+            tail = ring.tail.load(std::memory_order_acquire);
+            if (head - tail == GPS_UART_RX_RING_SIZE) {
+                ring.stats.ring_overruns++;
+                continue;
+            }
+        }
+
+        char c = static_cast<char>(data & UART_UARTDR_DATA_BITS);
+        if (c == '$') {
+            GpsUartRxMark& mark = marks[mark_count++ & (GPS_UART_RX_MARK_COUNT - 1)];
+            mark.position.store(UINT32_MAX, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            mark.time_us = now_us;
+            mark.position.store(head, std::memory_order_release);
+        }
+        ring.buffer[head & (GPS_UART_RX_RING_SIZE - 1)] = c;
+        head++;
+        ring.stats.bytes_received++;
+    }
+
+    uint32_t used = head - tail;
+    if (used > ring.stats.peak_used) {
+        ring.stats.peak_used = used;
+    }
+    ring.head.store(head, std::memory_order_release);
+}
+
+} // namespace
+
+void gps_uart_rx_init() {
+    irq_set_exclusive_handler(gps_uart_irq(), gps_uart_rx_handler);
+    irq_set_enabled(gps_uart_irq(), true);
+    gps_uart_rx_set_enabled(true);
+}
+
+void gps_uart_rx_set_enabled(bool enabled) {
+    uart_set_irq_enables(GPS_UART_PORT, enabled, false);
+}
+
+size_t gps_uart_rx_read(char* buffer, size_t length) {
+    uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint32_t available = ring.head.load(std::memory_order_acquire) - tail;
+    if (length > available) {
+        length = available;
+    }
+
+    uint32_t start = tail & (GPS_UART_RX_RING_SIZE - 1);
+    size_t first = GPS_UART_RX_RING_SIZE - start;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(buffer, &ring.buffer[start], first);
+    memcpy(buffer + first, &ring.buffer[0], length - first);
+
+    ring.tail.store(tail + length, std::memory_order_release);
+    return length;
+}
+
+GpsUartRxStats gps_uart_rx_get_stats() {
+    return ring.stats;
+}
+
+uint32_t gps_uart_rx_position() {
+    return ring.tail.load(std::memory_order_relaxed);
+}
+
+bool gps_uart_rx_sentence_time(uint32_t position, uint64_t& time_us) {
+    for (GpsUartRxMark& mark : marks) {
+        if (mark.position.load(std::memory_order_acquire) != position) {
+            continue;
+        }
+        uint64_t time = mark.time_us;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mark.position.load(std::memory_order_relaxed) == position) {
+            time_us = time;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,101 @@
+#ifndef GPS_UART_RX_H
+#define GPS_UART_RX_H
+
+#include <cstdint>
+#include <cstddef>
+#include "hardware/uart.h"
+
+/**
+ * @file gps_uart_rx.h
+ * @brief Interrupt-fed receive ring for the GPS UART
+ * @details The UART RX and RX timeout interrupts move every byte from the
+ *          32-byte hardware FIFO into a ring buffer, so sentences survive while
+ *          core 1 sleeps or writes telemetry to the SD card. collect_gps_data()
+ *          drains the ring at its own pace.
+ *
+ *          The ring is single producer (the interrupt) and single consumer
+ *          (core 1), so head and tail are atomics and no lock is taken. Bytes
+ *          arriving when the ring is full are dropped and counted; FIFO overruns
+ *          and line errors reported by the UART are counted as well, so zero loss
+ *          can be checked at any baud rate.
+ *
+ *          The interrupt also records the time at which each '$' sentence start
+ *          arrived, so the consumer can timestamp a sentence at its reception
+ *          rather than when it got around to parsing it.
+ *
+ * @defgroup Location Location
+ * @brief Classes for handling location data.
+ * @{
+ */
+
+/**
+ * @brief Size of the receive ring in bytes, must be a power of two.
+ * @details 2 KB holds about 2 s of NMEA output at 9600 baud and 170 ms at 115200 baud.
+ */
+static constexpr size_t GPS_UART_RX_RING_SIZE = 2048;
+
+/**
+ * @brief Number of sentence start times kept, must be a power of two.
+ * @details Covers the sentences held by the ring at the usual NMEA output.
+ */
+static constexpr size_t GPS_UART_RX_MARK_COUNT = 32;
+
+/**
+ * @brief Receive ring counters.
+ */
+struct GpsUartRxStats {
+    uint32_t bytes_received; /**< Bytes stored in the ring */
+    uint32_t ring_overruns;  /**< Bytes dropped because the ring was full */
+    uint32_t fifo_overruns;  /**< UART FIFO overruns, bytes lost before the interrupt ran */
+    uint32_t line_errors;    /**< Bytes received with a framing, parity or break error */
+    uint32_t peak_used;      /**< Highest ring occupancy seen in bytes */
+};
+
+/**
+ * @brief Installs the GPS UART receive interrupt.
+ * @details Must be called after uart_init(GPS_UART_PORT, ...); the interrupt is
+ *          serviced by the calling core.
+ */
+void gps_uart_rx_init();
+
+/**
+ * @brief Enables or disables the receive interrupt.
+ * @param enabled False hands the UART back to direct uart_getc() access, as used
+ *        by the GPS pass-through mode.
+ */
+void gps_uart_rx_set_enabled(bool enabled);
+
+/**
+ * @brief Copies received bytes out of the ring.
+ * @param buffer Destination.
+ * @param length Size of buffer.
+ * @return Number of bytes copied, 0 if the ring is empty.
+ * @details Called from core 1 only.
+ */
+size_t gps_uart_rx_read(char* buffer, size_t length);
+
+/**
+ * @brief Gets the stream position of the next byte gps_uart_rx_read() returns.
+ * @return Number of bytes read from the ring since boot, wrapping.
+ * @details Called from core 1 only.
+ */
+uint32_t gps_uart_rx_position();
+
+/**
+ * @brief Gets the reception time of a sentence start.
+ * @param position Stream position of the '$' byte.
+ * @param[out] time_us time_us_64() when the interrupt took the byte from the FIFO.
+ * @return False if the byte was not a '$' or its time was already overwritten.
+ * @details The byte waited in the FIFO for at most the FIFO threshold or the
+ *          RX timeout, a few character times.
+ */
+bool gps_uart_rx_sentence_time(uint32_t position, uint64_t& time_us);
+
+/**
+ * @brief Gets a snapshot of the receive ring counters.
+ * @return Copy of the counters.
+ */
+GpsUartRxStats gps_uart_rx_get_stats();
+
+#endif // GPS_UART_RX_H
+/** @} */
@@ -0,0 +1,311 @@
+#include "nav_filter.h"
+#include <cmath>
+
+/**
+ * @file nav_filter.cpp
+ * @brief Implementation of the GPS and barometric altitude fusion
+ * @ingroup Location
+ */
+
+namespace {
+
+/** @brief Metres per 1e-7 degree of latitude. */
+constexpr float METRES_PER_E7_DEGREE = 0.0111319491f;
+
+/** @brief Vertical acceleration noise in m/s². */
+constexpr float VERTICAL_ACCELERATION = 0.5f;
+
+/** @brief Horizontal acceleration noise in m/s². */
+constexpr float HORIZONTAL_ACCELERATION = 1.0f;
+
+/** @brief Random walk of the barometric bias in m/√s, covering weather pressure changes. */
+constexpr float BARO_BIAS_DRIFT = 0.1f;
+
+/** @brief Correlation time of the horizontal velocity in s; dead reckoning fades out over it. */
+constexpr float VELOCITY_TIME_CONSTANT_S = 120.0f;
+
+/** @brief Barometric altitude noise in m. */
+constexpr float BARO_SIGMA = 0.5f;
+
+/** @brief GPS vertical error per unit of VDOP in m, and when VDOP is unknown. */
+constexpr float GPS_VERTICAL_UERE = 4.0f;
+constexpr float GPS_VERTICAL_DEFAULT_SIGMA = 8.0f;
+
+/** @brief GPS horizontal error per unit of HDOP in m, and when HDOP is unknown. */
+constexpr float GPS_HORIZONTAL_UERE = 2.5f;
+constexpr float GPS_HORIZONTAL_DEFAULT_SIGMA = 5.0f;
+
+/** @brief GPS speed noise in m/s. */
+constexpr float GPS_SPEED_SIGMA = 0.3f;
+
+/** @brief Initial speed uncertainty without a GPS velocity in m/s. */
+constexpr float UNKNOWN_SPEED_SIGMA = 30.0f;
+
+/** @brief Uncertainty of an altitude known only from the standard atmosphere in m. */
+constexpr float UNKNOWN_ALTITUDE_SIGMA = 100.0f;
+
+/** @brief Distance from the origin at which the horizontal frame is moved, in m. */
+constexpr float RECENTRE_DISTANCE_M = 10000.0f;
+
+constexpr float DEGREES_TO_RADIANS = 0.0174532925f;
+
+}
+
+
+void NavigationFilter::reset() {
+    vertical = {};
+    horizontal = {};
+    vertical_valid = false;
+    horizontal_valid = false;
+    has_baro = false;
+    vertical_rejects = 0;
+    horizontal_rejects = 0;
+}
+
+
+/**
+ * @brief Propagates the state.
+ * @param dt_s Time since the last step in seconds.
+ * @details Constant velocity with white acceleration noise; the barometric
+ *          bias is a random walk.
+ */
+void NavigationFilter::predict(float dt_s) {
+    if (dt_s <= 0.0f) {
+        return;
+    }
+    stats.steps++;
+
+    while (dt_s > 0.0f) {
+        float dt = dt_s > NAV_MAX_STEP_S ? NAV_MAX_STEP_S : dt_s;
+        dt_s -= dt;
+
+        float dt2 = dt * dt;
+        float q11 = dt2 * dt2 / 4.0f;
+        float q12 = dt2 * dt / 2.0f;
+        float q22 = dt2;
+
+        if (vertical_valid) {
+            float qa = VERTICAL_ACCELERATION * VERTICAL_ACCELERATION;
+            const float F[3][3] = {{1.0f, dt, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+            const float Q[3][3] = {
+                {q11 * qa, q12 * qa, 0.0f},
+                {q12 * qa, q22 * qa, 0.0f},
+                {0.0f, 0.0f, BARO_BIAS_DRIFT * BARO_BIAS_DRIFT * dt}
+            };
+            vertical.predict(F, Q);
+        }
+
+        if (horizontal_valid) {
+            float qa = HORIZONTAL_ACCELERATION * HORIZONTAL_ACCELERATION;
+            float decay = expf(-dt / VELOCITY_TIME_CONSTANT_S);
+            const float F[4][4] = {
+                {1.0f, 0.0f, dt, 0.0f},
+                {0.0f, 1.0f, 0.0f, dt},
+                {0.0f, 0.0f, decay, 0.0f},
+                {0.0f, 0.0f, 0.0f, decay}
+            };
+            const float Q[4][4] = {
+                {q11 * qa, 0.0f, q12 * qa, 0.0f},
+                {0.0f, q11 * qa, 0.0f, q12 * qa},
+                {q12 * qa, 0.0f, q22 * qa, 0.0f},
+                {0.0f, q12 * qa, 0.0f, q22 * qa}
+            };
+            horizontal.predict(F, Q);
+        }
+    }
+}
+
+
+/**
+ * @brief Fuses a barometric pressure.
+ * @param pressure_hpa Pressure in hPa; values outside 300-1100 hPa are ignored.
+ * @details The first pressure initialises the altitude from the standard
+ *          atmosphere with a large uncertainty, which the first GPS altitude
+ *          then resolves into the barometric bias.
+ */
+void NavigationFilter::update_baro(float pressure_hpa) {
+    if (!(pressure_hpa >= 300.0f && pressure_hpa <= 1100.0f)) {
+        return;
+    }
+    float baro_altitude = pressure_to_altitude(pressure_hpa);
+    has_baro = true;
+    last_baro_altitude_m = baro_altitude;
+    stats.baro_updates++;
+
+    if (!vertical_valid) {
+        float var = UNKNOWN_ALTITUDE_SIGMA * UNKNOWN_ALTITUDE_SIGMA;
+        init_vertical(baro_altitude, 0.0f, var, var + BARO_SIGMA * BARO_SIGMA, -var);
+        return;
+    }
+
+    const float H[3] = {1.0f, 0.0f, 1.0f};
+    vertical.update(H, baro_altitude, BARO_SIGMA * BARO_SIGMA, 0.0f);
+}
+
+
+/**
+ * @brief Fuses a GPS fix.
+ * @param gps Position, velocity and optionally altitude of the fix.
+ */
+void NavigationFilter::update_gps(const NavGpsInput& gps) {
+    stats.gps_updates++;
+
+    if (!horizontal_valid) {
+        init_horizontal(gps);
+    } else {
+        float sigma = gps.hdop > 0.0f ? GPS_HORIZONTAL_UERE * gps.hdop : GPS_HORIZONTAL_DEFAULT_SIGMA;
+        float r = sigma * sigma;
+        float north = static_cast<float>(gps.latitude_e7 - origin_latitude_e7) * METRES_PER_E7_DEGREE;
+        float east = static_cast<float>(gps.longitude_e7 - origin_longitude_e7) * east_scale;
+        const float H_north[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+        const float H_east[4] = {0.0f, 1.0f, 0.0f, 0.0f};
+
+        // both axes pass the gate or neither is applied
+        if (horizontal.within_gate(H_north, north, r, NAV_GATE_SIGMA) &&
+            horizontal.within_gate(H_east, east, r, NAV_GATE_SIGMA)) {
+            horizontal.update(H_north, north, r, 0.0f);
+            horizontal.update(H_east, east, r, 0.0f);
+            horizontal_rejects = 0;
+            if (gps.has_velocity) {
+                // the course of a slow receiver is noise, so the error grows with the speed
+                float course = gps.course_deg * DEGREES_TO_RADIANS;
+                float speed_r = GPS_SPEED_SIGMA * GPS_SPEED_SIGMA + 0.01f * gps.speed_mps * gps.speed_mps;
+                const float H_vn[4] = {0.0f, 0.0f, 1.0f, 0.0f};
+                const float H_ve[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+                horizontal.update(H_vn, gps.speed_mps * cosf(course), speed_r, 0.0f);
+                horizontal.update(H_ve, gps.speed_mps * sinf(course), speed_r, 0.0f);
+            }
+            recentre();
+        } else {
+            stats.gps_rejects++;
+            if (++horizontal_rejects >= NAV_MAX_REJECTS) {
+                stats.resets++;
+                init_horizontal(gps);
+            }
+        }
+    }
+
+    if (!gps.has_altitude) {
+        return;
+    }
+
+    float sigma = gps.vdop > 0.0f ? GPS_VERTICAL_UERE * gps.vdop : GPS_VERTICAL_DEFAULT_SIGMA;
+    float var = sigma * sigma;
+    if (!vertical_valid) {
+        float bias_var = UNKNOWN_ALTITUDE_SIGMA * UNKNOWN_ALTITUDE_SIGMA;
+        init_vertical(gps.altitude_m, 0.0f, var, bias_var, 0.0f);
+        return;
+    }
+
+    const float H[3] = {1.0f, 0.0f, 0.0f};
+    if (vertical.update(H, gps.altitude_m, var, NAV_GATE_SIGMA)) {
+        vertical_rejects = 0;
+    } else {
+        stats.gps_rejects++;
+        if (++vertical_rejects >= NAV_MAX_REJECTS) {
+            stats.resets++;
+            if (has_baro) {
+                init_vertical(gps.altitude_m, last_baro_altitude_m - gps.altitude_m, var,
+                              var + BARO_SIGMA * BARO_SIGMA, -var);
+            } else {
+                init_vertical(gps.altitude_m, 0.0f, var, UNKNOWN_ALTITUDE_SIGMA * UNKNOWN_ALTITUDE_SIGMA, 0.0f);
+            }
+        }
+    }
+}
+
+
+NavFusedState NavigationFilter::get_state() const {
+    NavFusedState state = {};
+    state.valid = vertical_valid || horizontal_valid;
+
+    if (vertical_valid) {
+        state.altitude_m = vertical.x[0];
+        state.vertical_speed_mps = vertical.x[1];
+        state.baro_bias_m = vertical.x[2];
+        state.altitude_sigma_m = sqrtf(vertical.P[0][0]);
+    }
+
+    if (horizontal_valid) {
+        state.has_position = true;
+        state.latitude_e7 = origin_latitude_e7 + static_cast<int32_t>(lroundf(horizontal.x[0] / METRES_PER_E7_DEGREE));
+        state.longitude_e7 = origin_longitude_e7 + static_cast<int32_t>(lroundf(horizontal.x[1] / east_scale));
+        state.position_sigma_m = sqrtf(horizontal.P[0][0] + horizontal.P[1][1]);
+        state.speed_mps = sqrtf(horizontal.x[2] * horizontal.x[2] + horizontal.x[3] * horizontal.x[3]);
+    }
+    return state;
+}
+
+
+float NavigationFilter::pressure_to_altitude(float pressure_hpa) {
+    return 44330.0f * (1.0f - powf(pressure_hpa / 1013.25f, 0.190295f));
+}
+
+
+// ==================== private methods
+
+/**
+ * @brief Sets the vertical state and covariance.
+ * @param altitude_m Altitude.
+ * @param bias_m Barometric bias.
+ * @param altitude_var Altitude variance.
+ * @param bias_var Bias variance.
+ * @param covariance Altitude-bias covariance; -altitude_var when the
+ *        barometric altitude (altitude + bias) is known precisely.
+ */
+void NavigationFilter::init_vertical(float altitude_m, float bias_m, float altitude_var, float bias_var, float covariance) {
+    vertical = {};
+    vertical.x[0] = altitude_m;
+    vertical.x[2] = bias_m;
+    vertical.P[0][0] = altitude_var;
+    vertical.P[1][1] = 1.0f;
+    vertical.P[2][2] = bias_var;
+    vertical.P[0][2] = covariance;
+    vertical.P[2][0] = covariance;
+    vertical_valid = true;
+    vertical_rejects = 0;
+}
+
+
+/**
+ * @brief Starts the horizontal filter at a fix, which becomes the origin.
+ * @param gps Fix.
+ */
+void NavigationFilter::init_horizontal(const NavGpsInput& gps) {
+    float sigma = gps.hdop > 0.0f ? GPS_HORIZONTAL_UERE * gps.hdop : GPS_HORIZONTAL_DEFAULT_SIGMA;
+    float course = gps.course_deg * DEGREES_TO_RADIANS;
+
+    origin_latitude_e7 = gps.latitude_e7;
+    origin_longitude_e7 = gps.longitude_e7;
+    east_scale = METRES_PER_E7_DEGREE * cosf(static_cast<float>(gps.latitude_e7) * 1e-7f * DEGREES_TO_RADIANS);
+
+    float velocity_var = UNKNOWN_SPEED_SIGMA * UNKNOWN_SPEED_SIGMA;
+    horizontal = {};
+    if (gps.has_velocity) {
+        horizontal.x[2] = gps.speed_mps * cosf(course);
+        horizontal.x[3] = gps.speed_mps * sinf(course);
+        velocity_var = 1.0f;
+    }
+    horizontal.P[0][0] = sigma * sigma;
+    horizontal.P[1][1] = sigma * sigma;
+    horizontal.P[2][2] = velocity_var;
+    horizontal.P[3][3] = velocity_var;
+    horizontal_valid = true;
+    horizontal_rejects = 0;
+}
+
+
+/**
+ * @brief Moves the origin to the current position once it is far away.
+ * @details Keeps the flat-earth projection and the float resolution accurate.
+ */
+void NavigationFilter::recentre() {
+    if (fabsf(horizontal.x[0]) < RECENTRE_DISTANCE_M && fabsf(horizontal.x[1]) < RECENTRE_DISTANCE_M) {
+        return;
+    }
+    origin_latitude_e7 += static_cast<int32_t>(lroundf(horizontal.x[0] / METRES_PER_E7_DEGREE));
+    origin_longitude_e7 += static_cast<int32_t>(lroundf(horizontal.x[1] / east_scale));
+    east_scale = METRES_PER_E7_DEGREE * cosf(static_cast<float>(origin_latitude_e7) * 1e-7f * DEGREES_TO_RADIANS);
+    horizontal.x[0] = 0.0f;
+    horizontal.x[1] = 0.0f;
+}
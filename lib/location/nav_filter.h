@@ -0,0 +1,259 @@
+#ifndef NAV_FILTER_H
+#define NAV_FILTER_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @file nav_filter.h
+ * @brief Kalman fusion of GPS position and altitude with barometric altitude
+ * @details Two small Kalman filters run at the telemetry sample rate:
+ *
+ *          - Vertical, state [altitude, vertical speed, baro bias]. The
+ *            barometric altitude measures altitude + bias at every step; the
+ *            GPS altitude measures the altitude and makes the bias observable.
+ *            Between fixes, or with the GPS off, the altitude follows the
+ *            barometer with the last estimated bias.
+ *          - Horizontal, state [north, east, north speed, east speed] in metres
+ *            around the first fix, updated by GPS position and velocity and
+ *            dead-reckoned between fixes.
+ *
+ *          Both use constant velocity models, fixed-size float matrices and
+ *          sequential scalar updates, so no matrix inversion and no heap are
+ *          needed. GPS measurements further than NAV_GATE_SIGMA standard
+ *          deviations from the prediction are rejected; after
+ *          NAV_MAX_REJECTS rejections in a row the filter restarts from GPS.
+ *
+ *          The class has no Pico SDK dependency, so tools/nav_replay.cpp runs
+ *          it on the host over recorded telemetry.
+ *
+ * @defgroup Location Location
+ * @brief Classes for handling location data.
+ * @{
+ */
+
+/**
+ * @brief Innovation gate in standard deviations.
+ */
+static constexpr float NAV_GATE_SIGMA = 5.0f;
+
+/**
+ * @brief Consecutive rejected GPS measurements that restart a filter.
+ */
+static constexpr uint32_t NAV_MAX_REJECTS = 10;
+
+/**
+ * @brief Longest prediction step in seconds; longer gaps are split.
+ */
+static constexpr float NAV_MAX_STEP_S = 10.0f;
+
+/**
+ * @brief Fixed-size linear Kalman filter with scalar measurements.
+ * @tparam N Number of states.
+ */
+template <size_t N>
+struct KalmanFilter {
+    float x[N];    /**< State estimate */
+    float P[N][N]; /**< State covariance */
+
+    /**
+     * @brief Propagates the state: x = F x, P = F P F' + Q.
+     * @param F State transition matrix.
+     * @param Q Process noise covariance.
+     */
+    void predict(const float (&F)[N][N], const float (&Q)[N][N]) {
+        float fx[N];
+        float fp[N][N];
+        for (size_t i = 0; i < N; i++) {
+            fx[i] = 0.0f;
+            for (size_t k = 0; k < N; k++) {
+                fx[i] += F[i][k] * x[k];
+            }
+            for (size_t j = 0; j < N; j++) {
+                fp[i][j] = 0.0f;
+                for (size_t k = 0; k < N; k++) {
+                    fp[i][j] += F[i][k] * P[k][j];
+                }
+            }
+        }
+        for (size_t i = 0; i < N; i++) {
+            x[i] = fx[i];
+            for (size_t j = 0; j < N; j++) {
+                float sum = Q[i][j];
+                for (size_t k = 0; k < N; k++) {
+                    sum += fp[i][k] * F[j][k];
+                }
+                P[i][j] = sum;
+            }
+        }
+    }
+
+    /**
+     * @brief Tests a scalar measurement z = H x + v, var(v) = r, against the gate without applying it.
+     * @param H Measurement row.
+     * @param z Measured value.
+     * @param r Measurement noise variance.
+     * @param gate Largest accepted innovation in standard deviations.
+     * @return True if the innovation is within the gate.
+     */
+    bool within_gate(const float (&H)[N], float z, float r, float gate) const {
+        float innovation = z;
+        float s = r;
+        for (size_t i = 0; i < N; i++) {
+            innovation -= H[i] * x[i];
+            for (size_t j = 0; j < N; j++) {
+                s += H[i] * P[i][j] * H[j];
+            }
+        }
+        return innovation * innovation <= gate * gate * s;
+    }
+
+    /**
+     * @brief Applies one scalar measurement z = H x + v, var(v) = r.
+     * @param H Measurement row.
+     * @param z Measured value.
+     * @param r Measurement noise variance.
+     * @param gate Largest accepted innovation in standard deviations, 0 to accept all.
+     * @return False if the measurement was rejected by the gate.
+     */
+    bool update(const float (&H)[N], float z, float r, float gate) {
+        float ph[N];
+        float innovation = z;
+        float s = r;
+        for (size_t i = 0; i < N; i++) {
+            innovation -= H[i] * x[i];
+            ph[i] = 0.0f;
+            for (size_t j = 0; j < N; j++) {
+                ph[i] += P[i][j] * H[j];
+            }
+            s += H[i] * ph[i];
+        }
+        if (gate > 0.0f && innovation * innovation > gate * gate * s) {
+            return false;
+        }
+
+        for (size_t i = 0; i < N; i++) {
+            float k = ph[i] / s;
+            x[i] += k * innovation;
+            for (size_t j = 0; j < N; j++) {
+                P[i][j] -= k * ph[j];
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief GPS measurement passed to the filter.
+ */
+struct NavGpsInput {
+    int32_t latitude_e7;  /**< Latitude in 1e-7 degrees */
+    int32_t longitude_e7; /**< Longitude in 1e-7 degrees */
+    float altitude_m;     /**< Altitude above mean sea level */
+    float speed_mps;      /**< Ground speed */
+    float course_deg;     /**< Course over ground */
+    bool has_velocity;    /**< speed_mps and course_deg are valid */
+    float hdop;           /**< Horizontal dilution of precision, 0 if unknown */
+    float vdop;           /**< Vertical dilution of precision, 0 if unknown */
+    bool has_altitude;    /**< altitude_m is valid */
+};
+
+/**
+ * @brief Fused navigation state.
+ */
+struct NavFusedState {
+    bool valid;                /**< At least one measurement was fused */
+    bool has_position;         /**< Horizontal position was initialised from GPS */
+    float altitude_m;          /**< Fused altitude above mean sea level */
+    float vertical_speed_mps;  /**< Vertical speed, positive up */
+    float altitude_sigma_m;    /**< Standard deviation of the altitude */
+    float baro_bias_m;         /**< Barometric minus true altitude */
+    int32_t latitude_e7;       /**< Fused latitude in 1e-7 degrees */
+    int32_t longitude_e7;      /**< Fused longitude in 1e-7 degrees */
+    float position_sigma_m;    /**< Standard deviation of the horizontal position */
+    float speed_mps;           /**< Fused ground speed */
+};
+
+/**
+ * @brief Counters of the fusion filter.
+ */
+struct NavFilterStats {
+    uint32_t steps;           /**< Prediction steps */
+    uint32_t baro_updates;    /**< Barometric altitudes fused */
+    uint32_t gps_updates;     /**< GPS fixes fused */
+    uint32_t gps_rejects;     /**< GPS measurements rejected by the gate */
+    uint32_t resets;          /**< Restarts after repeated rejections */
+};
+
+/**
+ * @brief GPS and barometric altitude fusion.
+ */
+class NavigationFilter {
+public:
+    NavigationFilter() { reset(); }
+
+    /**
+     * @brief Clears the state; the next measurements initialise it.
+     * @details The counters are kept.
+     */
+    void reset();
+
+    /**
+     * @brief Propagates the state.
+     * @param dt_s Time since the last step in seconds.
+     */
+    void predict(float dt_s);
+
+    /**
+     * @brief Fuses a barometric pressure.
+     * @param pressure_hpa Pressure in hPa; values outside 300-1100 hPa are ignored.
+     */
+    void update_baro(float pressure_hpa);
+
+    /**
+     * @brief Fuses a GPS fix.
+     * @param gps Position, velocity and optionally altitude of the fix.
+     */
+    void update_gps(const NavGpsInput& gps);
+
+    /**
+     * @brief Gets the fused state.
+     * @return State after the last update.
+     */
+    NavFusedState get_state() const;
+
+    /**
+     * @brief Gets the counters.
+     * @return Copy of the counters.
+     */
+    NavFilterStats get_stats() const { return stats; }
+
+    /**
+     * @brief Converts a pressure to an altitude in the standard atmosphere.
+     * @param pressure_hpa Pressure in hPa.
+     * @return Altitude in metres, relative to 1013.25 hPa.
+     */
+    static float pressure_to_altitude(float pressure_hpa);
+
+private:
+    void init_vertical(float altitude_m, float bias_m, float altitude_var, float bias_var, float covariance);
+    void init_horizontal(const NavGpsInput& gps);
+
+    void recentre();
+
+    KalmanFilter<3> vertical = {};
+    KalmanFilter<4> horizontal = {};
+    bool vertical_valid = false;
+    bool horizontal_valid = false;
+    bool has_baro = false;
+    float last_baro_altitude_m = 0.0f;
+    int32_t origin_latitude_e7 = 0;
+    int32_t origin_longitude_e7 = 0;
+    float east_scale = 0.0f;
+    uint32_t vertical_rejects = 0;
+    uint32_t horizontal_rejects = 0;
+    NavFilterStats stats = {};
+};
+
+#endif // NAV_FILTER_H
+/** @} */
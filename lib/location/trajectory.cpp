@@ -0,0 +1,263 @@
+#include "trajectory.h"
+#include <cmath>
+#include "pico/stdlib.h"
+#include "lib/location/NMEA/NMEA_data.h"
+#include "lib/clock/time_service.h"
+
+/**
+ * @file trajectory.cpp
+ * @brief Implementation of the trajectory store
+ * @ingroup Location
+ */
+
+namespace {
+
+/**
+ * @brief Metres per 1e-7 degree of latitude.
+ */
+constexpr float METRES_PER_E7_DEGREE = 0.0111319491f;
+
+/**
+ * @brief Point in metres relative to the anchor.
+ */
+struct LocalPoint {
+    float x;
+    float y;
+    float z;
+};
+
+LocalPoint to_local(const TrajectoryPoint& point, const TrajectoryPoint& origin, float longitude_scale) {
+    return {
+        static_cast<float>(point.longitude_e7 - origin.longitude_e7) * longitude_scale,
+        static_cast<float>(point.latitude_e7 - origin.latitude_e7) * METRES_PER_E7_DEGREE,
+        static_cast<float>(point.altitude_dm - origin.altitude_dm) * 0.1f
+    };
+}
+
+size_t write_u32(uint8_t* out, uint32_t value) {
+    for (size_t i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    return 4;
+}
+
+size_t write_varint(uint8_t* out, int32_t value) {
+    uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    size_t length = 0;
+    while (zigzag >= 0x80) {
+        out[length++] = static_cast<uint8_t>(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    out[length++] = static_cast<uint8_t>(zigzag);
+    return length;
+}
+
+/**
+ * @brief Longest encoding of a point as differences.
+ */
+constexpr size_t MAX_DELTA_POINT_SIZE = 4 * 5;
+
+/**
+ * @brief Size of a point encoded as absolute values.
+ */
+constexpr size_t ABSOLUTE_POINT_SIZE = 4 * 4;
+
+}
+
+
+TrajectoryStore& TrajectoryStore::get_instance() {
+    static TrajectoryStore instance;
+    return instance;
+}
+
+
+TrajectoryStore::TrajectoryStore() {
+    mutex_init(&mutex);
+    stats.tolerance_m = TRAJECTORY_DEFAULT_TOLERANCE_M;
+}
+
+
+/**
+ * @brief Samples the latest fix when a sample is due.
+ * @param now_ms Current time in ms since boot.
+ * @details The point time is the disciplined UTC time less the age of the
+ *          position, the altitude is 0 until GGA was received.
+ */
+void TrajectoryStore::process(uint32_t now_ms) {
+    if (now_ms - last_sample_ms < TRAJECTORY_SAMPLE_MS) {
+        return;
+    }
+    last_sample_ms = now_ms;
+
+    GpsFixSnapshot snapshot = NMEAData::get_instance().get_snapshot();
+    const GpsFix& fix = snapshot.fix;
+    if (!fix.rmc_valid || snapshot.age_ms >= TRAJECTORY_SAMPLE_MS) {
+        return;
+    }
+
+    TrajectoryPoint point;
+    point.time = TimeService::get_instance().get_utc() - snapshot.age_ms / 1000;
+    point.latitude_e7 = fix.latitude_e7;
+    point.longitude_e7 = fix.longitude_e7;
+    point.altitude_dm = (fix.sentences & GPS_FIX_HAS_GGA) ? fix.altitude_mm / 100 : 0;
+    add_point(point);
+}
+
+
+void TrajectoryStore::add_point(const TrajectoryPoint& point) {
+    mutex_enter_blocking(&mutex);
+    stats.input_points++;
+
+    if (!has_anchor) {
+        anchor = point;
+        has_anchor = true;
+        keep(point);
+    } else if (window_count == 0 || window_fits(point)) {
+        if (window_count == TRAJECTORY_WINDOW_SIZE) {
+            // close the segment at the last checked point, the window restarts from it
+            anchor = window[window_count - 1];
+            keep(anchor);
+            window_count = 0;
+            stats.full_windows++;
+        }
+        window[window_count++] = point;
+    } else {
+        anchor = window[window_count - 1];
+        keep(anchor);
+        window[0] = point;
+        window_count = 1;
+    }
+    mutex_exit(&mutex);
+}
+
+
+size_t TrajectoryStore::encode(size_t start, size_t max_points, uint8_t* out, size_t size, size_t& encoded) {
+    encoded = 0;
+    if (size < 1 + ABSOLUTE_POINT_SIZE) {
+        return 0;
+    }
+
+    mutex_enter_blocking(&mutex);
+    size_t total = polyline_size();
+    size_t end = start + max_points < total ? start + max_points : total;
+
+    size_t length = 0;
+    out[length++] = TRAJECTORY_FORMAT_VERSION;
+
+    for (size_t i = start; i < end; i++) {
+        const TrajectoryPoint& point = polyline_point(i);
+        if (i == start) {
+            length += write_u32(out + length, point.time);
+            length += write_u32(out + length, static_cast<uint32_t>(point.latitude_e7));
+            length += write_u32(out + length, static_cast<uint32_t>(point.longitude_e7));
+            length += write_u32(out + length, static_cast<uint32_t>(point.altitude_dm));
+        } else {
+            if (size - length < MAX_DELTA_POINT_SIZE) {
+                break;
+            }
+            const TrajectoryPoint& previous = polyline_point(i - 1);
+            length += write_varint(out + length, static_cast<int32_t>(point.time - previous.time));
+            length += write_varint(out + length, point.latitude_e7 - previous.latitude_e7);
+            length += write_varint(out + length, point.longitude_e7 - previous.longitude_e7);
+            length += write_varint(out + length, point.altitude_dm - previous.altitude_dm);
+        }
+        encoded++;
+    }
+    mutex_exit(&mutex);
+    return length;
+}
+
+
+bool TrajectoryStore::set_tolerance(uint32_t tolerance) {
+    if (tolerance == 0 || tolerance > TRAJECTORY_MAX_TOLERANCE_M) {
+        return false;
+    }
+    mutex_enter_blocking(&mutex);
+    tolerance_m = static_cast<float>(tolerance);
+    stats.tolerance_m = tolerance;
+    mutex_exit(&mutex);
+    return true;
+}
+
+
+void TrajectoryStore::clear() {
+    mutex_enter_blocking(&mutex);
+    head = 0;
+    count = 0;
+    has_anchor = false;
+    window_count = 0;
+    mutex_exit(&mutex);
+}
+
+
+TrajectoryStats TrajectoryStore::get_stats() {
+    mutex_enter_blocking(&mutex);
+    TrajectoryStats copy = stats;
+    copy.stored = polyline_size();
+    mutex_exit(&mutex);
+    return copy;
+}
+
+
+// ==================== private methods
+
+/**
+ * @brief Appends a kept point to the ring.
+ * @param point Point kept by the simplification.
+ */
+void TrajectoryStore::keep(const TrajectoryPoint& point) {
+    points[head] = point;
+    head = (head + 1) % TRAJECTORY_CAPACITY;
+    if (count < TRAJECTORY_CAPACITY) {
+        count++;
+    } else {
+        stats.overwritten++;
+    }
+    stats.kept_points++;
+}
+
+
+/**
+ * @brief Checks that the window points lie within the tolerance of the segment from the anchor to a point.
+ * @param end Candidate end of the segment.
+ * @return True if no window point is further than the tolerance.
+ */
+bool TrajectoryStore::window_fits(const TrajectoryPoint& end) const {
+    float longitude_scale = METRES_PER_E7_DEGREE * cosf(static_cast<float>(anchor.latitude_e7) * 1e-7f * 0.0174532925f);
+    LocalPoint segment = to_local(end, anchor, longitude_scale);
+    float segment_squared = segment.x * segment.x + segment.y * segment.y + segment.z * segment.z;
+    float tolerance_squared = tolerance_m * tolerance_m;
+
+    for (size_t i = 0; i < window_count; i++) {
+        LocalPoint p = to_local(window[i], anchor, longitude_scale);
+        float t = 0.0f;
+        if (segment_squared > 0.0f) {
+            t = (p.x * segment.x + p.y * segment.y + p.z * segment.z) / segment_squared;
+            t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        }
+        float dx = p.x - t * segment.x;
+        float dy = p.y - t * segment.y;
+        float dz = p.z - t * segment.z;
+        if (dx * dx + dy * dy + dz * dz > tolerance_squared) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Gets the number of points of the polyline.
+ * @return Stored points, plus the last window point which ends the polyline.
+ */
+size_t TrajectoryStore::polyline_size() const {
+    return count + (window_count != 0 ? 1 : 0);
+}
+
+
+const TrajectoryPoint& TrajectoryStore::polyline_point(size_t index) const {
+    if (index >= count) {
+        return window[window_count - 1];
+    }
+    return points[(head + TRAJECTORY_CAPACITY - count + index) % TRAJECTORY_CAPACITY];
+}
@@ -0,0 +1,180 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <cstdint>
+#include <cstddef>
+#include "pico/mutex.h"
+
+/**
+ * @file trajectory.h
+ * @brief On-board trajectory store with line simplification
+ * @details Positions are sampled once per TRAJECTORY_SAMPLE_MS and simplified
+ *          on the fly with the sliding (opening) window algorithm: the last
+ *          kept point is the anchor and the points received since form the
+ *          window. A new point extends the window while every window point lies
+ *          within the tolerance of the segment from the anchor to it; otherwise
+ *          the previous point is kept and becomes the new anchor. Straight or
+ *          stationary stretches therefore collapse to their end points, and
+ *          every dropped point is within the tolerance of the stored polyline.
+ *
+ *          Distances are 3D, in metres, on a local flat-earth projection around
+ *          the anchor. When the window fills up, the segment is closed at the
+ *          last window point, which becomes the anchor as if the next point
+ *          did not fit; this bounds the work per point without weakening the
+ *          error bound, at the cost of one extra point per
+ *          TRAJECTORY_WINDOW_SIZE samples on long straight stretches.
+ *
+ *          Kept points go into a ring of TRAJECTORY_CAPACITY points, the oldest
+ *          being overwritten when it is full. The polyline is read out with
+ *          encode() in a compact delta format decoded by the host tool
+ *          tools/trajectory_kml.py.
+ *
+ * @defgroup Location Location
+ * @brief Classes for handling location data.
+ * @{
+ */
+
+/**
+ * @brief One trajectory point.
+ */
+struct TrajectoryPoint {
+    uint32_t time;        /**< UTC time in seconds since the epoch */
+    int32_t latitude_e7;  /**< Latitude in 1e-7 degrees */
+    int32_t longitude_e7; /**< Longitude in 1e-7 degrees */
+    int32_t altitude_dm;  /**< Altitude above mean sea level in decimetres */
+};
+
+/**
+ * @brief Number of kept points stored.
+ */
+static constexpr size_t TRAJECTORY_CAPACITY = 512;
+
+/**
+ * @brief Number of points the sliding window holds.
+ */
+static constexpr size_t TRAJECTORY_WINDOW_SIZE = 32;
+
+/**
+ * @brief Interval between position samples.
+ */
+static constexpr uint32_t TRAJECTORY_SAMPLE_MS = 1000;
+
+/**
+ * @brief Simplification tolerance at boot in metres.
+ */
+static constexpr uint32_t TRAJECTORY_DEFAULT_TOLERANCE_M = 10;
+
+/**
+ * @brief Largest tolerance accepted in metres.
+ */
+static constexpr uint32_t TRAJECTORY_MAX_TOLERANCE_M = 1000;
+
+/**
+ * @brief Most points returned by one read command.
+ * @details Keeps the encoded part below 1 KB.
+ */
+static constexpr size_t TRAJECTORY_MAX_READ_POINTS = 48;
+
+/**
+ * @brief Version byte at the start of an encoded polyline.
+ */
+static constexpr uint8_t TRAJECTORY_FORMAT_VERSION = 1;
+
+/**
+ * @brief Trajectory store counters.
+ */
+struct TrajectoryStats {
+    uint32_t input_points;  /**< Positions sampled */
+    uint32_t kept_points;   /**< Points kept by the simplification */
+    uint32_t overwritten;   /**< Kept points lost to the ring wrapping */
+    uint32_t full_windows;  /**< Segments closed because the window was full */
+    uint32_t stored;        /**< Points of the polyline, stored points plus the current end */
+    uint32_t tolerance_m;   /**< Simplification tolerance in metres */
+};
+
+/**
+ * @brief Samples GPS positions and keeps a simplified polyline.
+ */
+class TrajectoryStore {
+public:
+    /**
+     * @brief Gets the singleton instance of the TrajectoryStore class.
+     * @return A reference to the singleton instance.
+     */
+    static TrajectoryStore& get_instance();
+
+    /**
+     * @brief Samples the latest fix when a sample is due.
+     * @param now_ms Current time in ms since boot.
+     * @details Called from the core 1 loop. Only fresh, valid RMC positions are used.
+     */
+    void process(uint32_t now_ms);
+
+    /**
+     * @brief Adds a position to the simplification.
+     * @param point Position.
+     */
+    void add_point(const TrajectoryPoint& point);
+
+    /**
+     * @brief Encodes part of the polyline.
+     * @param start Index of the first point, 0 being the oldest.
+     * @param max_points Number of points to encode.
+     * @param out Output buffer.
+     * @param size Size of out.
+     * @param[out] encoded Number of points written.
+     * @return Bytes written.
+     * @details Layout, little-endian: version byte, then the first point as
+     *          uint32 time and int32 latitude_e7, longitude_e7, altitude_dm,
+     *          then for every further point the differences to the previous one
+     *          in the same field order as zigzag varints. Each part starts with
+     *          an absolute point, so parts can be decoded independently.
+     */
+    size_t encode(size_t start, size_t max_points, uint8_t* out, size_t size, size_t& encoded);
+
+    /**
+     * @brief Sets the simplification tolerance.
+     * @param tolerance Tolerance in metres, 1 to TRAJECTORY_MAX_TOLERANCE_M.
+     * @return True if the tolerance is valid.
+     * @details Applies to points added from now on.
+     */
+    bool set_tolerance(uint32_t tolerance);
+
+    /**
+     * @brief Clears the stored polyline.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the counters.
+     * @return Copy of the counters.
+     */
+    TrajectoryStats get_stats();
+
+private:
+    TrajectoryStore();
+    TrajectoryStore(const TrajectoryStore&) = delete;
+    TrajectoryStore& operator=(const TrajectoryStore&) = delete;
+
+    void keep(const TrajectoryPoint& point);
+    bool window_fits(const TrajectoryPoint& end) const;
+    size_t polyline_size() const;
+    const TrajectoryPoint& polyline_point(size_t index) const;
+
+    mutex_t mutex;
+    TrajectoryPoint points[TRAJECTORY_CAPACITY];
+    size_t head = 0;
+    size_t count = 0;
+
+    TrajectoryPoint anchor = {};
+    bool has_anchor = false;
+    TrajectoryPoint window[TRAJECTORY_WINDOW_SIZE];
+    size_t window_count = 0;
+
+    float tolerance_m = TRAJECTORY_DEFAULT_TOLERANCE_M;
+    uint32_t last_sample_ms = 0;
+    TrajectoryStats stats = {};
+};
+
+#endif // TRAJECTORY_H
+/** @} */
@@ -0,0 +1,177 @@
+#include "log.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include "pico/multicore.h"
+#include "system_state_manager.h"
+#include "system_log.h"
+
+/**
+ * @file log.cpp
+ * @brief Implementation of the deferred binary logging
+ * @ingroup Logging
+ */
+
+namespace {
+
+/**
+ * @brief Level and format of a log site, indexed by LogSite.
+ */
+struct LogSiteInfo {
+    VerbosityLevel level;
+    const char* format;
+};
+
+const LogSiteInfo log_sites[] = {
+#define LOG_SITE_INFO(name, level, format) {VerbosityLevel::level, format},
+    LOG_SITES(LOG_SITE_INFO)
+#undef LOG_SITE_INFO
+};
+
+static_assert(sizeof(log_sites) / sizeof(log_sites[0]) == static_cast<size_t>(LogSite::COUNT),
+              "LOG_SITES table and LogSite enum out of sync");
+
+/**
+ * @brief Single-producer single-consumer ring of one core.
+ * @details head is only written by the owning core, tail only by log_drain() on core 0.
+ */
+struct LogRing {
+    LogRecord records[LOG_RING_SIZE];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> dropped{0};
+    uint32_t dropped_reported = 0;
+};
+
+LogRing log_rings[2];
+
+/**
+ * @brief Formats a site message, passing every argument as the type its conversion expects.
+ * @param message Output buffer.
+ * @param size Size of the buffer.
+ * @param format Site format with up to three %u / %d / %x.
+ * @param args Raw record arguments.
+ * @details Arguments are stored as uint32_t; a %d conversion gets its argument
+ *          back as int, so negative values such as an RSSI print with their sign.
+ */
+void format_message(char* message, size_t size, const char* format, const uint32_t (&args)[3]) {
+    size_t length = 0;
+    size_t next_arg = 0;
+    message[0] = '\0';
+
+    const char* p = format;
+    while (*p != '\0' && length + 1 < size) {
+        if (*p != '%') {
+            message[length++] = *p++;
+            message[length] = '\0';
+            continue;
+        }
+
+        const char* spec = p++;
+        while (*p != '\0' && strchr("-+ #0123456789", *p) != nullptr) {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        char conversion = *p++;
+        char spec_text[8];
+        size_t spec_length = p - spec;
+        if (conversion == '%' || spec_length >= sizeof(spec_text)) {
+            message[length++] = '%';
+            message[length] = '\0';
+            continue;
+        }
+        memcpy(spec_text, spec, spec_length);
+        spec_text[spec_length] = '\0';
+
+        uint32_t value = next_arg < 3 ? args[next_arg++] : 0;
+        int written = conversion == 'd' ?
+                      snprintf(message + length, size - length, spec_text, static_cast<int>(value)) :
+                      snprintf(message + length, size - length, spec_text, static_cast<unsigned>(value));
+        if (written < 0) {
+            break;
+        }
+        length += static_cast<size_t>(written) < size - length ? written : size - length - 1;
+    }
+}
+
+/**
+ * @brief Formats one record and prints it to the debug UART.
+ * @param record Record to print.
+ * @param core Core that logged the record.
+ */
+void print_record(const LogRecord& record, uint core) {
+    if (record.site >= static_cast<uint16_t>(LogSite::COUNT)) {
+        return;
+    }
+    const LogSiteInfo& info = log_sites[record.site];
+
+    char message[128];
+    format_message(message, sizeof(message), info.format, record.args);
+    if (static_cast<int>(info.level) <= static_cast<int>(SystemStateManager::get_instance().get_uart_verbosity())) {
+        uart_print_line(record.timestamp_ms, core, info.level, message);
+    }
+    SystemLog::get_instance().mirror(record.timestamp_ms, core, info.level, message);
+}
+
+} // namespace
+
+bool log_enabled(VerbosityLevel level) {
+    return static_cast<int>(level) <= static_cast<int>(SystemStateManager::get_instance().get_uart_verbosity()) ||
+           static_cast<int>(level) <= static_cast<int>(SystemLog::get_instance().get_storage_level());
+}
+
+void log_record(LogSite site, uint32_t arg0, uint32_t arg1, uint32_t arg2) {
+    if (!log_enabled(log_sites[static_cast<uint16_t>(site)].level)) {
+        return;
+    }
+
+    LogRing& ring = log_rings[get_core_num()];
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+    uint32_t tail = ring.tail.load(std::memory_order_acquire);
+
+    if (head - tail >= LOG_RING_SIZE) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    LogRecord& record = ring.records[head % LOG_RING_SIZE];
+    record.timestamp_ms = to_ms_since_boot(get_absolute_time());
+    record.site = static_cast<uint16_t>(site);
+    record.reserved = 0;
+    record.args[0] = arg0;
+    record.args[1] = arg1;
+    record.args[2] = arg2;
+
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void log_drain(size_t max_records) {
+    for (uint core = 0; core < 2; core++) {
+        LogRing& ring = log_rings[core];
+        uint32_t head = ring.head.load(std::memory_order_acquire);
+        uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+
+        for (size_t printed = 0; tail != head && printed < max_records; printed++) {
+            print_record(ring.records[tail % LOG_RING_SIZE], core);
+            tail++;
+            ring.tail.store(tail, std::memory_order_release);
+        }
+
+        uint32_t dropped = ring.dropped.load(std::memory_order_relaxed);
+        if (dropped != ring.dropped_reported) {
+            LogRecord notice = {};
+            notice.timestamp_ms = to_ms_since_boot(get_absolute_time());
+            notice.site = static_cast<uint16_t>(LogSite::LOG_RECORDS_DROPPED);
+            notice.args[0] = dropped - ring.dropped_reported;
+            notice.args[1] = core;
+            print_record(notice, core);
+            ring.dropped_reported = dropped;
+        }
+    }
+}
+
+uint32_t log_get_dropped(uint core) {
+    return core < 2 ? log_rings[core].dropped.load(std::memory_order_relaxed) : 0;
+}
@@ -0,0 +1,103 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <cstdint>
+#include <cstddef>
+#include "utils.h"
+
+/**
+ * @file log.h
+ * @brief Deferred binary logging
+ * @details Hot paths log a site ID and up to three integer arguments instead of
+ *          building a string for uart_print(). The record is written to a lock-free
+ *          ring owned by the calling core and formatted later by log_drain() in the
+ *          core 0 main loop. The verbosity filter runs before anything is written,
+ *          so a disabled site costs one comparison.
+ *
+ *          LOG_SITES is the single table of log sites. Site IDs are the position in
+ *          the table, so new sites are appended at the end; tools/log_decode.py reads
+ *          the same table to map the IDs of raw records back to level and format string.
+ *
+ * @defgroup Logging Logging
+ * @brief Deferred binary logging.
+ * @{
+ */
+
+/**
+ * @brief Table of log sites: X(name, level, printf format with up to three %u / %d / %x)
+ */
+#define LOG_SITES(X) \
+    X(LORA_PACKET_SENT,       DEBUG,   "LoRa packet sent, %u bytes in %u us") \
+    X(LORA_CHANNEL_BUSY,      DEBUG,   "LoRa channel busy, transmitting anyway") \
+    X(LORA_FRAME_SENT,        DEBUG,   "Frame %u.%u sent via LoRa in %u packet(s)") \
+    X(LORA_PACKET_RECEIVED,   DEBUG,   "Received LoRa packet of size %u, RSSI %d dBm") \
+    X(LORA_PACKET_OVERSIZE,   ERROR,   "Error: Packet exceeds maximum allowed size!") \
+    X(LORA_PACKET_TOO_SMALL,  ERROR,   "Error: Packet too small to contain metadata!") \
+    X(LORA_DEST_MISMATCH,     ERROR,   "Error: Destination address mismatch! (0x%x)") \
+    X(LORA_SRC_MISMATCH,      ERROR,   "Error: Local address mismatch! (0x%x)") \
+    X(FRAME_DECODE,           WARNING, "Decoding frame of %u bytes") \
+    X(FRAME_EXTRACTED,        DEBUG,   "Extracted frame (length=%u)") \
+    X(FRAME_NOT_FOUND,        WARNING, "No valid frame found in received data") \
+    X(BEACON_SENT,            DEBUG,   "Beacon %u sent") \
+    X(TELEMETRY_COLLECTED,    DEBUG,   "Telemetry collected") \
+    X(EVENT_LOGGED,           WARNING, "Event: %u Group: %u Event: %u") \
+    X(LOG_RECORDS_DROPPED,    WARNING, "%u log records dropped on core %u")
+
+/**
+ * @brief Log site identifiers generated from LOG_SITES.
+ */
+enum class LogSite : uint16_t {
+#define LOG_SITE_ENUM(name, level, format) name,
+    LOG_SITES(LOG_SITE_ENUM)
+#undef LOG_SITE_ENUM
+    COUNT
+};
+
+/**
+ * @brief One deferred log record as stored in the ring.
+ */
+struct LogRecord {
+    uint32_t timestamp_ms;  /**< Time of the call in ms since boot */
+    uint16_t site;          /**< LogSite of the call */
+    uint16_t reserved;      /**< Padding, always 0 */
+    uint32_t args[3];       /**< Raw arguments, interpreted by the site format */
+};
+
+/**
+ * @brief Number of records each core can buffer before records are dropped.
+ */
+static constexpr size_t LOG_RING_SIZE = 64;
+
+/**
+ * @brief Checks whether messages of a level pass the UART verbosity or the SD log storage level.
+ * @param level Message level.
+ * @return True if a message of this level would be printed or stored.
+ */
+bool log_enabled(VerbosityLevel level);
+
+/**
+ * @brief Writes a log record to the ring of the calling core.
+ * @param site Log site.
+ * @param arg0 First argument.
+ * @param arg1 Second argument.
+ * @param arg2 Third argument.
+ * @note Not for use from interrupt handlers - each ring has a single producer.
+ */
+void log_record(LogSite site, uint32_t arg0 = 0, uint32_t arg1 = 0, uint32_t arg2 = 0);
+
+/**
+ * @brief Formats and prints buffered log records.
+ * @param max_records Maximum number of records to print from each core's ring.
+ * @details Called from the core 0 main loop.
+ */
+void log_drain(size_t max_records = LOG_RING_SIZE);
+
+/**
+ * @brief Gets the number of records dropped because a ring was full.
+ * @param core Core number (0 or 1).
+ * @return Records dropped since boot.
+ */
+uint32_t log_get_dropped(uint core);
+
+#endif // LOG_H
+/** @} */
@@ -5,6 +5,7 @@
 #include <iostream>
 #include "pin_config.h"
 #include "utils.h"
+#include "i2c_bus.h"
 #include <sstream>
 
 
@@ -243,13 +244,7 @@ void INA3221::_read(ina3221_reg_t reg, uint16_t *val) {
     uint8_t reg_buf = reg;
     uint8_t data[2];
 
-    int ret = i2c_write_blocking(MAIN_I2C_PORT, _i2c_addr, &reg_buf, 1, true);
-    if (ret != 1) {
-        std::cerr << "Failed to write register address to I2C device." << std::endl;
-        return;
-    }
-
-    ret = i2c_read_blocking(MAIN_I2C_PORT, _i2c_addr, data, 2, false);
+    int ret = i2c_bus_write_read(MAIN_I2C_PORT, _i2c_addr, &reg_buf, 1, data, 2);
     if (ret != 2) {
         std::cerr << "Failed to read data from I2C device." << std::endl;
         return;
@@ -271,7 +266,7 @@ void INA3221::_write(ina3221_reg_t reg, uint16_t *val) {
     buf[1] = (*val >> 8) & 0xFF; // MSB
     buf[2] = (*val) & 0xFF;      // LSB
 
-    int ret = i2c_write_blocking(MAIN_I2C_PORT, _i2c_addr, buf, 3, false);
+    int ret = i2c_bus_write_read(MAIN_I2C_PORT, _i2c_addr, buf, 3, nullptr, 0);
     if (ret != 3) {
         std::cerr << "Failed to write data to I2C device." << std::endl;
     }
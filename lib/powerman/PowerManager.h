@@ -16,6 +16,7 @@
 #define POWER_MANAGER_H
 
 #include "INA3221/INA3221.h"
+#include "power_events.h"
 #include <map>
 #include <string>
 #include <hardware/i2c.h>
@@ -105,13 +106,13 @@ public:
 
 
     /** @brief Solar current threshold in milliamperes. */
-    static constexpr float SOLAR_CURRENT_THRESHOLD = 50.0f;  // mA
+    static constexpr float SOLAR_CURRENT_THRESHOLD = POWER_SOLAR_CURRENT_THRESHOLD;  // mA
     /** @brief USB current threshold in milliamperes. */
-    static constexpr float USB_CURRENT_THRESHOLD = 50.0f;    // mA
+    static constexpr float USB_CURRENT_THRESHOLD = POWER_USB_CURRENT_THRESHOLD;    // mA
     /** @brief Low voltage threshold in volts. */
-    static constexpr float BATTERY_LOW_THRESHOLD = 2.8f;     // V
+    static constexpr float BATTERY_LOW_THRESHOLD = POWER_BATTERY_LOW_THRESHOLD;     // V
     /** @brief Overcharge voltage threshold in volts. */
-    static constexpr float BATTERY_FULL_THRESHOLD = 4.2f; // V
+    static constexpr float BATTERY_FULL_THRESHOLD = POWER_BATTERY_FULL_THRESHOLD; // V
 
 private:
     /** @brief INA3221 instance for power monitoring. */
@@ -0,0 +1,67 @@
+#include "power_events.h"
+
+/**
+ * @file power_events.cpp
+ * @brief Implementation of the power event state machine
+ * @ingroup PowerManagement
+ */
+
+size_t power_events_update(PowerEventState& state, const PowerSample& sample, bool battery_powered, PowerEvent* events) {
+    size_t count = 0;
+
+    if (sample.charge_current_usb > POWER_USB_CURRENT_THRESHOLD && !state.usb_charging_active) {
+        events[count++] = PowerEvent::USB_CONNECTED;
+        state.usb_charging_active = true;
+    }
+    else if (sample.charge_current_usb < POWER_USB_CURRENT_THRESHOLD && state.usb_charging_active) {
+        events[count++] = PowerEvent::USB_DISCONNECTED;
+        state.usb_charging_active = false;
+    }
+
+    if (sample.charge_current_solar > POWER_SOLAR_CURRENT_THRESHOLD && !state.solar_charging_active) {
+        events[count++] = PowerEvent::SOLAR_ACTIVE;
+        state.solar_charging_active = true;
+    }
+    else if (sample.charge_current_solar < POWER_SOLAR_CURRENT_THRESHOLD && state.solar_charging_active) {
+        events[count++] = PowerEvent::SOLAR_INACTIVE;
+        state.solar_charging_active = false;
+    }
+
+    if (!battery_powered) {
+        if (state.battery_low || state.battery_full) {
+            events[count++] = PowerEvent::BATTERY_NORMAL;
+            state.battery_low = false;
+            state.battery_full = false;
+        }
+    }
+    else if (sample.battery_voltage < POWER_BATTERY_LOW_THRESHOLD && !state.battery_low) {
+        events[count++] = PowerEvent::BATTERY_LOW;
+        state.battery_low = true;
+        state.battery_full = false;
+    }
+    else if (sample.battery_voltage > POWER_BATTERY_FULL_THRESHOLD && !state.battery_full) {
+        events[count++] = PowerEvent::BATTERY_FULL;
+        state.battery_full = true;
+        state.battery_low = false;
+    }
+    else if (sample.battery_voltage > POWER_BATTERY_LOW_THRESHOLD && state.battery_low) {
+        events[count++] = PowerEvent::BATTERY_NORMAL;
+        state.battery_low = false;
+    }
+    else if (sample.battery_voltage < POWER_BATTERY_FULL_THRESHOLD && state.battery_full) {
+        events[count++] = PowerEvent::BATTERY_NORMAL;
+        state.battery_full = false;
+    }
+
+    float charge_current = sample.charge_current_solar + sample.charge_current_usb;
+    if (charge_current > sample.discharge_current && !state.discharge_active) {
+        events[count++] = PowerEvent::CHARGING;
+        state.discharge_active = true;
+    }
+    else if (charge_current < sample.discharge_current && state.discharge_active) {
+        events[count++] = PowerEvent::DISCHARGING;
+        state.discharge_active = false;
+    }
+
+    return count;
+}
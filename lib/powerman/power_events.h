@@ -0,0 +1,70 @@
+/**
+ * @file power_events.h
+ * @brief Power events derived from the measured voltages and currents
+ * @details The battery level events (BATTERY_LOW, BATTERY_FULL and
+ *          BATTERY_NORMAL) drive the default load shedding reaction rules.
+ *          They are only derived in SystemOperatingMode::BATTERY_POWERED:
+ *          on USB power the battery channel reads whatever is, or is not,
+ *          connected, typically below BATTERY_LOW_THRESHOLD without a cell.
+ *
+ *          Kept free of SDK dependencies so tools/power_events_replay.cpp
+ *          can replay recorded telemetry through it.
+ *
+ * @ingroup PowerManagement
+ */
+
+#ifndef POWER_EVENTS_H
+#define POWER_EVENTS_H
+
+#include <cstddef>
+#include "event_codes.h"
+
+/** @brief Solar current threshold in milliamperes. */
+static constexpr float POWER_SOLAR_CURRENT_THRESHOLD = 50.0f;
+/** @brief USB current threshold in milliamperes. */
+static constexpr float POWER_USB_CURRENT_THRESHOLD = 50.0f;
+/** @brief Low voltage threshold in volts. */
+static constexpr float POWER_BATTERY_LOW_THRESHOLD = 2.8f;
+/** @brief Overcharge voltage threshold in volts. */
+static constexpr float POWER_BATTERY_FULL_THRESHOLD = 4.2f;
+
+/**
+ * @brief Largest number of events one sample can produce.
+ */
+static constexpr size_t POWER_EVENTS_MAX_PER_SAMPLE = 4;
+
+/**
+ * @brief One power measurement.
+ */
+struct PowerSample {
+    float battery_voltage;      /**< Battery voltage in V */
+    float charge_current_usb;   /**< USB charge current in mA */
+    float charge_current_solar; /**< Solar charge current in mA */
+    float discharge_current;    /**< Battery discharge current in mA */
+};
+
+/**
+ * @brief Power states last reported.
+ */
+struct PowerEventState {
+    bool usb_charging_active = false;
+    bool solar_charging_active = false;
+    bool battery_low = false;
+    bool battery_full = false;
+    bool discharge_active = true;
+};
+
+/**
+ * @brief Updates the power states with a sample and lists the events of the changes.
+ * @param state States, updated.
+ * @param sample Measurement.
+ * @param battery_powered True in SystemOperatingMode::BATTERY_POWERED.
+ * @param[out] events Receives up to POWER_EVENTS_MAX_PER_SAMPLE events.
+ * @return Number of events.
+ * @details Without battery power no battery level event is produced; a low
+ *          or full state left from battery operation is ended with
+ *          BATTERY_NORMAL so the load shedding rules are undone.
+ */
+size_t power_events_update(PowerEventState& state, const PowerSample& sample, bool battery_powered, PowerEvent* events);
+
+#endif // POWER_EVENTS_H
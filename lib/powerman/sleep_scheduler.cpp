@@ -0,0 +1,204 @@
+#include "sleep_scheduler.h"
+#include "hardware/uart.h"
+#include "hardware/irq.h"
+#include "pin_config.h"
+#include "system_state_manager.h"
+
+/**
+ * @file sleep_scheduler.cpp
+ * @brief Implementation of the core sleep scheduler
+ * @ingroup PowerManagement
+ */
+
+namespace {
+
+/**
+ * @brief Sleep of core 1 when sleeping is disabled, the former loop delay.
+ */
+constexpr uint32_t LEGACY_CORE1_DELAY_MS = 10;
+
+// Typical RP2040 supply currents at 125 MHz, from the datasheet power figures
+constexpr float CURRENT_BASE_MA = 6.0f;          // clocks, peripherals, XIP flash
+constexpr float CURRENT_CORE_ACTIVE_MA = 7.0f;   // per core executing
+constexpr float CURRENT_CORE_SLEEP_MA = 1.0f;    // per core waiting in WFE
+
+uint debug_uart_irq() {
+    return DEBUG_UART_PORT == uart0 ? UART0_IRQ : UART1_IRQ;
+}
+
+}
+
+
+SleepScheduler& SleepScheduler::get_instance() {
+    static SleepScheduler instance;
+    return instance;
+}
+
+
+SleepScheduler::SleepScheduler() {
+    mutex_init(&mutex);
+}
+
+
+void SleepScheduler::init() {
+    if (uart_wake_installed) {
+        return;
+    }
+    irq_set_exclusive_handler(debug_uart_irq(), uart_wake_handler);
+    irq_set_enabled(debug_uart_irq(), true);
+    uart_wake_installed = true;
+}
+
+
+/**
+ * @brief Sleeps the calling core until a deadline, the maximum idle time or an interrupt.
+ * @param deadline_ms Time of the next scheduled work in ms since boot.
+ * @details The time since the previous idle() of the core is counted as active,
+ *          the time spent here as sleep. On core 0 the debug UART receive
+ *          interrupt is armed first; it fires at once if bytes are waiting.
+ *          A request_fast_poll() since the previous idle() shortens the limit
+ *          to SLEEP_FAST_POLL_MS.
+ */
+void SleepScheduler::idle(uint32_t deadline_ms) {
+    uint core = get_core_num();
+    bool fast = fast_poll[core];
+    fast_poll[core] = false;
+    if (!enabled) {
+        if (core == 1) {
+            sleep_ms(LEGACY_CORE1_DELAY_MS);
+        }
+        return;
+    }
+
+    uint32_t max_idle = max_idle_ms[core];
+    if (fast && max_idle > SLEEP_FAST_POLL_MS) {
+        max_idle = SLEEP_FAST_POLL_MS;
+    }
+
+    uint64_t start_us = time_us_64();
+    uint32_t now_ms = static_cast<uint32_t>(start_us / 1000);
+    uint32_t limit_ms = now_ms + max_idle;
+    if (static_cast<int32_t>(deadline_ms - limit_ms) > 0) {
+        deadline_ms = limit_ms;
+    }
+
+    bool slept = false;
+    bool timed_out = true;
+    if (static_cast<int32_t>(deadline_ms - now_ms) > 0) {
+        if (core == 0 && uart_wake_installed) {
+            uart_set_irq_enables(DEBUG_UART_PORT, true, false);
+        }
+        timed_out = best_effort_wfe_or_timeout(from_us_since_boot(static_cast<uint64_t>(deadline_ms) * 1000));
+        slept = true;
+    }
+    uint64_t end_us = time_us_64();
+
+    size_t mode = current_mode();
+    mutex_enter_blocking(&mutex);
+    SleepCoreStats& counters = stats[mode].cores[core];
+    if (last_wake_us[core] != 0) {
+        counters.active_us += start_us - last_wake_us[core];
+    }
+    if (slept) {
+        counters.sleep_us += end_us - start_us;
+        counters.wakeups++;
+        if (!timed_out) {
+            counters.early_wakeups++;
+        }
+    }
+    last_wake_us[core] = end_us;
+    mutex_exit(&mutex);
+}
+
+
+void SleepScheduler::request_fast_poll() {
+    fast_poll[get_core_num()] = true;
+}
+
+
+void SleepScheduler::idle() {
+    idle(to_ms_since_boot(get_absolute_time()) + max_idle_ms[get_core_num()]);
+}
+
+
+void SleepScheduler::set_enabled(bool enable) {
+    mutex_enter_blocking(&mutex);
+    if (enable && !enabled) {
+        // the time spent spinning while disabled is not counted
+        last_wake_us[0] = 0;
+        last_wake_us[1] = 0;
+    }
+    enabled = enable;
+    mutex_exit(&mutex);
+}
+
+
+bool SleepScheduler::set_max_idle(uint core, uint32_t max_idle) {
+    if (core >= 2 || max_idle == 0 || max_idle > SLEEP_MAX_IDLE_LIMIT_MS) {
+        return false;
+    }
+    max_idle_ms[core] = max_idle;
+    return true;
+}
+
+
+void SleepScheduler::record_current_sample(float discharge_current_ma) {
+    size_t mode = current_mode();
+    mutex_enter_blocking(&mutex);
+    SleepModeStats& counters = stats[mode];
+    counters.current_sum_ma += discharge_current_ma;
+    counters.current_samples++;
+    mutex_exit(&mutex);
+}
+
+
+SleepModeStats SleepScheduler::get_stats(size_t mode) {
+    SleepModeStats copy = {};
+    if (mode >= SLEEP_MODE_COUNT) {
+        return copy;
+    }
+    mutex_enter_blocking(&mutex);
+    copy = stats[mode];
+    mutex_exit(&mutex);
+    return copy;
+}
+
+
+/**
+ * @brief Estimates the average MCU current from the core duty cycles.
+ * @param stats Counters to evaluate.
+ * @param busy If true, estimate the same period with both cores always awake.
+ * @return Estimated average RP2040 current in mA, 0 if no time was counted.
+ */
+float SleepScheduler::estimate_current_ma(const SleepModeStats& stats, bool busy) {
+    float current = CURRENT_BASE_MA;
+    bool counted = false;
+    for (const SleepCoreStats& core : stats.cores) {
+        double total = static_cast<double>(core.active_us + core.sleep_us);
+        if (total <= 0.0) {
+            continue;
+        }
+        counted = true;
+        double duty = busy ? 1.0 : core.active_us / total;
+        current += static_cast<float>(duty * CURRENT_CORE_ACTIVE_MA + (1.0 - duty) * CURRENT_CORE_SLEEP_MA);
+    }
+    return counted ? current : 0.0f;
+}
+
+
+// ==================== private methods
+
+/**
+ * @brief Debug UART receive interrupt.
+ * @details Only ends the sleep of core 0: the interrupt masks itself and the
+ *          bytes stay in the FIFO for handle_uart_input().
+ */
+void SleepScheduler::uart_wake_handler() {
+    uart_set_irq_enables(DEBUG_UART_PORT, false, false);
+}
+
+
+size_t SleepScheduler::current_mode() const {
+    size_t mode = static_cast<size_t>(SystemStateManager::get_instance().get_operating_mode());
+    return mode < SLEEP_MODE_COUNT ? mode : 0;
+}
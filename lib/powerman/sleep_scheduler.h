@@ -0,0 +1,189 @@
+/**
+ * @file sleep_scheduler.h
+ * @brief Sleep of both cores between scheduled work
+ * @details The main loops of both cores used to spin: core 0 polled the radio
+ *          and the UART continuously and core 1 woke every 10 ms. Each loop now
+ *          ends with idle(), which puts the core to sleep (WFE, clocks kept
+ *          running) until the next scheduled work of that core - the next
+ *          telemetry sample on core 1 - but at most the core's maximum idle
+ *          time, which bounds the latency of the polled work (radio duty cycle,
+ *          GPS ring buffer, beacon).
+ *
+ *          Only interrupts taken on the sleeping core end its sleep early. The
+ *          one wake source installed for this is a debug UART receive
+ *          interrupt armed before each sleep of core 0, so commands are handled
+ *          as soon as they arrive. The radio is not interrupt driven (DIO0 is
+ *          not reliably wired and its flags are read by the polled receive), so
+ *          LoRa reception latency is bounded by the core 0 maximum idle time,
+ *          SLEEP_DEFAULT_MAX_IDLE_CORE0_MS by default. The GPS UART interrupt
+ *          runs on core 0 and does not wake core 1, so sentences are parsed
+ *          within the core 1 maximum idle time, SLEEP_DEFAULT_MAX_IDLE_CORE1_MS
+ *          by default; the receive ring buffer absorbs the bytes meanwhile.
+ *
+ *          Work that needs a short loop period for a while - the RTC seconds
+ *          edge hunt of TimeService, the RMC reception before a GPS time sync -
+ *          calls request_fast_poll() before idle(), which then sleeps at most
+ *          SLEEP_FAST_POLL_MS.
+ *
+ *          The time each core spends awake and asleep is counted per
+ *          SystemOperatingMode, together with the measured board discharge
+ *          current, and an average MCU current is estimated from typical RP2040
+ *          figures.
+ *
+ * @ingroup PowerManagement
+ */
+
+#ifndef SLEEP_SCHEDULER_H
+#define SLEEP_SCHEDULER_H
+
+#include <cstdint>
+#include "pico/stdlib.h"
+#include "pico/mutex.h"
+
+/**
+ * @brief Number of operating modes counted, see SystemOperatingMode.
+ */
+static constexpr size_t SLEEP_MODE_COUNT = 2;
+
+/**
+ * @brief Default longest sleep of core 0 in ms, the radio and UART polling latency without an interrupt.
+ */
+static constexpr uint32_t SLEEP_DEFAULT_MAX_IDLE_CORE0_MS = 50;
+
+/**
+ * @brief Default longest sleep of core 1 in ms, the GPS and housekeeping latency.
+ */
+static constexpr uint32_t SLEEP_DEFAULT_MAX_IDLE_CORE1_MS = 100;
+
+/**
+ * @brief Longest sleep in ms after request_fast_poll(), half of the former 10 ms loop delay.
+ */
+static constexpr uint32_t SLEEP_FAST_POLL_MS = 5;
+
+/**
+ * @brief Longest accepted maximum sleep in ms.
+ */
+static constexpr uint32_t SLEEP_MAX_IDLE_LIMIT_MS = 1000;
+
+/**
+ * @brief Time counters of one core in one operating mode.
+ */
+struct SleepCoreStats {
+    uint64_t active_us;     /**< Time awake */
+    uint64_t sleep_us;      /**< Time asleep in idle() */
+    uint32_t wakeups;       /**< Sleeps ended */
+    uint32_t early_wakeups; /**< Sleeps ended by an interrupt before the deadline */
+};
+
+/**
+ * @brief Counters of one operating mode.
+ */
+struct SleepModeStats {
+    SleepCoreStats cores[2];    /**< Per core */
+    float current_sum_ma;       /**< Sum of the measured discharge current samples */
+    uint32_t current_samples;   /**< Number of discharge current samples */
+};
+
+/**
+ * @brief Puts the cores to sleep between their scheduled work.
+ * @ingroup PowerManagement
+ */
+class SleepScheduler {
+public:
+    /**
+     * @brief Gets the singleton instance of the SleepScheduler class.
+     * @return A reference to the singleton instance.
+     */
+    static SleepScheduler& get_instance();
+
+    /**
+     * @brief Installs the debug UART receive interrupt that wakes core 0.
+     * @details Called on core 0 after the UART is initialised.
+     */
+    void init();
+
+    /**
+     * @brief Sleeps the calling core until a deadline, the maximum idle time or an interrupt.
+     * @param deadline_ms Time of the next scheduled work in ms since boot.
+     * @details Returns at once if the deadline has passed. When sleeping is
+     *          disabled, core 0 returns at once and core 1 sleeps 10 ms as
+     *          before.
+     */
+    void idle(uint32_t deadline_ms);
+
+    /**
+     * @brief Sleeps the calling core for at most its maximum idle time.
+     */
+    void idle();
+
+    /**
+     * @brief Limits the next idle() of the calling core to SLEEP_FAST_POLL_MS.
+     * @details Called every loop for as long as the fast loop is needed.
+     */
+    void request_fast_poll();
+
+    /**
+     * @brief Enables or disables sleeping.
+     * @param enable True to sleep between work.
+     */
+    void set_enabled(bool enable);
+
+    bool is_enabled() const { return enabled; }
+
+    /**
+     * @brief Sets the longest sleep of a core.
+     * @param core Core number.
+     * @param max_idle_ms 1 to SLEEP_MAX_IDLE_LIMIT_MS.
+     * @return True if the values are valid.
+     */
+    bool set_max_idle(uint core, uint32_t max_idle_ms);
+
+    /**
+     * @brief Gets the longest sleep of a core.
+     * @param core Core number.
+     * @return Maximum sleep in ms.
+     */
+    uint32_t get_max_idle(uint core) const { return core < 2 ? max_idle_ms[core] : 0; }
+
+    /**
+     * @brief Records a measured board discharge current for the current operating mode.
+     * @param discharge_current_ma Discharge current in mA.
+     * @details Called from the telemetry collection on core 1.
+     */
+    void record_current_sample(float discharge_current_ma);
+
+    /**
+     * @brief Gets the counters of an operating mode.
+     * @param mode Operating mode index, see SystemOperatingMode.
+     * @return Copy of the counters.
+     */
+    SleepModeStats get_stats(size_t mode);
+
+    /**
+     * @brief Estimates the average MCU current from the core duty cycles.
+     * @param stats Counters to evaluate.
+     * @param busy If true, estimate the same period with both cores always awake.
+     * @return Estimated average RP2040 current in mA, 0 if no time was counted.
+     * @details Uses typical RP2040 figures at 125 MHz; the board current
+     *          measured by the INA3221 also covers the radio, GPS and sensors.
+     */
+    static float estimate_current_ma(const SleepModeStats& stats, bool busy);
+
+private:
+    SleepScheduler();
+    SleepScheduler(const SleepScheduler&) = delete;
+    SleepScheduler& operator=(const SleepScheduler&) = delete;
+
+    static void uart_wake_handler();
+    size_t current_mode() const;
+
+    mutex_t mutex;
+    volatile bool enabled = true;
+    uint32_t max_idle_ms[2] = {SLEEP_DEFAULT_MAX_IDLE_CORE0_MS, SLEEP_DEFAULT_MAX_IDLE_CORE1_MS};
+    uint64_t last_wake_us[2] = {0, 0};
+    volatile bool fast_poll[2] = {false, false};
+    bool uart_wake_installed = false;
+    SleepModeStats stats[SLEEP_MODE_COUNT] = {};
+};
+
+#endif // SLEEP_SCHEDULER_H
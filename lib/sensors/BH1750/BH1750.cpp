@@ -8,6 +8,7 @@
 
 #include "BH1750.h"
 #include "pico/stdlib.h"
+#include "i2c_bus.h"
 #include <stdio.h>
 #include <iostream>
 
@@ -65,12 +66,33 @@ bool BH1750::configure(Mode mode) {
  * @return Light level in lux.
  */
 float BH1750::get_light_level() {
+    float lux = 0.0f;
+    read_light_level(&lux);
+    return lux;
+}
+
+/**
+ * @ingroup BH1750
+ * @brief Reads the light level from the BH1750 sensor, reporting bus errors.
+ * @param lux Pointer to store the light level in lux.
+ * @return True if the read was successful, false otherwise.
+ */
+bool BH1750::read_light_level(float* lux) {
     uint8_t buffer[2];
-    i2c_read_blocking(i2c_port_, _i2c_addr, buffer, 2, false);
+    if (read_pending_) {
+        read_pending_ = false;
+        if (i2c_bus_wait(i2c_port_, &read_transaction_) != I2cResult::OK) {
+            return false;
+        }
+        buffer[0] = read_buffer_[0];
+        buffer[1] = read_buffer_[1];
+    } else if (i2c_bus_write_read(i2c_port_, _i2c_addr, nullptr, 0, buffer, 2) != 2) {
+        return false;
+    }
     uint16_t level = (buffer[0] << 8) | buffer[1];
 
-    float lux = static_cast<float>(level) / 1.2f;
-    return lux;
+    *lux = static_cast<float>(level) / 1.2f;
+    return true;
 }
 
 /**
@@ -80,5 +102,24 @@ float BH1750::get_light_level() {
  */
 void BH1750::write8(uint8_t data) {
     uint8_t buf[1] = {data};
-    i2c_write_blocking(i2c_port_, _i2c_addr, buf, 1, false);
+    i2c_bus_write_read(i2c_port_, _i2c_addr, buf, 1, nullptr, 0);
+}
+
+/**
+ * @ingroup BH1750
+ * @brief Queues a read of the light level on the I2C bus.
+ * @return True if the read is queued or already pending, false otherwise.
+ * @details The next read_light_level() waits for this read instead of
+ *          starting its own, so the transfer overlaps other work.
+ */
+bool BH1750::start_light_level_read() {
+    if (read_pending_) {
+        return true;
+    }
+    read_transaction_ = I2cTransaction();
+    read_transaction_.address = _i2c_addr;
+    read_transaction_.read_data = read_buffer_;
+    read_transaction_.read_length = sizeof(read_buffer_);
+    read_pending_ = i2c_bus_submit(i2c_port_, &read_transaction_);
+    return read_pending_;
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #define __BH1750_H__
 
 #include "hardware/i2c.h"
+#include "i2c_bus.h"
 
 /**
  * @defgroup BH1750 BH1750 Light Sensor
@@ -111,6 +112,19 @@ public:
      */
     float get_light_level();
 
+    /**
+     * @brief Reads the light level from the BH1750 sensor, reporting bus errors.
+     * @param lux Pointer to store the light level in lux.
+     * @return True if the read was successful, false otherwise.
+     */
+    bool read_light_level(float* lux);
+
+    /**
+     * @brief Queues a read of the light level on the I2C bus.
+     * @return True if the read is queued or already pending, false otherwise.
+     */
+    bool start_light_level_read();
+
 private:
     /**
      * @brief Writes a single byte of data to the BH1750 sensor.
@@ -122,6 +136,13 @@ private:
     uint8_t _i2c_addr;
     /** @brief Pointer to the I2C interface */
     i2c_inst_t* i2c_port_;
+
+    /** @brief Queued light level read */
+    I2cTransaction read_transaction_;
+    /** @brief Buffer of the queued read */
+    uint8_t read_buffer_[2] = {0, 0};
+    /** @brief True while the queued read has not been collected */
+    bool read_pending_ = false;
 };
 
  #endif // __BH1750_H__
\ No newline at end of file
@@ -18,6 +18,21 @@ float BH1750Wrapper::read_data(SensorDataTypeIdentifier type) {
     return 0.0f;
 }
 
+SensorReading BH1750Wrapper::read_all() {
+    SensorReading reading;
+    float lux;
+    if (initialized_ && sensor_.read_light_level(&lux)) {
+        reading.set(SensorDataTypeIdentifier::LIGHT_LEVEL, lux);
+    }
+    return reading;
+}
+
+void BH1750Wrapper::start_acquisition() {
+    if (initialized_) {
+        sensor_.start_light_level_read();
+    }
+}
+
 bool BH1750Wrapper::is_initialized() const { 
     return initialized_; 
 }
@@ -17,6 +17,8 @@ public:
     int get_i2c_addr();
     bool init() override;
     float read_data(SensorDataTypeIdentifier type) override;
+    SensorReading read_all() override;
+    void start_acquisition() override;
     bool is_initialized() const override;
     SensorType get_type() const override;
     
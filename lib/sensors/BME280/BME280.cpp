@@ -15,6 +15,7 @@
 #include "pico/binary_info.h"
 #include "pico/stdlib.h"
 #include "utils.h"
+#include "i2c_bus.h"
 
 /**
  * @brief Constructor for the BME280 class.
@@ -22,7 +23,8 @@
  * @param address I2C address of the BME280 sensor (default: ADDR_SDO_LOW).
  */
 BME280::BME280(i2c_inst_t* i2cPort, uint8_t address)
-    : i2c_port(i2cPort), device_addr(address), calib_params{}, initialized_(false), t_fine(0) {
+    : i2c_port(i2cPort), device_addr(address), calib_params{}, initialized_(false), t_fine(0),
+      measurement_start_(nil_time) {
 }
 
 /**
@@ -72,6 +74,66 @@ void BME280::reset() {
     sleep_ms(10); // Wait for reset to complete
 }
 
+/**
+ * @brief Applies new acquisition settings.
+ * @param settings Settings to apply.
+ * @return True if the settings are valid and were written, false otherwise.
+ */
+bool BME280::apply_settings(const Settings& settings) {
+    if (settings.temperature_osr == Oversampling::OSR_X0 ||
+        settings.temperature_osr > Oversampling::OSR_X16 ||
+        settings.pressure_osr > Oversampling::OSR_X16 ||
+        settings.humidity_osr > Oversampling::OSR_X16 ||
+        settings.filter > Filter::X16 ||
+        settings.standby > Standby::MS_20) {
+        return false;
+    }
+
+    settings_ = settings;
+    measurement_pending_ = false;
+    if (!initialized_) {
+        // written by init()
+        return true;
+    }
+    return configure_sensor();
+}
+
+/**
+ * @brief Starts a measurement in forced mode.
+ * @return True if a measurement was started or is running, false otherwise.
+ */
+bool BME280::start_measurement() {
+    if (settings_.mode != Mode::FORCED || measurement_pending_) {
+        return true;
+    }
+    if (!write_register(REG_CTRL_MEAS, ctrl_meas_value(Mode::FORCED))) {
+        return false;
+    }
+    measurement_start_ = get_absolute_time();
+    measurement_pending_ = true;
+    return true;
+}
+
+/**
+ * @brief Gets the longest duration of one measurement.
+ * @return Maximum measurement time in microseconds.
+ * @details Datasheet 9.1: 1.25 ms + 2.3 ms per temperature sample, and
+ *          0.575 ms + 2.3 ms per sample for pressure and humidity if measured.
+ */
+uint32_t BME280::get_measurement_time_us() const {
+    auto samples = [](Oversampling osr) -> uint32_t {
+        return osr == Oversampling::OSR_X0 ? 0 : 1u << (static_cast<uint8_t>(osr) - 1);
+    };
+    uint32_t time_us = 1250 + 2300 * samples(settings_.temperature_osr);
+    if (settings_.pressure_osr != Oversampling::OSR_X0) {
+        time_us += 575 + 2300 * samples(settings_.pressure_osr);
+    }
+    if (settings_.humidity_osr != Oversampling::OSR_X0) {
+        time_us += 575 + 2300 * samples(settings_.humidity_osr);
+    }
+    return time_us;
+}
+
 /**
  * @brief Reads all raw data from the sensor.
  * @param temperature Pointer to store the raw temperature value.
@@ -85,20 +147,21 @@ bool BME280::read_raw_all(int32_t* temperature, int32_t* pressure, int32_t* humi
         return false;
     }
 
-    // Define the starting register address
-    uint8_t start_reg = REG_PRESSURE_MSB;
+    if (settings_.mode == Mode::FORCED) {
+        if (!measurement_pending_ && !start_measurement()) {
+            uart_print("Failed to start BME280 measurement.", VerbosityLevel::ERROR);
+            return false;
+        }
+        // the sensor is back in sleep with the result once the measurement time has passed
+        sleep_until(delayed_by_us(measurement_start_, get_measurement_time_us()));
+        measurement_pending_ = false;
+    }
+
     // Total bytes to read: 3 (pressure) + 3 (temperature) + 2 (humidity) = 8
     uint8_t buf[8] = {0};
 
-    // Write the starting register address
-    if (!write_register(start_reg, 1)) {
-        uart_print("Failed to write to BME280.", VerbosityLevel::ERROR);
-        return false;
-    }
-
-    // Read data
-    int ret = i2c_read_blocking(i2c_port, device_addr, buf, 8, false);
-    if (ret != 8) {
+    // Set the register pointer and read the burst in one transaction
+    if (!read_register(REG_PRESSURE_MSB, buf, 8)) {
         uart_print("Failed to read from BME280.", VerbosityLevel::ERROR);
         return false;
     }
@@ -111,6 +174,26 @@ bool BME280::read_raw_all(int32_t* temperature, int32_t* pressure, int32_t* humi
     return true;
 }
 
+/**
+ * @brief Reads and compensates temperature, pressure and humidity from one burst.
+ * @param temperature Pointer to store the temperature in degrees Celsius.
+ * @param pressure Pointer to store the pressure in hPa.
+ * @param humidity Pointer to store the relative humidity in %.
+ * @return True if the data was read successfully, false otherwise.
+ */
+bool BME280::read_compensated(float* temperature, float* pressure, float* humidity) {
+    int32_t temp_raw, pressure_raw, humidity_raw;
+    if (!read_raw_all(&temp_raw, &pressure_raw, &humidity_raw)) {
+        return false;
+    }
+
+    // convert_temperature() updates t_fine, used by the other two
+    *temperature = convert_temperature(temp_raw);
+    *pressure = convert_pressure(pressure_raw);
+    *humidity = convert_humidity(humidity_raw);
+    return true;
+}
+
 /**
  * @brief Converts raw temperature data to degrees Celsius.
  * @param temp_raw Raw temperature value.
@@ -216,24 +299,33 @@ bool BME280::get_calibration_parameters() {
 }
 
 /**
- * @brief Configures the sensor with default settings.
+ * @brief Writes the acquisition settings to the sensor.
  * @return True if the configuration was successful, false otherwise.
  */
 bool BME280::configure_sensor() {
-    // Set humidity oversampling (must be set before ctrl_meas)
-    if (!write_register(REG_CTRL_HUM, HUMIDITY_OVERSAMPLING)) {
+    // Sleep first: config writes may be ignored in normal mode
+    if (!write_register(REG_CTRL_MEAS, ctrl_meas_value(Mode::SLEEP))) {
+        uart_print("Failed to write CTRL_MEAS to BME280.", VerbosityLevel::ERROR);
+        return false;
+    }
+
+    // Set humidity oversampling (takes effect with the next ctrl_meas write)
+    if (!write_register(REG_CTRL_HUM, static_cast<uint8_t>(settings_.humidity_osr))) {
         uart_print("Failed to write CTRL_HUM to BME280.", VerbosityLevel::ERROR);
         return false;
     }
 
-    // Write config register
-    if (!write_register(REG_CONFIG, 0x00)) {
+    // Write config register: standby time, IIR filter, no SPI 3-wire
+    uint8_t config = static_cast<uint8_t>(static_cast<uint8_t>(settings_.standby) << 5 |
+                                          static_cast<uint8_t>(settings_.filter) << 2);
+    if (!write_register(REG_CONFIG, config)) {
         uart_print("Failed to write CONFIG to BME280.", VerbosityLevel::ERROR);
         return false;
     }
 
-    // Write ctrl_meas register
-    if (!write_register(REG_CTRL_MEAS, NORMAL_MODE)) {
+    // Normal mode starts measuring now; forced mode waits for start_measurement()
+    Mode mode = settings_.mode == Mode::NORMAL ? Mode::NORMAL : Mode::SLEEP;
+    if (!write_register(REG_CTRL_MEAS, ctrl_meas_value(mode))) {
         uart_print("Failed to write CTRL_MEAS to BME280.", VerbosityLevel::ERROR);
         return false;
     }
@@ -241,6 +333,17 @@ bool BME280::configure_sensor() {
     return true;
 }
 
+/**
+ * @brief Gets the ctrl_meas register value for a mode.
+ * @param mode Power mode.
+ * @return Register value with the temperature and pressure oversampling.
+ */
+uint8_t BME280::ctrl_meas_value(Mode mode) const {
+    return static_cast<uint8_t>(static_cast<uint8_t>(settings_.temperature_osr) << 5 |
+                                static_cast<uint8_t>(settings_.pressure_osr) << 2 |
+                                static_cast<uint8_t>(mode));
+}
+
 /**
  * @brief Helper function for I2C writes.
  * @param reg Register address to write to.
@@ -249,7 +352,7 @@ bool BME280::configure_sensor() {
  */
 bool BME280::write_register(uint8_t reg, uint8_t value) {
     uint8_t buf[2] = {reg, value};
-    int ret = i2c_write_blocking(i2c_port, device_addr, buf, 2, false);
+    int ret = i2c_bus_write_read(i2c_port, device_addr, buf, 2, nullptr, 0);
     return (ret == 2);
 }
 
@@ -261,12 +364,8 @@ bool BME280::write_register(uint8_t reg, uint8_t value) {
  * @return True if the read was successful, false otherwise.
  */
 bool BME280::read_register(uint8_t reg, uint8_t* data, size_t len) {
-    int ret = i2c_write_blocking(i2c_port, device_addr, &reg, 1, true);
-    if (ret != 1) {
-        return false;
-    }
-    ret = i2c_read_blocking(i2c_port, device_addr, data, len, false);
-    return (static_cast<size_t>(ret) == len);
+    int ret = i2c_bus_write_read(i2c_port, device_addr, &reg, 1, data, len);
+    return (ret >= 0 && static_cast<size_t>(ret) == len);
 }
 
 /**
@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <iostream>
 #include "hardware/i2c.h"
+#include "pico/time.h"
 
 /**
  * @brief Structure to hold the BME280 calibration parameters.
@@ -101,6 +102,76 @@ public:
         OSR_X16 = 0x05
     };
 
+    /**
+     * @brief Enum class for the sensor power modes.
+     */
+    enum class Mode : uint8_t {
+        /** @brief No measurements, lowest power */
+        SLEEP = 0x00,
+        /** @brief One measurement per trigger, then back to sleep */
+        FORCED = 0x01,
+        /** @brief Continuous measurements separated by the standby time */
+        NORMAL = 0x03
+    };
+
+    /**
+     * @brief Enum class for the IIR filter coefficient.
+     */
+    enum class Filter : uint8_t {
+        /** @brief Filter off */
+        OFF = 0x00,
+        /** @brief Coefficient 2 */
+        X2 = 0x01,
+        /** @brief Coefficient 4 */
+        X4 = 0x02,
+        /** @brief Coefficient 8 */
+        X8 = 0x03,
+        /** @brief Coefficient 16 */
+        X16 = 0x04
+    };
+
+    /**
+     * @brief Enum class for the standby time between measurements in normal mode.
+     */
+    enum class Standby : uint8_t {
+        /** @brief 0.5 ms */
+        MS_0_5 = 0x00,
+        /** @brief 62.5 ms */
+        MS_62_5 = 0x01,
+        /** @brief 125 ms */
+        MS_125 = 0x02,
+        /** @brief 250 ms */
+        MS_250 = 0x03,
+        /** @brief 500 ms */
+        MS_500 = 0x04,
+        /** @brief 1000 ms */
+        MS_1000 = 0x05,
+        /** @brief 10 ms */
+        MS_10 = 0x06,
+        /** @brief 20 ms */
+        MS_20 = 0x07
+    };
+
+    /**
+     * @brief Acquisition settings.
+     * @details The defaults follow the datasheet weather monitoring profile,
+     *          with pressure oversampled 4x for the barometric altitude.
+     */
+    struct Settings {
+        /** @brief Power mode */
+        Mode mode = Mode::FORCED;
+        /** @brief Temperature oversampling, must not be OSR_X0 */
+        Oversampling temperature_osr = Oversampling::OSR_X1;
+        /** @brief Pressure oversampling, OSR_X0 skips the measurement */
+        Oversampling pressure_osr = Oversampling::OSR_X4;
+        /** @brief Humidity oversampling, OSR_X0 skips the measurement */
+        Oversampling humidity_osr = Oversampling::OSR_X1;
+        /** @brief IIR filter coefficient, applied to pressure and temperature */
+        Filter filter = Filter::OFF;
+        /** @brief Standby time, used in normal mode only */
+        Standby standby = Standby::MS_1000;
+    };
+
     /**
      * @brief Constructor for the BME280 class.
      * @param i2cPort Pointer to the I2C interface.
@@ -119,15 +190,57 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Applies new acquisition settings.
+     * @param settings Settings to apply.
+     * @return True if the settings are valid and were written, false otherwise.
+     * @details The sensor is put to sleep first, since the config register may
+     *          be ignored in normal mode.
+     */
+    bool apply_settings(const Settings& settings);
+
+    /**
+     * @brief Gets the acquisition settings.
+     * @return The current settings.
+     */
+    Settings get_settings() const { return settings_; }
+
+    /**
+     * @brief Starts a measurement in forced mode.
+     * @return True if a measurement was started or is running, false otherwise.
+     * @details Does nothing in the other modes. The result is read by
+     *          read_raw_all() once the measurement time has passed.
+     */
+    bool start_measurement();
+
+    /**
+     * @brief Gets the longest duration of one measurement.
+     * @return Maximum measurement time in microseconds, from the datasheet formula.
+     */
+    uint32_t get_measurement_time_us() const;
+
     /**
      * @brief Reads all raw data from the sensor.
      * @param temperature Pointer to store the raw temperature value.
      * @param pressure Pointer to store the raw pressure value.
      * @param humidity Pointer to store the raw humidity value.
      * @return True if the data was read successfully, false otherwise.
+     * @details In forced mode a measurement is started if none is running,
+     *          and the call waits until the measurement time has passed.
      */
     bool read_raw_all(int32_t* temperature, int32_t* pressure, int32_t* humidity);
 
+    /**
+     * @brief Reads and compensates temperature, pressure and humidity from one burst.
+     * @param temperature Pointer to store the temperature in degrees Celsius.
+     * @param pressure Pointer to store the pressure in hPa.
+     * @param humidity Pointer to store the relative humidity in %.
+     * @return True if the data was read successfully, false otherwise.
+     * @details The temperature is converted first, so the pressure and
+     *          humidity are compensated with the t_fine of the same burst.
+     */
+    bool read_compensated(float* temperature, float* pressure, float* humidity);
+
     /**
      * @brief Converts raw temperature data to degrees Celsius.
      * @param temp_raw Raw temperature value.
@@ -176,11 +289,18 @@ private:
     bool read_register(uint8_t reg, uint8_t* data, size_t len);
 
     /**
-     * @brief Configures the sensor with default settings.
+     * @brief Writes the acquisition settings to the sensor.
      * @return True if the configuration was successful, false otherwise.
      */
     bool configure_sensor();
 
+    /**
+     * @brief Gets the ctrl_meas register value for a mode.
+     * @param mode Power mode.
+     * @return Register value with the temperature and pressure oversampling.
+     */
+    uint8_t ctrl_meas_value(Mode mode) const;
+
     /**
      * @brief Retrieves the calibration parameters from the sensor.
      * @return True if the parameters were read successfully, false otherwise.
@@ -201,6 +321,15 @@ private:
     /** @brief Fine temperature parameter needed for compensation */
     mutable int32_t t_fine;
 
+    /** @brief Acquisition settings */
+    Settings settings_;
+
+    /** @brief True while a forced measurement has been started and not read */
+    bool measurement_pending_ = false;
+
+    /** @brief Time the pending forced measurement was started */
+    absolute_time_t measurement_start_;
+
     /**
      * @brief Register Definitions for the BME280 sensor.
      */
@@ -250,16 +379,6 @@ private:
         REG_DIG_H6            = 0xE7   ///< Humidity calibration data
     };
 
-    /**
-     * @brief Sensor settings.
-     */
-    enum {
-        HUMIDITY_OVERSAMPLING = static_cast<uint8_t>(Oversampling::OSR_X16),  ///< Humidity oversampling setting
-        TEMPERATURE_OVERSAMPLING = static_cast<uint8_t>(Oversampling::OSR_X16), ///< Temperature oversampling setting
-        PRESSURE_OVERSAMPLING = static_cast<uint8_t>(Oversampling::OSR_X16),    ///< Pressure oversampling setting
-        NORMAL_MODE = 0xB7                                                        ///< Normal mode setting
-    };
-
     /**
      * @brief Calibration data length.
      */
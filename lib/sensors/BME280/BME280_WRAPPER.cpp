@@ -1,4 +1,29 @@
 #include "BME280_WRAPPER.h"
+#include "utils.h"
+
+namespace {
+
+// Option names, indexed by the register value of the setting
+const char* const MODE_NAMES[] = {"sleep", "forced", "", "normal"};
+const char* const OVERSAMPLING_NAMES[] = {"0", "1", "2", "4", "8", "16"};
+const char* const FILTER_NAMES[] = {"0", "2", "4", "8", "16"};
+const char* const STANDBY_NAMES[] = {"0.5", "62.5", "125", "250", "500", "1000", "10", "20"};
+
+/**
+ * @brief Looks up an option name.
+ * @return Register value of the option, -1 if unknown.
+ */
+template <size_t N>
+int find_option(const char* const (&names)[N], const std::string& value) {
+    for (size_t i = 0; i < N; i++) {
+        if (value == names[i] && names[i][0] != '\0') {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+}
 
 BME280Wrapper::BME280Wrapper(i2c_inst_t* i2c) : sensor_(i2c) {}
 
@@ -8,21 +33,40 @@ bool BME280Wrapper::init() {
 }
 
 float BME280Wrapper::read_data(SensorDataTypeIdentifier type) {
-    int32_t temp_raw, pressure_raw, humidity_raw;
-    sensor_.read_raw_all(&temp_raw, &pressure_raw, &humidity_raw);
-
     switch(type) {
         case SensorDataTypeIdentifier::TEMPERATURE:
-            return sensor_.convert_temperature(temp_raw);
         case SensorDataTypeIdentifier::PRESSURE:
-            return sensor_.convert_pressure(pressure_raw);
         case SensorDataTypeIdentifier::HUMIDITY:
-            return sensor_.convert_humidity(humidity_raw);
+            return read_all().get(type, 0.0f);
         default:
             return 0.0f;
     }
 }
 
+SensorReading BME280Wrapper::read_all() {
+    SensorReading reading;
+    float temperature, pressure, humidity;
+    BME280::Settings settings = sensor_.get_settings();
+    // in sleep mode the data registers hold the last measurement
+    if (initialized_ && settings.mode != BME280::Mode::SLEEP &&
+        sensor_.read_compensated(&temperature, &pressure, &humidity)) {
+        reading.set(SensorDataTypeIdentifier::TEMPERATURE, temperature);
+        if (settings.pressure_osr != BME280::Oversampling::OSR_X0) {
+            reading.set(SensorDataTypeIdentifier::PRESSURE, pressure);
+        }
+        if (settings.humidity_osr != BME280::Oversampling::OSR_X0) {
+            reading.set(SensorDataTypeIdentifier::HUMIDITY, humidity);
+        }
+    }
+    return reading;
+}
+
+void BME280Wrapper::start_acquisition() {
+    if (initialized_) {
+        sensor_.start_measurement();
+    }
+}
+
 bool BME280Wrapper::is_initialized() const {
     return initialized_;
 }
@@ -31,6 +75,69 @@ SensorType BME280Wrapper::get_type() const {
     return SensorType::ENVIRONMENT;
 }
 
-bool BME280Wrapper::configure([[maybe_unused]] const std::map<std::string, std::string>& config) {
-    return true;
+/**
+ * @brief Configures the acquisition.
+ * @param config Keys: mode (sleep, forced, normal), temperature_oversampling,
+ *               pressure_oversampling, humidity_oversampling (0, 1, 2, 4, 8, 16;
+ *               0 skips the value, not allowed for temperature), filter
+ *               (0, 2, 4, 8, 16) and standby_ms (0.5, 10, 20, 62.5, 125, 250,
+ *               500, 1000; normal mode only). Missing keys keep their value.
+ * @return True if all keys are valid and the settings were written.
+ */
+bool BME280Wrapper::configure(const std::map<std::string, std::string>& config) {
+    BME280::Settings settings = sensor_.get_settings();
+    for (const auto& [key, value] : config) {
+        int option = -1;
+        if (key == "mode") {
+            option = find_option(MODE_NAMES, value);
+            settings.mode = static_cast<BME280::Mode>(option);
+        }
+        else if (key == "temperature_oversampling") {
+            option = find_option(OVERSAMPLING_NAMES, value);
+            settings.temperature_osr = static_cast<BME280::Oversampling>(option);
+        }
+        else if (key == "pressure_oversampling") {
+            option = find_option(OVERSAMPLING_NAMES, value);
+            settings.pressure_osr = static_cast<BME280::Oversampling>(option);
+        }
+        else if (key == "humidity_oversampling") {
+            option = find_option(OVERSAMPLING_NAMES, value);
+            settings.humidity_osr = static_cast<BME280::Oversampling>(option);
+        }
+        else if (key == "filter") {
+            option = find_option(FILTER_NAMES, value);
+            settings.filter = static_cast<BME280::Filter>(option);
+        }
+        else if (key == "standby_ms") {
+            option = find_option(STANDBY_NAMES, value);
+            settings.standby = static_cast<BME280::Standby>(option);
+        }
+        else {
+            uart_print("[BME280Wrapper] Unknown configuration key: " + key, VerbosityLevel::WARNING);
+            return false;
+        }
+
+        if (option < 0) {
+            uart_print("[BME280Wrapper] Unknown " + key + " value: " + value, VerbosityLevel::WARNING);
+            return false;
+        }
+    }
+    return sensor_.apply_settings(settings);
+}
+
+/**
+ * @brief Gets the acquisition settings with the configure() keys.
+ * @return The settings, plus the read-only measurement_us, the longest measurement time.
+ */
+std::map<std::string, std::string> BME280Wrapper::get_configuration() const {
+    BME280::Settings settings = sensor_.get_settings();
+    return {
+        {"mode", MODE_NAMES[static_cast<uint8_t>(settings.mode)]},
+        {"temperature_oversampling", OVERSAMPLING_NAMES[static_cast<uint8_t>(settings.temperature_osr)]},
+        {"pressure_oversampling", OVERSAMPLING_NAMES[static_cast<uint8_t>(settings.pressure_osr)]},
+        {"humidity_oversampling", OVERSAMPLING_NAMES[static_cast<uint8_t>(settings.humidity_osr)]},
+        {"filter", FILTER_NAMES[static_cast<uint8_t>(settings.filter)]},
+        {"standby_ms", STANDBY_NAMES[static_cast<uint8_t>(settings.standby)]},
+        {"measurement_us", std::to_string(sensor_.get_measurement_time_us())},
+    };
 }
\ No newline at end of file
@@ -15,9 +15,12 @@ public:
 
     bool init() override;
     float read_data(SensorDataTypeIdentifier type) override;
+    SensorReading read_all() override;
     bool is_initialized() const override;
     SensorType get_type() const override;
     bool configure(const std::map<std::string, std::string>& config) override;
+    std::map<std::string, std::string> get_configuration() const override;
+    void start_acquisition() override;
 
     uint8_t get_address() const override {
         return 0x76;
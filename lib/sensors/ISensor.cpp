@@ -49,7 +49,10 @@ bool SensorWrapper::sensor_configure(SensorType type, const std::map<std::string
     if (sensors.find(type) == sensors.end()) {
         return false;
     }
-    return sensors[type]->configure(config);
+    mutex_enter_blocking(&sensors_mutex);
+    bool result = sensors[type]->configure(config);
+    mutex_exit(&sensors_mutex);
+    return result;
 }
 
 /**
@@ -63,7 +66,58 @@ float SensorWrapper::sensor_read_data(SensorType sensorType, SensorDataTypeIdent
     if (sensors.find(sensorType) == sensors.end()) {
         return -1.0f;
     }
-    return sensors[sensorType]->read_data(dataType);
+    mutex_enter_blocking(&sensors_mutex);
+    float value = sensors[sensorType]->read_data(dataType);
+    mutex_exit(&sensors_mutex);
+    return value;
+}
+
+/**
+ * @brief Reads all data types of a sensor in one acquisition.
+ * @param[in] sensorType Sensor type to read from.
+ * @return The values read; none is valid if the sensor is not present.
+ * @ingroup Sensors
+ */
+SensorReading SensorWrapper::sensor_read_all(SensorType sensorType) {
+    auto it = sensors.find(sensorType);
+    if (it == sensors.end() || it->second == nullptr) {
+        return SensorReading();
+    }
+    mutex_enter_blocking(&sensors_mutex);
+    SensorReading reading = it->second->read_all();
+    mutex_exit(&sensors_mutex);
+    return reading;
+}
+
+/**
+ * @brief Starts a triggered measurement of a sensor ahead of sensor_read_all().
+ * @param[in] sensorType Sensor type to trigger.
+ * @ingroup Sensors
+ */
+void SensorWrapper::sensor_start_acquisition(SensorType sensorType) {
+    auto it = sensors.find(sensorType);
+    if (it != sensors.end() && it->second != nullptr) {
+        mutex_enter_blocking(&sensors_mutex);
+        it->second->start_acquisition();
+        mutex_exit(&sensors_mutex);
+    }
+}
+
+/**
+ * @brief Gets the configuration of a sensor.
+ * @param[in] type Sensor type.
+ * @return A map of configuration parameters, empty if the sensor is not present.
+ * @ingroup Sensors
+ */
+std::map<std::string, std::string> SensorWrapper::sensor_get_configuration(SensorType type) {
+    auto it = sensors.find(type);
+    if (it == sensors.end() || it->second == nullptr) {
+        return {};
+    }
+    mutex_enter_blocking(&sensors_mutex);
+    std::map<std::string, std::string> config = it->second->get_configuration();
+    mutex_exit(&sensors_mutex);
+    return config;
 }
 
 /**
@@ -22,6 +22,7 @@
 #include <vector>
 #include <utility>
 #include "hardware/i2c.h"
+#include "pico/mutex.h"
 
 /**
  * @brief Enumeration of sensor types.
@@ -55,6 +56,55 @@ enum class SensorDataTypeIdentifier : uint8_t {
     PRESSURE = 0x04,
 };
 
+/**
+ * @brief Number of sensor data type identifiers, including NONE.
+ * @ingroup Sensors
+ */
+static constexpr size_t SENSOR_DATA_TYPE_COUNT = 5;
+
+/**
+ * @brief All values of a sensor from one acquisition.
+ * @details A sensor fills every value it measures from the same bus
+ *          transaction, so the values are consistent with each other. A value
+ *          is valid only if the sensor is initialised and the read succeeded.
+ * @ingroup Sensors
+ */
+struct SensorReading {
+    /** @brief Values indexed by SensorDataTypeIdentifier. */
+    float values[SENSOR_DATA_TYPE_COUNT] = {};
+    /** @brief Bit (1 << identifier) set for every valid value. */
+    uint8_t valid_mask = 0;
+
+    /**
+     * @brief Stores a valid value.
+     * @param[in] type Data type of the value.
+     * @param[in] value The value.
+     */
+    void set(SensorDataTypeIdentifier type, float value) {
+        values[static_cast<uint8_t>(type)] = value;
+        valid_mask |= 1u << static_cast<uint8_t>(type);
+    }
+
+    /**
+     * @brief Checks whether a value was read.
+     * @param[in] type Data type to check.
+     * @return True if the value is valid.
+     */
+    bool is_valid(SensorDataTypeIdentifier type) const {
+        return (valid_mask & (1u << static_cast<uint8_t>(type))) != 0;
+    }
+
+    /**
+     * @brief Gets a value.
+     * @param[in] type Data type to get.
+     * @param[in] fallback Value returned if the value is not valid.
+     * @return The value, or fallback.
+     */
+    float get(SensorDataTypeIdentifier type, float fallback = -1.0f) const {
+        return is_valid(type) ? values[static_cast<uint8_t>(type)] : fallback;
+    }
+};
+
 /**
  * @brief Abstract base class for sensors.
  * @details Defines the interface for interacting with different types of sensors.
@@ -81,6 +131,19 @@ public:
      */
     virtual float read_data(SensorDataTypeIdentifier type) = 0;
 
+    /**
+     * @brief Reads all data types of the sensor in one acquisition.
+     * @return The values read, with their validity flags.
+     */
+    virtual SensorReading read_all() = 0;
+
+    /**
+     * @brief Starts a triggered measurement ahead of read_all().
+     * @details Sensors measuring on demand start converting here, so the
+     *          conversion overlaps other work; the others do nothing.
+     */
+    virtual void start_acquisition() {}
+
     /**
      * @brief Checks if the sensor is initialized.
      * @return True if the sensor is initialized, false otherwise.
@@ -100,6 +163,12 @@ public:
      */
     virtual bool configure(const std::map<std::string, std::string>& config) = 0;
 
+    /**
+     * @brief Gets the sensor configuration.
+     * @return A map of the configuration parameters accepted by configure().
+     */
+    virtual std::map<std::string, std::string> get_configuration() const { return {}; }
+
     /**
      * @brief Gets the I2C address of the sensor.
      * @return The I2C address of the sensor.
@@ -148,6 +217,26 @@ public:
      */
     float sensor_read_data(SensorType sensorType, SensorDataTypeIdentifier dataType);
 
+    /**
+     * @brief Reads all data types of a sensor in one acquisition.
+     * @param[in] sensorType Sensor type to read from.
+     * @return The values read; none is valid if the sensor is not present.
+     */
+    SensorReading sensor_read_all(SensorType sensorType);
+
+    /**
+     * @brief Starts a triggered measurement of a sensor ahead of sensor_read_all().
+     * @param[in] sensorType Sensor type to trigger.
+     */
+    void sensor_start_acquisition(SensorType sensorType);
+
+    /**
+     * @brief Gets the configuration of a sensor.
+     * @param[in] type Sensor type.
+     * @return A map of configuration parameters, empty if the sensor is not present.
+     */
+    std::map<std::string, std::string> sensor_get_configuration(SensorType type);
+
     /**
      * @brief Gets a sensor.
      * @param[in] type Sensor type to get.
@@ -172,10 +261,15 @@ private:
     /** @brief Map of sensor types to sensor instances. */
     std::map<SensorType, ISensor*> sensors;
 
+    /** @brief Serialises sensor bus access between the command handlers and telemetry. */
+    mutex_t sensors_mutex;
+
     /**
      * @brief Private constructor for the singleton pattern.
      */
-    SensorWrapper() = default;
+    SensorWrapper() {
+        mutex_init(&sensors_mutex);
+    }
 };
 
 #endif
@@ -0,0 +1,197 @@
+#include "system_log.h"
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include "system_state_manager.h"
+
+/**
+ * @file system_log.cpp
+ * @brief Implementation of the persistent system log.
+ * @ingroup Storage
+ */
+
+static_assert((SystemLog::RING_SIZE & (SystemLog::RING_SIZE - 1)) == 0, "RING_SIZE must be a power of two");
+
+namespace {
+
+/**
+ * @brief Gets the one-letter level tag used in the log file.
+ * @param level The verbosity level.
+ * @return Level tag.
+ */
+char level_tag(VerbosityLevel level) {
+    switch (level) {
+        case VerbosityLevel::ERROR:   return 'E';
+        case VerbosityLevel::WARNING: return 'W';
+        case VerbosityLevel::INFO:    return 'I';
+        case VerbosityLevel::DEBUG:   return 'D';
+        default:                      return '-';
+    }
+}
+
+} // namespace
+
+SystemLog::SystemLog() {
+    critical_section_init(&ring_lock);
+    mutex_init(&file_mutex);
+}
+
+/**
+ * @brief Reads the current log size and marks the boot in the log.
+ * @ingroup Storage
+ */
+void SystemLog::init() {
+    struct stat file_stat;
+    file_size = (stat(SYSTEM_LOG_PATH, &file_stat) == 0) ? file_stat.st_size : 0;
+    initialized = true;
+
+    mirror(to_ms_since_boot(get_absolute_time()), get_core_num(), VerbosityLevel::ERROR, "System init started");
+}
+
+/**
+ * @brief Copies a formatted line into the RAM ring if its level is stored.
+ * @ingroup Storage
+ */
+void SystemLog::mirror(uint32_t timestamp, uint core_num, VerbosityLevel level, const char* msg) {
+    if (level == VerbosityLevel::SILENT ||
+        static_cast<int>(level) > static_cast<int>(storage_level)) {
+        return;
+    }
+
+    char line[MAX_LINE_LENGTH + 24];
+    int length = snprintf(line, sizeof(line), "%lu;%u;%c;%.*s\n",
+                          static_cast<unsigned long>(timestamp), core_num, level_tag(level),
+                          static_cast<int>(MAX_LINE_LENGTH), msg);
+    if (length <= 0) {
+        return;
+    }
+    size_t size = static_cast<size_t>(length) < sizeof(line) ? length : sizeof(line) - 1;
+
+    critical_section_enter_blocking(&ring_lock);
+    if (RING_SIZE - (head - tail) < size) {
+        dropped_bytes += size;
+        critical_section_exit(&ring_lock);
+        return;
+    }
+
+    uint32_t start = head & (RING_SIZE - 1);
+    size_t first = RING_SIZE - start;
+    if (first > size) {
+        first = size;
+    }
+    memcpy(&ring[start], line, first);
+    memcpy(&ring[0], line + first, size - first);
+    head += size;
+    critical_section_exit(&ring_lock);
+}
+
+/**
+ * @brief Writes pending ring content to the SD card.
+ * @ingroup Storage
+ */
+void SystemLog::process(uint32_t current_time) {
+    if (!initialized || !SystemStateManager::get_instance().is_sd_card_mounted()) {
+        return;
+    }
+
+    critical_section_enter_blocking(&ring_lock);
+    uint32_t pending = head - tail;
+    uint32_t read_start = tail;
+    critical_section_exit(&ring_lock);
+
+    if (pending == 0) {
+        last_write_time = current_time;
+        return;
+    }
+
+    size_t to_write;
+    if (pending >= SECTOR_SIZE) {
+        to_write = pending - (pending % SECTOR_SIZE);
+    } else if (current_time - last_write_time >= FLUSH_TIMEOUT_MS) {
+        to_write = pending;
+    } else {
+        return;
+    }
+    if (to_write > MAX_WRITE_SIZE) {
+        to_write = MAX_WRITE_SIZE;
+    }
+
+    // only this function advances tail, so the range stays valid without the lock
+    static char chunk[MAX_WRITE_SIZE];
+    uint32_t start = read_start & (RING_SIZE - 1);
+    size_t first = RING_SIZE - start;
+    if (first > to_write) {
+        first = to_write;
+    }
+    memcpy(chunk, &ring[start], first);
+    memcpy(chunk + first, &ring[0], to_write - first);
+
+    mutex_enter_blocking(&file_mutex);
+    if (file_size + to_write > MAX_FILE_SIZE) {
+        rotate();
+    }
+
+    FILE* file = fopen(SYSTEM_LOG_PATH, "a");
+    size_t written = 0;
+    if (file) {
+        written = fwrite(chunk, 1, to_write, file);
+        fclose(file);
+        file_size += written;
+    }
+    mutex_exit(&file_mutex);
+
+    if (written == to_write) {
+        critical_section_enter_blocking(&ring_lock);
+        tail += to_write;
+        critical_section_exit(&ring_lock);
+        last_write_time = current_time;
+    }
+}
+
+/**
+ * @brief Moves the log to the first backup, dropping the oldest backup.
+ * @details Caller holds file_mutex.
+ */
+void SystemLog::rotate() {
+    remove(SYSTEM_LOG_BACKUP_2_PATH);
+    rename(SYSTEM_LOG_BACKUP_1_PATH, SYSTEM_LOG_BACKUP_2_PATH);
+    rename(SYSTEM_LOG_PATH, SYSTEM_LOG_BACKUP_1_PATH);
+    file_size = 0;
+}
+
+/**
+ * @brief Reads a range from the end of the log file.
+ * @ingroup Storage
+ */
+std::string SystemLog::read_tail(size_t offset_from_end, size_t length, size_t& size) {
+    std::string data;
+    size = 0;
+
+    if (!initialized || !SystemStateManager::get_instance().is_sd_card_mounted()) {
+        return data;
+    }
+
+    if (length > MAX_READ_LENGTH) {
+        length = MAX_READ_LENGTH;
+    }
+
+    mutex_enter_blocking(&file_mutex);
+    size = file_size;
+    if (offset_from_end < size) {
+        size_t end = size - offset_from_end;
+        size_t begin = (end > length) ? end - length : 0;
+
+        FILE* file = fopen(SYSTEM_LOG_PATH, "r");
+        if (file) {
+            if (fseek(file, static_cast<long>(begin), SEEK_SET) == 0) {
+                data.resize(end - begin);
+                size_t read = fread(&data[0], 1, end - begin, file);
+                data.resize(read);
+            }
+            fclose(file);
+        }
+    }
+    mutex_exit(&file_mutex);
+
+    return data;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file system_log.h
+ * @brief Persistent system log on the SD card
+ *
+ * @details Lines printed with uart_print() at or above a configurable storage
+ *          level are mirrored into a RAM ring. SystemLog::process(), run from the
+ *          core 1 loop next to the telemetry flush, appends the ring to
+ *          SYSTEM_LOG_PATH in sector-sized writes. The log is rotated to
+ *          SYSTEM_LOG_PATH.1 / .2 when it grows past MAX_FILE_SIZE. Mirroring
+ *          only copies into the ring, so callers never wait for the SD card; if
+ *          the ring is full the line is dropped and counted.
+ *
+ * @ingroup Storage
+ * @{
+ */
+
+#ifndef SYSTEM_LOG_H
+#define SYSTEM_LOG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+#include "utils.h"
+
+#define SYSTEM_LOG_PATH "/log.txt"
+#define SYSTEM_LOG_BACKUP_1_PATH "/log.1.txt"
+#define SYSTEM_LOG_BACKUP_2_PATH "/log.2.txt"
+
+/**
+ * @class SystemLog
+ * @brief Asynchronous, size-capped log file on the SD card.
+ * @details File line format: <ms since boot>;<core>;<E|W|I|D>;<message>
+ * @ingroup Storage
+ */
+class SystemLog {
+public:
+    /**
+     * @brief Gets the singleton instance of the SystemLog class.
+     * @return A reference to the singleton instance.
+     */
+    static SystemLog& get_instance() {
+        static SystemLog instance;
+        return instance;
+    }
+
+    /**
+     * @brief Reads the current log size and marks the boot in the log.
+     * @details Called once the SD card is mounted. Lines mirrored before that are
+     *          kept in the ring and written on the first process() call.
+     */
+    void init();
+
+    /**
+     * @brief Copies a formatted line into the RAM ring if its level is stored.
+     * @param timestamp Time of the message in ms since boot.
+     * @param core_num Core that produced the message.
+     * @param level Message level; SILENT (protocol frames) is never stored.
+     * @param msg Message text.
+     * @details Safe to call from both cores; never touches the SD card.
+     */
+    void mirror(uint32_t timestamp, uint core_num, VerbosityLevel level, const char* msg);
+
+    /**
+     * @brief Writes pending ring content to the SD card.
+     * @param current_time Current time in ms since boot.
+     * @details Writes whole sectors as soon as they are available and flushes a
+     *          partial sector once it has waited FLUSH_TIMEOUT_MS. Call from core 1.
+     */
+    void process(uint32_t current_time);
+
+    /**
+     * @brief Reads a range from the end of the log file.
+     * @param offset_from_end Number of bytes between the end of the range and the end of the file.
+     * @param length Maximum number of bytes to read.
+     * @param[out] file_size Size of the log file.
+     * @return The bytes read, empty if the range is outside the file or the card is not mounted.
+     */
+    std::string read_tail(size_t offset_from_end, size_t length, size_t& file_size);
+
+    /**
+     * @brief Gets the least severe level that is stored.
+     * @return Storage level.
+     */
+    VerbosityLevel get_storage_level() const { return storage_level; }
+
+    /**
+     * @brief Sets the least severe level that is stored.
+     * @param level New storage level, SILENT disables the log.
+     */
+    void set_storage_level(VerbosityLevel level) { storage_level = level; }
+
+    /**
+     * @brief Gets the number of bytes dropped because the ring was full.
+     * @return Dropped bytes since boot.
+     */
+    uint32_t get_dropped_bytes() const { return dropped_bytes; }
+
+    /** @brief Size of the RAM ring in bytes, power of two. */
+    static constexpr size_t RING_SIZE = 8192;
+    /** @brief SD sector size, the unit of regular writes. */
+    static constexpr size_t SECTOR_SIZE = 512;
+    /** @brief Largest single write to the card. */
+    static constexpr size_t MAX_WRITE_SIZE = 4 * SECTOR_SIZE;
+    /** @brief Time after which a partial sector is written anyway. */
+    static constexpr uint32_t FLUSH_TIMEOUT_MS = 10000;
+    /** @brief Log size that triggers a rotation. */
+    static constexpr size_t MAX_FILE_SIZE = 256 * 1024;
+    /** @brief Longest message stored per line, longer messages are truncated. */
+    static constexpr size_t MAX_LINE_LENGTH = 160;
+    /** @brief Largest range returned by read_tail(). */
+    static constexpr size_t MAX_READ_LENGTH = 1024;
+
+private:
+    SystemLog();
+    SystemLog(const SystemLog&) = delete;
+    SystemLog& operator=(const SystemLog&) = delete;
+
+    void rotate();
+
+    char ring[RING_SIZE];
+    uint32_t head = 0;                /**< Free-running write counter, guarded by ring_lock */
+    uint32_t tail = 0;                /**< Free-running read counter, guarded by ring_lock */
+    critical_section_t ring_lock;
+    mutex_t file_mutex;               /**< Serializes the writer and read_tail() */
+
+    VerbosityLevel storage_level = VerbosityLevel::WARNING;
+    volatile uint32_t dropped_bytes = 0;
+    uint32_t last_write_time = 0;
+    size_t file_size = 0;
+    bool initialized = false;
+};
+
+#endif // SYSTEM_LOG_H
+/** @} */
@@ -0,0 +1,102 @@
+#include "swinging_door.h"
+#include <cmath>
+
+/**
+ * @file swinging_door.cpp
+ * @brief Implementation of the swinging door compressor
+ * @ingroup TelemetryManager
+ */
+
+bool SwingingDoor::configure(float new_deviation, uint32_t new_max_interval_s) {
+    deviation = new_deviation > 0.0f ? new_deviation : 0.0f;
+    max_interval_s = new_max_interval_s;
+    return reset();
+}
+
+
+bool SwingingDoor::reset() {
+    // the snapshot is only decided by the next sample, which now starts a new line
+    bool keep = started;
+    if (keep) {
+        stats.kept++;
+    }
+    started = false;
+    snapshot_is_archive = false;
+    return keep;
+}
+
+
+/**
+ * @brief Adds a sample.
+ * @param time Sample time in seconds.
+ * @param value Sample value.
+ * @return True if the previous sample must be kept; false for the first sample.
+ * @details The previous sample is kept when it is the archive (the very first
+ *          sample), when the line from the archive to the new sample leaves the
+ *          doors, when the archive would get older than the maximum interval, or
+ *          when a sample is not finite. Checking the line itself, rather than
+ *          only whether the doors crossed, is what bounds the error of the
+ *          line ending at the kept sample.
+ */
+bool SwingingDoor::add(uint32_t time, float value) {
+    stats.samples++;
+
+    if (!started) {
+        started = true;
+        snapshot_is_archive = true;
+        archive_time = time;
+        archive_value = value;
+        snapshot_time = time;
+        snapshot_value = value;
+        return false;
+    }
+
+    bool keep = false;
+    if (snapshot_is_archive) {
+        keep = true;
+        snapshot_is_archive = false;
+        open_doors(time, value);
+    } else {
+        uint32_t elapsed = time - archive_time;
+        bool finite = std::isfinite(value) && std::isfinite(snapshot_value) && std::isfinite(archive_value);
+        bool closed = deviation <= 0.0f || !finite || elapsed == 0 || elapsed > max_interval_s;
+
+        if (!closed) {
+            // the line to the new sample must stay between the doors of all samples since the archive
+            float slope = (value - archive_value) / static_cast<float>(elapsed);
+            float margin = deviation / static_cast<float>(elapsed);
+            upper_slope = slope + margin < upper_slope ? slope + margin : upper_slope;
+            lower_slope = slope - margin > lower_slope ? slope - margin : lower_slope;
+            closed = slope > upper_slope || slope < lower_slope;
+        }
+
+        if (closed) {
+            keep = true;
+            archive_time = snapshot_time;
+            archive_value = snapshot_value;
+            open_doors(time, value);
+        }
+    }
+
+    if (keep) {
+        stats.kept++;
+    }
+    snapshot_time = time;
+    snapshot_value = value;
+    return keep;
+}
+
+
+// ==================== private methods
+
+/**
+ * @brief Opens the doors from the archive to a new sample.
+ * @param time Sample time.
+ * @param value Sample value.
+ */
+void SwingingDoor::open_doors(uint32_t time, float value) {
+    uint32_t elapsed = time - archive_time;
+    float span = static_cast<float>(elapsed != 0 ? elapsed : 1);
+    upper_slope = (value + deviation - archive_value) / span;
+    lower_slope = (value - deviation - archive_value) / span;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file swinging_door.h
+ * @brief Swinging door compression of slowly changing telemetry channels
+ * @details The compressor sees every sample but only keeps the ones needed to
+ *          rebuild the signal by linear interpolation within an absolute error.
+ *          Starting from the last kept (archived) point, two doors pivot around
+ *          it at +/- deviation: every new sample narrows the range of slopes a
+ *          line from the archive may have to pass within the deviation of all
+ *          samples since. When the line to a new sample falls outside that
+ *          range, the previous sample is kept and becomes the new archive. Every
+ *          dropped sample therefore lies within the deviation of the line
+ *          between its kept neighbours.
+ *
+ *          The decision for a sample is made when the next one arrives, so a
+ *          kept sample is known one sample late. A sample is also kept when the
+ *          last kept one is more than the maximum interval old, and samples that
+ *          are not finite are always kept.
+ *
+ *          The class has no Pico SDK dependency; tools/deadband_eval.cpp runs it
+ *          over recorded logs.
+ *
+ * @ingroup TelemetryManager
+ */
+
+#ifndef SWINGING_DOOR_H
+#define SWINGING_DOOR_H
+
+#include <cstdint>
+
+/**
+ * @brief Counters of one compressed channel.
+ * @ingroup TelemetryManager
+ */
+struct SwingingDoorStats {
+    uint32_t samples;   /**< Samples seen */
+    uint32_t kept;      /**< Samples kept */
+};
+
+/**
+ * @brief Swinging door compressor of one channel.
+ * @ingroup TelemetryManager
+ */
+class SwingingDoor {
+public:
+    /**
+     * @brief Sets the compression parameters and restarts the channel.
+     * @param deviation Largest reconstruction error, 0 keeps every sample.
+     * @param max_interval_s Longest time between kept samples in seconds.
+     * @return True if the last sample must be kept, as for reset().
+     */
+    bool configure(float deviation, uint32_t max_interval_s);
+
+    /**
+     * @brief Adds a sample.
+     * @param time Sample time in seconds.
+     * @param value Sample value.
+     * @return True if the previous sample must be kept; false for the first sample.
+     */
+    bool add(uint32_t time, float value);
+
+    /**
+     * @brief Restarts the channel; the next sample is kept.
+     * @return True if the last sample must be kept. Its decision was still
+     *         open, and dropping it would leave the samples since the previous
+     *         kept one without an end point.
+     */
+    bool reset();
+
+    float get_deviation() const { return deviation; }
+    uint32_t get_max_interval() const { return max_interval_s; }
+    SwingingDoorStats get_stats() const { return stats; }
+
+private:
+    void open_doors(uint32_t time, float value);
+
+    float deviation = 0.0f;
+    uint32_t max_interval_s = 0;
+
+    bool started = false;
+    bool snapshot_is_archive = false;
+    uint32_t archive_time = 0;
+    float archive_value = 0.0f;
+    uint32_t snapshot_time = 0;
+    float snapshot_value = 0.0f;
+    float upper_slope = 0.0f;
+    float lower_slope = 0.0f;
+
+    SwingingDoorStats stats = {};
+};
+
+#endif // SWINGING_DOOR_H
@@ -0,0 +1,77 @@
+/**
+ * @file telemetry_channels.h
+ * @brief Telemetry channels compressed with the swinging door deadband
+ * @details Shared by TelemetryManager and the host tool tools/deadband_eval.cpp,
+ *          so both use the same channel order and default deviations.
+ * @ingroup TelemetryManager
+ */
+
+#ifndef TELEMETRY_CHANNELS_H
+#define TELEMETRY_CHANNELS_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Compressed telemetry channels.
+ * @details The power channels are columns of telemetry.csv, the others of sensors.csv.
+ * @ingroup TelemetryManager
+ */
+enum class TelemetryChannel : uint8_t {
+    BATTERY_VOLTAGE,
+    SYSTEM_VOLTAGE,
+    CHARGE_CURRENT_USB,
+    CHARGE_CURRENT_SOLAR,
+    DISCHARGE_CURRENT,
+    TEMPERATURE,
+    PRESSURE,
+    HUMIDITY,
+    LIGHT,
+    COUNT
+};
+
+/**
+ * @brief Number of compressed channels.
+ */
+static constexpr size_t TELEMETRY_CHANNEL_COUNT = static_cast<size_t>(TelemetryChannel::COUNT);
+
+/**
+ * @brief Number of power channels, the first ones of TelemetryChannel.
+ */
+static constexpr size_t TELEMETRY_POWER_CHANNEL_COUNT = 5;
+
+/**
+ * @brief Default longest time between stored samples of a channel in seconds.
+ */
+static constexpr uint32_t TELEMETRY_DEADBAND_DEFAULT_MAX_INTERVAL_S = 300;
+
+/**
+ * @brief Longest accepted maximum interval in seconds.
+ */
+static constexpr uint32_t TELEMETRY_DEADBAND_MAX_INTERVAL_S = 86400;
+
+/**
+ * @brief Name and default deviation of a channel.
+ */
+struct TelemetryChannelInfo {
+    const char* name;   /**< CSV column name */
+    float deviation;    /**< Default reconstruction error in the channel unit */
+};
+
+/**
+ * @brief Channels in TelemetryChannel order.
+ * @details The deviations are about twice the noise seen in telemetry_test.
+ */
+static constexpr TelemetryChannelInfo TELEMETRY_CHANNELS[TELEMETRY_CHANNEL_COUNT] = {
+    {"battery_v", 0.02f},
+    {"system_v", 0.02f},
+    {"usb_ma", 5.0f},
+    {"solar_ma", 5.0f},
+    {"discharge_ma", 5.0f},
+    {"temperature", 0.1f},
+    {"pressure", 0.1f},
+    {"humidity", 0.5f},
+    {"light", 2.0f},
+};
+
+#endif // TELEMETRY_CHANNELS_H
@@ -9,10 +9,13 @@
 
 #include "telemetry_manager.h"
 #include "utils.h"
+#include "log.h"
 #include "storage.h"
 #include "PowerManager.h"
+#include "sleep_scheduler.h"
+#include "pin_config.h"
 #include "ISensor.h"
-#include "DS3231.h"
+#include "time_service.h"
 #include <deque>
 #include <mutex>
 #include <iomanip>
@@ -41,18 +44,22 @@
  */
 #define DEFAULT_FLUSH_THRESHOLD 10
 
-TelemetryManager::TelemetryManager() {}
+TelemetryManager::TelemetryManager() {
+    mutex_init(&telemetry_mutex);
+    for (size_t i = 0; i < TELEMETRY_CHANNEL_COUNT; i++) {
+        deadband[i].configure(TELEMETRY_CHANNELS[i].deviation, TELEMETRY_DEADBAND_DEFAULT_MAX_INTERVAL_S);
+    }
+}
 
 /**
  * @brief Initializes the telemetry manager.
  * @return True if initialization was successful, false otherwise.
- * @details Initializes the telemetry mutex, checks if the SD card is mounted,
+ * @details Checks if the SD card is mounted,
  *          and creates the telemetry and sensor data CSV files if they don't exist.
  *          Also writes the CSV headers to the files.
  * @ingroup TelemetryManager
  */
 bool TelemetryManager::init() {
-    mutex_init(&telemetry_mutex);
     if (!SystemStateManager::get_instance().is_sd_card_mounted()) {
         uart_print("Telemetry system initialized (storage not available)", VerbosityLevel::WARNING);
         return false;
@@ -66,7 +73,8 @@ bool TelemetryManager::init() {
         if (telemetry_file) {
             fprintf(telemetry_file, "timestamp,build,battery_v,system_v,usb_ma,solar_ma,discharge_ma,"
                 "gps_time,latitude,lat_dir,longitude,lon_dir,speed_mps,course_deg,date,"
-                "fix_quality,satellites,altitude_m\n");
+                "fix_quality,satellites,altitude_m,"
+                "nav_alt_m,nav_vz_mps,nav_alt_sigma_m,nav_baro_bias_m,nav_lat,nav_lon,nav_pos_sigma_m\n");
             fclose(telemetry_file);
             uart_print("Created new telemetry log", VerbosityLevel::INFO);
         }
@@ -111,6 +119,8 @@ void TelemetryManager::collect_power_telemetry(TelemetryRecord& record) {
     record.charge_current_usb = PowerManager::get_instance().get_current_charge_usb();
     record.charge_current_solar = PowerManager::get_instance().get_current_charge_solar();
     record.discharge_current = PowerManager::get_instance().get_current_draw();
+    radio_record_current_sample(record.discharge_current);
+    SleepScheduler::get_instance().record_current_sample(record.discharge_current);
 }
 
 /**
@@ -119,109 +129,37 @@ void TelemetryManager::collect_power_telemetry(TelemetryRecord& record) {
  * @param[in] charge_current_usb The current USB charging current.
  * @param[in] charge_current_solar The current solar charging current.
  * @param[in] discharge_current The current battery discharge current.
+ * @details Battery level events are only emitted on battery power, see power_events.h.
  * @ingroup TelemetryManager
  */
 void TelemetryManager::emit_power_events(float battery_voltage, float charge_current_usb, float charge_current_solar, float discharge_current) {
-    static bool usb_charging_active = false;
-    static bool solar_charging_active = false;
-    static bool battery_low = false;
-    static bool battery_full = false;
-    static bool discharge_active = true;
-
-    if (charge_current_usb > PowerManager::USB_CURRENT_THRESHOLD && !usb_charging_active) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::USB_CONNECTED);
-        usb_charging_active = true;
-    }
-    else if (charge_current_usb < PowerManager::USB_CURRENT_THRESHOLD && usb_charging_active) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::USB_DISCONNECTED);
-        usb_charging_active = false;
-    }
+    PowerSample sample = {battery_voltage, charge_current_usb, charge_current_solar, discharge_current};
+    bool battery_powered = SystemStateManager::get_instance().get_operating_mode() == SystemOperatingMode::BATTERY_POWERED;
 
-    if (charge_current_solar > PowerManager::SOLAR_CURRENT_THRESHOLD && !solar_charging_active) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::SOLAR_ACTIVE);
-        solar_charging_active = true;
-    }
-    else if (charge_current_solar < PowerManager::SOLAR_CURRENT_THRESHOLD && solar_charging_active) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::SOLAR_INACTIVE);
-        solar_charging_active = false;
-    }
-
-    if (battery_voltage < PowerManager::BATTERY_LOW_THRESHOLD && !battery_low) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::BATTERY_LOW);
-        battery_low = true;
-        battery_full = false; 
-    }
-    else if (battery_voltage > PowerManager::BATTERY_FULL_THRESHOLD && !battery_full) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::BATTERY_FULL);
-        battery_full = true;
-        battery_low = false; 
-    }
-    else if (battery_voltage > PowerManager::BATTERY_LOW_THRESHOLD && battery_low) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::BATTERY_NORMAL);
-        battery_low = false;
-    }
-    else if (battery_voltage < PowerManager::BATTERY_FULL_THRESHOLD && battery_full) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::BATTERY_NORMAL);
-        battery_full = false;
-    }
-
-    if (charge_current_solar + charge_current_usb > discharge_current && !discharge_active) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::CHARGING);
-        discharge_active = true;
-    }
-    else if (charge_current_solar + charge_current_usb < discharge_current && discharge_active) {
-        EventEmitter::emit(EventGroup::POWER, PowerEvent::DISCHARGING);
-        discharge_active = false;
+    PowerEvent events[POWER_EVENTS_MAX_PER_SAMPLE];
+    size_t count = power_events_update(power_state, sample, battery_powered, events);
+    for (size_t i = 0; i < count; i++) {
+        EventEmitter::emit(EventGroup::POWER, events[i]);
     }
 }
 
 /**
  * @brief Collects GPS telemetry data.
  * @param[out] record The telemetry record to update with GPS data.
+ * @details A position older than GPS_FIX_STALE_MS is not reported; satellite
+ *          and time fields are kept.
  * @ingroup TelemetryManager
  */
 void TelemetryManager::collect_gps_telemetry(TelemetryRecord& record) {
-    auto& nmea_data = NMEAData::get_instance();
-    
-    std::vector<std::string> rmc_tokens = nmea_data.get_rmc_tokens();
-    if (rmc_tokens.size() >= 12) {
-        record.time = (rmc_tokens.size() > 1 && !rmc_tokens[1].empty()) ? rmc_tokens[1].substr(0, 6) : "0";  // Only keep HHMMSS
-        record.latitude = (rmc_tokens.size() > 3 && !rmc_tokens[3].empty()) ? rmc_tokens[3] : "0";
-        record.lat_dir = (rmc_tokens.size() > 4 && !rmc_tokens[4].empty()) ? rmc_tokens[4] : "N";
-        record.longitude = (rmc_tokens.size() > 5 && !rmc_tokens[5].empty()) ? rmc_tokens[5] : "0";
-        record.lon_dir = (rmc_tokens.size() > 6 && !rmc_tokens[6].empty()) ? rmc_tokens[6] : "E";
-        
-        std::string knots = (rmc_tokens.size() > 7 && !rmc_tokens[7].empty()) ? rmc_tokens[7] : "0";
-        try {
-            float speed_knots = std::stof(knots);
-            float speed_ms = speed_knots * 0.514444; // Convert knots to m/s
-            record.speed = std::to_string(speed_ms);
-        } catch (const std::exception&) {
-            record.speed = "0";
-        }
-        
-        record.course = (rmc_tokens.size() > 8 && !rmc_tokens[8].empty()) ? rmc_tokens[8] : "0";
-        record.date = (rmc_tokens.size() > 9 && !rmc_tokens[9].empty()) ? rmc_tokens[9] : "0";
-    } else {
-        record.time = "0";
-        record.latitude = "0";
-        record.lat_dir = "N";
-        record.longitude = "0";
-        record.lon_dir = "E";
-        record.speed = "0";
-        record.course = "0";
-        record.date = "0";
-    }
-
-    std::vector<std::string> gga_tokens = nmea_data.get_gga_tokens();
-    if (gga_tokens.size() >= 15) {
-        record.fix_quality = (gga_tokens.size() > 6 && !gga_tokens[6].empty()) ? gga_tokens[6] : "0";
-        record.satellites = (gga_tokens.size() > 7 && !gga_tokens[7].empty()) ? gga_tokens[7] : "0";
-        record.altitude = (gga_tokens.size() > 9 && !gga_tokens[9].empty()) ? gga_tokens[9] : "0";
-    } else {
-        record.fix_quality = "0";
-        record.satellites = "0";
-        record.altitude = "0";
+    GpsFixSnapshot snapshot = NMEAData::get_instance().get_snapshot();
+    record.gps = snapshot.fix;
+    if (snapshot.age_ms > GPS_FIX_STALE_MS) {
+        record.gps.rmc_valid = false;
+        record.gps.latitude_e7 = 0;
+        record.gps.longitude_e7 = 0;
+        record.gps.altitude_mm = 0;
+        record.gps.speed_mmps = 0;
+        record.gps.course_cdeg = 0;
     }
 }
 
@@ -232,10 +170,54 @@ void TelemetryManager::collect_gps_telemetry(TelemetryRecord& record) {
  */
 void TelemetryManager::collect_sensor_telemetry(SensorDataRecord& sensor_record) {
     SensorWrapper& sensor_wrapper = SensorWrapper::get_instance();
-    sensor_record.temperature = sensor_wrapper.sensor_read_data(SensorType::ENVIRONMENT, SensorDataTypeIdentifier::TEMPERATURE);
-    sensor_record.pressure = sensor_wrapper.sensor_read_data(SensorType::ENVIRONMENT, SensorDataTypeIdentifier::PRESSURE);
-    sensor_record.humidity = sensor_wrapper.sensor_read_data(SensorType::ENVIRONMENT, SensorDataTypeIdentifier::HUMIDITY);
-    sensor_record.light = sensor_wrapper.sensor_read_data(SensorType::LIGHT, SensorDataTypeIdentifier::LIGHT_LEVEL);
+    // one acquisition per sensor; values not read are stored as -1
+    SensorReading environment = sensor_wrapper.sensor_read_all(SensorType::ENVIRONMENT);
+    SensorReading light = sensor_wrapper.sensor_read_all(SensorType::LIGHT);
+    sensor_record.temperature = environment.get(SensorDataTypeIdentifier::TEMPERATURE);
+    sensor_record.pressure = environment.get(SensorDataTypeIdentifier::PRESSURE);
+    sensor_record.humidity = environment.get(SensorDataTypeIdentifier::HUMIDITY);
+    sensor_record.light = light.get(SensorDataTypeIdentifier::LIGHT_LEVEL);
+}
+
+/**
+ * @brief Steps the navigation filter with the sample just collected.
+ * @param[out] record The telemetry record receiving the fused state.
+ * @param[in] pressure_hpa Pressure of the same sample.
+ * @details The filter is predicted to now and updated with the pressure. A GPS
+ *          fix is fused once, when its RMC is valid and younger than the sample
+ *          interval; its altitude only from a GGA of a fix that GSA does not report as 2D.
+ * @ingroup TelemetryManager
+ */
+void TelemetryManager::collect_nav_telemetry(TelemetryRecord& record, float pressure_hpa) {
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    if (last_nav_ms != 0) {
+        nav_filter.predict((now_ms - last_nav_ms) / 1000.0f);
+    }
+    last_nav_ms = now_ms;
+
+    nav_filter.update_baro(pressure_hpa);
+
+    GpsFixSnapshot snapshot = NMEAData::get_instance().get_snapshot();
+    const GpsFix& fix = snapshot.fix;
+    if (fix.rmc_valid && snapshot.age_ms <= sample_interval_ms && fix.utc_time_ms != last_nav_fix_utc_ms) {
+        last_nav_fix_utc_ms = fix.utc_time_ms;
+
+        NavGpsInput gps;
+        gps.latitude_e7 = fix.latitude_e7;
+        gps.longitude_e7 = fix.longitude_e7;
+        gps.altitude_m = fix.altitude_mm / 1000.0f;
+        gps.speed_mps = fix.speed_mmps / 1000.0f;
+        gps.course_deg = fix.course_cdeg / 100.0f;
+        gps.has_velocity = true;
+        bool has_gsa = (fix.sentences & GPS_FIX_HAS_GSA) != 0;
+        gps.has_altitude = (fix.sentences & GPS_FIX_HAS_GGA) && fix.fix_quality != 0 && !(has_gsa && fix.fix_type < 3);
+        gps.hdop = has_gsa ? fix.hdop_c / 100.0f : 0.0f;
+        gps.vdop = has_gsa ? fix.vdop_c / 100.0f : 0.0f;
+        nav_filter.update_gps(gps);
+        record.fix_fused = true;
+    }
+
+    record.nav = nav_filter.get_state();
 }
 
 /**
@@ -246,11 +228,20 @@ void TelemetryManager::collect_sensor_telemetry(SensorDataRecord& sensor_record)
  * @ingroup TelemetryManager
  */
 bool TelemetryManager::collect_telemetry() {
-    uint32_t timestamp = DS3231::get_instance().get_local_time();
+    uint32_t timestamp = TimeService::get_instance().get_local_time();
     TelemetryRecord record;
     record.timestamp = timestamp;
     record.build_version = std::to_string(BUILD_NUMBER);
 
+    I2cBusStats main_bus = i2c_bus_get_stats(MAIN_I2C_PORT);
+    I2cBusStats sensors_bus = i2c_bus_get_stats(SENSORS_I2C_PORT);
+    uint64_t sweep_start_us = time_us_64();
+
+    // a forced BME280 measurement converts and the BH1750 result is read on
+    // the sensors bus while power is read on the main bus and GPS is collected
+    SensorWrapper::get_instance().sensor_start_acquisition(SensorType::ENVIRONMENT);
+    SensorWrapper::get_instance().sensor_start_acquisition(SensorType::LIGHT);
+
     collect_power_telemetry(record);
     emit_power_events(record.battery_voltage, record.charge_current_usb, record.charge_current_solar, record.discharge_current);                                            
 
@@ -259,27 +250,147 @@ bool TelemetryManager::collect_telemetry() {
     SensorDataRecord sensor_record;
     sensor_record.timestamp = timestamp;
     collect_sensor_telemetry(sensor_record);
+    record_sweep(sweep_start_us, main_bus, sensors_bus);
+
+    collect_nav_telemetry(record, sensor_record.pressure);
 
     mutex_enter_blocking(&telemetry_mutex);
 
-    telemetry_buffer[telemetry_buffer_write_index] = record;
-    sensor_data_buffer[telemetry_buffer_write_index] = sensor_record;
-    telemetry_buffer_write_index = (telemetry_buffer_write_index + 1) % TELEMETRY_BUFFER_SIZE;
-    if (telemetry_buffer_count < TELEMETRY_BUFFER_SIZE) {
-        telemetry_buffer_count++;
-    }
+    compress_records(record, sensor_record);
 
     last_telemetry_record_copy = record;
     last_sensor_record_copy = sensor_record;
+    last_records_valid = true;
+
+    mutex_exit(&telemetry_mutex);
+
+    log_record(LogSite::TELEMETRY_COLLECTED);
+
+    return true;
+}
+
 
+/**
+ * @brief Accounts one sensor sweep.
+ * @param start_us Time the sweep started.
+ * @param main_bus Counters of the main bus at the start.
+ * @param sensors_bus Counters of the sensors bus at the start.
+ * @ingroup TelemetryManager
+ */
+void TelemetryManager::record_sweep(uint64_t start_us, const I2cBusStats& main_bus, const I2cBusStats& sensors_bus) {
+    uint32_t duration = static_cast<uint32_t>(time_us_64() - start_us);
+    I2cBusStats main_now = i2c_bus_get_stats(MAIN_I2C_PORT);
+    I2cBusStats sensors_now = i2c_bus_get_stats(SENSORS_I2C_PORT);
+
+    mutex_enter_blocking(&telemetry_mutex);
+    sweep_stats.sweeps++;
+    sweep_stats.last_us = duration;
+    if (duration > sweep_stats.max_us) {
+        sweep_stats.max_us = duration;
+    }
+    sweep_stats.total_us += duration;
+    sweep_stats.irq_us += (main_now.irq_us - main_bus.irq_us) + (sensors_now.irq_us - sensors_bus.irq_us);
+    sweep_stats.wait_us += (main_now.wait_us - main_bus.wait_us) + (sensors_now.wait_us - sensors_bus.wait_us);
     mutex_exit(&telemetry_mutex);
+}
+
+
+SensorSweepStats TelemetryManager::get_sweep_stats() {
+    mutex_enter_blocking(&telemetry_mutex);
+    SensorSweepStats copy = sweep_stats;
+    mutex_exit(&telemetry_mutex);
+    return copy;
+}
 
-    uart_print("Telemetry collected", VerbosityLevel::DEBUG);
 
+/**
+ * @brief Runs the deadband compression and buffers the previous records.
+ * @param record The telemetry record just collected.
+ * @param sensor_record The sensor data record just collected.
+ * @details The new sample decides which channels of the pending (previous)
+ *          records are stored. The pending records are buffered if any channel
+ *          is or a GPS fix was fused with them, and the new ones become pending.
+ *          Called with the telemetry mutex held.
+ * @ingroup TelemetryManager
+ */
+void TelemetryManager::compress_records(const TelemetryRecord& record, const SensorDataRecord& sensor_record) {
+    const float values[TELEMETRY_CHANNEL_COUNT] = {
+        record.battery_voltage,
+        record.system_voltage,
+        record.charge_current_usb,
+        record.charge_current_solar,
+        record.discharge_current,
+        sensor_record.temperature,
+        sensor_record.pressure,
+        sensor_record.humidity,
+        sensor_record.light
+    };
+
+    uint32_t stored = forced_channels;
+    forced_channels = 0;
+    for (size_t i = 0; i < TELEMETRY_CHANNEL_COUNT; i++) {
+        if (deadband[i].add(record.timestamp, values[i])) {
+            stored |= 1u << i;
+        }
+    }
+
+    if (has_pending_record && (stored != 0 || pending_record.fix_fused)) {
+        uint32_t power_mask = (1u << TELEMETRY_POWER_CHANNEL_COUNT) - 1;
+        pending_record.stored_channels = static_cast<uint8_t>(stored & power_mask);
+        pending_sensor_record.stored_channels = static_cast<uint8_t>(stored >> TELEMETRY_POWER_CHANNEL_COUNT);
+
+        telemetry_buffer[telemetry_buffer_write_index] = pending_record;
+        sensor_data_buffer[telemetry_buffer_write_index] = pending_sensor_record;
+        telemetry_buffer_write_index = (telemetry_buffer_write_index + 1) % TELEMETRY_BUFFER_SIZE;
+        if (telemetry_buffer_count < TELEMETRY_BUFFER_SIZE) {
+            telemetry_buffer_count++;
+        }
+    }
+
+    pending_record = record;
+    pending_sensor_record = sensor_record;
+    has_pending_record = true;
+}
+
+
+/**
+ * @brief Configures the deadband compression of a channel.
+ * @param channel Channel.
+ * @param deviation Largest reconstruction error in the channel unit, 0 stores every sample.
+ * @param max_interval_s Longest time between stored samples, 1 to TELEMETRY_DEADBAND_MAX_INTERVAL_S.
+ * @return True if the parameters are valid.
+ * @details The channel restarts, so its next sample is stored. The pending
+ *          sample, whose decision the restart cuts short, is stored as well.
+ * @ingroup TelemetryManager
+ */
+bool TelemetryManager::set_deadband(TelemetryChannel channel, float deviation, uint32_t max_interval_s) {
+    if (channel >= TelemetryChannel::COUNT || deviation < 0.0f ||
+        max_interval_s == 0 || max_interval_s > TELEMETRY_DEADBAND_MAX_INTERVAL_S) {
+        return false;
+    }
+    mutex_enter_blocking(&telemetry_mutex);
+    if (deadband[static_cast<size_t>(channel)].configure(deviation, max_interval_s)) {
+        forced_channels |= 1u << static_cast<size_t>(channel);
+    }
+    mutex_exit(&telemetry_mutex);
     return true;
 }
 
 
+/**
+ * @brief Gets the deadband compressor of a channel.
+ * @param channel Channel, must be below TelemetryChannel::COUNT.
+ * @return Copy of the compressor with its parameters and counters.
+ * @ingroup TelemetryManager
+ */
+SwingingDoor TelemetryManager::get_deadband(TelemetryChannel channel) {
+    mutex_enter_blocking(&telemetry_mutex);
+    SwingingDoor copy = deadband[static_cast<size_t>(channel)];
+    mutex_exit(&telemetry_mutex);
+    return copy;
+}
+
+
 /**
  * @brief Save buffered telemetry and sensor data to storage
  * @return True if data was successfully saved
@@ -319,8 +430,13 @@ bool TelemetryManager::flush_telemetry() {
 
     // Write all records to CSV
     for (size_t i = 0; i < telemetry_buffer_count; i++) {
-        fprintf(telemetry_file, "%s\n", telemetry_buffer[read_index].to_csv().c_str());
-        fprintf(sensor_file, "%s\n", sensor_data_buffer[read_index].to_csv().c_str());
+        // lines whose channels were all dropped by the deadband are skipped unless they carry a new fix
+        if (telemetry_buffer[read_index].stored_channels != 0 || telemetry_buffer[read_index].fix_fused) {
+            fprintf(telemetry_file, "%s\n", telemetry_buffer[read_index].to_csv().c_str());
+        }
+        if (sensor_data_buffer[read_index].stored_channels != 0) {
+            fprintf(sensor_file, "%s\n", sensor_data_buffer[read_index].to_csv().c_str());
+        }
         read_index = (read_index + 1) % TELEMETRY_BUFFER_SIZE;
     }
 
@@ -352,6 +468,21 @@ bool TelemetryManager::is_telemetry_collection_time(uint32_t current_time, uint3
 }
 
 
+/**
+ * @brief Sets the telemetry sample interval.
+ * @param interval_ms Interval in milliseconds.
+ * @return True if the interval is within MIN_SAMPLE_INTERVAL_MS and MAX_SAMPLE_INTERVAL_MS.
+ * @ingroup TelemetryManager
+ */
+bool TelemetryManager::set_sample_interval(uint32_t interval_ms) {
+    if (interval_ms < MIN_SAMPLE_INTERVAL_MS || interval_ms > MAX_SAMPLE_INTERVAL_MS) {
+        return false;
+    }
+    sample_interval_ms = interval_ms;
+    return true;
+}
+
+
 /**
  * @brief Check if it's time to flush telemetry buffer based on count
  * @param collection_counter Current collection counter
@@ -383,4 +514,24 @@ std::string TelemetryManager::get_last_telemetry_record_csv() {
  */
 std::string TelemetryManager::get_last_sensor_record_csv() {
     return last_sensor_record_copy.to_csv();
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Copies the last collected telemetry and sensor records.
+ * @param[out] telemetry Receives the last telemetry record.
+ * @param[out] sensors Receives the last sensor data record.
+ * @return True if at least one record has been collected since boot, false otherwise.
+ * @details Both records are copied under the telemetry mutex, so they always come
+ *          from the same collection cycle.
+ * @ingroup TelemetryManager
+ */
+bool TelemetryManager::get_last_records(TelemetryRecord& telemetry, SensorDataRecord& sensors) {
+    mutex_enter_blocking(&telemetry_mutex);
+    bool valid = last_records_valid;
+    if (valid) {
+        telemetry = last_telemetry_record_copy;
+        sensors = last_sensor_record_copy;
+    }
+    mutex_exit(&telemetry_mutex);
+    return valid;
+}
@@ -8,6 +8,14 @@
  *          Telemetry is collected at configurable intervals and stored in a
  *          circular buffer before being flushed to persistent storage after
  *          a configurable number of records are collected.
+ *
+ *          The power and sensor channels go through swinging door deadband
+ *          compression (swinging_door.h): every sample is processed, but a
+ *          channel is only written when it is needed to rebuild the signal
+ *          within its deviation by linear interpolation, or when its maximum
+ *          interval ran out. Channels not stored are empty cells, and lines
+ *          without any stored channel are not written. Records are buffered one
+ *          sample late, when the next sample has decided about them.
  * 
  * @defgroup TelemetryManager Telemetry Manager
  * @{
@@ -20,12 +28,16 @@
 #include <cstdint>
 #include <string>
 #include "pico/stdlib.h"
-#include "lib/location/NMEA/nmea_data.h"
+#include "lib/location/NMEA/NMEA_data.h"
+#include "lib/location/nav_filter.h"
+#include "swinging_door.h"
+#include "telemetry_channels.h"
 #include "utils.h"
 #include "storage.h"
 #include "PowerManager.h"
 #include "ISensor.h"
 #include "DS3231.h"
+#include "i2c_bus.h"
 #include <deque>
 #include <mutex>
 #include <iomanip>
@@ -35,6 +47,22 @@
 #include "communication.h"
 #include <functional>
 
+/**
+ * @struct SensorSweepStats
+ * @brief Timing of the sensor sweeps of collect_telemetry()
+ * @details A sweep runs from the start of the sensor acquisitions to the end
+ *          of collect_sensor_telemetry(). The I2C times are the growth of the
+ *          counters of both buses during the sweeps.
+ */
+struct SensorSweepStats {
+    uint32_t sweeps;    /**< Sweeps completed */
+    uint32_t last_us;   /**< Duration of the last sweep */
+    uint32_t max_us;    /**< Longest sweep */
+    uint64_t total_us;  /**< Sum of the sweep durations */
+    uint64_t irq_us;    /**< CPU time in the I2C interrupts during the sweeps */
+    uint64_t wait_us;   /**< Time the sweeps slept waiting for I2C transactions */
+};
+
 /**
 * @struct TelemetryRecord
 * @brief Structure representing a single telemetry data point
@@ -52,50 +80,105 @@ struct TelemetryRecord {
     float charge_current_usb; /**< USB charging current in mA */
     float charge_current_solar; /**< Solar charging current in mA */
     float discharge_current;  /**< Battery discharge current in mA */
+
+    /** @brief Bit per power channel (TelemetryChannel order) written to the log; the others are left empty. */
+    uint8_t stored_channels = 0xFF;
     
-    // GPS data - key RMC fields
-    std::string time;         /**< UTC time from GPS */
-    std::string latitude;     /**< Latitude from GPS */
-    std::string lat_dir;      /**< N/S latitude direction */
-    std::string longitude;    /**< Longitude from GPS */
-    std::string lon_dir;      /**< E/W longitude direction */
-    std::string speed;        /**< Speed in knots */
-    std::string course;       /**< Course in degrees */
-    std::string date;         /**< Date from GPS */
-    
-    // GPS data - key GGA fields
-    std::string fix_quality;  /**< GPS fix quality */
-    std::string satellites;   /**< Number of satellites in view */
-    std::string altitude;     /**< Altitude in meters */
-    
+    // GPS data - RMC and GGA fields in fixed point
+    GpsFix gps;               /**< Fix decoded from the latest RMC and GGA sentences */
+
+    // Fused navigation state
+    NavFusedState nav;        /**< GPS and barometric fusion after this sample */
+
+    /** @brief A new GPS fix was fused in this sample; the line is written whatever the deadband stores. */
+    bool fix_fused = false;
     
+    /**
+     * @brief Formats the GPS columns of the CSV line.
+     * @details Keeps the NMEA notation of earlier logs: ddmm.mmmmm coordinates
+     *          with a hemisphere letter, HHMMSS time and ddmmyy date. Columns of
+     *          a sentence not received yet are 0.
+     * @return GPS columns, comma separated.
+     * @ingroup TelemetryManager
+     */
+    std::string gps_csv() const {
+        char latitude[16] = "0";
+        char longitude[16] = "0";
+        char time[8] = "0";
+        char date[8] = "0";
+        char altitude[16] = "0";
+        uint32_t speed_mmps = 0;
+        uint16_t course_cdeg = 0;
+
+        if (gps.sentences & GPS_FIX_HAS_RMC) {
+            uint32_t seconds = gps.utc_time_ms / 1000;
+            snprintf(time, sizeof(time), "%02lu%02lu%02lu", static_cast<unsigned long>(seconds / 3600),
+                     static_cast<unsigned long>(seconds / 60 % 60), static_cast<unsigned long>(seconds % 60));
+            snprintf(date, sizeof(date), "%02u%02u%02u", gps.day, gps.month, gps.year);
+            nmea_format_coordinate(latitude, sizeof(latitude), gps.latitude_e7, true);
+            nmea_format_coordinate(longitude, sizeof(longitude), gps.longitude_e7, false);
+            speed_mmps = gps.speed_mmps;
+            course_cdeg = gps.course_cdeg;
+        }
+        if (gps.sentences & GPS_FIX_HAS_GGA) {
+            int32_t magnitude = gps.altitude_mm < 0 ? -gps.altitude_mm : gps.altitude_mm;
+            snprintf(altitude, sizeof(altitude), "%s%ld.%03ld", gps.altitude_mm < 0 ? "-" : "",
+                     static_cast<long>(magnitude / 1000), static_cast<long>(magnitude % 1000));
+        }
+
+        char line[128];
+        snprintf(line, sizeof(line), "%s,%s,%c,%s,%c,%lu.%03lu,%u.%02u,%s,%u,%u,%s",
+                 time,
+                 latitude, gps.latitude_e7 < 0 ? 'S' : 'N',
+                 longitude, gps.longitude_e7 < 0 ? 'W' : 'E',
+                 static_cast<unsigned long>(speed_mmps / 1000), static_cast<unsigned long>(speed_mmps % 1000),
+                 course_cdeg / 100, course_cdeg % 100,
+                 date,
+                 gps.fix_quality,
+                 gps.satellites,
+                 altitude);
+        return line;
+    }
+
+    /**
+     * @brief Formats the fused navigation columns of the CSV line.
+     * @details Altitude, vertical speed, altitude sigma and barometric bias in
+     *          m and m/s, then latitude and longitude in decimal degrees and the
+     *          position sigma. Columns of a filter not initialised yet are 0.
+     * @return Navigation columns, comma separated.
+     * @ingroup TelemetryManager
+     */
+    std::string nav_csv() const {
+        char line[128];
+        snprintf(line, sizeof(line), "%.2f,%.2f,%.2f,%.2f,%.7f,%.7f,%.1f",
+                 nav.altitude_m, nav.vertical_speed_mps, nav.altitude_sigma_m, nav.baro_bias_m,
+                 nav.has_position ? nav.latitude_e7 * 1e-7 : 0.0,
+                 nav.has_position ? nav.longitude_e7 * 1e-7 : 0.0,
+                 nav.position_sigma_m);
+        return line;
+    }
+
     /**
      * @brief Converts the telemetry record to a CSV string.
      * @return A CSV string representing the telemetry record.
      * @ingroup TelemetryManager
      */
     std::string to_csv() const {
+        const float power[TELEMETRY_POWER_CHANNEL_COUNT] = {
+            battery_voltage, system_voltage, charge_current_usb, charge_current_solar, discharge_current
+        };
         std::stringstream ss;
         ss << timestamp << "," 
             << build_version << ","
-            << std::fixed << std::setprecision(3)
-            << battery_voltage << ","
-            << system_voltage << ","
-            << charge_current_usb << ","
-            << charge_current_solar << ","
-            << discharge_current << ","
-
-           // GPS RMC data
-            << time << ","
-            << latitude << "," << lat_dir << ","
-            << longitude << "," << lon_dir << ","
-            << speed << ","
-            << course << ","
-            << date << ","
-            // GPS GGA data
-            << fix_quality << ","
-            << satellites << ","
-            << altitude;
+            << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < TELEMETRY_POWER_CHANNEL_COUNT; i++) {
+            if (stored_channels & (1u << i)) {
+                ss << power[i];
+            }
+            ss << ",";
+        }
+        ss << gps_csv() << ","
+            << nav_csv();
         return ss.str();
     }
 };
@@ -114,6 +197,9 @@ struct SensorDataRecord {
     float pressure;           /**< Pressure in hPa */
     float humidity;           /**< Relative humidity in % */
     float light;              /**< Light intensity in lux */
+
+    /** @brief Bit per sensor channel (TelemetryChannel order from TEMPERATURE) written to the log. */
+    uint8_t stored_channels = 0xFF;
     
     /**
      * @brief Converts the sensor data record to a CSV string.
@@ -121,13 +207,16 @@ struct SensorDataRecord {
      * @ingroup TelemetryManager
      */
     std::string to_csv() const {
+        const float values[] = {temperature, pressure, humidity, light};
         std::stringstream ss;
-        ss << timestamp << "," 
-            << std::fixed << std::setprecision(3)
-            << temperature << ","
-            << pressure << ","
-            << humidity << ","
-            << light;
+        ss << timestamp
+            << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+            ss << ",";
+            if (stored_channels & (1u << i)) {
+                ss << values[i];
+            }
+        }
         return ss.str();
     }
 };
@@ -201,6 +290,26 @@ public:
      */
     void collect_sensor_telemetry(SensorDataRecord& sensor_record);
 
+    /**
+     * @brief Steps the navigation filter with the sample just collected.
+     * @param[out] record The telemetry record receiving the fused state.
+     * @param[in] pressure_hpa Pressure of the same sample.
+     * @ingroup TelemetryManager
+     */
+    void collect_nav_telemetry(TelemetryRecord& record, float pressure_hpa);
+
+    /**
+     * @brief Gets the navigation filter counters.
+     * @return Copy of the counters.
+     */
+    NavFilterStats get_nav_stats() const { return nav_filter.get_stats(); }
+
+    /**
+     * @brief Gets the sensor sweep timing.
+     * @return Copy of the counters.
+     */
+    SensorSweepStats get_sweep_stats();
+
     /**
      * @brief Save buffered telemetry data to storage
      * @return True if data was successfully saved
@@ -247,11 +356,53 @@ public:
      */
     std::string get_last_sensor_record_csv();
 
+    /**
+     * @brief Copies the last collected telemetry and sensor records.
+     * @param[out] telemetry Receives the last telemetry record.
+     * @param[out] sensors Receives the last sensor data record.
+     * @return True if at least one record has been collected since boot, false otherwise.
+     */
+    bool get_last_records(TelemetryRecord& telemetry, SensorDataRecord& sensors);
+
     static constexpr int TELEMETRY_BUFFER_SIZE = 20;
 
     size_t get_telemetry_buffer_count() const { return telemetry_buffer_count; }
     size_t get_telemetry_buffer_write_index() const { return telemetry_buffer_write_index; }
 
+    /**
+     * @brief Gets the telemetry sample interval.
+     * @return Interval in milliseconds.
+     */
+    uint32_t get_sample_interval() const { return sample_interval_ms; }
+
+    /**
+     * @brief Sets the telemetry sample interval.
+     * @param interval_ms Interval in milliseconds.
+     * @return True if the interval is within MIN_SAMPLE_INTERVAL_MS and MAX_SAMPLE_INTERVAL_MS.
+     */
+    bool set_sample_interval(uint32_t interval_ms);
+
+    /**
+     * @brief Configures the deadband compression of a channel.
+     * @param channel Channel.
+     * @param deviation Largest reconstruction error in the channel unit, 0 stores every sample.
+     * @param max_interval_s Longest time between stored samples, 1 to TELEMETRY_DEADBAND_MAX_INTERVAL_S.
+     * @return True if the parameters are valid.
+     */
+    bool set_deadband(TelemetryChannel channel, float deviation, uint32_t max_interval_s);
+
+    /**
+     * @brief Gets the deadband compressor of a channel.
+     * @param channel Channel.
+     * @return Copy of the compressor with its parameters and counters.
+     */
+    SwingingDoor get_deadband(TelemetryChannel channel);
+
+    /** @brief Shortest accepted sample interval in milliseconds. */
+    static constexpr uint32_t MIN_SAMPLE_INTERVAL_MS = 1000;
+    /** @brief Longest accepted sample interval in milliseconds. */
+    static constexpr uint32_t MAX_SAMPLE_INTERVAL_MS = 3600 * 1000;
+
 private:
     TelemetryManager();  // Private constructor
     ~TelemetryManager() = default;
@@ -268,6 +419,11 @@ private:
 
     uint32_t sample_interval_ms = DEFAULT_SAMPLE_INTERVAL_MS;
 
+    /**
+     * @brief Power states last reported by emit_power_events()
+     */
+    PowerEventState power_state;
+
     /**
      * @brief Current flush threshold (number of records that triggers a flush)
      */
@@ -289,6 +445,39 @@ private:
      */
     TelemetryRecord last_telemetry_record_copy;
     SensorDataRecord last_sensor_record_copy;
+    bool last_records_valid = false;
+
+    /**
+     * @brief GPS and barometric altitude fusion, stepped at every sample
+     */
+    NavigationFilter nav_filter;
+    uint32_t last_nav_ms = 0;
+    uint32_t last_nav_fix_utc_ms = UINT32_MAX;
+
+    /**
+     * @brief Sensor sweep timing, updated at every sample
+     */
+    SensorSweepStats sweep_stats = {};
+
+    /**
+     * @brief Swinging door compressors per channel, fed with every sample
+     */
+    std::array<SwingingDoor, TELEMETRY_CHANNEL_COUNT> deadband;
+
+    /**
+     * @brief Latest records, buffered once the next sample decides which of their channels are stored
+     */
+    TelemetryRecord pending_record;
+    SensorDataRecord pending_sensor_record;
+    bool has_pending_record = false;
+
+    /**
+     * @brief Channels of the pending records stored because their compressor was reconfigured
+     */
+    uint32_t forced_channels = 0;
+
+    void compress_records(const TelemetryRecord& record, const SensorDataRecord& sensor_record);
+    void record_sweep(uint64_t start_us, const I2cBusStats& main_bus, const I2cBusStats& sensors_bus);
 
     /**
      * @brief Mutex for thread-safe access to the telemetry buffer
@@ -0,0 +1,357 @@
+#include "uart_tx.h"
+#include <cstring>
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "pin_config.h"
+
+/**
+ * @file uart_tx.cpp
+ * @brief Implementation of the DMA-fed debug UART transmit ring
+ * @ingroup UartTx
+ */
+
+static_assert((UART_TX_RING_SIZE & (UART_TX_RING_SIZE - 1)) == 0, "UART_TX_RING_SIZE must be a power of two");
+
+namespace {
+
+/**
+ * @brief Number of queued droppable writes that can be tracked for eviction.
+ * @details Enough for a ring of 32 byte lines; a droppable write that finds the
+ *          list full takes the slot of the oldest one or is discarded, so every
+ *          queued droppable write stays evictable.
+ */
+constexpr size_t UART_TX_MAX_DROPPABLE = UART_TX_RING_SIZE / 32;
+
+/**
+ * @brief Bytes handed to the DMA at a time (about 11 ms at 115200 baud).
+ */
+constexpr size_t UART_TX_DMA_BLOCK = 128;
+
+/**
+ * @brief Position of a queued droppable write in the ring.
+ */
+struct UartTxDroppable {
+    uint32_t start;   /**< Head counter before the write */
+    uint32_t length;  /**< Bytes of the write */
+};
+
+/**
+ * @brief Transmit ring and DMA state.
+ * @details head and tail are free-running byte counters; the ring index is the
+ *          counter modulo UART_TX_RING_SIZE. The DMA sends from dma_block, which
+ *          the feeder fills from the ring at tail, so every byte between tail
+ *          and head is still queued and a droppable write starting at tail can
+ *          be discarded by advancing tail. droppable lists the droppable writes,
+ *          oldest first, that may still be queued. All fields are guarded by lock,
+ *          which is also taken by the DMA interrupt handler.
+ */
+struct UartTxRing {
+    char buffer[UART_TX_RING_SIZE];
+    char dma_block[UART_TX_DMA_BLOCK];
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t in_flight = 0;
+    UartTxDroppable droppable[UART_TX_MAX_DROPPABLE];
+    size_t droppable_first = 0;
+    size_t droppable_count = 0;
+    uint32_t waiting_writers = 0;
+    bool oversize_write = false;
+    int dma_channel = -1;
+    critical_section_t lock;
+    UartTxStats stats = {};
+};
+
+UartTxRing ring;
+
+size_t free_space_locked() {
+    return UART_TX_RING_SIZE - (ring.head - ring.tail);
+}
+
+UartTxDroppable& droppable_at(size_t index) {
+    return ring.droppable[(ring.droppable_first + index) % UART_TX_MAX_DROPPABLE];
+}
+
+/**
+ * @brief Removes the oldest entry of the droppable list.
+ * @details Caller holds ring.lock.
+ */
+void pop_droppable_locked() {
+    ring.droppable_first = (ring.droppable_first + 1) % UART_TX_MAX_DROPPABLE;
+    ring.droppable_count--;
+}
+
+/**
+ * @brief Starts a DMA transfer of the next block, if idle and data is queued.
+ * @details A block ends before a droppable write that does not fit in it whole,
+ *          unless that write is the first in the block. Caller holds ring.lock.
+ */
+void start_transfer_locked() {
+    uint32_t pending = ring.head - ring.tail;
+    if (ring.in_flight != 0 || pending == 0) {
+        return;
+    }
+
+    uint32_t length = pending < UART_TX_DMA_BLOCK ? pending : UART_TX_DMA_BLOCK;
+    // end the block before a droppable write it would cut, so tail stays on a write boundary
+    for (size_t i = 0; i < ring.droppable_count; i++) {
+        uint32_t offset = droppable_at(i).start - ring.tail;
+        if (offset >= length) {
+            break;
+        }
+        if (offset > 0 && offset + droppable_at(i).length > length) {
+            length = offset;
+            break;
+        }
+    }
+    uint32_t start = ring.tail & (UART_TX_RING_SIZE - 1);
+    uint32_t first = UART_TX_RING_SIZE - start;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(ring.dma_block, &ring.buffer[start], first);
+    memcpy(ring.dma_block + first, &ring.buffer[0], length - first);
+
+    ring.tail += length;
+    ring.in_flight = length;
+    dma_channel_transfer_from_buffer_now(ring.dma_channel, ring.dma_block, length);
+
+    // writes the feeder has started to send can no longer be discarded
+    while (ring.droppable_count > 0 && static_cast<int32_t>(droppable_at(0).start - ring.tail) < 0) {
+        pop_droppable_locked();
+    }
+}
+
+/**
+ * @brief DMA completion handler, releases the transferred block and starts the next one.
+ */
+void uart_tx_dma_handler() {
+    if (ring.dma_channel < 0 || !dma_channel_get_irq1_status(ring.dma_channel)) {
+        return;
+    }
+    dma_channel_acknowledge_irq1(ring.dma_channel);
+
+    critical_section_enter_blocking(&ring.lock);
+    ring.in_flight = 0;
+    start_transfer_locked();
+    critical_section_exit(&ring.lock);
+}
+
+/**
+ * @brief Copies bytes into the ring at head, wrapping at the end of the buffer.
+ * @details Caller holds ring.lock and has checked there is room.
+ */
+void copy_in_locked(const char* data, size_t length) {
+    uint32_t start = ring.head & (UART_TX_RING_SIZE - 1);
+    size_t first = UART_TX_RING_SIZE - start;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&ring.buffer[start], data, first);
+    memcpy(&ring.buffer[0], data + first, length - first);
+
+    ring.head += length;
+    ring.stats.bytes_written += length;
+
+    uint32_t used = ring.head - ring.tail;
+    if (used > ring.stats.peak_used) {
+        ring.stats.peak_used = used;
+    }
+}
+
+/**
+ * @brief Counts the bytes of the droppable writes queued back to back from tail.
+ * @details These are the writes evict_locked() can discard. Caller holds ring.lock.
+ */
+size_t evictable_locked() {
+    size_t bytes = 0;
+    uint32_t next = ring.tail;
+    for (size_t i = 0; i < ring.droppable_count && droppable_at(i).start == next; i++) {
+        bytes += droppable_at(i).length;
+        next += droppable_at(i).length;
+    }
+    return bytes;
+}
+
+/**
+ * @brief Discards the oldest queued droppable writes until needed bytes are free.
+ * @details Only writes starting at tail are discarded, by advancing tail, so
+ *          nothing is moved. Stops at the first write that must not be lost.
+ *          Caller holds ring.lock.
+ */
+void evict_locked(size_t needed) {
+    while (free_space_locked() < needed && ring.droppable_count > 0 && droppable_at(0).start == ring.tail) {
+        uint32_t length = droppable_at(0).length;
+        pop_droppable_locked();
+        ring.tail += length;
+        ring.stats.bytes_dropped += length;
+    }
+}
+
+/**
+ * @brief Makes room for one more entry in the droppable list.
+ * @return False if the list is full and its oldest write cannot be discarded.
+ * @details Caller holds ring.lock.
+ */
+bool reserve_droppable_locked() {
+    if (ring.droppable_count < UART_TX_MAX_DROPPABLE) {
+        return true;
+    }
+    if (droppable_at(0).start != ring.tail) {
+        return false;
+    }
+    evict_locked(free_space_locked() + droppable_at(0).length);
+    return true;
+}
+
+/**
+ * @brief Queues a droppable write, discarding older droppable writes to make room.
+ * @return True if the write was queued, false if it was discarded.
+ * @details A droppable write never waits: it is discarded if a write that must
+ *          not be lost is waiting for room, or if evicting would not free enough.
+ *          Caller holds ring.lock.
+ */
+bool write_droppable_locked(const char* data, size_t length) {
+    if (ring.waiting_writers > 0 || ring.oversize_write || free_space_locked() + evictable_locked() < length) {
+        ring.stats.bytes_dropped += length;
+        return false;
+    }
+
+    evict_locked(length);
+    if (!reserve_droppable_locked()) {
+        ring.stats.bytes_dropped += length;
+        return false;
+    }
+    uint32_t start = ring.head;
+    copy_in_locked(data, length);
+    droppable_at(ring.droppable_count) = {start, static_cast<uint32_t>(length)};
+    ring.droppable_count++;
+    start_transfer_locked();
+    return true;
+}
+
+/**
+ * @brief Releases ring.lock for a moment so the DMA interrupt (possibly on this core) can free space.
+ */
+void wait_unlocked() {
+    critical_section_exit(&ring.lock);
+    tight_loop_contents();
+    critical_section_enter_blocking(&ring.lock);
+}
+
+} // namespace
+
+bool uart_tx_init() {
+    if (ring.dma_channel >= 0) {
+        return true;
+    }
+
+    critical_section_init(&ring.lock);
+
+    int channel = dma_claim_unused_channel(false);
+    if (channel < 0) {
+        return false;
+    }
+
+    dma_channel_config config = dma_channel_get_default_config(channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, uart_get_dreq(DEBUG_UART_PORT, true));
+    dma_channel_configure(channel, &config, &uart_get_hw(DEBUG_UART_PORT)->dr, nullptr, 0, false);
+
+    dma_channel_set_irq1_enabled(channel, true);
+    irq_add_shared_handler(DMA_IRQ_1, uart_tx_dma_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    ring.dma_channel = channel;
+    return true;
+}
+
+bool uart_tx_write(const char* data, size_t length, bool may_drop) {
+    if (ring.dma_channel < 0) {
+        uart_write_blocking(DEBUG_UART_PORT, reinterpret_cast<const uint8_t*>(data), length);
+        return true;
+    }
+
+    critical_section_enter_blocking(&ring.lock);
+
+    if (may_drop) {
+        bool queued = write_droppable_locked(data, length);
+        critical_section_exit(&ring.lock);
+        return queued;
+    }
+
+    // wait until the whole write fits, so it is copied under the lock in one piece
+    size_t needed = length < UART_TX_RING_SIZE ? length : UART_TX_RING_SIZE;
+    bool blocked = false;
+    while (true) {
+        if (!ring.oversize_write) {
+            evict_locked(needed);
+            if (free_space_locked() >= needed) {
+                break;
+            }
+        }
+        if (!blocked) {
+            ring.stats.blocked_writes++;
+            ring.waiting_writers++;
+            blocked = true;
+        }
+        wait_unlocked();
+    }
+    if (blocked) {
+        ring.waiting_writers--;
+    }
+
+    if (length <= UART_TX_RING_SIZE) {
+        copy_in_locked(data, length);
+        start_transfer_locked();
+        critical_section_exit(&ring.lock);
+        return true;
+    }
+
+    // longer than the ring: queued in pieces while every other write waits or is dropped
+    ring.oversize_write = true;
+    while (length > 0) {
+        size_t space = free_space_locked();
+        if (space == 0) {
+            wait_unlocked();
+            continue;
+        }
+        size_t chunk = length < space ? length : space;
+        copy_in_locked(data, chunk);
+        start_transfer_locked();
+        data += chunk;
+        length -= chunk;
+    }
+    ring.oversize_write = false;
+
+    critical_section_exit(&ring.lock);
+    return true;
+}
+
+void uart_tx_flush() {
+    if (ring.dma_channel >= 0) {
+        while (true) {
+            critical_section_enter_blocking(&ring.lock);
+            bool empty = ring.head == ring.tail && ring.in_flight == 0;
+            critical_section_exit(&ring.lock);
+            if (empty) {
+                break;
+            }
+            tight_loop_contents();
+        }
+    }
+    uart_tx_wait_blocking(DEBUG_UART_PORT);
+}
+
+UartTxStats uart_tx_get_stats() {
+    if (ring.dma_channel < 0) {
+        return ring.stats;
+    }
+    critical_section_enter_blocking(&ring.lock);
+    UartTxStats snapshot = ring.stats;
+    critical_section_exit(&ring.lock);
+    return snapshot;
+}
@@ -0,0 +1,79 @@
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include <cstdint>
+#include <cstddef>
+#include "hardware/uart.h"
+
+/**
+ * @file uart_tx.h
+ * @brief DMA-fed transmit ring for the debug UART
+ * @details uart_print() and send_frame_uart() copy their output into a ring
+ *          buffer and return; a DMA channel paced by the UART TX DREQ drains the
+ *          ring in the background. Before uart_tx_init() writes fall back to
+ *          blocking uart_write_blocking().
+ *
+ *          Overflow policy: when a write that may be dropped (INFO/DEBUG log lines)
+ *          does not fit, the oldest queued droppable writes are discarded whole to
+ *          make room, so the newest lines get through. Only writes at the front of
+ *          the queue, not yet handed to the DMA, are discarded, by advancing the
+ *          tail; nothing is moved. If that cannot free enough room, or a write that
+ *          must not be lost is waiting, the new write is discarded instead.
+ *
+ *          Writes that must not be lost (command frames, warnings, errors) are never
+ *          discarded: they wait until the whole write fits and are then copied in
+ *          one piece, so no other output lands inside them. A write longer than the
+ *          ring is queued in pieces while all other writes wait or are dropped.
+ *
+ * @defgroup UartTx UART TX
+ * @brief Non-blocking debug UART output.
+ * @{
+ */
+
+/**
+ * @brief Size of the transmit ring in bytes, must be a power of two.
+ */
+static constexpr size_t UART_TX_RING_SIZE = 4096;
+
+/**
+ * @brief Transmit ring counters.
+ */
+struct UartTxStats {
+    uint32_t bytes_written;  /**< Bytes accepted into the ring */
+    uint32_t bytes_dropped;  /**< Bytes discarded because the ring was full, queued or new */
+    uint32_t peak_used;      /**< Highest ring occupancy seen in bytes */
+    uint32_t blocked_writes; /**< Writes that had to wait for free space */
+};
+
+/**
+ * @brief Claims a DMA channel and starts feeding the debug UART from the ring.
+ * @return True if a DMA channel was available.
+ * @details Must be called on core 0 after uart_init(DEBUG_UART_PORT, ...); the DMA
+ *          completion interrupt is serviced by the calling core.
+ */
+bool uart_tx_init();
+
+/**
+ * @brief Queues bytes for transmission on the debug UART.
+ * @param data Bytes to send.
+ * @param length Number of bytes.
+ * @param may_drop If true older droppable writes, or this one, are discarded when
+ *        the ring is full, otherwise the call waits until there is room.
+ * @return True if the bytes were queued, false if they were dropped.
+ */
+bool uart_tx_write(const char* data, size_t length, bool may_drop);
+
+/**
+ * @brief Waits until everything queued has left the UART.
+ * @details Used before raw UART access (GPS passthrough) and before a reset.
+ */
+void uart_tx_flush();
+
+/**
+ * @brief Gets a snapshot of the transmit ring counters.
+ * @return Copy of the counters.
+ */
+UartTxStats uart_tx_get_stats();
+
+#endif // UART_TX_H
+/** @} */
@@ -6,6 +6,8 @@
 #include <string>
 #include <array>
 #include "system_state_manager.h"
+#include "uart_tx.h"
+#include "system_log.h"
 
 /**
  * @file utils.cpp
@@ -55,29 +57,82 @@ std::string get_level_prefix(VerbosityLevel level) {
  * @param msg The message to print.
  * @param uart The UART instance to use for printing.
  * @details Prints the given message to the specified UART, prepending it with a timestamp and the core number.
- *          Uses a mutex to ensure thread-safe access to the UART.
+ *          Messages at or above the SystemLog storage level are also mirrored to the SD card log,
+ *          independently of the UART verbosity.
  */
 void uart_print(const std::string& msg, VerbosityLevel level, uart_inst_t* uart) {
-    if (static_cast<int>(level) > static_cast<int>(SystemStateManager::get_instance().get_uart_verbosity())) {
+    bool to_uart = static_cast<int>(level) <= static_cast<int>(SystemStateManager::get_instance().get_uart_verbosity());
+    bool to_storage = level != VerbosityLevel::SILENT &&
+                      static_cast<int>(level) <= static_cast<int>(SystemLog::get_instance().get_storage_level());
+    if (!to_uart && !to_storage) {
         return;
     }
 
+    uint32_t timestamp = to_ms_since_boot(get_absolute_time());
+    uint core_num = get_core_num();
+
+    if (to_storage) {
+        SystemLog::get_instance().mirror(timestamp, core_num, level, msg.c_str());
+    }
+    if (to_uart) {
+        uart_print_line(timestamp, core_num, level, msg.c_str(), uart);
+    }
+}
+
+
+/**
+ * @brief Prints an already formatted line to UART with the uart_print() decoration.
+ * @param timestamp Time of the message in ms since boot.
+ * @param core_num Core that produced the message.
+ * @param level Message verbosity level, used for color and prefix only.
+ * @param msg The message to print.
+ * @param uart The UART instance to use for printing.
+ * @details No verbosity check - callers filter before formatting. Also used by
+ *          log_drain() to print deferred records with their original timestamp and core.
+ *          Output to DEBUG_UART_PORT goes through the DMA transmit ring: INFO and DEBUG
+ *          lines are dropped if the ring is full, everything else (including frames sent
+ *          at SILENT level) waits for room.
+ */
+void uart_print_line(uint32_t timestamp, uint core_num, VerbosityLevel level, const char* msg, uart_inst_t* uart) {
     static bool mutex_inited = false;
     if (!mutex_inited) {
         mutex_init(&uart_mutex);
         mutex_inited = true;
     }
 
-    uint32_t timestamp = to_ms_since_boot(get_absolute_time());
-    uint core_num = get_core_num();
-
     std::string color = get_level_color(level);
     std::string prefix = get_level_prefix(level);
     std::string msg_to_send = "[" + std::to_string(timestamp) + "ms] - Core " + 
                            std::to_string(core_num) + ": " + 
                            color + prefix + ANSI_RESET + msg + "\r\n";
 
+    if (uart == DEBUG_UART_PORT) {
+        bool may_drop = static_cast<int>(level) >= static_cast<int>(VerbosityLevel::INFO);
+        uart_tx_write(msg_to_send.c_str(), msg_to_send.length(), may_drop);
+        return;
+    }
+
     mutex_enter_blocking(&uart_mutex);
     uart_puts(uart, msg_to_send.c_str());
     mutex_exit(&uart_mutex);
 }
+
+
+/**
+ * @brief Calculates CRC-16/CCITT-FALSE over a byte buffer
+ * @param data Pointer to the data
+ * @param length Number of bytes
+ * @return CRC value (polynomial 0x1021, initial value 0xFFFF)
+ * @details Bitwise implementation - slower than a table but costs no flash for the table,
+ *          which is fine for the short binary packets it is used on.
+ */
+uint16_t crc16_ccitt(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
\ No newline at end of file
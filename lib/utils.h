@@ -47,4 +47,25 @@ void uart_print(const std::string& msg,
                 uart_inst_t* uart = DEBUG_UART_PORT);
 
 
+/**
+ * @brief Prints an already formatted line to UART with the uart_print() decoration
+ * @param timestamp Time of the message in ms since boot
+ * @param core_num Core that produced the message
+ * @param level Message verbosity level, used for color and prefix only
+ * @param msg The message to print
+ * @param uart The UART port to use
+ */
+void uart_print_line(uint32_t timestamp, uint core_num, VerbosityLevel level,
+                     const char* msg, uart_inst_t* uart = DEBUG_UART_PORT);
+
+
+/**
+ * @brief Calculates CRC-16/CCITT-FALSE over a byte buffer
+ * @param data Pointer to the data
+ * @param length Number of bytes
+ * @return CRC value (polynomial 0x1021, initial value 0xFFFF)
+ */
+uint16_t crc16_ccitt(const uint8_t* data, size_t length);
+
+
 #endif
\ No newline at end of file
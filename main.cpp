@@ -1,7 +1,5 @@
 #include "includes.h"
 
-#define LOG_FILENAME "/log.txt"
-
 void core1_entry() {
     uart_print("Starting core 1", VerbosityLevel::DEBUG);
     EventEmitter::emit(EventGroup::SYSTEM, SystemEvent::CORE1_START);
@@ -10,11 +8,15 @@ void core1_entry() {
     uint32_t telemetry_collection_counter = 0;
 
     TelemetryManager::get_instance().init();
+    GpsConfigManager::get_instance().request_reconfigure();
 
     while (true) {
         collect_gps_data();
+        GpsConfigManager::get_instance().process();
         
         uint32_t currentTime = to_ms_since_boot(get_absolute_time());
+        GpsPowerScheduler::get_instance().process(currentTime);
+        TrajectoryStore::get_instance().process(currentTime);
                 
         if (TelemetryManager::get_instance().is_telemetry_collection_time(currentTime, last_telemetry_time)) {
             TelemetryManager::get_instance().collect_telemetry();
@@ -27,13 +29,23 @@ void core1_entry() {
             }
         }
 
+        GpsTimeSync::get_instance().process(currentTime);
+        TimeService::get_instance().process(currentTime);
+        EventManager::get_instance().process();
+        SystemLog::get_instance().process(currentTime);
+
         if (SystemStateManager::get_instance().is_bootloader_reset_pending()) {
             sleep_ms(100);
             uart_print("Entering BOOTSEL mode...", VerbosityLevel::WARNING);
+            uart_tx_flush();
             reset_usb_boot(0, 0);
         }
-        
-        sleep_ms(10);
+
+        if (TimeService::get_instance().needs_fast_poll() ||
+            GpsTimeSync::get_instance().needs_fast_poll(to_ms_since_boot(get_absolute_time()))) {
+            SleepScheduler::get_instance().request_fast_poll();
+        }
+        SleepScheduler::get_instance().idle(last_telemetry_time + TelemetryManager::get_instance().get_sample_interval());
     }
 }
 
@@ -43,10 +55,13 @@ bool init_pico_hw() {
     uart_init(DEBUG_UART_PORT, DEBUG_UART_BAUD_RATE);
     gpio_set_function(DEBUG_UART_TX_PIN, UART_FUNCSEL_NUM(DEBUG_UART_PORT, DEBUG_UART_TX_PIN));
     gpio_set_function(DEBUG_UART_RX_PIN, UART_FUNCSEL_NUM(DEBUG_UART_PORT, DEBUG_UART_RX_PIN));
+    uart_tx_init();
+    SleepScheduler::get_instance().init();
 
     uart_init(GPS_UART_PORT, GPS_UART_BAUD_RATE);
     gpio_set_function(GPS_UART_TX_PIN, UART_FUNCSEL_NUM(GPS_UART_PORT, GPS_UART_TX_PIN));
     gpio_set_function(GPS_UART_RX_PIN, UART_FUNCSEL_NUM(GPS_UART_PORT, GPS_UART_RX_PIN));
+    gps_uart_rx_init();
 
     gpio_init(PICO_DEFAULT_LED_PIN);
     gpio_set_dir(PICO_DEFAULT_LED_PIN, GPIO_OUT);
@@ -60,6 +75,7 @@ bool init_pico_hw() {
     gpio_set_function(MAIN_I2C_SDA_PIN, GPIO_FUNC_I2C);
     gpio_pull_up(MAIN_I2C_SCL_PIN);
     gpio_pull_up(MAIN_I2C_SDA_PIN);
+    i2c_bus_init(MAIN_I2C_PORT);
 
     gpio_init(GPS_POWER_ENABLE_PIN);
     gpio_set_dir(GPS_POWER_ENABLE_PIN, GPIO_OUT);
@@ -70,6 +86,7 @@ bool init_pico_hw() {
     gpio_set_function(SENSORS_I2C_SDA_PIN, GPIO_FUNC_I2C);
     gpio_pull_up(SENSORS_I2C_SCL_PIN);
     gpio_pull_up(SENSORS_I2C_SDA_PIN);
+    i2c_bus_init(SENSORS_I2C_PORT);
     gpio_init(SENSORS_POWER_ENABLE_PIN);
     gpio_set_dir(SENSORS_POWER_ENABLE_PIN, GPIO_OUT);
     gpio_put(SENSORS_POWER_ENABLE_PIN, true);
@@ -84,6 +101,8 @@ bool init_pico_hw() {
 }
 
 bool init_modules(){
+    TimeService::get_instance().init();
+
     bool radio_init_status = initialize_radio();
     SystemStateManager::get_instance().set_radio_init_ok(radio_init_status);
     
@@ -91,29 +110,8 @@ bool init_modules(){
     SystemStateManager::get_instance().set_sd_card_mounted(sd_init_status);
     
     if (sd_init_status) {
-        FILE *fp = fopen(LOG_FILENAME, "w");
-        if (fp) {
-            uart_print("Log file opened.", VerbosityLevel::DEBUG);
-            int bytes_written = fprintf(fp, "System init started.\n");
-            uart_print("Written " + std::to_string(bytes_written) + " bytes.", VerbosityLevel::DEBUG);
-            int close_status = fclose(fp);
-            uart_print("Close file status: " + std::to_string(close_status), VerbosityLevel::DEBUG);
-
-            struct stat file_stat;
-            if (stat(LOG_FILENAME, &file_stat) == 0) {
-                size_t file_size = file_stat.st_size;
-                uart_print("File size: " + std::to_string(file_size) + " bytes", VerbosityLevel::DEBUG);
-            } else {
-                uart_print("Failed to get file size", VerbosityLevel::ERROR);
-            }
-
-            uart_print("File path: /" + std::string(LOG_FILENAME), VerbosityLevel::DEBUG);
-        } else {
-            uart_print("Failed to open log file for writing.", VerbosityLevel::ERROR);
-        }
-    }
-
-    if (sd_init_status) {
+        SystemLog::get_instance().init();
+        EventManager::get_instance().init();
         uart_print("SD card init: OK", VerbosityLevel::DEBUG);
     } else {
         uart_print("SD card init: FAILED", VerbosityLevel::ERROR);
@@ -194,13 +192,19 @@ int main()
 
     while (true)
     {
-        int packet_size = LoRa.parse_packet();
+        int packet_size = radio_poll();
         if (packet_size)
         {
             on_receive(packet_size);
         }
 
         handle_uart_input();
+
+        log_drain();
+
+        BeaconManager::get_instance().process(to_ms_since_boot(get_absolute_time()));
+
+        SleepScheduler::get_instance().idle();
     }
 
     return 0;
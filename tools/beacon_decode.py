@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Ground decoder of the housekeeping beacon (lib/comms/beacon.h).
+
+Reads BeaconPacket hex strings, one per line, from files or standard input:
+8.5 responses (bare values or whole KBST frames) or captured packets, with or
+without the two LoRa address bytes. Every packet is checked for magic, version
+and CRC-16/CCITT-FALSE and printed field by field, or as one CSV line per
+packet with --csv. Exits with 2 if any packet is rejected.
+
+Examples:
+    python3 tools/beacon_decode.py responses.txt
+    echo BC01... | python3 tools/beacon_decode.py --csv
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+BEACON_MAGIC = 0xBC
+BEACON_VERSION = 1
+
+# BeaconPacket, little-endian and packed
+LAYOUT = [
+    ("magic", "B"),
+    ("version", "B"),
+    ("sequence", "H"),
+    ("uptime_s", "I"),
+    ("timestamp", "I"),
+    ("battery_mv", "H"),
+    ("system_mv", "H"),
+    ("usb_current_ma", "h"),
+    ("solar_current_ma", "h"),
+    ("discharge_current_ma", "h"),
+    ("temperature_cdeg", "h"),
+    ("latitude_e7", "i"),
+    ("longitude_e7", "i"),
+    ("altitude_m", "h"),
+    ("fix_quality", "B"),
+    ("satellites", "B"),
+    ("event_count", "H"),
+    ("rx_packets", "H"),
+    ("tx_packets", "H"),
+    ("rx_errors", "H"),
+    ("last_rssi_dbm", "h"),
+    ("last_snr_qdb", "b"),
+    ("status_flags", "B"),
+    ("crc", "H"),
+]
+FORMAT = "<" + "".join(code for _, code in LAYOUT)
+PACKET_SIZE = struct.calcsize(FORMAT)
+assert PACKET_SIZE == 50, "BeaconPacket is 50 bytes"
+
+# BeaconStatusFlag
+FLAGS = [
+    "sd_mounted",
+    "radio_ok",
+    "light_ok",
+    "env_ok",
+    "usb_powered",
+    "gps_powered",
+    "telemetry_ok",
+]
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def decode(data):
+    """Returns the fields of a packet as a dict, raises ValueError if it is not a valid beacon."""
+    if len(data) == PACKET_SIZE + 2:
+        data = data[2:]  # destination and sender addresses of a captured packet
+    if len(data) != PACKET_SIZE:
+        raise ValueError("%d bytes, a beacon has %d" % (len(data), PACKET_SIZE))
+    fields = dict(zip((name for name, _ in LAYOUT), struct.unpack(FORMAT, data)))
+    if fields["magic"] != BEACON_MAGIC:
+        raise ValueError("magic 0x%02X" % fields["magic"])
+    if fields["version"] != BEACON_VERSION:
+        raise ValueError("unsupported version %d" % fields["version"])
+    crc = crc16_ccitt(data[:-2])
+    if crc != fields["crc"]:
+        raise ValueError("CRC 0x%04X, computed 0x%04X" % (fields["crc"], crc))
+    return fields
+
+
+def to_units(fields):
+    """Converts the fixed point fields to their units, in layout order."""
+    return [
+        ("sequence", fields["sequence"]),
+        ("uptime_s", fields["uptime_s"]),
+        ("timestamp", fields["timestamp"]),
+        ("battery_v", fields["battery_mv"] / 1000.0),
+        ("system_v", fields["system_mv"] / 1000.0),
+        ("usb_ma", fields["usb_current_ma"]),
+        ("solar_ma", fields["solar_current_ma"]),
+        ("discharge_ma", fields["discharge_current_ma"]),
+        ("temperature_c", fields["temperature_cdeg"] / 100.0),
+        ("latitude", fields["latitude_e7"] * 1e-7),
+        ("longitude", fields["longitude_e7"] * 1e-7),
+        ("altitude_m", fields["altitude_m"]),
+        ("fix_quality", fields["fix_quality"]),
+        ("satellites", fields["satellites"]),
+        ("events", fields["event_count"]),
+        ("rx_packets", fields["rx_packets"]),
+        ("tx_packets", fields["tx_packets"]),
+        ("rx_errors", fields["rx_errors"]),
+        ("rssi_dbm", fields["last_rssi_dbm"]),
+        ("snr_db", fields["last_snr_qdb"] / 4.0),
+        ("flags", "|".join(name for bit, name in enumerate(FLAGS) if fields["status_flags"] & (1 << bit))),
+    ]
+
+
+def hex_strings(line):
+    """Yields the hex strings of a line, taking the value field of a KBST frame."""
+    line = line.strip()
+    if ";" in line:
+        fields = line.split(";")
+        line = fields[5] if len(fields) > 5 else ""
+    line = re.sub(r"\s", "", line)
+    if line:
+        yield line
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="*", help="files with one hex packet per line, standard input if none")
+    parser.add_argument("--csv", action="store_true", help="one CSV line per packet")
+    args = parser.parse_args()
+
+    lines = []
+    if args.inputs:
+        for path in args.inputs:
+            with open(path) as f:
+                lines += f.readlines()
+    else:
+        lines = sys.stdin.readlines()
+
+    rejected = 0
+    header_printed = False
+    for number, line in enumerate(lines, 1):
+        for text in hex_strings(line):
+            try:
+                values = to_units(decode(bytes.fromhex(text)))
+            except ValueError as e:
+                print("line %d: %s" % (number, e), file=sys.stderr)
+                rejected += 1
+                continue
+            if args.csv:
+                if not header_printed:
+                    print(",".join(name for name, _ in values))
+                    header_printed = True
+                print(",".join(str(value) for _, value in values))
+            else:
+                for name, value in values:
+                    print("%-14s %s" % (name, value))
+                print()
+    return 2 if rejected else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,200 @@
+/**
+ * @file deadband_eval.cpp
+ * @brief Host evaluation of the swinging door telemetry compression
+ * @details Runs lib/telemetry/swinging_door.cpp with the channel defaults of
+ *          lib/telemetry/telemetry_channels.h over a sensors.csv and a
+ *          telemetry.csv log recorded at full rate. For every channel it reports
+ *          the samples stored and the largest error of the linear
+ *          reconstruction from the stored samples, which must not exceed the
+ *          deviation. A telemetry.csv line is written when one of its power
+ *          channels is stored or it carries a new GPS fix.
+ *
+ *          Build and run from the repository root:
+ *
+ *              g++ -O2 -std=c++17 -I lib/telemetry -o deadband_eval tools/deadband_eval.cpp lib/telemetry/swinging_door.cpp
+ *              ./deadband_eval telemetry_test/sensors.csv telemetry_test/telemetry.csv
+ *
+ *          Arguments: SENSORS_CSV TELEMETRY_CSV [MAX_INTERVAL_S [DEVIATION_SCALE [RECONFIGURE_EVERY]]].
+ *          DEVIATION_SCALE multiplies all default deviations. RECONFIGURE_EVERY
+ *          reconfigures every channel after that many samples, as command 8.6 does.
+ */
+
+#include "swinging_door.h"
+#include "telemetry_channels.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Sample {
+    uint32_t time;
+    float value;
+};
+
+/**
+ * @brief Reads CSV columns into channels.
+ * @param path CSV file, the first column being the time.
+ * @param first_column Column of the first channel.
+ * @param first_channel Channel receiving first_column.
+ * @param count Number of channels.
+ */
+void read_columns(const char* path, size_t first_column, size_t first_channel, size_t count,
+                  std::vector<std::vector<Sample>>& channels) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < first_column + count || fields[0].empty() || !isdigit(fields[0][0])) {
+            continue;
+        }
+        uint32_t time = static_cast<uint32_t>(strtoul(fields[0].c_str(), nullptr, 10));
+        for (size_t i = 0; i < count; i++) {
+            channels[first_channel + i].push_back({time, strtof(fields[first_column + i].c_str(), nullptr)});
+        }
+    }
+}
+
+/**
+ * @brief Marks the telemetry.csv rows carrying a new GPS fix.
+ * @param path telemetry.csv, rows filtered as read_columns() does for the power channels.
+ * @return Per row, true if the latitude is set and the GPS time changed.
+ */
+std::vector<bool> read_fixes(const char* path) {
+    std::vector<bool> fixes;
+    std::ifstream file(path);
+    std::string line;
+    std::string last_time;
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 2 + TELEMETRY_POWER_CHANNEL_COUNT || fields[0].empty() || !isdigit(fields[0][0])) {
+            continue;
+        }
+        bool fix = fields.size() > 8 && !fields[8].empty() && fields[7] != last_time;
+        if (fix) {
+            last_time = fields[7];
+        }
+        fixes.push_back(fix);
+    }
+    return fixes;
+}
+
+/**
+ * @brief Largest error of the linear interpolation between kept samples.
+ */
+double reconstruction_error(const std::vector<Sample>& samples, const std::vector<bool>& kept) {
+    double worst = 0.0;
+    size_t previous = 0;
+    for (size_t i = 1; i < samples.size(); i++) {
+        if (!kept[i]) {
+            continue;
+        }
+        for (size_t j = previous + 1; j < i; j++) {
+            double fraction = static_cast<double>(samples[j].time - samples[previous].time) /
+                              static_cast<double>(samples[i].time - samples[previous].time);
+            double line = samples[previous].value + fraction * (samples[i].value - samples[previous].value);
+            worst = std::fmax(worst, std::fabs(line - samples[j].value));
+        }
+        previous = i;
+    }
+    return worst;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s SENSORS_CSV TELEMETRY_CSV [MAX_INTERVAL_S [DEVIATION_SCALE [RECONFIGURE_EVERY]]]\n",
+                argv[0]);
+        return 1;
+    }
+    uint32_t max_interval = argc > 3 ? static_cast<uint32_t>(atol(argv[3])) : TELEMETRY_DEADBAND_DEFAULT_MAX_INTERVAL_S;
+    float scale = argc > 4 ? strtof(argv[4], nullptr) : 1.0f;
+    size_t reconfigure_every = argc > 5 ? static_cast<size_t>(atol(argv[5])) : 0;
+
+    std::vector<std::vector<Sample>> channels(TELEMETRY_CHANNEL_COUNT);
+    read_columns(argv[2], 2, 0, TELEMETRY_POWER_CHANNEL_COUNT, channels);
+    read_columns(argv[1], 1, TELEMETRY_POWER_CHANNEL_COUNT, TELEMETRY_CHANNEL_COUNT - TELEMETRY_POWER_CHANNEL_COUNT, channels);
+
+    printf("%-14s %10s %8s %7s %10s %10s\n", "channel", "deviation", "samples", "stored", "reduction", "max_error");
+    size_t total_samples = 0;
+    size_t total_kept = 0;
+    bool bound_held = true;
+    std::vector<bool> telemetry_rows(channels[0].size(), false);
+    std::vector<bool> sensor_rows(channels[TELEMETRY_POWER_CHANNEL_COUNT].size(), false);
+
+    for (size_t c = 0; c < TELEMETRY_CHANNEL_COUNT; c++) {
+        const std::vector<Sample>& samples = channels[c];
+        if (samples.empty()) {
+            continue;
+        }
+        SwingingDoor door;
+        float deviation = TELEMETRY_CHANNELS[c].deviation * scale;
+        door.configure(deviation, max_interval);
+
+        std::vector<bool> kept(samples.size(), false);
+        for (size_t i = 0; i < samples.size(); i++) {
+            if (reconfigure_every > 0 && i > 0 && i % reconfigure_every == 0 && door.configure(deviation, max_interval)) {
+                kept[i - 1] = true;
+            }
+            if (door.add(samples[i].time, samples[i].value)) {
+                kept[i - 1] = true;
+            }
+        }
+        // the firmware stores the last sample when the next one arrives; close the log here
+        kept.back() = true;
+
+        size_t stored = 0;
+        std::vector<bool>& rows = c < TELEMETRY_POWER_CHANNEL_COUNT ? telemetry_rows : sensor_rows;
+        for (size_t i = 0; i < kept.size(); i++) {
+            stored += kept[i] ? 1 : 0;
+            if (kept[i] && i < rows.size()) {
+                rows[i] = true;
+            }
+        }
+        double error = reconstruction_error(samples, kept);
+        bool held = error <= deviation * 1.0001 + 1e-6;
+        bound_held = bound_held && held;
+        total_samples += samples.size();
+        total_kept += stored;
+
+        printf("%-14s %10.3f %8zu %7zu %9.1f%% %10.4f%s\n", TELEMETRY_CHANNELS[c].name, deviation,
+               samples.size(), stored, 100.0 * (1.0 - static_cast<double>(stored) / samples.size()), error,
+               held ? "" : "  BOUND EXCEEDED");
+    }
+
+    printf("%-14s %10s %8zu %7zu %9.1f%%\n", "total", "", total_samples, total_kept,
+           total_samples ? 100.0 * (1.0 - static_cast<double>(total_kept) / total_samples) : 0.0);
+
+    // a CSV line is written when any of its channels is stored or, in telemetry.csv, it has a new fix
+    std::vector<bool> fixes = read_fixes(argv[2]);
+    size_t telemetry_lines = 0;
+    size_t sensor_lines = 0;
+    size_t fix_count = 0;
+    for (size_t i = 0; i < telemetry_rows.size(); i++) {
+        bool fix = i < fixes.size() && fixes[i];
+        telemetry_lines += telemetry_rows[i] || fix ? 1 : 0;
+        fix_count += fix ? 1 : 0;
+    }
+    for (bool row : sensor_rows) {
+        sensor_lines += row ? 1 : 0;
+    }
+    printf("telemetry.csv lines %zu of %zu (%zu new fixes, all written), sensors.csv lines %zu of %zu\n",
+           telemetry_lines, telemetry_rows.size(), fix_count, sensor_lines, sensor_rows.size());
+    return bound_held ? 0 : 2;
+}
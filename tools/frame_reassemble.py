@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Reference reassembler of fragmented response frames (frame_fragment() in lib/comms/frame.cpp).
+
+A response whose encoded frame does not fit one LoRa packet (252 characters)
+is split into fragments that are ordinary frames of the same direction, group,
+command and unit. The value of each fragment starts with a header:
+
+    <index>/<total>:<slice>
+
+index counts from 1 to total, both decimal without padding, and the slices
+concatenated in index order are the original value. Every fragment but the
+last has the operation type SEQ; the last one (index == total) carries the
+operation type of the original response, so it also marks the end of the
+payload. There is no separate end frame.
+
+    KBST;1;SEQ;5;1;1/3:0001...;TSBK
+    KBST;1;SEQ;5;1;2/3:...;TSBK
+    KBST;1;VAL;5;1;3/3:...;TSBK
+
+Reads frames, one per line, from files or standard input; text before "KBST;"
+on a line (e.g. a log timestamp) is ignored. Frames that are not fragments are
+passed through, complete fragment sets are printed as the original frame.
+Exits with 2 if a fragment set is incomplete, inconsistent or interrupted.
+
+Examples:
+    python3 tools/frame_reassemble.py ground_log.txt
+    python3 tools/frame_reassemble.py --values < ground_log.txt
+"""
+
+import argparse
+import re
+import sys
+
+FRAME_BEGIN = "KBST"
+FRAME_END = "TSBK"
+FRAGMENT_HEADER = re.compile(r"^(\d+)/(\d+):")
+
+
+def parse_frame(line):
+    """Returns (direction, operation, group, command, value, unit) or None."""
+    start = line.find(FRAME_BEGIN + ";")
+    if start < 0:
+        return None
+    fields = line[start:].strip().split(";")
+    if len(fields) not in (7, 8) or fields[-1] != FRAME_END:
+        return None
+    unit = fields[6] if len(fields) == 8 else ""
+    return fields[1], fields[2], fields[3], fields[4], fields[5], unit
+
+
+def encode_frame(direction, operation, group, command, value, unit):
+    fields = [FRAME_BEGIN, direction, operation, group, command, value]
+    if unit:
+        fields.append(unit)
+    return ";".join(fields + [FRAME_END])
+
+
+class Reassembler:
+    """Collects the fragments of one response at a time per direction, group and command."""
+
+    def __init__(self):
+        self.pending = {}
+        self.errors = []
+
+    def add(self, frame):
+        """Returns the complete frame once it is known, otherwise None."""
+        direction, operation, group, command, value, unit = frame
+        header = FRAGMENT_HEADER.match(value)
+        if not header:
+            return frame
+        index, total = int(header.group(1)), int(header.group(2))
+        key = (direction, group, command)
+        if index < 1 or index > total:
+            self.errors.append("%s.%s: fragment %d/%d out of range" % (group, command, index, total))
+            return None
+        if (operation == "SEQ") != (index < total):
+            self.errors.append("%s.%s: fragment %d/%d has operation %s" % (group, command, index, total, operation))
+
+        entry = self.pending.get(key)
+        if entry is not None and (entry["total"] != total or index in entry["slices"]):
+            self.errors.append("%s.%s: response interrupted, missing fragments %s" %
+                               (group, command, self.missing(entry)))
+            entry = None
+        if entry is None:
+            entry = {"total": total, "slices": {}, "unit": unit}
+            self.pending[key] = entry
+        entry["slices"][index] = value[header.end():]
+
+        if index == total:
+            del self.pending[key]
+            if len(entry["slices"]) != total:
+                self.errors.append("%s.%s: missing fragments %s" % (group, command, self.missing(entry)))
+                return None
+            payload = "".join(entry["slices"][i] for i in range(1, total + 1))
+            return direction, operation, group, command, payload, unit
+        return None
+
+    def finish(self):
+        for (_, group, command), entry in self.pending.items():
+            self.errors.append("%s.%s: log ends before the last fragment, missing %s" %
+                               (group, command, self.missing(entry)))
+        self.pending.clear()
+
+    @staticmethod
+    def missing(entry):
+        return ",".join(str(i) for i in range(1, entry["total"] + 1) if i not in entry["slices"]) or "none"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="*", help="files with one frame per line, standard input if none")
+    parser.add_argument("--values", action="store_true", help="print only the values of the frames")
+    args = parser.parse_args()
+
+    lines = []
+    if args.inputs:
+        for path in args.inputs:
+            with open(path) as f:
+                lines += f.readlines()
+    else:
+        lines = sys.stdin.readlines()
+
+    reassembler = Reassembler()
+    for line in lines:
+        frame = parse_frame(line)
+        if frame is None:
+            continue
+        complete = reassembler.add(frame)
+        if complete is not None:
+            print(complete[4] if args.values else encode_frame(*complete))
+    reassembler.finish()
+
+    for error in reassembler.errors:
+        print(error, file=sys.stderr)
+    return 2 if reassembler.errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
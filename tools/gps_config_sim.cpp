@@ -0,0 +1,322 @@
+/**
+ * @file gps_config_sim.cpp
+ * @brief Host simulation of the GPS receiver configuration
+ * @details Runs gps_config_run() from lib/location/gps_receiver.cpp with the
+ *          MTK and UBX profiles against a scripted receiver on a simulated
+ *          UART with a virtual clock. The receiver talks at its own baud rate
+ *          and only hears commands and is heard at the matching host rate; it
+ *          outputs an RMC sentence every 200 ms and answers each command as
+ *          scripted: acknowledged, rejected or ignored, a baud change being
+ *          followed or ignored.
+ *
+ *          Every scenario checks the resulting state, baud rate, navigation
+ *          rate and counters, covering ACK, NACK, timeout, the fallback to the
+ *          default baud rate and a missing receiver.
+ *
+ *          Build and run from the repository root:
+ *
+ *              g++ -O2 -std=c++17 -I . -I lib -I lib/location -o gps_config_sim tools/gps_config_sim.cpp lib/location/gps_receiver.cpp lib/location/NMEA/nmea_parser.cpp
+ *              ./gps_config_sim
+ */
+
+#include "gps_config.h"
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+
+namespace {
+
+/**
+ * @brief Scripted answer to a command.
+ */
+enum class Reply { ACK, NACK, SILENT };
+
+/**
+ * @brief Command kinds the receiver recognises.
+ */
+enum class CommandKind { BAUD, RATE, OUTPUT, UNKNOWN };
+
+constexpr uint32_t SENTENCE_PERIOD_MS = 200;
+constexpr uint32_t REPLY_DELAY_MS = 20;
+
+struct Script {
+    bool present = true;        /**< Receiver connected */
+    uint32_t start_baud = GPS_UART_BAUD_RATE;
+    bool follow_baud = true;    /**< Switches when told to */
+    Reply output = Reply::ACK;
+    Reply rate = Reply::ACK;
+};
+
+struct Expected {
+    GpsConfigState state;
+    uint32_t baud;
+    uint32_t rate_hz;
+    uint32_t acks;
+    uint32_t nacks;
+    uint32_t timeouts;
+    uint32_t fallbacks;
+};
+
+/**
+ * @brief Bytes on the wire, readable from due_ms if the host listens at baud.
+ */
+struct Transfer {
+    uint32_t due_ms;
+    uint32_t baud;
+    std::string bytes;
+};
+
+std::string nmea_sentence(const char* body) {
+    uint8_t checksum = 0;
+    for (const char* c = body; *c; c++) {
+        checksum ^= static_cast<uint8_t>(*c);
+    }
+    char out[128];
+    snprintf(out, sizeof(out), "$%s*%02X\r\n", body, checksum);
+    return out;
+}
+
+std::string ubx_ack(bool ack, uint8_t message_class, uint8_t id) {
+    uint8_t frame[10] = {0xB5, 0x62, 0x05, static_cast<uint8_t>(ack ? 0x01 : 0x00), 2, 0, message_class, id, 0, 0};
+    for (size_t i = 2; i < 8; i++) {
+        frame[8] += frame[i];
+        frame[9] += frame[8];
+    }
+    return std::string(reinterpret_cast<char*>(frame), sizeof(frame));
+}
+
+/**
+ * @brief Simulated receiver, UART and clock.
+ */
+class FakeReceiver {
+public:
+    FakeReceiver(GpsReceiverType type, const Script& script)
+        : type(type), script(script), receiver_baud(script.start_baud) {}
+
+    GpsConfigLink link() {
+        return {this, write, read, set_baud, now_ms, sleep_ms};
+    }
+
+    uint32_t host_baud = GPS_UART_BAUD_RATE;
+
+private:
+    static FakeReceiver& self(void* context) { return *static_cast<FakeReceiver*>(context); }
+
+    static void write(void* context, const uint8_t* data, size_t length) {
+        FakeReceiver& r = self(context);
+        if (!r.script.present || r.host_baud != r.receiver_baud) {
+            return;
+        }
+        r.time_ms += static_cast<uint32_t>(length * 10 * 1000 / r.host_baud) + 1;
+        r.handle_command(data, length);
+    }
+
+    static size_t read(void* context, char* buffer, size_t length) {
+        FakeReceiver& r = self(context);
+        r.emit_sentences();
+        size_t count = 0;
+        while (count < length && !r.wire.empty() && r.wire.front().due_ms <= r.time_ms) {
+            Transfer& transfer = r.wire.front();
+            if (transfer.baud != r.host_baud) {
+                r.wire.pop_front();
+                continue;
+            }
+            buffer[count++] = transfer.bytes[0];
+            transfer.bytes.erase(0, 1);
+            if (transfer.bytes.empty()) {
+                r.wire.pop_front();
+            }
+        }
+        return count;
+    }
+
+    static void set_baud(void* context, uint32_t baud) {
+        self(context).host_baud = baud;
+    }
+
+    static uint32_t now_ms(void* context) {
+        return self(context).time_ms;
+    }
+
+    static void sleep_ms(void* context, uint32_t ms) {
+        self(context).time_ms += ms;
+    }
+
+    void emit_sentences() {
+        if (!script.present) {
+            return;
+        }
+        while (next_sentence_ms <= time_ms) {
+            queue(next_sentence_ms, nmea_sentence("GPRMC,123519.00,A,4807.038,N,01131.000,E,0.0,0.0,230394,,,A"));
+            next_sentence_ms += SENTENCE_PERIOD_MS;
+        }
+    }
+
+    void queue(uint32_t due_ms, const std::string& bytes) {
+        wire.push_back({due_ms, receiver_baud, bytes});
+    }
+
+    void answer(Reply reply, const std::string& ack, const std::string& nack) {
+        if (reply == Reply::ACK) {
+            queue(time_ms + REPLY_DELAY_MS, ack);
+        } else if (reply == Reply::NACK) {
+            queue(time_ms + REPLY_DELAY_MS, nack);
+        }
+    }
+
+    void handle_command(const uint8_t* data, size_t length) {
+        CommandKind kind = CommandKind::UNKNOWN;
+        uint32_t baud = 0;
+        std::string ack;
+        std::string nack;
+
+        if (type == GpsReceiverType::MTK) {
+            std::string text(reinterpret_cast<const char*>(data), length);
+            std::string number = text.substr(5, 3);
+            kind = number == "251" ? CommandKind::BAUD : number == "220" ? CommandKind::RATE :
+                   number == "314" ? CommandKind::OUTPUT : CommandKind::UNKNOWN;
+            if (kind == CommandKind::BAUD) {
+                baud = static_cast<uint32_t>(strtoul(text.c_str() + 9, nullptr, 10));
+            }
+            ack = nmea_sentence(("PMTK001," + number + ",3").c_str());
+            nack = nmea_sentence(("PMTK001," + number + ",1").c_str());
+        } else {
+            if (length >= 8 && data[2] == 0x06) {
+                kind = data[3] == 0x00 ? CommandKind::BAUD : data[3] == 0x08 ? CommandKind::RATE :
+                       data[3] == 0x01 ? CommandKind::OUTPUT : CommandKind::UNKNOWN;
+            }
+            if (kind == CommandKind::BAUD) {
+                baud = data[14] | data[15] << 8 | data[16] << 16 | static_cast<uint32_t>(data[17]) << 24;
+            }
+            ack = ubx_ack(true, data[2], data[3]);
+            nack = ubx_ack(false, data[2], data[3]);
+        }
+
+        switch (kind) {
+            case CommandKind::BAUD:
+                if (script.follow_baud) {
+                    receiver_baud = baud;
+                }
+                break;
+            case CommandKind::RATE:
+                answer(script.rate, ack, nack);
+                break;
+            case CommandKind::OUTPUT:
+                answer(script.output, ack, nack);
+                break;
+            default:
+                break;
+        }
+    }
+
+    GpsReceiverType type;
+    Script script;
+    uint32_t receiver_baud;
+    uint32_t time_ms = 0;
+    uint32_t next_sentence_ms = 0;
+    std::deque<Transfer> wire;
+};
+
+size_t output_commands(GpsReceiverType type) {
+    uint8_t command[GPS_CONFIG_MAX_COMMAND];
+    size_t count = 0;
+    while (gps_receiver_profile(type).build_output(static_cast<uint8_t>(count), command, sizeof(command)) > 0) {
+        count++;
+    }
+    return count;
+}
+
+const char* state_name(GpsConfigState state) {
+    switch (state) {
+        case GpsConfigState::DEFAULT:     return "DEFAULT";
+        case GpsConfigState::CONFIGURED:  return "CONFIGURED";
+        case GpsConfigState::PARTIAL:     return "PARTIAL";
+        case GpsConfigState::NO_RECEIVER: return "NO_RECEIVER";
+    }
+    return "?";
+}
+
+/**
+ * @brief Runs one scenario and compares the outcome.
+ * @return True if the outcome is the expected one.
+ */
+bool run(GpsReceiverType type, const char* name, const Script& script, const Expected& expected) {
+    FakeReceiver receiver(type, script);
+    GpsConfigLink link = receiver.link();
+    GpsConfigStatus status = {GPS_CONFIG_DEFAULT_RECEIVER, GPS_UART_BAUD_RATE, 1, GpsConfigState::DEFAULT, 0, 0, 0, 0, 0};
+
+    gps_config_run(link, status, type, GPS_CONFIG_DEFAULT_BAUD, GPS_CONFIG_DEFAULT_RATE_HZ);
+
+    bool pass = status.state == expected.state && status.baud == expected.baud && receiver.host_baud == expected.baud &&
+                status.rate_hz == expected.rate_hz && status.acks == expected.acks && status.nacks == expected.nacks &&
+                status.timeouts == expected.timeouts && status.fallbacks == expected.fallbacks;
+
+    printf("%-4s %-22s %-11s %6u %3u Hz %4u %5u %8u %9u %7u ms  %s\n", gps_receiver_profile(type).name, name,
+           state_name(status.state), status.baud, status.rate_hz, status.acks, status.nacks, status.timeouts,
+           status.fallbacks, status.duration_ms, pass ? "ok" : "FAIL");
+    if (!pass) {
+        printf("     expected %-11s %6u %3u Hz %4u %5u %8u %9u\n", state_name(expected.state), expected.baud,
+               expected.rate_hz, expected.acks, expected.nacks, expected.timeouts, expected.fallbacks);
+    }
+    return pass;
+}
+
+}
+
+int main() {
+    printf("%-4s %-22s %-11s %6s %6s %4s %5s %8s %9s %10s\n", "type", "scenario", "state", "baud", "rate", "acks",
+           "nacks", "timeouts", "fallbacks", "duration");
+
+    const uint32_t fast = GPS_CONFIG_DEFAULT_BAUD;
+    const uint32_t slow = GPS_UART_BAUD_RATE;
+    const uint32_t slow_rate = slow / 3000 < GPS_CONFIG_DEFAULT_RATE_HZ ? slow / 3000 : GPS_CONFIG_DEFAULT_RATE_HZ;
+    bool pass = true;
+
+    for (GpsReceiverType type : {GpsReceiverType::MTK, GpsReceiverType::UBX}) {
+        uint32_t outputs = static_cast<uint32_t>(output_commands(type));
+        const uint32_t rate = GPS_CONFIG_DEFAULT_RATE_HZ;
+
+        Script script;
+        pass &= run(type, "all acknowledged", script,
+                    {GpsConfigState::CONFIGURED, fast, rate, outputs + 1, 0, 0, 0});
+
+        script = Script();
+        script.start_baud = fast;
+        pass &= run(type, "already at new baud", script,
+                    {GpsConfigState::CONFIGURED, fast, rate, outputs + 1, 0, 0, 0});
+
+        script = Script();
+        script.rate = Reply::NACK;
+        pass &= run(type, "rate rejected", script,
+                    {GpsConfigState::PARTIAL, fast, 1, outputs, 1, 0, 0});
+
+        script = Script();
+        script.output = Reply::NACK;
+        pass &= run(type, "output rejected", script,
+                    {GpsConfigState::PARTIAL, fast, rate, 1, outputs, 0, 0});
+
+        script = Script();
+        script.output = Reply::SILENT;
+        pass &= run(type, "output unanswered", script,
+                    {GpsConfigState::PARTIAL, fast, rate, 1, 0, outputs, 0});
+
+        script = Script();
+        script.rate = Reply::SILENT;
+        pass &= run(type, "rate unanswered", script,
+                    {GpsConfigState::PARTIAL, fast, 1, outputs, 0, 1, 0});
+
+        script = Script();
+        script.follow_baud = false;
+        pass &= run(type, "baud change ignored", script,
+                    {GpsConfigState::PARTIAL, slow, slow_rate, outputs + 1, 0, 0, 1});
+
+        script = Script();
+        script.present = false;
+        pass &= run(type, "no receiver", script,
+                    {GpsConfigState::NO_RECEIVER, slow, 1, 0, 0, 0, 0});
+    }
+
+    printf("%s\n", pass ? "all scenarios passed" : "SCENARIOS FAILED");
+    return pass ? 0 : 2;
+}
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Host decoder of raw deferred log records (lib/log.h).
+
+The site table is read from the LOG_SITES macro of lib/log.h, so the decoder
+always matches the tree it is run from; decode records with the log.h of the
+build that wrote them, since site IDs are positions in the table.
+
+A record is the LogRecord struct, 20 bytes little-endian:
+
+    offset 0   uint32  timestamp_ms   ms since boot
+    offset 4   uint16  site           position in LOG_SITES
+    offset 6   uint16  reserved       0
+    offset 8   uint32  args[3]        interpreted by the site format
+
+sites
+    Lists the site IDs with level and format.
+
+decode
+    Formats records from a binary file (e.g. a memory dump of a log ring taken
+    over SWD) or, with --hex, from text with one record of 40 hex digits per
+    line. All-zero records (unused ring slots) are skipped. Exits with 2 if a
+    record has an unknown site.
+
+Examples:
+    python3 tools/log_decode.py sites
+    python3 tools/log_decode.py decode ring0.bin --sort
+    python3 tools/log_decode.py decode records.txt --hex
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+RECORD_FORMAT = "<IHH3I"
+RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "lib", "log.h")
+
+SITE_ENTRY = re.compile(r'X\(\s*(\w+)\s*,\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+CONVERSION = re.compile(r"%(-?\d*)([udx%])")
+
+
+def read_sites(path):
+    """Returns [(name, level, format)] in LOG_SITES order."""
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    start = text.find("#define LOG_SITES(X)")
+    if start < 0:
+        raise ValueError("no LOG_SITES table in %s" % path)
+    # the macro ends at the first line not continued with a backslash
+    lines = []
+    for line in text[start:].splitlines():
+        lines.append(line)
+        if not line.rstrip().endswith("\\"):
+            break
+    return SITE_ENTRY.findall("\n".join(lines))
+
+
+def format_message(fmt, args):
+    """Applies a site format with up to three %u / %d / %x to raw uint32 arguments."""
+    remaining = list(args)
+
+    def convert(match):
+        width, kind = match.groups()
+        if kind == "%":
+            return "%"
+        value = remaining.pop(0) if remaining else 0
+        if kind == "d" and value & 0x80000000:
+            value -= 1 << 32
+        return ("%" + width + ("x" if kind == "x" else "d")) % value
+
+    return CONVERSION.sub(convert, fmt.encode().decode("unicode_escape"))
+
+
+def read_records(path, hex_text):
+    if hex_text:
+        records = []
+        with open(path) as f:
+            for line in f:
+                line = re.sub(r"\s", "", line)
+                if line:
+                    records.append(bytes.fromhex(line))
+        return records
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) % RECORD_SIZE:
+        print("%s: %d trailing bytes ignored" % (path, len(data) % RECORD_SIZE), file=sys.stderr)
+    return [data[i:i + RECORD_SIZE] for i in range(0, len(data) - RECORD_SIZE + 1, RECORD_SIZE)]
+
+
+def command_sites(args, sites):
+    print("%4s  %-24s %-8s %s" % ("id", "site", "level", "format"))
+    for site_id, (name, level, fmt) in enumerate(sites):
+        print("%4d  %-24s %-8s %s" % (site_id, name, level, fmt))
+    return 0
+
+
+def command_decode(args, sites):
+    decoded = []
+    unknown = 0
+    for path in args.records:
+        for raw in read_records(path, args.hex):
+            if len(raw) != RECORD_SIZE:
+                print("%s: record of %d bytes skipped" % (path, len(raw)), file=sys.stderr)
+                continue
+            timestamp, site, _, *values = struct.unpack(RECORD_FORMAT, raw)
+            if not any(raw):
+                continue
+            if site >= len(sites):
+                print("%s: unknown site %d at %d ms" % (path, site, timestamp), file=sys.stderr)
+                unknown += 1
+                continue
+            name, level, fmt = sites[site]
+            decoded.append((timestamp, level, name, format_message(fmt, values)))
+
+    if args.sort:
+        decoded.sort(key=lambda record: record[0])
+    for timestamp, level, name, message in decoded:
+        print("%10d ms  %-8s %-24s %s" % (timestamp, level, name, message))
+    return 2 if unknown else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="log.h holding LOG_SITES")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    commands.add_parser("sites", help="list the log sites")
+
+    decode_parser = commands.add_parser("decode", help="format raw records")
+    decode_parser.add_argument("records", nargs="+", help="binary record files, or text with --hex")
+    decode_parser.add_argument("--hex", action="store_true", help="one record of 40 hex digits per line")
+    decode_parser.add_argument("--sort", action="store_true", help="order records by timestamp")
+
+    args = parser.parse_args()
+    sites = read_sites(args.header)
+    return command_sites(args, sites) if args.command == "sites" else command_decode(args, sites)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,236 @@
+/**
+ * @file nav_replay.cpp
+ * @brief Host replay of the navigation filter over recorded telemetry
+ * @details Feeds lib/location/nav_filter.cpp with the pressure column of a
+ *          sensors.csv log and the GPS points of a KML track downloaded from
+ *          the ground station, one step per sensor sample like
+ *          TelemetryManager::collect_nav_telemetry(). GPS power duty cycling is
+ *          emulated by only passing the fixes of the first WINDOW seconds of
+ *          every PERIOD seconds; the fixes withheld are the reference for the
+ *          altitude and position error during the outages, compared with
+ *          holding the last GPS value.
+ *
+ *          The wall time of every filter step is measured; note that it is host
+ *          time, the RP2040 has no FPU and is considerably slower.
+ *
+ *          Build and run from the repository root:
+ *
+ *              g++ -O2 -std=c++17 -I lib/location -o nav_replay tools/nav_replay.cpp lib/location/nav_filter.cpp
+ *              ./nav_replay telemetry_test/sensors.csv telemetry_test/kubisat_trajectory_20250320_120007.kml 60 10
+ *
+ *          Arguments: SENSORS_CSV KML [PERIOD_S WINDOW_S [UTC_OFFSET_S]]. The
+ *          sensor log uses local time; UTC_OFFSET_S (3600 by default) is
+ *          subtracted to match the UTC names of the KML placemarks.
+ */
+
+#include "nav_filter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct GpsPoint {
+    double latitude;
+    double longitude;
+    double altitude;
+};
+
+struct ErrorStats {
+    std::vector<double> errors;
+
+    void add(double error) { errors.push_back(std::fabs(error)); }
+
+    /** @brief Error below which a fraction of the samples lie. */
+    double percentile(double fraction) {
+        if (errors.empty()) {
+            return 0.0;
+        }
+        std::sort(errors.begin(), errors.end());
+        return errors[static_cast<size_t>(fraction * (errors.size() - 1))];
+    }
+};
+
+std::string between(const std::string& text, const std::string& open, const std::string& close, size_t& position) {
+    size_t start = text.find(open, position);
+    if (start == std::string::npos) {
+        position = std::string::npos;
+        return "";
+    }
+    start += open.size();
+    size_t end = text.find(close, start);
+    position = end == std::string::npos ? end : end + close.size();
+    return text.substr(start, end - start);
+}
+
+/**
+ * @brief Reads the timestamped Point placemarks of a ground station KML.
+ */
+std::map<long, GpsPoint> read_kml(const char* path) {
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    std::map<long, GpsPoint> points;
+    size_t position = 0;
+    while (position != std::string::npos) {
+        std::string placemark = between(text, "<Placemark>", "</Placemark>", position);
+        if (placemark.find("<Point>") == std::string::npos) {
+            continue;
+        }
+        size_t inner = 0;
+        std::string name = between(placemark, "<name>", "</name>", inner);
+        inner = 0;
+        std::string coordinates = between(placemark, "<coordinates>", "</coordinates>", inner);
+
+        struct tm time = {};
+        GpsPoint point;
+        if (sscanf(name.c_str(), "%d-%d-%d %d:%d:%d", &time.tm_year, &time.tm_mon, &time.tm_mday,
+                   &time.tm_hour, &time.tm_min, &time.tm_sec) != 6 ||
+            sscanf(coordinates.c_str(), "%lf,%lf,%lf", &point.longitude, &point.latitude, &point.altitude) != 3) {
+            continue;
+        }
+        time.tm_year -= 1900;
+        time.tm_mon -= 1;
+        points[static_cast<long>(timegm(&time))] = point;
+    }
+    return points;
+}
+
+double distance_m(const GpsPoint& a, const GpsPoint& b) {
+    double north = (a.latitude - b.latitude) * 111319.491;
+    double east = (a.longitude - b.longitude) * 111319.491 * std::cos(a.latitude * M_PI / 180.0);
+    return std::sqrt(north * north + east * east);
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s SENSORS_CSV KML [PERIOD_S WINDOW_S [UTC_OFFSET_S]]\n", argv[0]);
+        return 1;
+    }
+    long period = argc > 4 ? atol(argv[3]) : 1;
+    long window = argc > 4 ? atol(argv[4]) : 1;
+    long utc_offset = argc > 5 ? atol(argv[5]) : 3600;
+    if (period <= 0 || window <= 0) {
+        fprintf(stderr, "PERIOD_S and WINDOW_S must be positive\n");
+        return 1;
+    }
+
+    std::map<long, GpsPoint> track = read_kml(argv[2]);
+    std::ifstream sensors(argv[1]);
+    if (track.empty() || !sensors) {
+        fprintf(stderr, "no GPS points or sensor log\n");
+        return 1;
+    }
+
+    NavigationFilter filter;
+    ErrorStats fused_altitude;
+    ErrorStats held_altitude;
+    ErrorStats fused_position;
+    ErrorStats held_position;
+    std::vector<double> step_ns;
+
+    long first_time = 0;
+    long previous_time = 0;
+    bool have_gps = false;
+    GpsPoint last_gps = {};
+    size_t samples = 0;
+
+    std::string line;
+    while (std::getline(sensors, line)) {
+        long local_time;
+        float temperature;
+        float pressure;
+        if (sscanf(line.c_str(), "%ld,%f,%f", &local_time, &temperature, &pressure) != 3) {
+            continue;
+        }
+        long time = local_time - utc_offset;
+        if (samples == 0) {
+            first_time = time;
+        }
+
+        auto fix = track.find(time);
+        bool in_window = (time - first_time) % period < window;
+        NavGpsInput gps = {};
+        if (fix != track.end()) {
+            gps.latitude_e7 = static_cast<int32_t>(std::lround(fix->second.latitude * 1e7));
+            gps.longitude_e7 = static_cast<int32_t>(std::lround(fix->second.longitude * 1e7));
+            gps.altitude_m = static_cast<float>(fix->second.altitude);
+            gps.has_altitude = true;
+
+            // the KML has no RMC velocity, emulate it from the neighbouring points
+            auto before = track.find(time - 1);
+            auto after = track.find(time + 1);
+            if (before != track.end() && after != track.end()) {
+                double north = (after->second.latitude - before->second.latitude) * 111319.491 / 2.0;
+                double east = (after->second.longitude - before->second.longitude) * 111319.491 *
+                              std::cos(fix->second.latitude * M_PI / 180.0) / 2.0;
+                double course = std::atan2(east, north) * 180.0 / M_PI;
+                gps.speed_mps = static_cast<float>(std::sqrt(north * north + east * east));
+                gps.course_deg = static_cast<float>(course < 0.0 ? course + 360.0 : course);
+                gps.has_velocity = true;
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (samples != 0) {
+            filter.predict(static_cast<float>(time - previous_time));
+        }
+        filter.update_baro(pressure);
+        if (fix != track.end() && in_window) {
+            filter.update_gps(gps);
+        }
+        NavFusedState state = filter.get_state();
+        auto end = std::chrono::steady_clock::now();
+        step_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+
+        if (fix != track.end()) {
+            if (!in_window && have_gps && state.has_position) {
+                GpsPoint fused = {state.latitude_e7 * 1e-7, state.longitude_e7 * 1e-7, state.altitude_m};
+                fused_altitude.add(state.altitude_m - fix->second.altitude);
+                held_altitude.add(last_gps.altitude - fix->second.altitude);
+                fused_position.add(distance_m(fused, fix->second));
+                held_position.add(distance_m(last_gps, fix->second));
+            }
+            if (in_window) {
+                last_gps = fix->second;
+                have_gps = true;
+            }
+        }
+        previous_time = time;
+        samples++;
+    }
+
+    NavFilterStats stats = filter.get_stats();
+    double total_ns = 0.0;
+    double worst_ns = 0.0;
+    for (double ns : step_ns) {
+        total_ns += ns;
+        worst_ns = ns > worst_ns ? ns : worst_ns;
+    }
+
+    printf("samples %zu, gps points %zu, gps %ld s of every %ld s\n", samples, track.size(), window, period);
+    printf("filter: %u baro, %u gps updates, %u rejects, %u resets\n",
+           stats.baro_updates, stats.gps_updates, stats.gps_rejects, stats.resets);
+    printf("outage samples %zu, absolute error median / 95th percentile / max\n", fused_altitude.errors.size());
+    printf("  altitude  fused %6.1f / %6.1f / %6.1f m   held gps %6.1f / %6.1f / %6.1f m\n",
+           fused_altitude.percentile(0.5), fused_altitude.percentile(0.95), fused_altitude.percentile(1.0),
+           held_altitude.percentile(0.5), held_altitude.percentile(0.95), held_altitude.percentile(1.0));
+    printf("  position  fused %6.1f / %6.1f / %6.1f m   held gps %6.1f / %6.1f / %6.1f m\n",
+           fused_position.percentile(0.5), fused_position.percentile(0.95), fused_position.percentile(1.0),
+           held_position.percentile(0.5), held_position.percentile(0.95), held_position.percentile(1.0));
+    printf("step time (host): mean %.0f ns, max %.0f ns\n",
+           step_ns.empty() ? 0.0 : total_ns / step_ns.size(), worst_ns);
+    return 0;
+}
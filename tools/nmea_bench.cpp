@@ -0,0 +1,149 @@
+/**
+ * @file nmea_bench.cpp
+ * @brief Host benchmark of the NMEA parser over recorded logs
+ * @details Feeds every sentence of a recorded NMEA log to
+ *          lib/location/NMEA/nmea_parser.cpp into one running GpsFix, the way
+ *          gps_collector.cpp does, and reports per sentence type the accepted
+ *          and rejected counts, counted like the parse statistics of command
+ *          7.3, and the mean and largest parse time. Each sentence is parsed
+ *          REPEAT times in a row to time it above the clock resolution, each
+ *          time into its own copy of the running fix, since GSA and GSV
+ *          sentences add to the fix; the running fix itself gets every
+ *          sentence once.
+ *
+ *          Lines may carry a prefix such as a timestamp; the sentence starts at
+ *          the first '$'. Lines without one are skipped.
+ *          telemetry_test/gps_sample.nmea is a short sample log: acquisition
+ *          without a fix, fixed sentences along the recorded test trajectory,
+ *          a sentence with a bad checksum and an unsupported one.
+ *
+ *          Note that the times are host times, the RP2040 is considerably slower.
+ *
+ *          Build and run from the repository root:
+ *
+ *              g++ -O2 -std=c++17 -I lib/location/NMEA -o nmea_bench tools/nmea_bench.cpp lib/location/NMEA/nmea_parser.cpp
+ *              ./nmea_bench telemetry_test/gps_sample.nmea
+ *
+ *          Arguments: NMEA_LOG [REPEAT], REPEAT being 100 by default.
+ */
+
+#include "nmea_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t TYPE_COUNT = static_cast<size_t>(NmeaSentence::COUNT);
+
+const char* const TYPE_NAMES[TYPE_COUNT] = {"other", "RMC", "GGA", "GSA", "GSV"};
+
+/**
+ * @brief Counters and parse times of one sentence type.
+ */
+struct TypeStats {
+    size_t sentences = 0;
+    size_t accepted = 0;
+    size_t rejected = 0;
+    size_t checksum_errors = 0;
+    size_t unsupported = 0;
+    double total_ns = 0.0;
+    double max_ns = 0.0;
+};
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s NMEA_LOG [REPEAT]\n", argv[0]);
+        return 1;
+    }
+    int repeat = argc > 2 ? atoi(argv[2]) : 100;
+    if (repeat < 1) {
+        repeat = 1;
+    }
+
+    std::ifstream file(argv[1]);
+    if (!file) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<std::string> sentences;
+    std::string line;
+    size_t skipped = 0;
+    while (std::getline(file, line)) {
+        size_t start = line.find('$');
+        if (start == std::string::npos) {
+            skipped++;
+            continue;
+        }
+        size_t end = line.find_last_not_of("\r\n");
+        sentences.push_back(line.substr(start, end + 1 - start));
+    }
+    if (sentences.empty()) {
+        fprintf(stderr, "no sentences in %s\n", argv[1]);
+        return 1;
+    }
+
+    TypeStats stats[TYPE_COUNT];
+    TypeStats total;
+    GpsFix fix = {};
+    std::vector<GpsFix> scratch(repeat);
+
+    for (const std::string& sentence : sentences) {
+        NmeaSentence type = NmeaSentence::UNKNOWN;
+
+        std::fill(scratch.begin(), scratch.end(), fix);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat; i++) {
+            nmea_parse_sentence(sentence.c_str(), sentence.size(), scratch[i], type);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / repeat;
+
+        NmeaStatus status = nmea_parse_sentence(sentence.c_str(), sentence.size(), fix, type);
+
+        for (TypeStats* s : {&stats[static_cast<size_t>(type)], &total}) {
+            s->sentences++;
+            s->total_ns += ns;
+            if (ns > s->max_ns) {
+                s->max_ns = ns;
+            }
+            switch (status) {
+                case NmeaStatus::OK:
+                    s->accepted++;
+                    break;
+                case NmeaStatus::UNSUPPORTED:
+                    s->unsupported++;
+                    break;
+                case NmeaStatus::BAD_CHECKSUM:
+                    s->checksum_errors++;
+                    s->rejected++;
+                    break;
+                default:
+                    s->rejected++;
+                    break;
+            }
+        }
+    }
+
+    printf("%-6s %9s %9s %9s %9s %11s %9s %9s\n", "type", "sentences", "accepted", "rejected", "checksum",
+           "unsupported", "mean_ns", "max_ns");
+    for (size_t t = 0; t <= TYPE_COUNT; t++) {
+        const TypeStats& s = t < TYPE_COUNT ? stats[t] : total;
+        if (s.sentences == 0) {
+            continue;
+        }
+        printf("%-6s %9zu %9zu %9zu %9zu %11zu %9.1f %9.1f\n", t < TYPE_COUNT ? TYPE_NAMES[t] : "total",
+               s.sentences, s.accepted, s.rejected, s.checksum_errors, s.unsupported, s.total_ns / s.sentences,
+               s.max_ns);
+    }
+    printf("%zu lines without a sentence skipped, %d parses per sentence\n", skipped, repeat);
+    printf("last fix: rmc_valid %d, lat %.7f, lon %.7f, %u satellites\n", fix.rmc_valid ? 1 : 0,
+           fix.latitude_e7 * 1e-7, fix.longitude_e7 * 1e-7, fix.satellites);
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file power_events_replay.cpp
+ * @brief Host replay of the power events over recorded telemetry
+ * @details Runs lib/powerman/power_events.cpp over the power columns of a
+ *          telemetry.csv log, once as a battery powered and once as a USB
+ *          powered board, followed by a synthetic battery voltage ramp from
+ *          4.3 V down to 0 V and back, which covers a USB bench supply
+ *          without a cell. Every event is listed with its time.
+ *
+ *          The battery level events drive the default load shedding reaction
+ *          rules; the replay fails if any of them is produced on USB power, or
+ *          if the ramp does not produce them on battery power.
+ *
+ *          Build and run from the repository root:
+ *
+ *              g++ -O2 -std=c++17 -I lib/powerman -I lib/eventman -o power_events_replay tools/power_events_replay.cpp lib/powerman/power_events.cpp
+ *              ./power_events_replay telemetry_test/telemetry.csv
+ */
+
+#include "power_events.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Sample {
+    uint32_t time;
+    PowerSample power;
+};
+
+const char* event_name(PowerEvent event) {
+    switch (event) {
+        case PowerEvent::BATTERY_LOW:      return "BATTERY_LOW";
+        case PowerEvent::BATTERY_FULL:     return "BATTERY_FULL";
+        case PowerEvent::BATTERY_NORMAL:   return "BATTERY_NORMAL";
+        case PowerEvent::SOLAR_ACTIVE:     return "SOLAR_ACTIVE";
+        case PowerEvent::SOLAR_INACTIVE:   return "SOLAR_INACTIVE";
+        case PowerEvent::USB_CONNECTED:    return "USB_CONNECTED";
+        case PowerEvent::USB_DISCONNECTED: return "USB_DISCONNECTED";
+        case PowerEvent::DISCHARGING:      return "DISCHARGING";
+        case PowerEvent::CHARGING:         return "CHARGING";
+        default:                           return "?";
+    }
+}
+
+bool is_battery_level(PowerEvent event) {
+    return event == PowerEvent::BATTERY_LOW || event == PowerEvent::BATTERY_FULL ||
+           event == PowerEvent::BATTERY_NORMAL;
+}
+
+/**
+ * @brief Reads time, battery voltage and the three currents of a telemetry.csv.
+ */
+std::vector<Sample> read_telemetry(const char* path) {
+    std::vector<Sample> samples;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 7 || fields[0].empty() || !isdigit(fields[0][0])) {
+            continue;
+        }
+        Sample sample;
+        sample.time = static_cast<uint32_t>(strtoul(fields[0].c_str(), nullptr, 10));
+        sample.power.battery_voltage = strtof(fields[2].c_str(), nullptr);
+        sample.power.charge_current_usb = strtof(fields[4].c_str(), nullptr);
+        sample.power.charge_current_solar = strtof(fields[5].c_str(), nullptr);
+        sample.power.discharge_current = strtof(fields[6].c_str(), nullptr);
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+/**
+ * @brief Battery voltage ramp 4.3 V -> 0 V -> 4.3 V in 0.1 V steps, no currents.
+ */
+std::vector<Sample> voltage_ramp(uint32_t start_time) {
+    std::vector<Sample> samples;
+    for (int step = 0; step <= 86; step++) {
+        int decivolts = step <= 43 ? 43 - step : step - 43;
+        samples.push_back({start_time + static_cast<uint32_t>(step), {decivolts / 10.0f, 0.0f, 0.0f, 0.0f}});
+    }
+    return samples;
+}
+
+/**
+ * @brief Replays samples and counts the battery level events.
+ */
+size_t replay(const char* label, const std::vector<Sample>& samples, bool battery_powered) {
+    PowerEventState state;
+    PowerEvent events[POWER_EVENTS_MAX_PER_SAMPLE];
+    size_t battery_events = 0;
+    size_t total = 0;
+
+    printf("%s, %s powered, %zu samples\n", label, battery_powered ? "battery" : "USB", samples.size());
+    for (const Sample& sample : samples) {
+        size_t count = power_events_update(state, sample.power, battery_powered, events);
+        for (size_t i = 0; i < count; i++) {
+            printf("  %10u %5.2f V  %s\n", sample.time, sample.power.battery_voltage, event_name(events[i]));
+            battery_events += is_battery_level(events[i]) ? 1 : 0;
+        }
+        total += count;
+    }
+    printf("  %zu events, %zu battery level events\n", total, battery_events);
+    return battery_events;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s TELEMETRY_CSV\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Sample> recorded = read_telemetry(argv[1]);
+    std::vector<Sample> ramp = voltage_ramp(recorded.empty() ? 0 : recorded.back().time + 1);
+
+    replay("recorded", recorded, true);
+    size_t usb_recorded = replay("recorded", recorded, false);
+    size_t battery_ramp = replay("ramp", ramp, true);
+    size_t usb_ramp = replay("ramp", ramp, false);
+
+    bool quiet_on_usb = usb_recorded == 0 && usb_ramp == 0;
+    bool active_on_battery = battery_ramp > 0;
+    printf("battery level events on USB power: %s\n", quiet_on_usb ? "none" : "PRESENT");
+    printf("battery level events on battery power: %s\n", active_on_battery ? "present" : "MISSING");
+    return quiet_on_usb && active_on_battery ? 0 : 2;
+}
@@ -0,0 +1,298 @@
+#!/usr/bin/env python3
+"""Ground tool for the on-board trajectory store (command 7.9).
+
+decode
+    Converts 7.9 responses (TOTAL,START,COUNT,HEX, one per line) to a KML track.
+
+benchmark
+    Runs the on-board sliding window simplification (lib/location/trajectory.cpp)
+    over the LineString of KML tracks recorded at 1 Hz and reports the point
+    reduction, the encoded size and the largest deviation from the original.
+    Exits with 2 if the deviation exceeds the tolerance on any track.
+
+Examples:
+    python3 tools/trajectory_kml.py decode responses.txt -o track.kml
+    python3 tools/trajectory_kml.py benchmark telemetry_test/*.kml --tolerance 10
+"""
+
+import argparse
+import math
+import re
+import struct
+import sys
+from datetime import datetime, timezone
+
+FORMAT_VERSION = 1
+METRES_PER_E7_DEGREE = 0.0111319491
+WINDOW_SIZE = 32
+CAPACITY = 512
+RAW_POINT_SIZE = 16
+
+
+# ---------------------------------------------------------------- encoding
+
+def zigzag_varint(value):
+    zigzag = ((value << 1) ^ (value >> 31)) & 0xFFFFFFFF
+    out = bytearray()
+    while zigzag >= 0x80:
+        out.append((zigzag & 0x7F) | 0x80)
+        zigzag >>= 7
+    out.append(zigzag)
+    return bytes(out)
+
+
+def encode(points):
+    """Encodes (time, lat_e7, lon_e7, alt_dm) tuples like TrajectoryStore::encode."""
+    out = bytearray([FORMAT_VERSION])
+    for i, point in enumerate(points):
+        if i == 0:
+            out += struct.pack("<Iiii", *point)
+        else:
+            previous = points[i - 1]
+            for field in range(4):
+                delta = (point[field] - previous[field]) & 0xFFFFFFFF
+                out += zigzag_varint(delta - (1 << 32) if delta & 0x80000000 else delta)
+    return bytes(out)
+
+
+def decode(data):
+    if not data:
+        return []
+    if data[0] != FORMAT_VERSION:
+        raise ValueError("unsupported format version %d" % data[0])
+    if len(data) < 17:
+        return []
+
+    point = list(struct.unpack_from("<Iiii", data, 1))
+    points = [tuple(point)]
+    position = 17
+    while position < len(data):
+        for field in range(4):
+            value = 0
+            shift = 0
+            while True:
+                byte = data[position]
+                position += 1
+                value |= (byte & 0x7F) << shift
+                shift += 7
+                if not byte & 0x80:
+                    break
+            delta = (value >> 1) ^ -(value & 1)
+            point[field] += delta
+        point[0] &= 0xFFFFFFFF
+        points.append(tuple(point))
+    return points
+
+
+# ---------------------------------------------------------------- simplification
+
+def to_local(point, origin, longitude_scale):
+    return ((point[2] - origin[2]) * longitude_scale,
+            (point[1] - origin[1]) * METRES_PER_E7_DEGREE,
+            (point[3] - origin[3]) * 0.1)
+
+
+def segment_distance(p, segment):
+    squared = sum(c * c for c in segment)
+    t = 0.0
+    if squared > 0.0:
+        t = min(1.0, max(0.0, sum(a * b for a, b in zip(p, segment)) / squared))
+    return math.sqrt(sum((a - t * b) ** 2 for a, b in zip(p, segment)))
+
+
+def longitude_scale_at(point):
+    return METRES_PER_E7_DEGREE * math.cos(math.radians(point[1] * 1e-7))
+
+
+class SlidingWindow:
+    """Python port of TrajectoryStore::add_point."""
+
+    def __init__(self, tolerance_m):
+        self.tolerance = tolerance_m
+        self.kept = []
+        self.anchor = None
+        self.window = []
+        self.full_windows = 0
+
+    def fits(self, end):
+        scale = longitude_scale_at(self.anchor)
+        segment = to_local(end, self.anchor, scale)
+        return all(segment_distance(to_local(p, self.anchor, scale), segment) <= self.tolerance
+                   for p in self.window)
+
+    def add(self, point):
+        if self.anchor is None:
+            self.anchor = point
+            self.kept.append(point)
+        elif not self.window or self.fits(point):
+            if len(self.window) == WINDOW_SIZE:
+                self.anchor = self.window[-1]
+                self.kept.append(self.anchor)
+                self.window = []
+                self.full_windows += 1
+            self.window.append(point)
+        else:
+            self.anchor = self.window[-1]
+            self.kept.append(self.anchor)
+            self.window = [point]
+
+    def polyline(self):
+        return self.kept + self.window[-1:]
+
+
+def max_deviation(original, simplified):
+    """Largest distance of an original point to the simplified polyline segment covering it."""
+    worst = 0.0
+    segment_index = 0
+    times = [p[0] for p in simplified]
+    for point in original:
+        while segment_index + 2 < len(simplified) and point[0] > times[segment_index + 1]:
+            segment_index += 1
+        start = simplified[segment_index]
+        end = simplified[min(segment_index + 1, len(simplified) - 1)]
+        scale = longitude_scale_at(start)
+        worst = max(worst, segment_distance(to_local(point, start, scale), to_local(end, start, scale)))
+    return worst
+
+
+# ---------------------------------------------------------------- KML
+
+def read_kml_track(path):
+    with open(path, encoding="utf-8-sig") as f:
+        text = f.read()
+    match = re.search(r"<LineString>.*?<coordinates>(.*?)</coordinates>", text, re.S)
+    if not match:
+        raise ValueError("%s: no LineString coordinates" % path)
+
+    points = []
+    for second, token in enumerate(match.group(1).split()):
+        fields = token.split(",")
+        longitude = float(fields[0])
+        latitude = float(fields[1])
+        altitude = float(fields[2]) if len(fields) > 2 else 0.0
+        points.append((second, round(latitude * 1e7), round(longitude * 1e7), round(altitude * 10)))
+    return points
+
+
+def write_kml(points, path):
+    lines = [
+        '<?xml version="1.0" encoding="UTF-8"?>',
+        '<kml xmlns="http://www.opengis.net/kml/2.2">',
+        "<Document>",
+        "  <name>KubiSat GPS Track</name>",
+        "  <description>Simplified track downlinked from the KubiSat trajectory store</description>",
+        '  <Style id="yellowLineGreenPoly">',
+        "    <LineStyle>",
+        "      <color>7f00ffff</color>",
+        "      <width>4</width>",
+        "    </LineStyle>",
+        "    <PolyStyle>",
+        "      <color>7f00ff00</color>",
+        "    </PolyStyle>",
+        "  </Style>",
+        "  <Placemark>",
+        "    <name>KubiSat Trajectory</name>",
+        "    <description>Simplified GPS trajectory, %d points</description>" % len(points),
+        "    <styleUrl>#yellowLineGreenPoly</styleUrl>",
+        "    <LineString>",
+        "      <extrude>1</extrude>",
+        "      <tessellate>1</tessellate>",
+        "      <altitudeMode>absolute</altitudeMode>",
+        "      <coordinates>",
+    ]
+    for _, lat, lon, alt in points:
+        lines.append("        %.7f,%.7f,%.1f" % (lon * 1e-7, lat * 1e-7, alt / 10))
+    lines += ["      </coordinates>", "    </LineString>", "  </Placemark>"]
+
+    for time, lat, lon, alt in points:
+        stamp = datetime.fromtimestamp(time, timezone.utc).strftime("%Y-%m-%d %H:%M:%S")
+        lines += [
+            "  <Placemark>",
+            "    <name>%s</name>" % stamp,
+            "    <Point>",
+            "      <altitudeMode>absolute</altitudeMode>",
+            "      <coordinates>%.7f,%.7f,%.1f</coordinates>" % (lon * 1e-7, lat * 1e-7, alt / 10),
+            "    </Point>",
+            "  </Placemark>",
+        ]
+    lines += ["</Document>", "</kml>", ""]
+
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines))
+
+
+# ---------------------------------------------------------------- commands
+
+def command_decode(args):
+    by_index = {}
+    for path in args.responses:
+        with open(path) as f:
+            for line in f:
+                line = line.strip()
+                # accept bare values or whole frames, the value being the last ;-field holding commas
+                fields = [field for field in line.split(";") if field.count(",") == 3] if ";" in line else [line]
+                if not fields:
+                    continue
+                total, start, count, payload = fields[0].split(",")
+                points = decode(bytes.fromhex(payload))
+                if len(points) != int(count):
+                    print("%s: expected %s points, decoded %d" % (path, count, len(points)), file=sys.stderr)
+                for offset, point in enumerate(points):
+                    by_index[int(start) + offset] = point
+
+    points = [by_index[index] for index in sorted(by_index)]
+    if not points:
+        print("no points decoded", file=sys.stderr)
+        return 1
+    write_kml(points, args.output)
+    print("%d points written to %s" % (len(points), args.output))
+    return 0
+
+
+def command_benchmark(args):
+    """Returns 2 if the simplification exceeds the tolerance on any track."""
+    print("%-40s %8s %7s %9s %10s %10s %8s" %
+          ("track", "points", "kept", "reduction", "raw_bytes", "enc_bytes", "max_dev"))
+    bound_held = True
+    for path in args.tracks:
+        track = read_kml_track(path)
+        if not track:
+            continue
+        simplifier = SlidingWindow(args.tolerance)
+        for point in track:
+            simplifier.add(point)
+        polyline = simplifier.polyline()
+
+        encoded = encode(polyline)
+        assert decode(encoded) == polyline
+        reduction = 100.0 * (1.0 - len(polyline) / len(track))
+        deviation = max_deviation(track, polyline)
+        # the firmware computes in single precision
+        held = deviation <= args.tolerance * 1.0001 + 1e-3
+        bound_held = bound_held and held
+        notes = " (exceeds ring of %d)" % CAPACITY if len(polyline) > CAPACITY else ""
+        notes += "" if held else "  BOUND EXCEEDED"
+        print("%-40s %8d %7d %8.1f%% %10d %10d %7.1fm%s" %
+              (path.split("/")[-1], len(track), len(polyline), reduction,
+               len(track) * RAW_POINT_SIZE, len(encoded), deviation, notes))
+    return 0 if bound_held else 2
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    decode_parser = commands.add_parser("decode", help="convert 7.9 responses to KML")
+    decode_parser.add_argument("responses", nargs="+", help="files with one response per line")
+    decode_parser.add_argument("-o", "--output", default="trajectory.kml")
+
+    benchmark_parser = commands.add_parser("benchmark", help="simplify KML tracks like the satellite")
+    benchmark_parser.add_argument("tracks", nargs="+", help="KML files with a LineString track")
+    benchmark_parser.add_argument("--tolerance", type=float, default=10.0, help="tolerance in metres")
+
+    args = parser.parse_args()
+    return command_decode(args) if args.command == "decode" else command_benchmark(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())